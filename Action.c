@@ -28,7 +28,10 @@ in the source distribution for its full text.
 #include "OpenFilesScreen.h"
 #include "Process.h"
 #include "ProcessLocksScreen.h"
+#include "Profile.h"
 #include "ProvideCurses.h"
+#include "Replay.h"
+#include "SamplingScreen.h"
 #include "ScreenManager.h"
 #include "SignalsPanel.h"
 #include "TraceScreen.h"
@@ -396,6 +399,7 @@ static Htop_Reaction actionLsof(State* st) {
       return HTOP_OK;
 
    OpenFilesScreen* ofs = OpenFilesScreen_new(p);
+   InfoScreen_setState((InfoScreen*)ofs, st);
    InfoScreen_run((InfoScreen*)ofs);
    OpenFilesScreen_delete((Object*)ofs);
    clear();
@@ -408,6 +412,7 @@ static Htop_Reaction actionShowLocks(State* st) {
    if (!p)
       return HTOP_OK;
    ProcessLocksScreen* pls = ProcessLocksScreen_new(p);
+   InfoScreen_setState((InfoScreen*)pls, st);
    InfoScreen_run((InfoScreen*)pls);
    ProcessLocksScreen_delete((Object*)pls);
    clear();
@@ -415,6 +420,24 @@ static Htop_Reaction actionShowLocks(State* st) {
    return HTOP_REFRESH | HTOP_REDRAW_BAR;
 }
 
+static Htop_Reaction actionSampleThreads(State* st) {
+   /* recorded processes are not there to be sampled */
+   if (st->pl->replay)
+      return HTOP_OK;
+
+   const Process* p = (Process*) Panel_getSelected((Panel*)st->mainPanel);
+   if (!p)
+      return HTOP_OK;
+
+   SamplingScreen* ss = SamplingScreen_new(p);
+   InfoScreen_setState((InfoScreen*)ss, st);
+   InfoScreen_run((InfoScreen*)ss);
+   SamplingScreen_delete((Object*)ss);
+   clear();
+   CRT_enableDelay();
+   return HTOP_REFRESH | HTOP_REDRAW_BAR;
+}
+
 static Htop_Reaction actionStrace(State* st) {
    if (Settings_isReadonly())
       return HTOP_OK;
@@ -424,6 +447,7 @@ static Htop_Reaction actionStrace(State* st) {
       return HTOP_OK;
 
    TraceScreen* ts = TraceScreen_new(p);
+   InfoScreen_setState((InfoScreen*)ts, st);
    bool ok = TraceScreen_forkTracer(ts);
    if (ok) {
       InfoScreen_run((InfoScreen*)ts);
@@ -454,6 +478,47 @@ static Htop_Reaction actionTogglePauseProcessUpdate(State* st) {
    return HTOP_REFRESH | HTOP_REDRAW_BAR;
 }
 
+static Htop_Reaction seekReplay(State* st, int64_t deltaMs) {
+   if (!st->pl->replay)
+      return HTOP_OK;
+
+   Replay_seek(st->pl->replay, deltaMs);
+   return HTOP_RECALCULATE | HTOP_REDRAW_BAR | HTOP_KEEP_FOLLOWING;
+}
+
+static Htop_Reaction actionSeekReplayBackward(State* st) {
+   return seekReplay(st, -60 * 1000);
+}
+
+static Htop_Reaction actionSeekReplayForward(State* st) {
+   return seekReplay(st, 60 * 1000);
+}
+
+static Htop_Reaction changeReplaySpeed(State* st, int doublings) {
+   if (!st->pl->replay)
+      return HTOP_OK;
+
+   Replay_changeSpeed(st->pl->replay, doublings);
+   return HTOP_REDRAW_BAR;
+}
+
+static Htop_Reaction actionSlowerReplay(State* st) {
+   return changeReplaySpeed(st, -1);
+}
+
+static Htop_Reaction actionFasterReplay(State* st) {
+   return changeReplaySpeed(st, 1);
+}
+
+/* Deliberately not listed in the help screen, this is for debugging htop itself */
+static Htop_Reaction actionToggleProfile(State* st) {
+   Profile_enable();
+   st->showProfile = !st->showProfile;
+   if (!st->showProfile)
+      clear();
+   return HTOP_REFRESH | HTOP_REDRAW_BAR;
+}
+
 static const struct {
    const char* key;
    bool roInactive;
@@ -467,6 +532,7 @@ static const struct {
    { .key = "      p: ",  .roInactive = false, .info = "toggle program path" },
    { .key = "      m: ",  .roInactive = false, .info = "toggle merged command" },
    { .key = "      Z: ",  .roInactive = false, .info = "pause/resume process updates" },
+   { .key = "( ) b f: ",  .roInactive = false, .info = "replay speed / seek by 1 min" },
    { .key = "      u: ",  .roInactive = false, .info = "show processes of a single user" },
    { .key = "      H: ",  .roInactive = false, .info = "hide/show user process threads" },
    { .key = "      K: ",  .roInactive = false, .info = "hide/show kernel threads" },
@@ -494,9 +560,14 @@ static const struct {
 #endif
    { .key = "      e: ", .roInactive = false, .info = "show process environment" },
    { .key = "      i: ", .roInactive = true,  .info = "set IO priority" },
-   { .key = "      l: ", .roInactive = true,  .info = "list open files with lsof" },
+#ifdef HTOP_LINUX
+   { .key = "      V: ", .roInactive = false, .info = "show memory maps of process" },
+   { .key = "      G: ", .roInactive = false, .info = "show resource usage per cgroup" },
+#endif
+   { .key = "      l: ", .roInactive = true,  .info = "list open files" },
    { .key = "      x: ", .roInactive = false, .info = "list file locks of process" },
    { .key = "      s: ", .roInactive = true,  .info = "trace syscalls with strace" },
+   { .key = "      W: ", .roInactive = false, .info = "sample syscalls and wait channels" },
    { .key = "      w: ", .roInactive = false, .info = "wrap process command in multiple lines" },
    { .key = " F2 C S: ", .roInactive = false, .info = "setup" },
    { .key = " F1 h ?: ", .roInactive = false, .info = "show this help screen" },
@@ -636,6 +707,7 @@ static Htop_Reaction actionShowEnvScreen(State* st) {
       return HTOP_OK;
 
    EnvScreen* es = EnvScreen_new(p);
+   InfoScreen_setState((InfoScreen*)es, st);
    InfoScreen_run((InfoScreen*)es);
    EnvScreen_delete((Object*)es);
    clear();
@@ -649,6 +721,7 @@ static Htop_Reaction actionShowCommandScreen(State* st) {
       return HTOP_OK;
 
    CommandScreen* cmdScr = CommandScreen_new(p);
+   InfoScreen_setState((InfoScreen*)cmdScr, st);
    InfoScreen_run((InfoScreen*)cmdScr);
    CommandScreen_delete((Object*)cmdScr);
    clear();
@@ -658,6 +731,9 @@ static Htop_Reaction actionShowCommandScreen(State* st) {
 
 void Action_setBindings(Htop_Action* keys) {
    keys[' '] = actionTag;
+   keys['!'] = actionToggleProfile;
+   keys['('] = actionSlowerReplay;
+   keys[')'] = actionFasterReplay;
    keys['*'] = actionExpandOrCollapseAllBranches;
    keys['+'] = actionExpandOrCollapse;
    keys[','] = actionSetSortColumn;
@@ -679,6 +755,7 @@ void Action_setBindings(Htop_Action* keys) {
    keys['S'] = actionSetup;
    keys['T'] = actionSortByTime;
    keys['U'] = actionUntagAll;
+   keys['W'] = actionSampleThreads;
    keys['Z'] = actionTogglePauseProcessUpdate;
    keys['['] = actionLowerPriority;
    keys['\014'] = actionRedraw; // Ctrl+L
@@ -686,8 +763,10 @@ void Action_setBindings(Htop_Action* keys) {
    keys['\\'] = actionIncFilter;
    keys[']'] = actionHigherPriority;
    keys['a'] = actionSetAffinity;
+   keys['b'] = actionSeekReplayBackward;
    keys['c'] = actionTagAllChildren;
    keys['e'] = actionShowEnvScreen;
+   keys['f'] = actionSeekReplayForward;
    keys['h'] = actionHelp;
    keys['k'] = actionKill;
    keys['l'] = actionLsof;
@@ -33,7 +33,9 @@ typedef enum {
    HTOP_RESIZE          = 0x80 | HTOP_REFRESH | HTOP_REDRAW_BAR | HTOP_UPDATE_PANELHDR,
 } Htop_Reaction;
 
+struct EventLoop_; // IWYU pragma: keep
 struct MainPanel_; // IWYU pragma: keep
+struct Sampler_; // IWYU pragma: keep
 
 typedef struct State_ {
    Settings* settings;
@@ -43,6 +45,9 @@ typedef struct State_ {
    Header* header;
    bool pauseProcessUpdate;
    bool hideProcessSelection;
+   bool showProfile;
+   struct Sampler_* sampler;
+   struct EventLoop_* events;  /* woken up by the sampler, NULL if input is polled */
 } State;
 
 static inline bool State_hideFunctionBar(const State* st) {
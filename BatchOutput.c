@@ -0,0 +1,224 @@
+/*
+htop - BatchOutput.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "BatchOutput.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "FlightRecorder.h"
+#include "Header.h"
+#include "Platform.h"
+#include "Process.h"
+#include "Replay.h"
+#include "Server.h"
+#include "Settings.h"
+#include "Vector.h"
+#include "XUtils.h"
+
+
+typedef struct BatchSample_ {
+   FILE* out;
+   BatchFormat format;
+   const ProcessField* fields;
+   char timestamp[32];
+   bool first;
+} BatchSample;
+
+static void BatchOutput_sleepMs(unsigned long ms) {
+   struct timespec req = {
+      .tv_sec = ms / 1000,
+      .tv_nsec = (ms % 1000) * 1000000L
+   };
+   while (nanosleep(&req, &req) == -1)
+      continue;
+}
+
+static void BatchOutput_writeCsvString(FILE* out, const char* s) {
+   if (!s[strcspn(s, ",\"\r\n")]) {
+      fputs(s, out);
+      return;
+   }
+
+   fputc('"', out);
+   for (; *s; s++) {
+      if (*s == '"')
+         fputc('"', out);
+      fputc(*s, out);
+   }
+   fputc('"', out);
+}
+
+static void BatchOutput_writeJsonString(FILE* out, const char* s) {
+   fputc('"', out);
+   for (; *s; s++) {
+      unsigned char c = (unsigned char)*s;
+      switch (c) {
+         case '"':  fputs("\\\"", out); break;
+         case '\\': fputs("\\\\", out); break;
+         case '\n': fputs("\\n", out); break;
+         case '\r': fputs("\\r", out); break;
+         case '\t': fputs("\\t", out); break;
+         default:
+            if (c < 0x20)
+               fprintf(out, "\\u%04x", c);
+            else
+               fputc(c, out);
+            break;
+      }
+   }
+   fputc('"', out);
+}
+
+static void BatchOutput_writeValue(const BatchSample* this, const ProcessFieldValue* value) {
+   switch (value->type) {
+      case PROCESS_VALUE_INTEGER:
+         fprintf(this->out, "%lld", value->integer);
+         break;
+      case PROCESS_VALUE_REAL:
+         fprintf(this->out, "%.2f", value->real);
+         break;
+      case PROCESS_VALUE_STRING:
+         if (this->format == BATCH_FORMAT_JSON)
+            BatchOutput_writeJsonString(this->out, value->string);
+         else
+            BatchOutput_writeCsvString(this->out, value->string);
+         break;
+      case PROCESS_VALUE_NONE:
+         if (this->format == BATCH_FORMAT_JSON)
+            fputs("null", this->out);
+         break;
+   }
+}
+
+static void BatchOutput_writeProcess(Process* p, void* data) {
+   BatchSample* this = data;
+   ProcessFieldValue value;
+
+   if (this->format == BATCH_FORMAT_JSON) {
+      fputs(this->first ? "{" : ",{", this->out);
+      for (int i = 0; this->fields[i]; i++) {
+         fprintf(this->out, "%s\"%s\":", i ? "," : "", Process_fields[this->fields[i]].name);
+         Process_getFieldValue(p, this->fields[i], &value);
+         BatchOutput_writeValue(this, &value);
+      }
+      fputc('}', this->out);
+   } else {
+      fputs(this->timestamp, this->out);
+      for (int i = 0; this->fields[i]; i++) {
+         fputc(',', this->out);
+         Process_getFieldValue(p, this->fields[i], &value);
+         BatchOutput_writeValue(this, &value);
+      }
+      fputc('\n', this->out);
+   }
+
+   this->first = false;
+}
+
+static void BatchOutput_writeSample(BatchSample* this, ProcessList* pl, BatchOutput_Filter matches, void* matchesData) {
+   xSnprintf(this->timestamp, sizeof(this->timestamp), "%" PRIu64 ".%03" PRIu64, pl->realtimeMs / 1000, pl->realtimeMs % 1000);
+   this->first = true;
+
+   if (this->format == BATCH_FORMAT_JSON)
+      fprintf(this->out, "{\"timestamp\":%s,\"processes\":[", this->timestamp);
+
+   if (matches) {
+      for (int i = 0; i < Vector_size(pl->processes); i++) {
+         Process* p = (Process*) Vector_get(pl->processes, i);
+         if (p->tombStampMs == 0 && matches(p, matchesData))
+            BatchOutput_writeProcess(p, this);
+      }
+   } else {
+      ProcessList_forEachShown(pl, BatchOutput_writeProcess, this);
+   }
+
+   if (this->format == BATCH_FORMAT_JSON)
+      fputs("]}\n", this->out);
+}
+
+void BatchOutput_writeJson(FILE* out, ProcessList* pl, const ProcessField* fields, BatchOutput_Filter matches, void* matchesData) {
+   BatchSample sample = {
+      .out = out,
+      .format = BATCH_FORMAT_JSON,
+      .fields = fields,
+   };
+   BatchOutput_writeSample(&sample, pl, matches, matchesData);
+}
+
+bool BatchOutput_run(ProcessList* pl, Header* header, FILE* out, BatchFormat format, const ProcessField* fields, int iterations) {
+   BatchSample sample = {
+      .out = out,
+      .format = format,
+      .fields = fields,
+   };
+
+   if (format == BATCH_FORMAT_CSV) {
+      fputs("TIMESTAMP", out);
+      for (int i = 0; fields[i]; i++)
+         fprintf(out, ",%s", Process_fields[fields[i]].name);
+      fputc('\n', out);
+   }
+
+   /* CPU usage is only known after the second scan, a replay has it recorded */
+   if (!pl->replay) {
+      Platform_gettime_realtime(&pl->realtime, &pl->realtimeMs);
+      ProcessList_scan(pl, false);
+      BatchOutput_sleepMs(75);
+   }
+
+   uint64_t lastCpuUs = ProcessList_cpuTimeUs();
+
+   for (int i = 0; iterations < 0 || i < iterations; i++) {
+      /* a replay is converted as fast as possible, up to its end */
+      if (pl->replay) {
+         if (Replay_atEnd(pl->replay))
+            break;
+      } else if (i > 0 && pl->server) {
+         Server_wait(pl->server, pl, ProcessList_budgetedInterval(pl));
+      } else if (i > 0) {
+         BatchOutput_sleepMs((unsigned long)ProcessList_budgetedInterval(pl));
+      }
+
+      Platform_gettime_realtime(&pl->realtime, &pl->realtimeMs);
+      ProcessList_scan(pl, false);
+
+      /* As in the interactive sampler, the output of the previous update is part of the cost */
+      uint64_t cpuUs = ProcessList_cpuTimeUs();
+      ProcessList_addUpdateCost(pl, cpuUs - lastCpuUs);
+      lastCpuUs = cpuUs;
+      if (!pl->replay)
+         pl->updateIntervalMs = ProcessList_budgetedInterval(pl);
+
+      ProcessList_sort(pl);
+
+      if (header)
+         Header_updateData(header);
+
+      if (ProcessList_afterScan(pl)) {
+         const FlightRecorder* flight = pl->flightRecorder;
+         if (flight->error)
+            fprintf(stderr, "Warning: could not dump the flight recorder to %s: %s\n", flight->lastDump, strerror(flight->error));
+         else
+            fprintf(stderr, "Flight recorder dumped to %s\n", flight->lastDump);
+      }
+
+      if (format == BATCH_FORMAT_SILENT)
+         continue;
+
+      BatchOutput_writeSample(&sample, pl, NULL, NULL);
+
+      if (fflush(out) != 0 || ferror(out))
+         return false;
+   }
+
+   return true;
+}
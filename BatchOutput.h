@@ -0,0 +1,44 @@
+#ifndef HEADER_BatchOutput
+#define HEADER_BatchOutput
+/*
+htop - BatchOutput.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "Header.h"
+#include "Process.h"
+#include "ProcessField.h"
+#include "ProcessList.h"
+
+
+typedef enum BatchFormat_ {
+   BATCH_FORMAT_NONE,         /* run interactively */
+   BATCH_FORMAT_CSV,          /* one header line, then one line per process and sample */
+   BATCH_FORMAT_JSON,         /* one JSON object per sample and line */
+   BATCH_FORMAT_SILENT,       /* nothing, for recording without a terminal */
+} BatchFormat;
+
+typedef bool (*BatchOutput_Filter)(const Process* p, void* data);
+
+/*
+ * Writes the given columns of the processes as one JSON line, as in batch
+ * mode. Without a filter these are the shown processes, with one all which
+ * it accepts, regardless of the filters of the process list.
+ */
+void BatchOutput_writeJson(FILE* out, ProcessList* pl, const ProcessField* fields, BatchOutput_Filter matches, void* matchesData);
+
+/*
+ * Scans the processes every settings->delay and writes the given columns of
+ * the shown ones to out, without using the terminal. fields is terminated by
+ * NULL_PROCESSFIELD; a negative number of iterations runs until interrupted.
+ * The meters of header, if given, are updated along for recording and
+ * serving them. Returns false if writing failed.
+ */
+bool BatchOutput_run(ProcessList* pl, Header* header, FILE* out, BatchFormat format, const ProcessField* fields, int iterations);
+
+#endif
@@ -14,9 +14,11 @@ in the source distribution for its full text.
 #include <string.h>
 
 #include "CRT.h"
+#include "Macros.h"
 #include "Object.h"
 #include "Platform.h"
 #include "ProcessList.h"
+#include "ProvideCurses.h"
 #include "RichString.h"
 #include "Settings.h"
 #include "XUtils.h"
@@ -335,6 +337,226 @@ static void SingleColCPUsMeter_draw(Meter* this, int x, int y, int w) {
 }
 
 
+/* ---------- CPU heatmap ---------- */
+
+#define CPU_HEATMAP_ROW_CELLS 64
+#define CPU_HEATMAP_CAPTION_LEN 4
+
+typedef struct CPUHeatmapData_ {
+   unsigned int cpus;
+   unsigned int groups;
+   char groupPrefix;          /* 'N'ode, 'P'ackage or '\0' for no grouping */
+   double* percent;           /* per CPU utilisation, NAN when offline */
+   unsigned int* order;       /* CPU indices (0-based) in display order */
+   unsigned int* groupStart;  /* offsets into order[], groups + 1 entries */
+   unsigned int* groupId;     /* topology index of each group */
+} CPUHeatmapData;
+
+#ifdef HAVE_LIBNCURSESW
+static const char* const CPUHeatmapMeter_shadesUtf8[] = {
+   "·", "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"
+};
+#endif
+
+static const char CPUHeatmapMeter_shadesAscii[] = ".123456789#";
+
+static char CPUHeatmapMeter_groupPrefix(const Meter* this) {
+   if (As_Meter(this) == &CPUHeatmapNUMAMeter_class)
+      return 'N';
+   if (As_Meter(this) == &CPUHeatmapPackageMeter_class)
+      return 'P';
+   return '\0';
+}
+
+static void CPUHeatmapMeter_assignGroups(const Meter* this, unsigned int* groupOf) {
+   unsigned int cpus = this->pl->existingCPUs;
+   for (unsigned int i = 0; i < cpus; i++)
+      groupOf[i] = 0;
+
+#ifdef HAVE_LIBHWLOC
+   const ProcessList* pl = this->pl;
+   if (!pl->topologyOk)
+      return;
+
+   hwloc_obj_type_t type = CPUHeatmapMeter_groupPrefix(this) == 'N' ? HWLOC_OBJ_NUMANODE : HWLOC_OBJ_PACKAGE;
+   int nobjs = hwloc_get_nbobjs_by_type(pl->topology, type);
+   for (int j = 0; j < nobjs; j++) {
+      hwloc_obj_t obj = hwloc_get_obj_by_type(pl->topology, type, j);
+      if (!obj || !obj->cpuset)
+         continue;
+
+      unsigned int id;
+      hwloc_bitmap_foreach_begin(id, obj->cpuset)
+         if (id < cpus)
+            groupOf[id] = j;
+      hwloc_bitmap_foreach_end();
+   }
+#endif
+}
+
+static void CPUHeatmapMeter_done(Meter* this) {
+   CPUHeatmapData* data = this->meterData;
+   if (!data)
+      return;
+
+   free(data->percent);
+   free(data->order);
+   free(data->groupStart);
+   free(data->groupId);
+   free(data);
+   this->meterData = NULL;
+}
+
+static void CPUHeatmapMeter_init(Meter* this) {
+   CPUHeatmapMeter_done(this);
+
+   unsigned int cpus = this->pl->existingCPUs;
+   CPUHeatmapData* data = this->meterData = xCalloc(1, sizeof(CPUHeatmapData));
+   data->cpus = cpus;
+   data->percent = xCalloc(cpus, sizeof(double));
+   data->order = xCalloc(cpus, sizeof(unsigned int));
+   data->groupPrefix = CPUHeatmapMeter_groupPrefix(this);
+
+   unsigned int* groupOf = xCalloc(cpus, sizeof(unsigned int));
+   unsigned int maxGroup = 0;
+   if (data->groupPrefix)
+      CPUHeatmapMeter_assignGroups(this, groupOf);
+   for (unsigned int i = 0; i < cpus; i++)
+      maxGroup = MAXIMUM(maxGroup, groupOf[i]);
+
+   /* Stable counting sort of the CPUs by their group */
+   unsigned int* counts = xCalloc(maxGroup + 2, sizeof(unsigned int));
+   for (unsigned int i = 0; i < cpus; i++)
+      counts[groupOf[i] + 1]++;
+   for (unsigned int g = 1; g <= maxGroup + 1; g++)
+      counts[g] += counts[g - 1];
+
+   data->groupStart = xCalloc(maxGroup + 2, sizeof(unsigned int));
+   data->groupId = xCalloc(maxGroup + 1, sizeof(unsigned int));
+   unsigned int groups = 0;
+   for (unsigned int g = 0; g <= maxGroup; g++) {
+      if (counts[g + 1] == counts[g])
+         continue;
+
+      data->groupStart[groups] = counts[g];
+      data->groupId[groups] = g;
+      groups++;
+   }
+   data->groupStart[groups] = cpus;
+   data->groups = groups;
+
+   unsigned int* next = counts;
+   for (unsigned int i = 0; i < cpus; i++)
+      data->order[next[groupOf[i]]++] = i;
+
+   free(counts);
+   free(groupOf);
+
+   int h = 0;
+   for (unsigned int g = 0; g < groups; g++) {
+      unsigned int size = data->groupStart[g + 1] - data->groupStart[g];
+      h += (size + CPU_HEATMAP_ROW_CELLS - 1) / CPU_HEATMAP_ROW_CELLS;
+   }
+   this->h = MAXIMUM(h, 1);
+}
+
+static void CPUHeatmapMeter_updateMode(Meter* this, int mode) {
+   /* The heatmap has a single visual mode; keep the height computed at init */
+   this->mode = mode;
+}
+
+static void CPUHeatmapMeter_updateValues(Meter* this) {
+   CPUHeatmapData* data = this->meterData;
+   unsigned int cpus = MINIMUM(data->cpus, this->pl->existingCPUs);
+   for (unsigned int i = 0; i < cpus; i++)
+      data->percent[i] = Platform_setCPUValues(this, i + 1);
+   for (unsigned int i = cpus; i < data->cpus; i++)
+      data->percent[i] = NAN;
+}
+
+static void CPUHeatmapMeter_draw(Meter* this, int x, int y, int w) {
+   const CPUHeatmapData* data = this->meterData;
+
+   const char* const* shadesUtf8 = NULL;
+   int levels = sizeof(CPUHeatmapMeter_shadesAscii) - 1;
+#ifdef HAVE_LIBNCURSESW
+   if (CRT_utf8) {
+      shadesUtf8 = CPUHeatmapMeter_shadesUtf8;
+      levels = ARRAYSIZE(CPUHeatmapMeter_shadesUtf8);
+   }
+#endif
+
+   int avail = w - CPU_HEATMAP_CAPTION_LEN - 1;
+   if (avail < 1)
+      return;
+
+   for (unsigned int g = 0; g < data->groups; g++) {
+      unsigned int first = data->groupStart[g];
+      unsigned int size = data->groupStart[g + 1] - first;
+      unsigned int rows = (size + CPU_HEATMAP_ROW_CELLS - 1) / CPU_HEATMAP_ROW_CELLS;
+      unsigned int perRow = (size + rows - 1) / rows;
+      /* Fold neighbouring CPUs into one cell (showing the busiest) when the column is too narrow */
+      unsigned int perCell = (perRow + avail - 1) / avail;
+
+      for (unsigned int r = 0; r < rows; r++, y++) {
+         char caption[CPU_HEATMAP_CAPTION_LEN + 1];
+         if (r > 0)
+            caption[0] = '\0';
+         else if (data->groupPrefix && data->groups > 1)
+            xSnprintf(caption, sizeof(caption), "%c%u", data->groupPrefix, data->groupId[g]);
+         else
+            xSnprintf(caption, sizeof(caption), "%s", Meter_getCaption(this));
+         attrset(CRT_colors[METER_TEXT]);
+         mvaddnstr(y, x, caption, CPU_HEATMAP_CAPTION_LEN);
+
+         unsigned int from = first + r * perRow;
+         unsigned int to = MINIMUM(from + perRow, first + size);
+         int cx = x + CPU_HEATMAP_CAPTION_LEN;
+         int lastAttr = -1;
+         for (unsigned int i = from; i < to; i += perCell, cx++) {
+            double percent = NAN;
+            for (unsigned int j = i; j < MINIMUM(i + perCell, to); j++) {
+               double p = data->percent[data->order[j]];
+               if (!isnan(p) && (isnan(percent) || p > percent))
+                  percent = p;
+            }
+
+            int attr;
+            int level;
+            if (isnan(percent)) {
+               attr = CRT_colors[METER_SHADOW];
+               level = -1;
+            } else {
+               level = (int)(percent * (levels - 1) / 100.0 + 0.5);
+               level = CLAMP(level, 0, levels - 1);
+               if (level == 0)
+                  attr = CRT_colors[BAR_SHADOW];
+               else if (percent < 33.3)
+                  attr = CRT_colors[METER_VALUE_OK];
+               else if (percent < 66.6)
+                  attr = CRT_colors[METER_VALUE_WARN];
+               else
+                  attr = CRT_colors[METER_VALUE_ERROR];
+            }
+
+            if (attr != lastAttr) {
+               attrset(attr);
+               lastAttr = attr;
+            }
+
+            if (level < 0)
+               mvaddch(y, cx, ' ');
+            else if (shadesUtf8)
+               mvaddstr(y, cx, shadesUtf8[level]);
+            else
+               mvaddch(y, cx, CPUHeatmapMeter_shadesAscii[level]);
+         }
+      }
+   }
+   attrset(CRT_colors[RESET_COLOR]);
+}
+
+
 const MeterClass CPUMeter_class = {
    .super = {
       .extends = Class(Meter),
@@ -603,3 +825,63 @@ const MeterClass RightCPUs8Meter_class = {
    .updateMode = OctoColCPUsMeter_updateMode,
    .done = AllCPUsMeter_done
 };
+
+const MeterClass CPUHeatmapMeter_class = {
+   .super = {
+      .extends = Class(Meter),
+      .delete = Meter_delete
+   },
+   .updateValues = CPUHeatmapMeter_updateValues,
+   .defaultMode = CUSTOM_METERMODE,
+   .maxItems = CPU_METER_ITEMCOUNT,
+   .total = 100.0,
+   .attributes = CPUMeter_attributes,
+   .name = "CPUHeatmap",
+   .uiName = "CPU heatmap",
+   .description = "CPU heatmap: one cell per CPU",
+   .caption = "CPU",
+   .draw = CPUHeatmapMeter_draw,
+   .init = CPUHeatmapMeter_init,
+   .updateMode = CPUHeatmapMeter_updateMode,
+   .done = CPUHeatmapMeter_done
+};
+
+const MeterClass CPUHeatmapNUMAMeter_class = {
+   .super = {
+      .extends = Class(Meter),
+      .delete = Meter_delete
+   },
+   .updateValues = CPUHeatmapMeter_updateValues,
+   .defaultMode = CUSTOM_METERMODE,
+   .maxItems = CPU_METER_ITEMCOUNT,
+   .total = 100.0,
+   .attributes = CPUMeter_attributes,
+   .name = "CPUHeatmapNUMA",
+   .uiName = "CPU heatmap by node",
+   .description = "CPU heatmap: one cell per CPU, one row group per NUMA node",
+   .caption = "CPU",
+   .draw = CPUHeatmapMeter_draw,
+   .init = CPUHeatmapMeter_init,
+   .updateMode = CPUHeatmapMeter_updateMode,
+   .done = CPUHeatmapMeter_done
+};
+
+const MeterClass CPUHeatmapPackageMeter_class = {
+   .super = {
+      .extends = Class(Meter),
+      .delete = Meter_delete
+   },
+   .updateValues = CPUHeatmapMeter_updateValues,
+   .defaultMode = CUSTOM_METERMODE,
+   .maxItems = CPU_METER_ITEMCOUNT,
+   .total = 100.0,
+   .attributes = CPUMeter_attributes,
+   .name = "CPUHeatmapPackage",
+   .uiName = "CPU heatmap by package",
+   .description = "CPU heatmap: one cell per CPU, one row group per package",
+   .caption = "CPU",
+   .draw = CPUHeatmapMeter_draw,
+   .init = CPUHeatmapMeter_init,
+   .updateMode = CPUHeatmapMeter_updateMode,
+   .done = CPUHeatmapMeter_done
+};
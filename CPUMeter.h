@@ -50,4 +50,10 @@ extern const MeterClass LeftCPUs8Meter_class;
 
 extern const MeterClass RightCPUs8Meter_class;
 
+extern const MeterClass CPUHeatmapMeter_class;
+
+extern const MeterClass CPUHeatmapNUMAMeter_class;
+
+extern const MeterClass CPUHeatmapPackageMeter_class;
+
 #endif
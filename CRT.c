@@ -92,6 +92,13 @@ const char* const* CRT_treeStr = CRT_treeStrAscii;
 static const Settings* CRT_crashSettings;
 static const int* CRT_delay;
 
+/* Upper bound for input timeouts while data is refreshed elsewhere, 0 if none */
+static int CRT_pollDelay = 0;
+
+int CRT_inputDelay(void) {
+   return CRT_pollDelay > 0 ? MINIMUM(CRT_pollDelay, *CRT_delay) : *CRT_delay;
+}
+
 const char* CRT_degreeSign;
 
 static const char* initDegreeSign(void) {
@@ -875,7 +882,7 @@ void CRT_init(const Settings* settings, bool allowUnicode) {
       CRT_colorSchemes[COLORSCHEME_BROKENGRAY][i] = color == (A_BOLD | ColorPairGrayBlack) ? ColorPair(White, Black) : color;
    }
 
-   halfdelay(*CRT_delay);
+   halfdelay(CRT_inputDelay());
    nonl();
    intrflush(stdscr, false);
    keypad(stdscr, true);
@@ -960,6 +967,13 @@ IGNORE_WCASTQUAL_END
    CRT_degreeSign = initDegreeSign();
 }
 
+void CRT_initHeadless(const Settings* settings) {
+   CRT_crashSettings = settings;
+   CRT_delay = &(settings->delay);
+   CRT_colorScheme = COLORSCHEME_MONOCHROME;
+   CRT_colors = CRT_colorSchemes[CRT_colorScheme];
+}
+
 void CRT_done() {
    curs_set(1);
    endwin();
@@ -979,7 +993,7 @@ int CRT_readKey() {
    cbreak();
    nodelay(stdscr, FALSE);
    int ret = getch();
-   halfdelay(*CRT_delay);
+   halfdelay(CRT_inputDelay());
    return ret;
 }
 
@@ -990,7 +1004,12 @@ void CRT_disableDelay() {
 }
 
 void CRT_enableDelay() {
-   halfdelay(*CRT_delay);
+   halfdelay(CRT_inputDelay());
+}
+
+void CRT_setPollDelay(int delay) {
+   CRT_pollDelay = delay;
+   halfdelay(CRT_inputDelay());
 }
 
 void CRT_setColors(int colorScheme) {
@@ -174,6 +174,9 @@ extern ColorScheme CRT_colorScheme;
 
 void CRT_init(const Settings* settings, bool allowUnicode);
 
+/* Sets up only what processing the process data relies on, without taking over the terminal */
+void CRT_initHeadless(const Settings* settings);
+
 void CRT_done(void);
 
 void CRT_resetSignalHandlers(void);
@@ -184,6 +187,12 @@ void CRT_disableDelay(void);
 
 void CRT_enableDelay(void);
 
+/* How long getch waits for input with the delay enabled, in tenths of a second */
+int CRT_inputDelay(void);
+
+/* Lets getch() return at least every delay tenths of a second, 0 to wait for the refresh delay again */
+void CRT_setPollDelay(int delay);
+
 void CRT_setColors(int colorScheme);
 
 #endif
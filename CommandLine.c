@@ -12,6 +12,7 @@ in the source distribution for its full text.
 
 #include <assert.h>
 #include <ctype.h>
+#include <errno.h>
 #include <getopt.h>
 #include <locale.h>
 #include <stdbool.h>
@@ -22,9 +23,12 @@ in the source distribution for its full text.
 #include <unistd.h>
 
 #include "Action.h"
+#include "BatchOutput.h"
 #include "CRT.h"
 #include "DynamicColumn.h"
 #include "DynamicMeter.h"
+#include "EventLoop.h"
+#include "FlightRecorder.h"
 #include "Hashtable.h"
 #include "Header.h"
 #include "IncSet.h"
@@ -33,8 +37,13 @@ in the source distribution for its full text.
 #include "Panel.h"
 #include "Platform.h"
 #include "Process.h"
+#include "ProcessFilter.h"
 #include "ProcessList.h"
 #include "ProvideCurses.h"
+#include "Recorder.h"
+#include "Replay.h"
+#include "Sampler.h"
+#include "Server.h"
 #include "ScreenManager.h"
 #include "Settings.h"
 #include "UsersTable.h"
@@ -49,14 +58,27 @@ static void printHelpFlag(const char* name) {
    printf("%s " VERSION "\n"
           COPYRIGHT "\n"
           "Released under the GNU GPLv2+.\n\n"
+          "   --attach=SOCKET              Show what the htop serving on SOCKET sees instead of the system\n"
+          "-b --batch[=csv|json|silent]    Print samples of the process list as CSV (default)\n"
+          "                                or as JSON lines (or nothing) instead of running interactively\n"
           "-C --no-color                   Use a monochrome color scheme\n"
           "-d --delay=DELAY                Set the delay between updates, in tenths of seconds\n"
+          "   --fields=COLUMN[,COLUMN...]  Columns to print in batch mode (default: the configured ones)\n"
+          "   --flight-dir=DIR             Directory for the flight recorder's recordings (default: .)\n"
+          "   --flight-recorder[=MINUTES]  Keep the last MINUTES (default: 10) of samples in memory and\n"
+          "                                write them to a recording on SIGUSR1 or when a trigger fires\n"
+          "   --flight-trigger=TRIGGER     Also write them when TRIGGER goes above its threshold, one of\n"
+          "                                load:N, psi-cpu:N, psi-io:N, psi-memory:N or cpu:PID:N\n"
           "-F --filter=FILTER              Show only the commands matching the given filter\n"
           "-h --help                       Print this help screen\n"
           "-H --highlight-changes[=DELAY]  Highlight new and old processes\n"
           "-M --no-mouse                   Disable the mouse\n"
+          "-n --iterations=N               Exit after printing N samples in batch mode\n"
           "-p --pid=PID[,PID,PID...]       Show only the given PIDs\n"
           "   --readonly                   Disable all system and process changing features\n"
+          "   --record=FILE                Record all samples to the new file FILE\n"
+          "   --replay=FILE                Play back the recording FILE instead of showing the system\n"
+          "   --serve=SOCKET               Serve every update to other programs on the Unix socket SOCKET\n"
           "-s --sort-key=COLUMN            Sort by COLUMN in list view (try --sort-key=help for a list)\n"
           "-t --tree                       Show the tree view (can be combined with -s)\n"
           "-u --user[=USERNAME]            Show only processes for a given user (or $USER)\n"
@@ -84,8 +106,44 @@ typedef struct CommandLineSettings_ {
    bool highlightChanges;
    int highlightDelaySecs;
    bool readonly;
+   BatchFormat batchFormat;
+   ProcessField* batchFields;
+   int iterations;
+   const char* recordFile;
+   const char* replayFile;
+   unsigned int flightMinutes;
+   const char* flightDirectory;
+   FlightTrigger* flightTriggers;
+   size_t flightTriggerCount;
+   const char* serveSocket;
+   const char* attachSocket;
 } CommandLineSettings;
 
+static ProcessField* CommandLine_parseFields(const char* list) {
+   size_t count = 0;
+   char** names = String_split(list, ',', &count);
+   ProcessField* fields = xCalloc(count + 1, sizeof(ProcessField));
+
+   for (size_t i = 0; i < count; i++) {
+      fields[i] = Process_fieldByName(names[i]);
+      if (fields[i] == NULL_PROCESSFIELD) {
+         fprintf(stderr, "Error: invalid column \"%s\".\n", names[i]);
+         free(fields);
+         fields = NULL;
+         break;
+      }
+   }
+
+   if (count == 0) {
+      fprintf(stderr, "Error: no columns given.\n");
+      free(fields);
+      fields = NULL;
+   }
+
+   String_freeArray(names);
+   return fields;
+}
+
 static CommandLineStatus parseArguments(const char* program, int argc, char** argv, CommandLineSettings* flags) {
 
    *flags = (CommandLineSettings) {
@@ -101,6 +159,17 @@ static CommandLineStatus parseArguments(const char* program, int argc, char** ar
       .highlightChanges = false,
       .highlightDelaySecs = -1,
       .readonly = false,
+      .batchFormat = BATCH_FORMAT_NONE,
+      .batchFields = NULL,
+      .iterations = -1,
+      .recordFile = NULL,
+      .replayFile = NULL,
+      .flightMinutes = 0,
+      .flightDirectory = ".",
+      .flightTriggers = NULL,
+      .flightTriggerCount = 0,
+      .serveSocket = NULL,
+      .attachSocket = NULL,
    };
 
    const struct option long_opts[] =
@@ -119,13 +188,23 @@ static CommandLineStatus parseArguments(const char* program, int argc, char** ar
       {"filter",     required_argument,   0, 'F'},
       {"highlight-changes", optional_argument, 0, 'H'},
       {"readonly",   no_argument,         0, 128},
+      {"batch",      optional_argument,   0, 'b'},
+      {"fields",     required_argument,   0, 140},
+      {"iterations", required_argument,   0, 'n'},
+      {"record",     required_argument,   0, 141},
+      {"replay",     required_argument,   0, 142},
+      {"flight-recorder", optional_argument, 0, 143},
+      {"flight-dir", required_argument,   0, 144},
+      {"flight-trigger", required_argument, 0, 145},
+      {"serve",      required_argument,   0, 146},
+      {"attach",     required_argument,   0, 147},
       PLATFORM_LONG_OPTIONS
       {0, 0, 0, 0}
    };
 
    int opt, opti = 0;
    /* Parse arguments */
-   while ((opt = getopt_long(argc, argv, "hVMCs:td:u::Up:F:H::", long_opts, &opti))) {
+   while ((opt = getopt_long(argc, argv, "hVMCs:td:u::Up:F:H::b::n:", long_opts, &opti))) {
       if (opt == EOF)
          break;
       switch (opt) {
@@ -145,15 +224,7 @@ static CommandLineStatus parseArguments(const char* program, int argc, char** ar
                }
                return STATUS_OK_EXIT;
             }
-            flags->sortKey = 0;
-            for (int j = 1; j < LAST_PROCESSFIELD; j++) {
-               if (Process_fields[j].name == NULL)
-                  continue;
-               if (String_eq(optarg, Process_fields[j].name)) {
-                  flags->sortKey = j;
-                  break;
-               }
-            }
+            flags->sortKey = Process_fieldByName(optarg);
             if (flags->sortKey == 0) {
                fprintf(stderr, "Error: invalid column \"%s\".\n", optarg);
                return STATUS_ERROR_EXIT;
@@ -248,6 +319,83 @@ static CommandLineStatus parseArguments(const char* program, int argc, char** ar
          case 128:
             flags->readonly = true;
             break;
+         case 'b': {
+            const char* format = optarg;
+            if (!format && optind < argc && argv[optind] != NULL &&
+                (argv[optind][0] != '\0' && argv[optind][0] != '-')) {
+                format = argv[optind++];
+            }
+
+            if (!format || String_eq(format, "csv")) {
+               flags->batchFormat = BATCH_FORMAT_CSV;
+            } else if (String_eq(format, "json")) {
+               flags->batchFormat = BATCH_FORMAT_JSON;
+            } else if (String_eq(format, "silent")) {
+               flags->batchFormat = BATCH_FORMAT_SILENT;
+            } else {
+               fprintf(stderr, "Error: invalid batch format \"%s\".\n", format);
+               return STATUS_ERROR_EXIT;
+            }
+            break;
+         }
+         case 140:
+            assert(optarg);
+            free(flags->batchFields);
+            flags->batchFields = CommandLine_parseFields(optarg);
+            if (!flags->batchFields)
+               return STATUS_ERROR_EXIT;
+            break;
+         case 'n':
+            if (sscanf(optarg, "%16d", &(flags->iterations)) != 1 || flags->iterations < 1) {
+               fprintf(stderr, "Error: invalid number of iterations \"%s\".\n", optarg);
+               return STATUS_ERROR_EXIT;
+            }
+            break;
+         case 141:
+            assert(optarg);
+            flags->recordFile = optarg;
+            break;
+         case 142:
+            assert(optarg);
+            flags->replayFile = optarg;
+            break;
+         case 143: {
+            const char* minutes = optarg;
+            if (!minutes && optind < argc && argv[optind] != NULL &&
+                (argv[optind][0] != '\0' && argv[optind][0] != '-')) {
+                minutes = argv[optind++];
+            }
+
+            flags->flightMinutes = 10;
+            if (minutes && (sscanf(minutes, "%10u", &flags->flightMinutes) != 1 || flags->flightMinutes < 1)) {
+               fprintf(stderr, "Error: invalid number of minutes \"%s\".\n", minutes);
+               return STATUS_ERROR_EXIT;
+            }
+            break;
+         }
+         case 144:
+            assert(optarg);
+            flags->flightDirectory = optarg;
+            break;
+         case 145: {
+            assert(optarg);
+            FlightTrigger trigger;
+            if (!FlightRecorder_parseTrigger(optarg, &trigger)) {
+               fprintf(stderr, "Error: invalid flight recorder trigger \"%s\".\n", optarg);
+               return STATUS_ERROR_EXIT;
+            }
+            flags->flightTriggers = xReallocArray(flags->flightTriggers, flags->flightTriggerCount + 1, sizeof(FlightTrigger));
+            flags->flightTriggers[flags->flightTriggerCount++] = trigger;
+            break;
+         }
+         case 146:
+            assert(optarg);
+            flags->serveSocket = optarg;
+            break;
+         case 147:
+            assert(optarg);
+            flags->attachSocket = optarg;
+            break;
 
          default: {
             CommandLineStatus status;
@@ -257,6 +405,34 @@ static CommandLineStatus parseArguments(const char* program, int argc, char** ar
          }
       }
    }
+
+   if (flags->replayFile && flags->attachSocket) {
+      fprintf(stderr, "Error: --replay and --attach can not be combined.\n");
+      return STATUS_ERROR_EXIT;
+   }
+
+   const char* replayOption = flags->replayFile ? "--replay" : "--attach";
+   bool replaying = flags->replayFile || flags->attachSocket;
+
+   if (flags->recordFile && replaying) {
+      fprintf(stderr, "Error: --record and %s can not be combined.\n", replayOption);
+      return STATUS_ERROR_EXIT;
+   }
+
+   if (flags->flightMinutes && replaying) {
+      fprintf(stderr, "Error: --flight-recorder and %s can not be combined.\n", replayOption);
+      return STATUS_ERROR_EXIT;
+   }
+
+   if (flags->attachSocket && flags->batchFormat != BATCH_FORMAT_NONE) {
+      fprintf(stderr, "Error: --attach only works interactively, talk to the socket directly instead.\n");
+      return STATUS_ERROR_EXIT;
+   }
+
+   /* triggers imply the flight recorder */
+   if (flags->flightTriggerCount && !flags->flightMinutes)
+      flags->flightMinutes = 10;
+
    return STATUS_OK;
 }
 
@@ -281,6 +457,149 @@ static void setCommFilter(State* state, char** commFilter) {
    *commFilter = NULL;
 }
 
+/* The configured columns, leaving out dynamic ones */
+static ProcessField* CommandLine_configuredFields(const Settings* settings) {
+   size_t count = 0;
+   while (settings->fields[count])
+      count++;
+
+   ProcessField* fields = xCalloc(count + 1, sizeof(ProcessField));
+   for (size_t i = 0, j = 0; i < count; i++) {
+      if (settings->fields[i] < LAST_PROCESSFIELD)
+         fields[j++] = settings->fields[i];
+   }
+   return fields;
+}
+
+/* The columns of JSON requests default to the ones of batch mode */
+static bool CommandLine_serve(ProcessList* pl, const Settings* settings, const CommandLineSettings* flags) {
+   char error[256];
+   ProcessField* fields = flags->batchFields ? flags->batchFields : CommandLine_configuredFields(settings);
+   pl->server = Server_new(flags->serveSocket, fields, error, sizeof(error));
+   if (fields != flags->batchFields)
+      free(fields);
+
+   if (!pl->server) {
+      fprintf(stderr, "Error: can not serve on %s: %s\n", flags->serveSocket, error);
+      return false;
+   }
+   return true;
+}
+
+static bool CommandLine_runBatch(ProcessList* pl, Settings* settings, CommandLineSettings* flags) {
+   CRT_initHeadless(settings);
+
+   /* Nothing would be printed at all for an invalid expression */
+   if (ProcessFilter_isExpression(flags->commFilter)) {
+      char error[256];
+      ProcessFilter* filter = ProcessFilter_new(flags->commFilter + 1, error, sizeof(error));
+      if (!filter) {
+         fprintf(stderr, "Error: invalid filter: %s\n", error);
+         return false;
+      }
+      ProcessFilter_delete(filter);
+   }
+
+   pl->incFilter = flags->commFilter;
+
+   ProcessField* fields = flags->batchFields;
+   if (!fields)
+      fields = CommandLine_configuredFields(settings);
+
+   /* the meters are only of use to a recording or a viewer */
+   Header* header = NULL;
+   if (pl->recorder || pl->server) {
+      header = Header_new(pl, settings, 2);
+      Header_populateFromSettings(header);
+   }
+
+   bool success = BatchOutput_run(pl, header, stdout, flags->batchFormat, fields, flags->iterations);
+   if (!success)
+      fprintf(stderr, "Error: could not write the samples: %s\n", strerror(errno));
+
+   if (fields != flags->batchFields)
+      free(fields);
+   if (header)
+      Header_delete(header);
+
+   return success;
+}
+
+static bool CommandLine_runInteractive(ProcessList* pl, Settings* settings, UsersTable* ut, CommandLineSettings* flags) {
+   Header* header = Header_new(pl, settings, 2);
+
+   Header_populateFromSettings(header);
+
+   CRT_init(settings, flags->allowUnicode);
+
+   MainPanel* panel = MainPanel_new();
+   ProcessList_setPanel(pl, (Panel*) panel);
+
+   MainPanel_updateTreeFunctions(panel, settings->treeView);
+
+   State state = {
+      .settings = settings,
+      .ut = ut,
+      .pl = pl,
+      .mainPanel = panel,
+      .header = header,
+      .pauseProcessUpdate = false,
+      .hideProcessSelection = false,
+      .showProfile = false,
+      .sampler = NULL,
+      .events = NULL,
+   };
+
+   MainPanel_setState(panel, &state);
+   if (flags->commFilter)
+      setCommFilter(&state, &(flags->commFilter));
+
+   ScreenManager* scr = ScreenManager_new(header, settings, &state, true);
+   ScreenManager_add(scr, (Panel*) panel, -1);
+
+   ProcessList_scan(pl, false);
+   /* CPU usage is only known after the second scan, a replay has it recorded */
+   if (!pl->replay) {
+      CommandLine_delay(pl, 75);
+      ProcessList_scan(pl, false);
+   }
+
+   if (settings->allBranchesCollapsed)
+      ProcessList_collapseAllBranches(pl);
+
+   /* Meters must not be drawn before they got their first values */
+   Header_updateData(header);
+
+   /* Further scans run in the background, input is waited for together with their results */
+   state.events = EventLoop_new();
+   state.sampler = Sampler_new(&state);
+   Platform_addEventSources(&state);
+   if (!state.events)
+      CRT_setPollDelay(1);
+
+   ScreenManager_run(scr, NULL, NULL);
+
+   Sampler_delete(state.sampler);
+   state.sampler = NULL;
+   EventLoop_delete(state.events);
+   state.events = NULL;
+
+   attron(CRT_colors[RESET_COLOR]);
+   mvhline(LINES - 1, 0, ' ', COLS);
+   attroff(CRT_colors[RESET_COLOR]);
+   refresh();
+
+   CRT_done();
+
+   Header_delete(header);
+   ProcessList_setPanel(pl, NULL);
+
+   ScreenManager_delete(scr);
+   MetersPanel_cleanup();
+
+   return true;
+}
+
 int CommandLine_run(const char* name, int argc, char** argv) {
 
    /* initialize locale */
@@ -296,7 +615,38 @@ int CommandLine_run(const char* name, int argc, char** argv) {
    if ((status = parseArguments(name, argc, argv, &flags)) != STATUS_OK)
       return status != STATUS_OK_EXIT ? 1 : 0;
 
-   if (flags.readonly)
+   /* Recordings are opened first, there is nothing to clean up if that fails */
+   Recorder* recorder = NULL;
+   Replay* replay = NULL;
+   if (flags.recordFile) {
+      recorder = Recorder_new(flags.recordFile);
+      if (!recorder) {
+         fprintf(stderr, "Error: can not record to %s: %s\n", flags.recordFile, strerror(errno));
+         return 1;
+      }
+   }
+   if (flags.replayFile) {
+      char error[256];
+      replay = Replay_new(flags.replayFile, error, sizeof(error));
+      if (!replay) {
+         fprintf(stderr, "Error: can not replay %s: %s\n", flags.replayFile, error);
+         return 1;
+      }
+   }
+   if (flags.attachSocket) {
+      char error[256];
+      replay = Replay_attach(flags.attachSocket, error, sizeof(error));
+      if (!replay) {
+         fprintf(stderr, "Error: can not attach to %s: %s\n", flags.attachSocket, error);
+         return 1;
+      }
+   }
+
+   FlightRecorder* flightRecorder = NULL;
+   if (flags.flightMinutes)
+      flightRecorder = FlightRecorder_new(flags.flightMinutes, flags.flightDirectory, flags.flightTriggers, flags.flightTriggerCount);
+
+   if (flags.readonly || replay)
       Settings_enableReadonly();
 
    if (!Platform_init())
@@ -311,14 +661,13 @@ int CommandLine_run(const char* name, int argc, char** argv) {
       dc = Hashtable_new(0, true);
 
    ProcessList* pl = ProcessList_new(ut, dm, dc, flags.pidMatchList, flags.userId);
+   pl->recorder = recorder;
+   pl->replay = replay;
+   pl->flightRecorder = flightRecorder;
 
    Settings* settings = Settings_new(pl->activeCPUs, dc);
    pl->settings = settings;
 
-   Header* header = Header_new(pl, settings, 2);
-
-   Header_populateFromSettings(header);
-
    if (flags.delay != -1)
       settings->delay = flags.delay;
    if (!flags.useColors)
@@ -342,64 +691,50 @@ int CommandLine_run(const char* name, int argc, char** argv) {
       Settings_setSortKey(settings, flags.sortKey);
    }
 
-   CRT_init(settings, flags.allowUnicode);
-
-   MainPanel* panel = MainPanel_new();
-   ProcessList_setPanel(pl, (Panel*) panel);
-
-   MainPanel_updateTreeFunctions(panel, settings->treeView);
-
-   State state = {
-      .settings = settings,
-      .ut = ut,
-      .pl = pl,
-      .mainPanel = panel,
-      .header = header,
-      .pauseProcessUpdate = false,
-      .hideProcessSelection = false,
-   };
-
-   MainPanel_setState(panel, &state);
-   if (flags.commFilter)
-      setCommFilter(&state, &(flags.commFilter));
-
-   ScreenManager* scr = ScreenManager_new(header, settings, &state, true);
-   ScreenManager_add(scr, (Panel*) panel, -1);
-
-   ProcessList_scan(pl, false);
-   CommandLine_delay(pl, 75);
-   ProcessList_scan(pl, false);
-
-   if (settings->allBranchesCollapsed)
-      ProcessList_collapseAllBranches(pl);
-
-   ScreenManager_run(scr, NULL, NULL);
-
-   attron(CRT_colors[RESET_COLOR]);
-   mvhline(LINES - 1, 0, ' ', COLS);
-   attroff(CRT_colors[RESET_COLOR]);
-   refresh();
+   bool success = !flags.serveSocket || CommandLine_serve(pl, settings, &flags);
+   if (success) {
+      if (flags.batchFormat != BATCH_FORMAT_NONE)
+         success = CommandLine_runBatch(pl, settings, &flags);
+      else
+         success = CommandLine_runInteractive(pl, settings, ut, &flags);
+   }
 
    Platform_done();
 
-   CRT_done();
-
    if (settings->changed) {
       int r = Settings_write(settings, false);
       if (r < 0)
          fprintf(stderr, "Can not save configuration to %s: %s\n", settings->filename, strerror(-r));
    }
 
-   Header_delete(header);
+   Server* server = pl->server;
    ProcessList_delete(pl);
 
-   ScreenManager_delete(scr);
-   MetersPanel_cleanup();
+   Server_delete(server);
+
+   /* The replayed processes referred to its strings */
+   Replay_delete(replay);
+
+   if (recorder && recorder->error)
+      fprintf(stderr, "Warning: recording to %s stopped early: %s\n", flags.recordFile, strerror(recorder->error));
+   Recorder_delete(recorder);
+
+   /* batch mode reports each dump as it happens */
+   if (flightRecorder && flags.batchFormat == BATCH_FORMAT_NONE) {
+      if (flightRecorder->error)
+         fprintf(stderr, "Warning: could not dump the flight recorder to %s: %s\n", flightRecorder->lastDump, strerror(flightRecorder->error));
+      if (flightRecorder->dumps)
+         fprintf(stderr, "Flight recorder wrote %u recording(s), the last to %s\n", flightRecorder->dumps, flightRecorder->lastDump);
+   }
+   FlightRecorder_delete(flightRecorder);
 
    UsersTable_delete(ut);
 
    if (flags.pidMatchList)
       Hashtable_delete(flags.pidMatchList);
+   free(flags.commFilter);
+   free(flags.batchFields);
+   free(flags.flightTriggers);
 
    CRT_resetSignalHandlers();
 
@@ -408,5 +743,5 @@ int CommandLine_run(const char* name, int argc, char** argv) {
    DynamicColumns_delete(dc);
    DynamicMeters_delete(dm);
 
-   return 0;
+   return success ? 0 : 1;
 }
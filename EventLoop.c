@@ -0,0 +1,185 @@
+/*
+htop - EventLoop.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "EventLoop.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
+#include "Macros.h"
+#include "ProvideCurses.h"
+#include "XUtils.h"
+
+
+static bool EventLoop_setFlags(int fd) {
+   int flags = fcntl(fd, F_GETFL);
+   if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+      return false;
+
+   return fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+static bool EventLoop_watch(const EventLoop* this, int fd, bool priority) {
+   struct epoll_event event = { .events = priority ? EPOLLPRI : EPOLLIN, .data.fd = fd };
+   return epoll_ctl(this->epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+#endif
+
+EventLoop* EventLoop_new(void) {
+   EventLoop* this = xCalloc(1, sizeof(EventLoop));
+   this->epollFd = -1;
+
+   if (pipe(this->wakeFds) < 0) {
+      free(this);
+      return NULL;
+   }
+   if (!EventLoop_setFlags(this->wakeFds[0]) || !EventLoop_setFlags(this->wakeFds[1]))
+      goto err;
+
+#ifdef HAVE_SYS_EPOLL_H
+   this->epollFd = epoll_create1(EPOLL_CLOEXEC);
+   if (this->epollFd < 0)
+      goto err;
+
+   /* fails e.g. for input redirected from a regular file, which cannot be waited for */
+   if (!EventLoop_watch(this, STDIN_FILENO, false) || !EventLoop_watch(this, this->wakeFds[0], false))
+      goto err;
+#endif
+
+   return this;
+
+err:
+   EventLoop_delete(this);
+   return NULL;
+}
+
+void EventLoop_delete(EventLoop* this) {
+   if (!this)
+      return;
+
+   if (this->epollFd >= 0)
+      close(this->epollFd);
+   close(this->wakeFds[0]);
+   close(this->wakeFds[1]);
+   free(this->sources);
+   free(this);
+}
+
+void EventLoop_addSource(EventLoop* this, int fd, bool priority, EventLoop_Handler handler, void* data) {
+#ifdef HAVE_SYS_EPOLL_H
+   if (!EventLoop_watch(this, fd, priority))
+      return;
+#endif
+
+   if (this->sourceCount == this->sourceCapacity) {
+      this->sourceCapacity = MAXIMUM(4, 2 * this->sourceCapacity);
+      this->sources = xReallocArray(this->sources, this->sourceCapacity, sizeof(EventLoop_Source));
+   }
+   this->sources[this->sourceCount++] = (EventLoop_Source) { .fd = fd, .priority = priority, .handler = handler, .data = data };
+}
+
+void EventLoop_removeSource(EventLoop* this, int fd) {
+   for (size_t i = 0; i < this->sourceCount; i++) {
+      if (this->sources[i].fd != fd)
+         continue;
+
+#ifdef HAVE_SYS_EPOLL_H
+      epoll_ctl(this->epollFd, EPOLL_CTL_DEL, fd, NULL);
+#endif
+      this->sources[i] = this->sources[--this->sourceCount];
+      return;
+   }
+}
+
+void EventLoop_wakeup(EventLoop* this) {
+   /* a full pipe already wakes the loop up */
+   char c = 0;
+   (void)! write(this->wakeFds[1], &c, 1);
+}
+
+static void EventLoop_dispatch(EventLoop* this, int fd) {
+   if (fd == this->wakeFds[0]) {
+      char buffer[64];
+      while (read(fd, buffer, sizeof(buffer)) > 0)
+         ;
+      return;
+   }
+
+   for (size_t i = 0; i < this->sourceCount; i++) {
+      if (this->sources[i].fd == fd && this->sources[i].handler) {
+         this->sources[i].handler(this->sources[i].data);
+         return;
+      }
+   }
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+
+/* Waits with SIGWINCH unblocked, so a resize reaches the curses handler and ends the wait */
+static void EventLoop_wait(EventLoop* this, const sigset_t* waitMask, int timeoutMs) {
+   struct epoll_event events[8];
+   int ready = epoll_pwait(this->epollFd, events, ARRAYSIZE(events), timeoutMs, waitMask);
+   for (int i = 0; i < ready; i++)
+      EventLoop_dispatch(this, events[i].data.fd);
+}
+
+#else
+
+/* A resize is only noticed with the next event here, at the latest the next refresh */
+static void EventLoop_wait(EventLoop* this, const sigset_t* waitMask, int timeoutMs) {
+   size_t count = 2 + this->sourceCount;
+   struct pollfd* fds = xMallocArray(count, sizeof(struct pollfd));
+   fds[0] = (struct pollfd) { .fd = STDIN_FILENO, .events = POLLIN };
+   fds[1] = (struct pollfd) { .fd = this->wakeFds[0], .events = POLLIN };
+   for (size_t i = 0; i < this->sourceCount; i++)
+      fds[2 + i] = (struct pollfd) { .fd = this->sources[i].fd, .events = this->sources[i].priority ? POLLPRI : POLLIN };
+
+   sigset_t blocked;
+   pthread_sigmask(SIG_SETMASK, waitMask, &blocked);
+   int ready = poll(fds, count, timeoutMs);
+   pthread_sigmask(SIG_SETMASK, &blocked, NULL);
+
+   for (size_t i = 1; ready > 0 && i < count; i++) {
+      if (fds[i].revents)
+         EventLoop_dispatch(this, fds[i].fd);
+   }
+   free(fds);
+}
+
+#endif
+
+int EventLoop_getch(EventLoop* this) {
+   return EventLoop_getchTimeout(this, -1);
+}
+
+int EventLoop_getchTimeout(EventLoop* this, int timeoutMs) {
+   /* a resize after the first look for input must still end the wait */
+   sigset_t resize;
+   sigset_t previous;
+   sigemptyset(&resize);
+   sigaddset(&resize, SIGWINCH);
+   pthread_sigmask(SIG_BLOCK, &resize, &previous);
+
+   int ch = getch();
+   if (ch == ERR) {
+      EventLoop_wait(this, &previous, timeoutMs);
+      ch = getch();
+   }
+
+   pthread_sigmask(SIG_SETMASK, &previous, NULL);
+   return ch;
+}
@@ -0,0 +1,61 @@
+#ifndef HEADER_EventLoop
+#define HEADER_EventLoop
+/*
+htop - EventLoop.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+
+
+/* Called on the waiting thread when the descriptor of a source can be read, or has priority data */
+typedef void (*EventLoop_Handler)(void* data);
+
+typedef struct EventLoop_Source_ {
+   int fd;
+   bool priority;             /* waits for priority data only, e.g. of pressure stall triggers which always read as readable */
+   EventLoop_Handler handler;  /* may be NULL to only wake up */
+   void* data;
+} EventLoop_Source;
+
+/*
+ * Waits for keys, for other file descriptors to become readable and for
+ * other threads asking to be woken up, instead of polling for any of them;
+ * with epoll where available, poll otherwise.
+ */
+typedef struct EventLoop_ {
+   int epollFd;               /* -1 when using poll */
+   int wakeFds[2];            /* a pipe written to by EventLoop_wakeup */
+
+   EventLoop_Source* sources;
+   size_t sourceCount;
+   size_t sourceCapacity;
+} EventLoop;
+
+/* Returns NULL if the descriptors needed could not be created, callers poll for input as before then */
+EventLoop* EventLoop_new(void);
+
+void EventLoop_delete(EventLoop* this);
+
+void EventLoop_addSource(EventLoop* this, int fd, bool priority, EventLoop_Handler handler, void* data);
+
+void EventLoop_removeSource(EventLoop* this, int fd);
+
+/* Makes a waiting EventLoop_getch return, may be called from any thread */
+void EventLoop_wakeup(EventLoop* this);
+
+/*
+ * Like getch, but waits without a timeout until a key was pressed, the
+ * terminal was resized, a source became readable or EventLoop_wakeup was
+ * called; returns ERR in the latter cases. Input must not be delayed by
+ * curses itself meanwhile, see CRT_disableDelay.
+ */
+int EventLoop_getch(EventLoop* this);
+
+/* Like EventLoop_getch, but also returns ERR after timeoutMs milliseconds unless negative */
+int EventLoop_getchTimeout(EventLoop* this, int timeoutMs);
+
+#endif
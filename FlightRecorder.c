@@ -0,0 +1,481 @@
+/*
+htop - FlightRecorder.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "FlightRecorder.h"
+
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Macros.h"
+#include "Platform.h"
+#include "Process.h"
+#include "ProcessList.h"
+#include "Profile.h"
+#include "Recorder.h"
+#include "Recording.h"
+#include "Vector.h"
+#include "XUtils.h"
+
+
+/* Unused strings are freed after that many samples were dropped */
+#define FLIGHT_SWEEP_INTERVAL 32
+
+static volatile sig_atomic_t FlightRecorder_dumpRequested = 0;
+
+static struct sigaction FlightRecorder_oldAction;
+
+static void FlightRecorder_handleSIGUSR1(ATTR_UNUSED int sgn) {
+   FlightRecorder_dumpRequested = 1;
+}
+
+static const struct {
+   const char* name;
+   FlightTriggerKind kind;
+} FlightRecorder_triggerNames[] = {
+   { "load", FLIGHT_TRIGGER_LOAD },
+   { "psi-cpu", FLIGHT_TRIGGER_PSI_CPU },
+   { "psi-io", FLIGHT_TRIGGER_PSI_IO },
+   { "psi-memory", FLIGHT_TRIGGER_PSI_MEMORY },
+   { "cpu", FLIGHT_TRIGGER_PROCESS },
+};
+
+bool FlightRecorder_parseTrigger(const char* spec, FlightTrigger* trigger) {
+   const char* colon = strchr(spec, ':');
+   if (!colon)
+      return false;
+
+   size_t nameLength = (size_t)(colon - spec);
+   bool found = false;
+   for (size_t i = 0; i < ARRAYSIZE(FlightRecorder_triggerNames); i++) {
+      if (strlen(FlightRecorder_triggerNames[i].name) == nameLength && strncmp(spec, FlightRecorder_triggerNames[i].name, nameLength) == 0) {
+         trigger->kind = FlightRecorder_triggerNames[i].kind;
+         found = true;
+         break;
+      }
+   }
+   if (!found)
+      return false;
+
+#if !defined(HTOP_LINUX) && !defined(HTOP_PCP)
+   if (trigger->kind != FLIGHT_TRIGGER_LOAD && trigger->kind != FLIGHT_TRIGGER_PROCESS)
+      return false;
+#endif
+
+   const char* value = colon + 1;
+   trigger->pid = 0;
+   if (trigger->kind == FLIGHT_TRIGGER_PROCESS) {
+      char* end;
+      long pid = strtol(value, &end, 10);
+      if (end == value || *end != ':' || pid <= 0 || pid > INT32_MAX)
+         return false;
+      trigger->pid = (pid_t)pid;
+      value = end + 1;
+   }
+
+   char* end;
+   trigger->threshold = strtod(value, &end);
+   trigger->above = false;
+   return end != value && *end == '\0' && trigger->threshold >= 0;
+}
+
+FlightRecorder* FlightRecorder_new(unsigned int minutes, const char* directory, const FlightTrigger* triggers, size_t triggerCount) {
+   FlightRecorder* this = xCalloc(1, sizeof(FlightRecorder));
+   this->windowMs = (uint64_t)minutes * 60 * 1000;
+   this->directory = xStrdup(directory);
+
+   this->capacity = 64;
+   this->samples = xCalloc(this->capacity, sizeof(FlightSample));
+
+   /* id 0 stands for no string */
+   this->stringCapacity = 64;
+   this->strings = xCalloc(this->stringCapacity, sizeof(char*));
+   this->hashes = xCalloc(this->stringCapacity, sizeof(uint32_t));
+   this->lastUsed = xCalloc(this->stringCapacity, sizeof(uint64_t));
+   this->freeIds = xCalloc(this->stringCapacity, sizeof(uint32_t));
+   this->stringCount = 1;
+   this->lookupSize = 128;
+   this->lookup = xCalloc(this->lookupSize, sizeof(uint32_t));
+
+   if (triggerCount) {
+      this->triggers = xCalloc(triggerCount, sizeof(FlightTrigger));
+      memcpy(this->triggers, triggers, triggerCount * sizeof(FlightTrigger));
+      this->triggerCount = triggerCount;
+   }
+
+   struct sigaction act;
+   memset(&act, 0, sizeof(act));
+   sigemptyset(&act.sa_mask);
+   act.sa_flags = SA_RESTART;
+   act.sa_handler = FlightRecorder_handleSIGUSR1;
+   sigaction(SIGUSR1, &act, &FlightRecorder_oldAction);
+
+   return this;
+}
+
+void FlightRecorder_delete(FlightRecorder* this) {
+   if (!this)
+      return;
+
+   sigaction(SIGUSR1, &FlightRecorder_oldAction, NULL);
+
+   for (size_t i = 0; i < this->capacity; i++)
+      free(this->samples[i].processes);
+   free(this->samples);
+   for (uint32_t i = 0; i < this->stringCount; i++)
+      free(this->strings[i]);
+   free(this->strings);
+   free(this->hashes);
+   free(this->lastUsed);
+   free(this->freeIds);
+   free(this->lookup);
+   free(this->triggers);
+   free(this->directory);
+   free(this);
+}
+
+static uint32_t FlightRecorder_hash(const char* str) {
+   /* FNV-1a */
+   uint32_t hash = 2166136261U;
+   for (; *str; str++)
+      hash = (hash ^ (unsigned char)*str) * 16777619U;
+   return hash;
+}
+
+static void FlightRecorder_rebuildLookup(FlightRecorder* this) {
+   memset(this->lookup, 0, this->lookupSize * sizeof(uint32_t));
+   for (uint32_t id = 1; id < this->stringCount; id++) {
+      if (!this->strings[id])
+         continue;
+
+      uint32_t i = this->hashes[id] & (this->lookupSize - 1);
+      while (this->lookup[i])
+         i = (i + 1) & (this->lookupSize - 1);
+      this->lookup[i] = id;
+   }
+}
+
+static uint32_t FlightRecorder_intern(FlightRecorder* this, const char* str) {
+   if (!str)
+      return 0;
+
+   uint32_t hash = FlightRecorder_hash(str);
+   uint32_t i = hash & (this->lookupSize - 1);
+   for (uint32_t id; (id = this->lookup[i]); i = (i + 1) & (this->lookupSize - 1)) {
+      if (this->hashes[id] == hash && String_eq(this->strings[id], str)) {
+         this->lastUsed[id] = this->serial;
+         return id;
+      }
+   }
+
+   uint32_t id;
+   if (this->freeCount > 0) {
+      id = this->freeIds[--this->freeCount];
+   } else {
+      if (this->stringCount == this->stringCapacity) {
+         uint32_t capacity = 2 * this->stringCapacity;
+         this->strings = xReallocArrayZero(this->strings, this->stringCapacity, capacity, sizeof(char*));
+         this->hashes = xReallocArrayZero(this->hashes, this->stringCapacity, capacity, sizeof(uint32_t));
+         this->lastUsed = xReallocArrayZero(this->lastUsed, this->stringCapacity, capacity, sizeof(uint64_t));
+         this->freeIds = xReallocArrayZero(this->freeIds, this->stringCapacity, capacity, sizeof(uint32_t));
+         this->stringCapacity = capacity;
+      }
+      id = this->stringCount++;
+   }
+   this->strings[id] = xStrdup(str);
+   this->hashes[id] = hash;
+   this->lastUsed[id] = this->serial;
+   this->lookup[i] = id;
+
+   uint32_t live = this->stringCount - this->freeCount;
+   if (2 * live > this->lookupSize) {
+      free(this->lookup);
+      this->lookupSize *= 2;
+      this->lookup = xCalloc(this->lookupSize, sizeof(uint32_t));
+      FlightRecorder_rebuildLookup(this);
+   }
+
+   return id;
+}
+
+/* Frees the strings no sample in the ring refers to any more */
+static void FlightRecorder_sweep(FlightRecorder* this) {
+   uint64_t oldest = this->samples[this->head].serial;
+   for (uint32_t id = 1; id < this->stringCount; id++) {
+      if (this->strings[id] && this->lastUsed[id] < oldest) {
+         free(this->strings[id]);
+         this->strings[id] = NULL;
+         this->freeIds[this->freeCount++] = id;
+      }
+   }
+   FlightRecorder_rebuildLookup(this);
+   this->dropped = 0;
+}
+
+static FlightSample* FlightRecorder_append(FlightRecorder* this) {
+   if (this->count == this->capacity) {
+      /* unroll the ring, the dropped samples' buffers come along for reuse */
+      size_t capacity = 2 * this->capacity;
+      FlightSample* samples = xCalloc(capacity, sizeof(FlightSample));
+      for (size_t i = 0; i < this->capacity; i++)
+         samples[i] = this->samples[(this->head + i) % this->capacity];
+      free(this->samples);
+      this->samples = samples;
+      this->capacity = capacity;
+      this->head = 0;
+   }
+
+   FlightSample* sample = &this->samples[(this->head + this->count) % this->capacity];
+   this->count++;
+   sample->serial = this->serial;
+   sample->count = 0;
+   return sample;
+}
+
+static void FlightRecorder_fill(FlightRecorder* this, const Process* p, FlightProcess* fp) {
+   fp->pid = p->pid;
+   fp->ppid = p->ppid;
+   fp->tgid = p->tgid;
+   fp->pgrp = p->pgrp;
+   fp->session = p->session;
+   fp->tpgid = p->tpgid;
+   fp->tty_nr = (uint32_t)p->tty_nr;
+   fp->st_uid = (uint32_t)p->st_uid;
+   fp->nice = (int32_t)p->nice;
+   fp->priority = (int32_t)p->priority;
+   fp->nlwp = (int32_t)p->nlwp;
+   fp->processor = p->processor;
+   fp->user = FlightRecorder_intern(this, p->user);
+   fp->tty = FlightRecorder_intern(this, p->tty_name);
+   fp->cmdline = FlightRecorder_intern(this, p->cmdline);
+   fp->comm = FlightRecorder_intern(this, p->procComm);
+   fp->exe = FlightRecorder_intern(this, p->procExe);
+   fp->cmdlineBasenameStart = p->cmdlineBasenameStart;
+   fp->cmdlineBasenameEnd = p->cmdlineBasenameEnd;
+   fp->percent_cpu = p->percent_cpu;
+   fp->percent_mem = p->percent_mem;
+   fp->state = (uint8_t)p->state;
+   fp->flags = (p->isKernelThread ? RECORDING_KERNEL_THREAD : 0) |
+               (p->isUserlandThread ? RECORDING_USERLAND_THREAD : 0) |
+               (p->procExeDeleted ? RECORDING_EXE_DELETED : 0) |
+               (p->usesDeletedLib ? RECORDING_DELETED_LIB : 0);
+   fp->m_virt = (uint64_t)p->m_virt;
+   fp->m_resident = (uint64_t)p->m_resident;
+   fp->time = p->time;
+   fp->minflt = p->minflt;
+   fp->majflt = p->majflt;
+   fp->starttime = p->starttime_ctime;
+}
+
+static double FlightRecorder_triggerValue(const FlightTrigger* trigger, const ProcessList* pl) {
+   double one, five, fifteen;
+
+   switch (trigger->kind) {
+      case FLIGHT_TRIGGER_LOAD:
+         Platform_getLoadAverage(&one, &five, &fifteen);
+         return one;
+#if defined(HTOP_LINUX) || defined(HTOP_PCP)
+      case FLIGHT_TRIGGER_PSI_CPU:
+         Platform_getPressureStall("cpu", true, &one, &five, &fifteen);
+         return one;
+      case FLIGHT_TRIGGER_PSI_IO:
+         Platform_getPressureStall("io", true, &one, &five, &fifteen);
+         return one;
+      case FLIGHT_TRIGGER_PSI_MEMORY:
+         Platform_getPressureStall("memory", true, &one, &five, &fifteen);
+         return one;
+#endif
+      case FLIGHT_TRIGGER_PROCESS: {
+         const Process* p = Hashtable_get(pl->processTable, trigger->pid);
+         return p && p->tombStampMs == 0 ? p->percent_cpu : NAN;
+      }
+      default:
+         return NAN;
+   }
+}
+
+/* Whether any trigger went above its threshold since the previous sample */
+static bool FlightRecorder_checkTriggers(FlightRecorder* this, const ProcessList* pl) {
+   bool fired = false;
+   for (size_t i = 0; i < this->triggerCount; i++) {
+      FlightTrigger* trigger = &this->triggers[i];
+      double value = FlightRecorder_triggerValue(trigger, pl);
+      bool above = !isnan(value) && value >= trigger->threshold;
+      if (above && !trigger->above)
+         fired = true;
+      trigger->above = above;
+   }
+   return fired;
+}
+
+static inline uint64_t FlightRecorder_integer(long long value) {
+   return (uint64_t)value;
+}
+
+static inline uint64_t FlightRecorder_real(double value) {
+   uint64_t slot;
+   memcpy(&slot, &value, sizeof(slot));
+   return slot;
+}
+
+/* The recorder's id for one of ours, interning it on first use */
+static uint64_t FlightRecorder_dumpString(const FlightRecorder* this, Recorder* recorder, uint32_t* ids, uint32_t id) {
+   if (!id)
+      return 0;
+   if (!ids[id])
+      ids[id] = Recorder_string(recorder, this->strings[id]);
+   return ids[id];
+}
+
+static void FlightRecorder_dumpProcess(const FlightRecorder* this, Recorder* recorder, uint32_t* ids, const FlightProcess* fp) {
+   uint64_t slots[RECORDING_FIELDS];
+   slots[RECORDING_PPID] = FlightRecorder_integer(fp->ppid);
+   slots[RECORDING_TGID] = FlightRecorder_integer(fp->tgid);
+   slots[RECORDING_PGRP] = FlightRecorder_integer(fp->pgrp);
+   slots[RECORDING_SESSION] = FlightRecorder_integer(fp->session);
+   slots[RECORDING_TTY_NR] = FlightRecorder_integer(fp->tty_nr);
+   slots[RECORDING_TPGID] = FlightRecorder_integer(fp->tpgid);
+   slots[RECORDING_ST_UID] = FlightRecorder_integer(fp->st_uid);
+   slots[RECORDING_STATE] = FlightRecorder_integer(fp->state);
+   slots[RECORDING_FLAGS] = fp->flags;
+   slots[RECORDING_NICE] = FlightRecorder_integer(fp->nice);
+   slots[RECORDING_PRIORITY] = FlightRecorder_integer(fp->priority);
+   slots[RECORDING_NLWP] = FlightRecorder_integer(fp->nlwp);
+   slots[RECORDING_PROCESSOR] = FlightRecorder_integer(fp->processor);
+   slots[RECORDING_PERCENT_CPU] = FlightRecorder_real(fp->percent_cpu);
+   slots[RECORDING_PERCENT_MEM] = FlightRecorder_real(fp->percent_mem);
+   slots[RECORDING_M_VIRT] = fp->m_virt;
+   slots[RECORDING_M_RESIDENT] = fp->m_resident;
+   slots[RECORDING_TIME] = fp->time;
+   slots[RECORDING_STARTTIME] = FlightRecorder_integer(fp->starttime);
+   slots[RECORDING_MINFLT] = fp->minflt;
+   slots[RECORDING_MAJFLT] = fp->majflt;
+   slots[RECORDING_USER] = FlightRecorder_dumpString(this, recorder, ids, fp->user);
+   slots[RECORDING_TTY] = FlightRecorder_dumpString(this, recorder, ids, fp->tty);
+   slots[RECORDING_CMDLINE] = FlightRecorder_dumpString(this, recorder, ids, fp->cmdline);
+   slots[RECORDING_BASENAME] = ((uint64_t)(uint32_t)fp->cmdlineBasenameStart << 32) | (uint32_t)fp->cmdlineBasenameEnd;
+   slots[RECORDING_COMM] = FlightRecorder_dumpString(this, recorder, ids, fp->comm);
+   slots[RECORDING_EXE] = FlightRecorder_dumpString(this, recorder, ids, fp->exe);
+
+   Recorder_addProcess(recorder, fp->pid, slots);
+}
+
+/* Creates a new recording named after the time of the newest sample */
+static Recorder* FlightRecorder_create(FlightRecorder* this) {
+   const FlightSample* newest = &this->samples[(this->head + this->count - 1) % this->capacity];
+   time_t seconds = (time_t)(newest->realtimeMs / 1000);
+   struct tm tm;
+   char stamp[32];
+   strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime_r(&seconds, &tm));
+
+   for (unsigned int attempt = 0; attempt < 100; attempt++) {
+      if (attempt == 0)
+         xSnprintf(this->lastDump, sizeof(this->lastDump), "%s/htop-flight-%d-%s.rec", this->directory, (int)getpid(), stamp);
+      else
+         xSnprintf(this->lastDump, sizeof(this->lastDump), "%s/htop-flight-%d-%s-%u.rec", this->directory, (int)getpid(), stamp, attempt);
+
+      Recorder* recorder = Recorder_new(this->lastDump);
+      if (recorder || errno != EEXIST)
+         return recorder;
+   }
+   return NULL;
+}
+
+/* Writes the samples in memory to a new recording; returns false with errno set on failure */
+static bool FlightRecorder_dump(FlightRecorder* this) {
+   Recorder* recorder = FlightRecorder_create(this);
+   if (!recorder)
+      return false;
+
+   uint32_t* ids = xCalloc(this->stringCount, sizeof(uint32_t));
+   for (size_t i = 0; i < this->count && !recorder->error; i++) {
+      const FlightSample* sample = &this->samples[(this->head + i) % this->capacity];
+
+      Recorder_beginSample(recorder);
+      for (uint32_t j = 0; j < sample->count; j++)
+         FlightRecorder_dumpProcess(this, recorder, ids, &sample->processes[j]);
+
+      RecordingSample counts = {
+         .realtimeMs = sample->realtimeMs,
+         .totalTasks = sample->totalTasks,
+         .runningTasks = sample->runningTasks,
+         .userlandThreads = sample->userlandThreads,
+         .kernelThreads = sample->kernelThreads,
+      };
+      Recorder_endSample(recorder, &counts);
+   }
+   free(ids);
+
+   int error = recorder->error;
+   Recorder_delete(recorder);
+   if (error) {
+      errno = error;
+      return false;
+   }
+   this->dumps++;
+   return true;
+}
+
+bool FlightRecorder_addSample(FlightRecorder* this, const ProcessList* pl) {
+   ProfileMark mark;
+   Profile_begin(&mark);
+
+   FlightSample* sample = FlightRecorder_append(this);
+   sample->realtimeMs = pl->realtimeMs;
+   sample->totalTasks = pl->totalTasks;
+   sample->runningTasks = pl->runningTasks;
+   sample->userlandThreads = pl->userlandThreads;
+   sample->kernelThreads = pl->kernelThreads;
+
+   uint32_t size = (uint32_t)Vector_size(pl->processes);
+   if (size > sample->capacity) {
+      free(sample->processes);
+      sample->capacity = size;
+      sample->processes = xMallocArray(size, sizeof(FlightProcess));
+   }
+
+   for (uint32_t i = 0; i < size; i++) {
+      const Process* p = (const Process*) Vector_get(pl->processes, (int)i);
+      if (p->tombStampMs > 0)
+         continue;
+
+      FlightRecorder_fill(this, p, &sample->processes[sample->count++]);
+   }
+   this->serial++;
+
+   while (this->count > 1 && sample->realtimeMs - this->samples[this->head].realtimeMs > this->windowMs) {
+      this->head = (this->head + 1) % this->capacity;
+      this->count--;
+      this->dropped++;
+   }
+   if (this->dropped >= FLIGHT_SWEEP_INTERVAL)
+      FlightRecorder_sweep(this);
+
+   Profile_end(&mark, PROFILE_RECORD);
+
+   bool requested = FlightRecorder_dumpRequested;
+   FlightRecorder_dumpRequested = 0;
+   if (FlightRecorder_checkTriggers(this, pl))
+      requested = true;
+
+   if (!requested)
+      return false;
+
+   this->error = FlightRecorder_dump(this) ? 0 : errno;
+   return true;
+}
+
+void FlightRecorder_requestDump(void) {
+   FlightRecorder_dumpRequested = 1;
+}
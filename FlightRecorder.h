@@ -0,0 +1,132 @@
+#ifndef HEADER_FlightRecorder
+#define HEADER_FlightRecorder
+/*
+htop - FlightRecorder.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+
+struct ProcessList_;
+
+/* One process in one sample, strings being ids of the flight recorder */
+typedef struct FlightProcess_ {
+   int32_t pid;
+   int32_t ppid;
+   int32_t tgid;
+   int32_t pgrp;
+   int32_t session;
+   int32_t tpgid;
+   uint32_t tty_nr;
+   uint32_t st_uid;
+   int32_t nice;
+   int32_t priority;
+   int32_t nlwp;
+   int32_t processor;
+   uint32_t user;
+   uint32_t tty;
+   uint32_t cmdline;
+   uint32_t comm;
+   uint32_t exe;
+   int32_t cmdlineBasenameStart;
+   int32_t cmdlineBasenameEnd;
+   float percent_cpu;
+   float percent_mem;
+   uint8_t state;
+   uint8_t flags;             /* RECORDING_FLAGS bits */
+   uint64_t m_virt;
+   uint64_t m_resident;
+   uint64_t time;
+   uint64_t minflt;
+   uint64_t majflt;
+   int64_t starttime;
+} FlightProcess;
+
+typedef struct FlightSample_ {
+   uint64_t serial;
+   uint64_t realtimeMs;
+   uint32_t totalTasks;
+   uint32_t runningTasks;
+   uint32_t userlandThreads;
+   uint32_t kernelThreads;
+   FlightProcess* processes;  /* kept allocated when the sample is dropped, for reuse */
+   uint32_t count;
+   uint32_t capacity;
+} FlightSample;
+
+typedef enum FlightTriggerKind_ {
+   FLIGHT_TRIGGER_LOAD,       /* 1 minute load average */
+   FLIGHT_TRIGGER_PSI_CPU,    /* "some" pressure stall over 10 seconds, in percent */
+   FLIGHT_TRIGGER_PSI_IO,
+   FLIGHT_TRIGGER_PSI_MEMORY,
+   FLIGHT_TRIGGER_PROCESS,    /* CPU usage of one process, in percent */
+} FlightTriggerKind;
+
+typedef struct FlightTrigger_ {
+   FlightTriggerKind kind;
+   pid_t pid;
+   double threshold;
+   bool above;                /* fires again only after going below the threshold */
+} FlightTrigger;
+
+/*
+ * Keeps the samples of the last minutes in memory, as fixed-size process
+ * records with interned strings, and writes them as a recording (see
+ * Recording.h) when asked to by SIGUSR1 or when a trigger goes above its
+ * threshold.
+ */
+typedef struct FlightRecorder_ {
+   uint64_t windowMs;
+   char* directory;
+
+   FlightSample* samples;     /* ring, oldest at head */
+   size_t head;
+   size_t count;
+   size_t capacity;
+   uint64_t serial;           /* of the next sample */
+   unsigned int dropped;      /* samples dropped since unused strings were freed */
+
+   /* interned strings, indexed by id; freed once no sample refers to them */
+   char** strings;
+   uint32_t* hashes;
+   uint64_t* lastUsed;        /* serial of the newest sample using the string */
+   uint32_t stringCount;      /* ids in use or free */
+   uint32_t stringCapacity;
+   uint32_t* freeIds;
+   uint32_t freeCount;
+   uint32_t* lookup;          /* open addressing table of string ids */
+   uint32_t lookupSize;
+
+   FlightTrigger* triggers;
+   size_t triggerCount;
+
+   unsigned int dumps;        /* recordings written successfully */
+   char lastDump[4096];       /* path of the last recording written */
+   int error;                 /* errno of the last failed dump, 0 if it succeeded */
+} FlightRecorder;
+
+/* Parses a trigger of the form load:N, psi-cpu:N, psi-io:N, psi-memory:N or cpu:PID:N */
+bool FlightRecorder_parseTrigger(const char* spec, FlightTrigger* trigger);
+
+/* Keeps the given minutes of samples, the triggers are copied */
+FlightRecorder* FlightRecorder_new(unsigned int minutes, const char* directory, const FlightTrigger* triggers, size_t triggerCount);
+
+void FlightRecorder_delete(FlightRecorder* this);
+
+/*
+ * Adds the current state of the process list, drops the samples which fell
+ * out of the window and dumps them all if requested. Returns whether a dump
+ * was attempted, see lastDump and error for its outcome.
+ */
+bool FlightRecorder_addSample(FlightRecorder* this, const struct ProcessList_* pl);
+
+/* Dumps with the next sample, like SIGUSR1 does; for the UI thread */
+void FlightRecorder_requestDump(void);
+
+#endif
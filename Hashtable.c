@@ -191,10 +191,14 @@ void Hashtable_setSize(Hashtable* this, size_t size) {
    if (size <= this->items)
       return;
 
+   size_t newSize = nextPrime(size);
+   if (newSize == this->size)
+      return;
+
    HashtableItem* oldBuckets = this->buckets;
    size_t oldSize = this->size;
 
-   this->size = nextPrime(size);
+   this->size = newSize;
    this->buckets = (HashtableItem*) xCalloc(this->size, sizeof(HashtableItem));
    this->items = 0;
 
@@ -217,8 +221,8 @@ void Hashtable_put(Hashtable* this, ht_key_t key, void* value) {
    assert(this->size > 0);
    assert(value);
 
-   /* grow on load-factor > 0.7 */
-   if (10 * this->items > 7 * this->size) {
+   /* grow on load-factor > 0.7, counting the new item so small tables never fill up */
+   if (10 * (this->items + 1) > 7 * this->size) {
       if (SIZE_MAX / 2 < this->size)
          CRT_fatalError("Hashtable: size overflow");
 
@@ -282,7 +286,7 @@ void* Hashtable_remove(Hashtable* this, ht_key_t key) {
 
    /* shrink on load-factor < 0.125 */
    if (8 * this->items < this->size)
-      Hashtable_setSize(this, this->size / 2);
+      Hashtable_setSize(this, this->size / 3); /* account for nextPrime rounding up */
 
    return res;
 }
@@ -68,6 +68,7 @@ IncSet* IncSet_new(FunctionBar* bar) {
    this->defaultBar = bar;
    this->filtering = false;
    this->found = false;
+   this->foldedValues = false;
    return this;
 }
 
@@ -77,8 +78,31 @@ void IncSet_delete(IncSet* this) {
    free(this);
 }
 
-static void updateWeakPanel(const IncSet* this, Panel* panel, Vector* lines) {
+static void updateWeakPanel(const IncSet* this, Panel* panel, Vector* lines, bool narrowed) {
    const Object* selected = Panel_getSelected(panel);
+   if (this->filtering && narrowed) {
+      /* a longer filter only matches lines shown already, so only those need to be checked */
+      int n = 0;
+      const char* incFilter = this->modes[INC_FILTER].buffer;
+      int selectedIndex = 0;
+      for (int i = 0; i < Panel_size(panel); i++) {
+         Object* line = Panel_get(panel, i);
+         if (String_contains_i(((const ListItem*)line)->value, incFilter)) {
+            if (selected == line) {
+               selectedIndex = n;
+            }
+
+            Panel_set(panel, n, line);
+            n++;
+         }
+      }
+      Vector_removeRange(panel->items, n, Panel_size(panel) - n);
+      panel->scrollV = 0;
+      panel->needsRedraw = true;
+      Panel_setSelected(panel, selectedIndex);
+      return;
+   }
+
    Panel_prune(panel);
    if (this->filtering) {
       int n = 0;
@@ -105,10 +129,25 @@ static void updateWeakPanel(const IncSet* this, Panel* panel, Vector* lines) {
    }
 }
 
-static bool search(const IncMode* mode, Panel* panel, IncMode_GetPanelValue getPanelValue) {
+/* Folds the needle once, so panels providing case-folded values can use a plain (vectorized) strstr */
+static inline const char* IncMode_prepareNeedle(const IncSet* this, const IncMode* mode, char* folded) {
+   if (!this->foldedValues)
+      return mode->buffer;
+
+   String_lowerCopy(folded, mode->buffer, strlen(mode->buffer));
+   return folded;
+}
+
+static inline bool IncSet_matches(const IncSet* this, const char* value, const char* needle) {
+   return this->foldedValues ? strstr(value, needle) != NULL : String_contains_i(value, needle);
+}
+
+static bool search(const IncSet* this, const IncMode* mode, Panel* panel, IncMode_GetPanelValue getPanelValue) {
+   char folded[INCMODE_MAX + 1];
+   const char* needle = IncMode_prepareNeedle(this, mode, folded);
    int size = Panel_size(panel);
    for (int i = 0; i < size; i++) {
-      if (String_contains_i(getPanelValue(panel, i), mode->buffer)) {
+      if (IncSet_matches(this, getPanelValue(panel, i), needle)) {
          Panel_setSelected(panel, i);
          return true;
       }
@@ -117,7 +156,9 @@ static bool search(const IncMode* mode, Panel* panel, IncMode_GetPanelValue getP
    return false;
 }
 
-static bool IncMode_find(const IncMode* mode, Panel* panel, IncMode_GetPanelValue getPanelValue, int step) {
+static bool IncMode_find(const IncSet* this, const IncMode* mode, Panel* panel, IncMode_GetPanelValue getPanelValue, int step) {
+   char folded[INCMODE_MAX + 1];
+   const char* needle = IncMode_prepareNeedle(this, mode, folded);
    int size = Panel_size(panel);
    int here = Panel_getSelectedIndex(panel);
    int i = here;
@@ -133,7 +174,7 @@ static bool IncMode_find(const IncMode* mode, Panel* panel, IncMode_GetPanelValu
          return false;
       }
 
-      if (String_contains_i(getPanelValue(panel, i), mode->buffer)) {
+      if (IncSet_matches(this, getPanelValue(panel, i), needle)) {
          Panel_setSelected(panel, i);
          return true;
       }
@@ -147,12 +188,13 @@ bool IncSet_handleKey(IncSet* this, int ch, Panel* panel, IncMode_GetPanelValue
    IncMode* mode = this->active;
    int size = Panel_size(panel);
    bool filterChanged = false;
+   bool filterNarrowed = false;
    bool doSearch = true;
    if (ch == KEY_F(3) || ch == KEY_F(15)) {
       if (size == 0)
          return true;
 
-      IncMode_find(mode, panel, getPanelValue, ch == KEY_F(3) ? 1 : -1);
+      IncMode_find(this, mode, panel, getPanelValue, ch == KEY_F(3) ? 1 : -1);
       doSearch = false;
    } else if (0 < ch && ch < 255 && isprint((unsigned char)ch)) {
       if (mode->index < INCMODE_MAX) {
@@ -161,6 +203,7 @@ bool IncSet_handleKey(IncSet* this, int ch, Panel* panel, IncMode_GetPanelValue
          mode->buffer[mode->index] = 0;
          if (mode->isFilter) {
             filterChanged = true;
+            filterNarrowed = this->filtering;
             if (mode->index == 1) {
                this->filtering = true;
             }
@@ -199,10 +242,10 @@ bool IncSet_handleKey(IncSet* this, int ch, Panel* panel, IncMode_GetPanelValue
       doSearch = false;
    }
    if (doSearch) {
-      this->found = search(mode, panel, getPanelValue);
+      this->found = search(this, mode, panel, getPanelValue);
    }
    if (filterChanged && lines) {
-      updateWeakPanel(this, panel, lines);
+      updateWeakPanel(this, panel, lines, filterNarrowed);
    }
    return filterChanged;
 }
@@ -35,6 +35,7 @@ typedef struct IncSet_ {
    FunctionBar* defaultBar;
    bool filtering;
    bool found;
+   bool foldedValues;  /* whether IncMode_GetPanelValue returns case-folded strings */
 } IncSet;
 
 static inline const char* IncSet_filter(const IncSet* this) {
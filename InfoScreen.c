@@ -7,10 +7,13 @@
 #include <string.h>
 
 #include "CRT.h"
+#include "EventLoop.h"
 #include "IncSet.h"
 #include "ListItem.h"
+#include "Macros.h"
 #include "Object.h"
 #include "ProvideCurses.h"
+#include "Sampler.h"
 #include "XUtils.h"
 
 
@@ -28,6 +31,10 @@ InfoScreen* InfoScreen_init(InfoScreen* this, const Process* process, FunctionBa
    this->display = Panel_new(0, 1, COLS, height, Class(ListItem), false, bar);
    this->inc = IncSet_new(bar);
    this->lines = Vector_new(Vector_type(this->display->items), true, DEFAULT_SIZE);
+   this->maxLines = 0;
+   this->events = NULL;
+   this->sampler = NULL;
+   this->waitMs = -1;
    Panel_setHeader(this->display, panelHeader);
    return this;
 }
@@ -60,7 +67,35 @@ void InfoScreen_drawTitled(InfoScreen* this, const char* fmt, ...) {
    IncSet_drawBar(this->inc);
 }
 
+void InfoScreen_setMaxLines(InfoScreen* this, int maxLines) {
+   this->maxLines = maxLines;
+}
+
+/* Drops the oldest lines, along with those of them the panel shows, keeping the selection on its line */
+static void InfoScreen_dropLines(InfoScreen* this, int count) {
+   Panel* panel = this->display;
+   int shown = 0;
+   for (int i = 0; i < count && shown < Panel_size(panel); i++) {
+      if (Panel_get(panel, shown) == Vector_get(this->lines, i)) {
+         shown++;
+      }
+   }
+
+   if (shown > 0) {
+      Vector_removeRange(panel->items, 0, shown);
+      panel->scrollV = MAXIMUM(panel->scrollV - shown, 0);
+      Panel_setSelected(panel, panel->selected - shown);
+      panel->needsRedraw = true;
+   }
+   Vector_removeRange(this->lines, 0, count);
+}
+
 void InfoScreen_addLine(InfoScreen* this, const char* line) {
+   /* a little slack, so the remaining lines are moved only every so often */
+   if (this->maxLines > 0 && Vector_size(this->lines) >= this->maxLines + this->maxLines / 8) {
+      InfoScreen_dropLines(this, Vector_size(this->lines) - this->maxLines + 1);
+   }
+
    Vector_add(this->lines, (Object*) ListItem_new(line, 0));
    const char* incFilter = IncSet_filter(this->inc);
    if (!incFilter || String_contains_i(line, incFilter)) {
@@ -77,6 +112,31 @@ void InfoScreen_appendLine(InfoScreen* this, const char* line) {
    }
 }
 
+void InfoScreen_setState(InfoScreen* this, const State* st) {
+   this->events = st->events;
+   this->sampler = st->events ? st->sampler : NULL;
+}
+
+static int InfoScreen_getch(InfoScreen* this) {
+   if (!this->events) {
+      if (this->waitMs >= 0)
+         timeout(this->waitMs);
+      return getch();
+   }
+
+   /* as in ScreenManager_run, the data is only left to the sampler while waiting */
+   if (this->sampler)
+      Sampler_release(this->sampler);
+
+   CRT_disableDelay();
+   int ch = EventLoop_getchTimeout(this->events, this->waitMs >= 0 ? this->waitMs : 100 * CRT_inputDelay());
+
+   if (this->sampler)
+      Sampler_acquire(this->sampler);
+
+   return ch;
+}
+
 void InfoScreen_run(InfoScreen* this) {
    Panel* panel = this->display;
 
@@ -97,7 +157,7 @@ void InfoScreen_run(InfoScreen* this) {
 #ifdef HAVE_SET_ESCDELAY
       set_escdelay(25);
 #endif
-      int ch = getch();
+      int ch = InfoScreen_getch(this);
 
       if (ch == ERR) {
          if (As_InfoScreen(this)->onErr) {
@@ -3,6 +3,8 @@
 
 #include <stdbool.h>
 
+#include "Action.h"
+#include "EventLoop.h"
 #include "FunctionBar.h"
 #include "IncSet.h"
 #include "Macros.h"
@@ -12,12 +14,18 @@
 #include "Vector.h"
 
 
+struct Sampler_; // IWYU pragma: keep
+
 typedef struct InfoScreen_ {
    Object super;
    const Process* process;
    Panel* display;
    IncSet* inc;
    Vector* lines;
+   int maxLines;              /* oldest lines are dropped beyond this, 0 for no limit */
+   EventLoop* events;         /* the main loop's, waited on for keys and sources instead of polling */
+   struct Sampler_* sampler;  /* released while waiting, so scans and their sources carry on */
+   int waitMs;                /* longest wait for a key before onErr, -1 for the refresh delay */
 } InfoScreen;
 
 typedef void(*InfoScreen_Scan)(InfoScreen*);
@@ -46,10 +54,15 @@ InfoScreen* InfoScreen_done(InfoScreen* this);
 ATTR_FORMAT(printf, 2, 3)
 void InfoScreen_drawTitled(InfoScreen* this, const char* fmt, ...);
 
+void InfoScreen_setMaxLines(InfoScreen* this, int maxLines);
+
 void InfoScreen_addLine(InfoScreen* this, const char* line);
 
 void InfoScreen_appendLine(InfoScreen* this, const char* line);
 
+/* Shares the main loop's event loop and sampler, call before InfoScreen_run */
+void InfoScreen_setState(InfoScreen* this, const State* st);
+
 void InfoScreen_run(InfoScreen* this);
 
 #endif
@@ -17,6 +17,7 @@ in the source distribution for its full text.
 #include "Process.h"
 #include "ProcessList.h"
 #include "ProvideCurses.h"
+#include "Replay.h"
 #include "Settings.h"
 #include "XUtils.h"
 
@@ -46,8 +47,8 @@ static void MainPanel_pidSearch(MainPanel* this, int ch) {
 }
 
 static const char* MainPanel_getValue(Panel* this, int i) {
-   const Process* p = (const Process*) Panel_get(this, i);
-   return Process_getCommand(p);
+   Process* p = (Process*) Panel_get(this, i);
+   return Process_getFilterCommand(p);
 }
 
 static HandlerResult MainPanel_eventHandler(Panel* super, int ch) {
@@ -186,6 +187,11 @@ static void MainPanel_drawFunctionBar(Panel* super, bool hideFunctionBar) {
    if (this->state->pauseProcessUpdate) {
       FunctionBar_append("PAUSED", CRT_colors[PAUSED]);
    }
+   if (this->state->pl->replay) {
+      char status[64];
+      Replay_status(this->state->pl->replay, status, sizeof(status));
+      FunctionBar_append(status, CRT_colors[PAUSED]);
+   }
 }
 
 static void MainPanel_printHeader(Panel* super) {
@@ -208,6 +214,7 @@ MainPanel* MainPanel_new() {
    Panel_init((Panel*) this, 1, 1, 1, 1, Class(Process), false, FunctionBar_new(Settings_isReadonly() ? MainFunctions_ro : MainFunctions, NULL, NULL));
    this->keys = xCalloc(KEY_MAX, sizeof(Htop_Action));
    this->inc = IncSet_new(MainPanel_getFunctionBar(this));
+   this->inc->foldedValues = true;
 
    Action_setBindings(this->keys);
    Platform_setBindings(this->keys);
@@ -19,7 +19,10 @@ in the source distribution for its full text.
 #include "Macros.h"
 #include "Object.h"
 #include "ProvideCurses.h"
+#include "Recorder.h"
+#include "Replay.h"
 #include "RichString.h"
+#include "Server.h"
 #include "Settings.h"
 #include "XUtils.h"
 
@@ -50,6 +53,22 @@ Meter* Meter_new(const struct ProcessList_* pl, unsigned int param, const MeterC
    return this;
 }
 
+void Meter_updateValues(Meter* this) {
+   const ProcessList* pl = this->pl;
+
+   if (pl->replay) {
+      Replay_updateMeter(pl->replay, this);
+   } else {
+      As_Meter(this)->updateValues(this);
+
+      if (pl->recorder)
+         Recorder_addMeter(pl->recorder, this);
+   }
+
+   if (pl->server)
+      Server_addMeter(pl->server, this);
+}
+
 int Meter_humanUnit(char* buffer, unsigned long int value, size_t size) {
    const char* prefix = "KMGTPEZY";
    unsigned long int powi = 1;
@@ -315,9 +334,13 @@ static void GraphMeterMode_draw(Meter* this, int x, int y, int w) {
    x += captionLen;
    w -= captionLen;
 
-   if (!timercmp(&pl->realtime, &(data->time), <)) {
-      int globalDelay = this->pl->settings->delay;
-      struct timeval delay = { .tv_sec = globalDelay / 10, .tv_usec = (globalDelay % 10) * 100000L };
+   int globalDelay = this->pl->settings->delay;
+   struct timeval delay = { .tv_sec = globalDelay / 10, .tv_usec = (globalDelay % 10) * 100000L };
+   struct timeval lastTime;
+   timersub(&(data->time), &delay, &lastTime);
+
+   // also move on when going back in time, e.g. seeking in a replay
+   if (!timercmp(&pl->realtime, &(data->time), <) || timercmp(&pl->realtime, &lastTime, <)) {
       timeradd(&pl->realtime, &delay, &(data->time));
 
       for (int i = 0; i < nValues - 1; i++)
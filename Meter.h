@@ -84,7 +84,6 @@ typedef struct MeterClass_ {
 #define Meter_updateMode(this_, m_)    As_Meter(this_)->updateMode((Meter*)(this_), m_)
 #define Meter_drawFn(this_)            As_Meter(this_)->draw
 #define Meter_doneFn(this_)            As_Meter(this_)->done
-#define Meter_updateValues(this_)      As_Meter(this_)->updateValues((Meter*)(this_))
 #define Meter_getUiNameFn(this_)       As_Meter(this_)->getUiName
 #define Meter_getUiName(this_,n_,l_)   As_Meter(this_)->getUiName((const Meter*)(this_),n_,l_)
 #define Meter_getCaptionFn(this_)      As_Meter(this_)->getCaption
@@ -138,6 +137,9 @@ extern const MeterClass Meter_class;
 
 Meter* Meter_new(const ProcessList* pl, unsigned int param, const MeterClass* type);
 
+/* Updates the values through the meter class, or from the replay if there is one */
+void Meter_updateValues(Meter* this);
+
 int Meter_humanUnit(char* buffer, unsigned long int value, size_t size);
 
 void Meter_delete(Object* cast);
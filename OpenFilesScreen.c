@@ -19,42 +19,30 @@ in the source distribution for its full text.
 
 #include "Macros.h"
 #include "Panel.h"
+#include "Platform.h"
 #include "ProvideCurses.h"
 #include "Vector.h"
 #include "XUtils.h"
 
 
-typedef struct OpenFiles_Data_ {
-   char* data[7];
-} OpenFiles_Data;
-
-typedef struct OpenFiles_ProcessData_ {
-   OpenFiles_Data data;
-   int error;
-   struct OpenFiles_FileData_* files;
-} OpenFiles_ProcessData;
-
-typedef struct OpenFiles_FileData_ {
-   OpenFiles_Data data;
-   struct OpenFiles_FileData_* next;
-} OpenFiles_FileData;
-
 static size_t getIndexForType(char type) {
    switch (type) {
    case 'f':
-      return 0;
+      return OPENFILES_FD;
    case 'a':
-      return 1;
+      return OPENFILES_ACCESS;
    case 'D':
-      return 2;
+      return OPENFILES_DEVICE;
    case 'i':
-      return 3;
+      return OPENFILES_INODE;
    case 'n':
-      return 4;
+      return OPENFILES_NAME;
    case 's':
-      return 5;
+      return OPENFILES_SIZE;
    case 't':
-      return 6;
+      return OPENFILES_TYPE;
+   case 'o':
+      return OPENFILES_OFFSET;
    }
 
    /* should never reach here */
@@ -74,15 +62,42 @@ OpenFilesScreen* OpenFilesScreen_new(const Process* process) {
    } else {
       this->pid = process->pid;
    }
-   return (OpenFilesScreen*) InfoScreen_init(&this->super, process, NULL, LINES - 2, "   FD TYPE    MODE DEVICE           SIZE       NODE  NAME");
+   this->native = NULL;
+   return (OpenFilesScreen*) InfoScreen_init(&this->super, process, NULL, LINES - 2, "   FD TYPE    MODE DEVICE           SIZE     OFFSET       NODE  NAME");
+}
+
+static void OpenFiles_Data_clear(OpenFiles_Data* data) {
+   for (size_t i = 0; i < ARRAYSIZE(data->data); i++)
+      free(data->data[i]);
+}
+
+void OpenFiles_ProcessData_delete(OpenFiles_ProcessData* pdata) {
+   if (!pdata)
+      return;
+
+   OpenFiles_FileData* fdata = pdata->files;
+   while (fdata) {
+      OpenFiles_FileData* next = fdata->next;
+      OpenFiles_Data_clear(&fdata->data);
+      free(fdata->link);
+      free(fdata);
+      fdata = next;
+   }
+   OpenFiles_Data_clear(&pdata->data);
+   free(pdata);
 }
 
-void OpenFilesScreen_delete(Object* this) {
-   free(InfoScreen_done((InfoScreen*)this));
+void OpenFilesScreen_delete(Object* cast) {
+   OpenFilesScreen* this = (OpenFilesScreen*) cast;
+   OpenFiles_ProcessData_delete(this->native);
+   free(InfoScreen_done(&this->super));
 }
 
 static void OpenFilesScreen_draw(InfoScreen* this) {
-   InfoScreen_drawTitled(this, "Snapshot of files open in process %d - %s", ((OpenFilesScreen*)this)->pid, Process_getCommand(this->process));
+   if (((OpenFilesScreen*)this)->native)
+      InfoScreen_drawTitled(this, "Files open in process %d - %s", ((OpenFilesScreen*)this)->pid, Process_getCommand(this->process));
+   else
+      InfoScreen_drawTitled(this, "Snapshot of files open in process %d - %s", ((OpenFilesScreen*)this)->pid, Process_getCommand(this->process));
 }
 
 static OpenFiles_ProcessData* OpenFilesScreen_getProcessData(pid_t pid) {
@@ -151,6 +166,7 @@ static OpenFiles_ProcessData* OpenFilesScreen_getProcessData(pid_t pid) {
       case 'D':  /* file's major/minor device number */
       case 'i':  /* file's inode number */
       case 'n':  /* file name, comment, Internet address */
+      case 'o':  /* file's offset */
       case 's':  /* file's size */
       case 't':  /* file's type */
       {
@@ -166,7 +182,6 @@ static OpenFiles_ProcessData* OpenFilesScreen_getProcessData(pid_t pid) {
       case 'k':  /* link count */
       case 'l':  /* file's lock status */
       case 'L':  /* process login name */
-      case 'o':  /* file's offset */
       case 'p':  /* process ID */
       case 'P':  /* protocol name */
       case 'R':  /* parent process ID */
@@ -194,54 +209,69 @@ static OpenFiles_ProcessData* OpenFilesScreen_getProcessData(pid_t pid) {
    return pdata;
 }
 
-static void OpenFiles_Data_clear(OpenFiles_Data* data) {
-   for (size_t i = 0; i < ARRAYSIZE(data->data); i++)
-      free(data->data[i]);
-}
-
-static void OpenFilesScreen_scan(InfoScreen* this) {
-   Panel* panel = this->display;
+static void OpenFilesScreen_scan(InfoScreen* super) {
+   OpenFilesScreen* this = (OpenFilesScreen*) super;
+   Panel* panel = super->display;
    int idx = Panel_getSelectedIndex(panel);
    Panel_prune(panel);
-   OpenFiles_ProcessData* pdata = OpenFilesScreen_getProcessData(((OpenFilesScreen*)this)->pid);
+
+   /* the platform's listing, if any, takes over the entries which did not change */
+   OpenFiles_ProcessData* pdata = Platform_getProcessOpenFiles(this->pid, this->native);
+   if (pdata) {
+      OpenFiles_ProcessData_delete(this->native);
+      this->native = pdata;
+   } else {
+      pdata = OpenFilesScreen_getProcessData(this->pid);
+   }
+
    if (pdata->error == 127) {
-      InfoScreen_addLine(this, "Could not execute 'lsof'. Please make sure it is available in your $PATH.");
+      InfoScreen_addLine(super, "Could not execute 'lsof'. Please make sure it is available in your $PATH.");
    } else if (pdata->error == 1) {
-      InfoScreen_addLine(this, "Failed listing open files.");
+      InfoScreen_addLine(super, "Failed listing open files.");
    } else {
-      OpenFiles_FileData* fdata = pdata->files;
-      while (fdata) {
-         OpenFiles_Data* data = &fdata->data;
+      for (const OpenFiles_FileData* fdata = pdata->files; fdata; fdata = fdata->next) {
+         const OpenFiles_Data* data = &fdata->data;
          size_t lenN = strlen(getDataForType(data, 'n'));
-         size_t sizeEntry = 5 + 7 + 4 + 10 + 10 + 10 + lenN + 7 /*spaces*/ + 1 /*null*/;
+         size_t sizeEntry = 5 + 7 + 4 + 10 + 10 + 10 + 10 + lenN + 8 /*spaces*/ + 1 /*null*/;
          char entry[sizeEntry];
-         xSnprintf(entry, sizeof(entry), "%5.5s %-7.7s %-4.4s %-10.10s %10.10s %10.10s  %s",
+         const char* offset = getDataForType(data, 'o');
+         if (String_startsWith(offset, "0t"))
+            offset += 2;
+         xSnprintf(entry, sizeof(entry), "%5.5s %-7.7s %-4.4s %-10.10s %10.10s %10.10s %10.10s  %s",
                    getDataForType(data, 'f'),
                    getDataForType(data, 't'),
                    getDataForType(data, 'a'),
                    getDataForType(data, 'D'),
                    getDataForType(data, 's'),
+                   offset,
                    getDataForType(data, 'i'),
                    getDataForType(data, 'n'));
-         InfoScreen_addLine(this, entry);
-         OpenFiles_Data_clear(data);
-         OpenFiles_FileData* old = fdata;
-         fdata = fdata->next;
-         free(old);
+         InfoScreen_addLine(super, entry);
       }
-      OpenFiles_Data_clear(&pdata->data);
    }
-   free(pdata);
-   Vector_insertionSort(this->lines);
+   if (pdata != this->native)
+      OpenFiles_ProcessData_delete(pdata);
+   Vector_insertionSort(super->lines);
    Vector_insertionSort(panel->items);
    Panel_setSelected(panel, idx);
 }
 
+/* Native listings are cheap enough to refresh on every update, lsof is not */
+static void OpenFilesScreen_onErr(InfoScreen* super) {
+   const OpenFilesScreen* this = (const OpenFilesScreen*) super;
+   if (!this->native || this->native->error)
+      return;
+
+   Vector_prune(super->lines);
+   OpenFilesScreen_scan(super);
+}
+
 const InfoScreenClass OpenFilesScreen_class = {
    .super = {
       .extends = Class(Object),
       .delete = OpenFilesScreen_delete
    },
    .scan = OpenFilesScreen_scan,
-   .draw = OpenFilesScreen_draw
+   .draw = OpenFilesScreen_draw,
+   .onErr = OpenFilesScreen_onErr
 };
@@ -14,9 +14,39 @@ in the source distribution for its full text.
 #include "Process.h"
 
 
+/* Columns of an open file, named after the lsof fields they are read from */
+typedef enum OpenFiles_Field_ {
+   OPENFILES_FD,              /* f */
+   OPENFILES_ACCESS,          /* a */
+   OPENFILES_DEVICE,          /* D */
+   OPENFILES_INODE,           /* i */
+   OPENFILES_NAME,            /* n */
+   OPENFILES_SIZE,            /* s */
+   OPENFILES_TYPE,            /* t */
+   OPENFILES_OFFSET,          /* o */
+   OPENFILES_FIELDS
+} OpenFiles_Field;
+
+typedef struct OpenFiles_Data_ {
+   char* data[OPENFILES_FIELDS];
+} OpenFiles_Data;
+
+typedef struct OpenFiles_FileData_ {
+   OpenFiles_Data data;
+   char* link;                /* target of the /proc/PID/fd link when listed natively, else NULL */
+   struct OpenFiles_FileData_* next;
+} OpenFiles_FileData;
+
+typedef struct OpenFiles_ProcessData_ {
+   OpenFiles_Data data;
+   int error;
+   struct OpenFiles_FileData_* files;
+} OpenFiles_ProcessData;
+
 typedef struct OpenFilesScreen_ {
    InfoScreen super;
    pid_t pid;
+   OpenFiles_ProcessData* native;  /* last listing of the platform, refreshed while the screen is open */
 } OpenFilesScreen;
 
 extern const InfoScreenClass OpenFilesScreen_class;
@@ -25,4 +55,6 @@ OpenFilesScreen* OpenFilesScreen_new(const Process* process);
 
 void OpenFilesScreen_delete(Object* this);
 
+void OpenFiles_ProcessData_delete(OpenFiles_ProcessData* pdata);
+
 #endif
@@ -70,7 +70,7 @@ void Process_setUidColumnWidth(uid_t maxUid) {
 
 void Process_printBytes(RichString* str, unsigned long long number, bool coloring) {
    char buffer[16];
-   int len;
+   size_t len;
 
    int largeNumberColor = coloring ? CRT_colors[LARGE_NUMBER] : CRT_colors[PROCESS];
    int processMegabytesColor = coloring ? CRT_colors[PROCESS_MEGABYTES] : CRT_colors[PROCESS];
@@ -88,68 +88,82 @@ void Process_printBytes(RichString* str, unsigned long long number, bool colorin
 
    if (number < 1000) {
       //Plain number, no markings
-      len = xSnprintf(buffer, sizeof(buffer), "%5llu ", number);
+      len = String_formatUnsigned(buffer, number, 5, ' ');
+      buffer[len++] = ' ';
       RichString_appendnAscii(str, processColor, buffer, len);
    } else if (number < 100000) {
       //2 digit MB, 3 digit KB
-      len = xSnprintf(buffer, sizeof(buffer), "%2llu", number / 1000);
+      len = String_formatUnsigned(buffer, number / 1000, 2, ' ');
       RichString_appendnAscii(str, processMegabytesColor, buffer, len);
       number %= 1000;
-      len = xSnprintf(buffer, sizeof(buffer), "%03llu ", number);
+      len = String_formatUnsigned(buffer, number, 3, '0');
+      buffer[len++] = ' ';
       RichString_appendnAscii(str, processColor, buffer, len);
    } else if (number < 1000 * ONE_K) {
       //3 digit MB
       number /= ONE_K;
-      len = xSnprintf(buffer, sizeof(buffer), "%4lluM ", number);
+      len = String_formatUnsigned(buffer, number, 4, ' ');
+      buffer[len++] = 'M';
+      buffer[len++] = ' ';
       RichString_appendnAscii(str, processMegabytesColor, buffer, len);
    } else if (number < 10000 * ONE_K) {
       //1 digit GB, 3 digit MB
       number /= ONE_K;
-      len = xSnprintf(buffer, sizeof(buffer), "%1llu", number / 1000);
+      len = String_formatUnsigned(buffer, number / 1000, 1, ' ');
       RichString_appendnAscii(str, processGigabytesColor, buffer, len);
       number %= 1000;
-      len = xSnprintf(buffer, sizeof(buffer), "%03lluM ", number);
+      len = String_formatUnsigned(buffer, number, 3, '0');
+      buffer[len++] = 'M';
+      buffer[len++] = ' ';
       RichString_appendnAscii(str, processMegabytesColor, buffer, len);
    } else if (number < 100000 * ONE_K) {
       //2 digit GB, 1 digit MB
       number /= 100 * ONE_K;
-      len = xSnprintf(buffer, sizeof(buffer), "%2llu", number / 10);
+      len = String_formatUnsigned(buffer, number / 10, 2, ' ');
       RichString_appendnAscii(str, processGigabytesColor, buffer, len);
       number %= 10;
-      len = xSnprintf(buffer, sizeof(buffer), ".%1llu", number);
-      RichString_appendnAscii(str, processMegabytesColor, buffer, len);
+      buffer[0] = '.';
+      buffer[1] = (char)('0' + number);
+      RichString_appendnAscii(str, processMegabytesColor, buffer, 2);
       RichString_appendAscii(str, processGigabytesColor, "G ");
    } else if (number < 1000 * ONE_M) {
       //3 digit GB
       number /= ONE_M;
-      len = xSnprintf(buffer, sizeof(buffer), "%4lluG ", number);
+      len = String_formatUnsigned(buffer, number, 4, ' ');
+      buffer[len++] = 'G';
+      buffer[len++] = ' ';
       RichString_appendnAscii(str, processGigabytesColor, buffer, len);
    } else if (number < 10000ULL * ONE_M) {
       //1 digit TB, 3 digit GB
       number /= ONE_M;
-      len = xSnprintf(buffer, sizeof(buffer), "%1llu", number / 1000);
+      len = String_formatUnsigned(buffer, number / 1000, 1, ' ');
       RichString_appendnAscii(str, largeNumberColor, buffer, len);
       number %= 1000;
-      len = xSnprintf(buffer, sizeof(buffer), "%03lluG ", number);
+      len = String_formatUnsigned(buffer, number, 3, '0');
+      buffer[len++] = 'G';
+      buffer[len++] = ' ';
       RichString_appendnAscii(str, processGigabytesColor, buffer, len);
    } else if (number < 100000 * ONE_M) {
       //2 digit TB, 1 digit GB
       number /= 100 * ONE_M;
-      len = xSnprintf(buffer, sizeof(buffer), "%2llu", number / 10);
+      len = String_formatUnsigned(buffer, number / 10, 2, ' ');
       RichString_appendnAscii(str, largeNumberColor, buffer, len);
       number %= 10;
-      len = xSnprintf(buffer, sizeof(buffer), ".%1llu", number);
-      RichString_appendnAscii(str, processGigabytesColor, buffer, len);
+      buffer[0] = '.';
+      buffer[1] = (char)('0' + number);
+      RichString_appendnAscii(str, processGigabytesColor, buffer, 2);
       RichString_appendAscii(str, largeNumberColor, "T ");
    } else if (number < 10000ULL * ONE_G) {
       //3 digit TB or 1 digit PB, 3 digit TB
       number /= ONE_G;
-      len = xSnprintf(buffer, sizeof(buffer), "%4lluT ", number);
+      len = String_formatUnsigned(buffer, number, 4, ' ');
+      buffer[len++] = 'T';
+      buffer[len++] = ' ';
       RichString_appendnAscii(str, largeNumberColor, buffer, len);
    } else {
       //2 digit PB and above
-      len = xSnprintf(buffer, sizeof(buffer), "%4.1lfP ", (double)number / ONE_T);
-      RichString_appendnAscii(str, largeNumberColor, buffer, len);
+      int plen = xSnprintf(buffer, sizeof(buffer), "%4.1lfP ", (double)number / ONE_T);
+      RichString_appendnAscii(str, largeNumberColor, buffer, plen);
    }
 }
 
@@ -161,7 +175,7 @@ void Process_printKBytes(RichString* str, unsigned long long number, bool colori
 }
 
 void Process_printCount(RichString* str, unsigned long long number, bool coloring) {
-   char buffer[13];
+   char buffer[24];
 
    int largeNumberColor = coloring ? CRT_colors[LARGE_NUMBER] : CRT_colors[PROCESS];
    int processMegabytesColor = coloring ? CRT_colors[PROCESS_MEGABYTES] : CRT_colors[PROCESS];
@@ -171,19 +185,23 @@ void Process_printCount(RichString* str, unsigned long long number, bool colorin
    if (number == ULLONG_MAX) {
       RichString_appendAscii(str, CRT_colors[PROCESS_SHADOW], "        N/A ");
    } else if (number >= 100000LL * ONE_DECIMAL_T) {
-      xSnprintf(buffer, sizeof(buffer), "%11llu ", number / ONE_DECIMAL_G);
-      RichString_appendnAscii(str, largeNumberColor, buffer, 12);
+      size_t len = String_formatUnsigned(buffer, number / ONE_DECIMAL_G, 11, ' ');
+      buffer[len++] = ' ';
+      RichString_appendnAscii(str, largeNumberColor, buffer, len);
    } else if (number >= 100LL * ONE_DECIMAL_T) {
-      xSnprintf(buffer, sizeof(buffer), "%11llu ", number / ONE_DECIMAL_M);
+      String_formatUnsigned(buffer, number / ONE_DECIMAL_M, 11, ' ');
+      buffer[11] = ' ';
       RichString_appendnAscii(str, largeNumberColor, buffer, 8);
       RichString_appendnAscii(str, processMegabytesColor, buffer + 8, 4);
    } else if (number >= 10LL * ONE_DECIMAL_G) {
-      xSnprintf(buffer, sizeof(buffer), "%11llu ", number / ONE_DECIMAL_K);
+      String_formatUnsigned(buffer, number / ONE_DECIMAL_K, 11, ' ');
+      buffer[11] = ' ';
       RichString_appendnAscii(str, largeNumberColor, buffer, 5);
       RichString_appendnAscii(str, processMegabytesColor, buffer + 5, 3);
       RichString_appendnAscii(str, processColor, buffer + 8, 4);
    } else {
-      xSnprintf(buffer, sizeof(buffer), "%11llu ", number);
+      String_formatUnsigned(buffer, number, 11, ' ');
+      buffer[11] = ' ';
       RichString_appendnAscii(str, largeNumberColor, buffer, 2);
       RichString_appendnAscii(str, processMegabytesColor, buffer + 2, 3);
       RichString_appendnAscii(str, processColor, buffer + 5, 3);
@@ -192,8 +210,8 @@ void Process_printCount(RichString* str, unsigned long long number, bool colorin
 }
 
 void Process_printTime(RichString* str, unsigned long long totalHundredths, bool coloring) {
-   char buffer[10];
-   int len;
+   char buffer[24];
+   size_t len;
 
    unsigned long long totalSeconds = totalHundredths / 100;
    unsigned long long hours = totalSeconds / 3600;
@@ -207,61 +225,57 @@ void Process_printTime(RichString* str, unsigned long long totalHundredths, bool
    int hourColor = coloring ? CRT_colors[PROCESS_MEGABYTES] : CRT_colors[PROCESS];
    int defColor  = CRT_colors[PROCESS];
 
+   /* Both parts of the larger units share six columns, the first one taking what the second does not need */
    if (days >= /* Ignore leapyears */365) {
-      int years = days / 365;
-      int daysLeft = days - 365 * years;
-
-      if (daysLeft >= 100) {
-         len = xSnprintf(buffer, sizeof(buffer), "%3dy", years);
-         RichString_appendnAscii(str, yearColor, buffer, len);
-         len = xSnprintf(buffer, sizeof(buffer), "%3dd ", daysLeft);
-         RichString_appendnAscii(str, dayColor, buffer, len);
-      } else if (daysLeft >= 10) {
-         len = xSnprintf(buffer, sizeof(buffer), "%4dy", years);
-         RichString_appendnAscii(str, yearColor, buffer, len);
-         len = xSnprintf(buffer, sizeof(buffer), "%2dd ", daysLeft);
-         RichString_appendnAscii(str, dayColor, buffer, len);
-      } else {
-         len = xSnprintf(buffer, sizeof(buffer), "%5dy", years);
-         RichString_appendnAscii(str, yearColor, buffer, len);
-         len = xSnprintf(buffer, sizeof(buffer), "%1dd ", daysLeft);
-         RichString_appendnAscii(str, dayColor, buffer, len);
-      }
+      unsigned long long years = days / 365;
+      unsigned long long daysLeft = days - 365 * years;
+      size_t yearWidth = daysLeft >= 100 ? 3 : daysLeft >= 10 ? 4 : 5;
+
+      len = String_formatUnsigned(buffer, years, yearWidth, ' ');
+      buffer[len++] = 'y';
+      RichString_appendnAscii(str, yearColor, buffer, len);
+      len = String_formatUnsigned(buffer, daysLeft, 6 - yearWidth, ' ');
+      buffer[len++] = 'd';
+      buffer[len++] = ' ';
+      RichString_appendnAscii(str, dayColor, buffer, len);
    } else if (days >= 100) {
-      int hoursLeft = hours - days * 24;
-
-      if (hoursLeft >= 10) {
-         len = xSnprintf(buffer, sizeof(buffer), "%4llud", days);
-         RichString_appendnAscii(str, dayColor, buffer, len);
-         len = xSnprintf(buffer, sizeof(buffer), "%2dh ", hoursLeft);
-         RichString_appendnAscii(str, hourColor, buffer, len);
-      } else {
-         len = xSnprintf(buffer, sizeof(buffer), "%5llud", days);
-         RichString_appendnAscii(str, dayColor, buffer, len);
-         len = xSnprintf(buffer, sizeof(buffer), "%1dh ", hoursLeft);
-         RichString_appendnAscii(str, hourColor, buffer, len);
-      }
+      unsigned long long hoursLeft = hours - days * 24;
+      size_t dayWidth = hoursLeft >= 10 ? 4 : 5;
+
+      len = String_formatUnsigned(buffer, days, dayWidth, ' ');
+      buffer[len++] = 'd';
+      RichString_appendnAscii(str, dayColor, buffer, len);
+      len = String_formatUnsigned(buffer, hoursLeft, 6 - dayWidth, ' ');
+      buffer[len++] = 'h';
+      buffer[len++] = ' ';
+      RichString_appendnAscii(str, hourColor, buffer, len);
    } else if (hours >= 100) {
-      int minutesLeft = totalSeconds / 60 - hours * 60;
+      unsigned long long minutesLeft = totalSeconds / 60 - hours * 60;
+      size_t hourWidth = minutesLeft >= 10 ? 4 : 5;
 
-      if (minutesLeft >= 10) {
-         len = xSnprintf(buffer, sizeof(buffer), "%4lluh", hours);
-         RichString_appendnAscii(str, hourColor, buffer, len);
-         len = xSnprintf(buffer, sizeof(buffer), "%2dm ", minutesLeft);
-         RichString_appendnAscii(str, defColor, buffer, len);
-      } else {
-         len = xSnprintf(buffer, sizeof(buffer), "%5lluh", hours);
-         RichString_appendnAscii(str, hourColor, buffer, len);
-         len = xSnprintf(buffer, sizeof(buffer), "%1dm ", minutesLeft);
-         RichString_appendnAscii(str, defColor, buffer, len);
-      }
+      len = String_formatUnsigned(buffer, hours, hourWidth, ' ');
+      buffer[len++] = 'h';
+      RichString_appendnAscii(str, hourColor, buffer, len);
+      len = String_formatUnsigned(buffer, minutesLeft, 6 - hourWidth, ' ');
+      buffer[len++] = 'm';
+      buffer[len++] = ' ';
+      RichString_appendnAscii(str, defColor, buffer, len);
    } else if (hours > 0) {
-      len = xSnprintf(buffer, sizeof(buffer), "%2lluh", hours);
+      len = String_formatUnsigned(buffer, hours, 2, ' ');
+      buffer[len++] = 'h';
       RichString_appendnAscii(str, hourColor, buffer, len);
-      len = xSnprintf(buffer, sizeof(buffer), "%02d:%02d ", minutes, seconds);
+      len = String_formatUnsigned(buffer, minutes, 2, '0');
+      buffer[len++] = ':';
+      len += String_formatUnsigned(buffer + len, seconds, 2, '0');
+      buffer[len++] = ' ';
       RichString_appendnAscii(str, defColor, buffer, len);
    } else {
-      len = xSnprintf(buffer, sizeof(buffer), "%2d:%02d.%02d ", minutes, seconds, hundredths);
+      len = String_formatUnsigned(buffer, minutes, 2, ' ');
+      buffer[len++] = ':';
+      len += String_formatUnsigned(buffer + len, seconds, 2, '0');
+      buffer[len++] = '.';
+      len += String_formatUnsigned(buffer + len, hundredths, 2, '0');
+      buffer[len++] = ' ';
       RichString_appendnAscii(str, defColor, buffer, len);
    }
 }
@@ -459,6 +473,9 @@ void Process_makeCommandStr(Process* this) {
    mc->prevCmdlineSet = stripExeFromCmdline;
    mc->prevShowThreadNames = showThreadNames;
 
+   /* The string is rebuilt, possibly in place */
+   this->commandSerial++;
+
    /* Mark everything as unchanged */
    mc->cmdlineChanged = false;
    mc->commChanged = false;
@@ -684,8 +701,37 @@ void Process_writeCommand(const Process* this, int attr, int baseAttr, RichStrin
    }
 }
 
+/* Like "%*.*f" with one or two decimals, but without going through printf for the usual values */
+static size_t Process_formatFixed(char* buffer, size_t size, double value, size_t width, unsigned int decimals) {
+   assert(decimals == 1 || decimals == 2);
+
+   if (!(value >= 0.0 && value < 1e15)) {
+      int len = snprintf(buffer, size, "%*.*f", (int)width, (int)decimals, value);
+      return len < 0 ? 0 : MINIMUM((size_t)len, size - 1);
+   }
+
+   const unsigned int scale = decimals == 1 ? 10 : 100;
+   /* product + error is the exact value, it decides products rounded onto a half like printf does */
+   double product = value * scale;
+   double error = fma(value, scale, -product);
+   double rounded = rint(product);
+   double half = product - rounded;
+   if (!(half < 0.5) && error > 0)
+      rounded += 1;
+   else if (!(half > -0.5) && error < 0)
+      rounded -= 1;
+
+   unsigned long long scaled = (unsigned long long)rounded;
+   size_t intWidth = width > decimals + 1 ? width - decimals - 1 : 0;
+
+   size_t len = String_formatUnsigned(buffer, scaled / scale, intWidth, ' ');
+   buffer[len++] = '.';
+   len += String_formatUnsigned(buffer + len, scaled % scale, decimals, '0');
+   return len;
+}
+
 void Process_printRate(RichString* str, double rate, bool coloring) {
-   char buffer[16];
+   char buffer[32];
 
    int largeNumberColor = CRT_colors[LARGE_NUMBER];
    int processMegabytesColor = CRT_colors[PROCESS_MEGABYTES];
@@ -699,28 +745,50 @@ void Process_printRate(RichString* str, double rate, bool coloring) {
 
    if (isnan(rate)) {
       RichString_appendAscii(str, shadowColor, "        N/A ");
-   } else if (rate < 0.005) {
-      int len = snprintf(buffer, sizeof(buffer), "%7.2f B/s ", rate);
-      RichString_appendnAscii(str, shadowColor, buffer, len);
+      return;
+   }
+
+   int attr;
+   char unit;
+   if (rate < 0.005) {
+      attr = shadowColor;
+      unit = 'B';
    } else if (rate < ONE_K) {
-      int len = snprintf(buffer, sizeof(buffer), "%7.2f B/s ", rate);
-      RichString_appendnAscii(str, processColor, buffer, len);
+      attr = processColor;
+      unit = 'B';
    } else if (rate < ONE_M) {
-      int len = snprintf(buffer, sizeof(buffer), "%7.2f K/s ", rate / ONE_K);
-      RichString_appendnAscii(str, processColor, buffer, len);
+      attr = processColor;
+      unit = 'K';
+      rate /= ONE_K;
    } else if (rate < ONE_G) {
-      int len = snprintf(buffer, sizeof(buffer), "%7.2f M/s ", rate / ONE_M);
-      RichString_appendnAscii(str, processMegabytesColor, buffer, len);
+      attr = processMegabytesColor;
+      unit = 'M';
+      rate /= ONE_M;
    } else if (rate < ONE_T) {
-      int len = snprintf(buffer, sizeof(buffer), "%7.2f G/s ", rate / ONE_G);
-      RichString_appendnAscii(str, largeNumberColor, buffer, len);
+      attr = largeNumberColor;
+      unit = 'G';
+      rate /= ONE_G;
    } else if (rate < ONE_P) {
-      int len = snprintf(buffer, sizeof(buffer), "%7.2f T/s ", rate / ONE_T);
-      RichString_appendnAscii(str, largeNumberColor, buffer, len);
+      attr = largeNumberColor;
+      unit = 'T';
+      rate /= ONE_T;
    } else {
-      int len = snprintf(buffer, sizeof(buffer), "%7.2f P/s ", rate / ONE_P);
-      RichString_appendnAscii(str, largeNumberColor, buffer, len);
+      attr = largeNumberColor;
+      unit = 'P';
+      rate /= ONE_P;
    }
+
+   size_t len = Process_formatFixed(buffer, sizeof(buffer) - 5, rate, 7, 2);
+   memcpy(buffer + len, " ?/s ", 5);
+   buffer[len + 1] = unit;
+   RichString_appendnAscii(str, attr, buffer, len + 5);
+}
+
+/* Same as "%*d " with the PID column width, for the writeField buffer */
+static void Process_printPid(char* buffer, pid_t pid) {
+   size_t len = String_formatSigned(buffer, pid, Process_pidDigits);
+   buffer[len++] = ' ';
+   buffer[len] = '\0';
 }
 
 void Process_printLeftAlignedField(RichString* str, int attr, const char* content, unsigned int width) {
@@ -730,26 +798,35 @@ void Process_printLeftAlignedField(RichString* str, int attr, const char* conten
 }
 
 void Process_printPercentage(float val, char* buffer, int n, int* attr) {
+   size_t len;
+
+   assert(n >= 8);
+
    if (val >= 0) {
       if (val < 99.9F) {
          if (val < 0.05F) {
             *attr = CRT_colors[PROCESS_SHADOW];
          }
-         xSnprintf(buffer, n, "%4.1f ", val);
+         len = Process_formatFixed(buffer, n - 2, val, 4, 1);
+         buffer[len++] = ' ';
       } else if (val < 999) {
          *attr = CRT_colors[PROCESS_MEGABYTES];
-         xSnprintf(buffer, n, "%3d. ", (int)val);
+         len = String_formatSigned(buffer, (int)val, 3);
+         buffer[len++] = '.';
+         buffer[len++] = ' ';
       } else {
          *attr = CRT_colors[PROCESS_MEGABYTES];
-         xSnprintf(buffer, n, "%4d ", (int)val);
+         len = String_formatSigned(buffer, (int)val, 4);
+         buffer[len++] = ' ';
       }
+      buffer[len] = '\0';
    } else {
       *attr = CRT_colors[PROCESS_SHADOW];
       xSnprintf(buffer, n, " N/A ");
    }
 }
 
-static inline char processStateChar(ProcessState state) {
+char Process_stateChar(ProcessState state) {
    switch (state) {
       case UNKNOWN: return '?';
       case RUNNABLE: return 'U';
@@ -771,6 +848,14 @@ static inline char processStateChar(ProcessState state) {
    }
 }
 
+ProcessField Process_fieldByName(const char* name) {
+   for (int j = 1; j < LAST_PROCESSFIELD; j++) {
+      if (Process_fields[j].name && String_eq(name, Process_fields[j].name))
+         return j;
+   }
+   return NULL_PROCESSFIELD;
+}
+
 void Process_writeField(const Process* this, RichString* str, ProcessField field) {
    char buffer[256];
    size_t n = sizeof(buffer);
@@ -892,9 +977,9 @@ void Process_writeField(const Process* this, RichString* str, ProcessField field
       break;
    }
    case PERCENT_MEM: Process_printPercentage(this->percent_mem, buffer, n, &attr); break;
-   case PGRP: xSnprintf(buffer, n, "%*d ", Process_pidDigits, this->pgrp); break;
-   case PID: xSnprintf(buffer, n, "%*d ", Process_pidDigits, this->pid); break;
-   case PPID: xSnprintf(buffer, n, "%*d ", Process_pidDigits, this->ppid); break;
+   case PGRP: Process_printPid(buffer, this->pgrp); break;
+   case PID: Process_printPid(buffer, this->pid); break;
+   case PPID: Process_printPid(buffer, this->ppid); break;
    case PRIORITY:
       if (this->priority <= -100)
          xSnprintf(buffer, n, " RT ");
@@ -902,10 +987,10 @@ void Process_writeField(const Process* this, RichString* str, ProcessField field
          xSnprintf(buffer, n, "%3ld ", this->priority);
       break;
    case PROCESSOR: xSnprintf(buffer, n, "%3d ", Settings_cpuId(this->settings, this->processor)); break;
-   case SESSION: xSnprintf(buffer, n, "%*d ", Process_pidDigits, this->session); break;
+   case SESSION: Process_printPid(buffer, this->session); break;
    case STARTTIME: xSnprintf(buffer, n, "%s", this->starttime_show); break;
    case STATE:
-      xSnprintf(buffer, n, "%c ", processStateChar(this->state));
+      xSnprintf(buffer, n, "%c ", Process_stateChar(this->state));
       switch (this->state) {
          case RUNNABLE:
          case RUNNING:
@@ -939,9 +1024,9 @@ void Process_writeField(const Process* this, RichString* str, ProcessField field
       if (this->tgid == this->pid)
          attr = CRT_colors[PROCESS_SHADOW];
 
-      xSnprintf(buffer, n, "%*d ", Process_pidDigits, this->tgid);
+      Process_printPid(buffer, this->tgid);
       break;
-   case TPGID: xSnprintf(buffer, n, "%*d ", Process_pidDigits, this->tpgid); break;
+   case TPGID: Process_printPid(buffer, this->tpgid); break;
    case TTY:
       if (!this->tty_name) {
          attr = CRT_colors[PROCESS_SHADOW];
@@ -1004,6 +1089,7 @@ void Process_done(Process* this) {
    free(this->procExe);
    free(this->procCwd);
    free(this->mergedCommand.str);
+   free(this->filterCommand);
    free(this->tty_name);
 }
 
@@ -1018,6 +1104,26 @@ const char* Process_getCommandStr(const Process* this) {
    return this->mergedCommand.str;
 }
 
+const char* Process_getFilterCommand(Process* this) {
+   const char* command = Process_getCommand(this);
+   if (!command)
+      return "";
+
+   if (this->filterCommand && this->filterCommandSrc == command && this->filterCommandSerial == this->commandSerial)
+      return this->filterCommand;
+
+   size_t len = strlen(command);
+   this->filterCommand = xRealloc(this->filterCommand, len + 1);
+   String_lowerCopy(this->filterCommand, command, len);
+   this->filterCommandSrc = command;
+   this->filterCommandSerial = this->commandSerial;
+
+   /* Any cached filter result was computed on the old string */
+   this->filterSerial = 0;
+
+   return this->filterCommand;
+}
+
 const ProcessClass Process_class = {
    .super = {
       .extends = Class(Object),
@@ -1178,6 +1284,46 @@ int Process_compareByKey_Base(const Process* p1, const Process* p2, ProcessField
    }
 }
 
+void Process_getFieldValue_Base(const Process* this, ProcessField key, ProcessFieldValue* value) {
+   value->type = PROCESS_VALUE_NONE;
+
+   switch (key) {
+   case COMM: ProcessFieldValue_setString(value, Process_getCommand(this)); break;
+   case CWD: ProcessFieldValue_setString(value, this->procCwd); break;
+   case ELAPSED: ProcessFieldValue_setInteger(value, (long long)(this->processList->realtimeMs / 1000) - this->starttime_ctime); break;
+   case MAJFLT: ProcessFieldValue_setInteger(value, this->majflt); break;
+   case MINFLT: ProcessFieldValue_setInteger(value, this->minflt); break;
+   case M_RESIDENT: ProcessFieldValue_setInteger(value, this->m_resident * 1024); break;
+   case M_VIRT: ProcessFieldValue_setInteger(value, this->m_virt * 1024); break;
+   case NICE: ProcessFieldValue_setInteger(value, this->nice); break;
+   case NLWP: ProcessFieldValue_setInteger(value, this->nlwp); break;
+   case PERCENT_CPU: ProcessFieldValue_setReal(value, this->percent_cpu); break;
+   case PERCENT_NORM_CPU: ProcessFieldValue_setReal(value, this->percent_cpu / this->processList->activeCPUs); break;
+   case PERCENT_MEM: ProcessFieldValue_setReal(value, this->percent_mem); break;
+   case PGRP: ProcessFieldValue_setInteger(value, this->pgrp); break;
+   case PID: ProcessFieldValue_setInteger(value, this->pid); break;
+   case PPID: ProcessFieldValue_setInteger(value, this->ppid); break;
+   case PRIORITY: ProcessFieldValue_setInteger(value, this->priority); break;
+   case PROCESSOR: ProcessFieldValue_setInteger(value, this->processor); break;
+   case PROC_COMM: ProcessFieldValue_setString(value, this->procComm); break;
+   case PROC_EXE: ProcessFieldValue_setString(value, this->procExe); break;
+   case SESSION: ProcessFieldValue_setInteger(value, this->session); break;
+   case STARTTIME: ProcessFieldValue_setInteger(value, this->starttime_ctime); break;
+   case STATE:
+      value->buffer[0] = Process_stateChar(this->state);
+      value->buffer[1] = '\0';
+      ProcessFieldValue_setString(value, value->buffer);
+      break;
+   case ST_UID: ProcessFieldValue_setInteger(value, this->st_uid); break;
+   case TIME: ProcessFieldValue_setReal(value, this->time / 100.0); break;
+   case TGID: ProcessFieldValue_setInteger(value, this->tgid); break;
+   case TPGID: ProcessFieldValue_setInteger(value, this->tpgid); break;
+   case TTY: ProcessFieldValue_setString(value, this->tty_name); break;
+   case USER: ProcessFieldValue_setString(value, this->user); break;
+   default: break;
+   }
+}
+
 void Process_updateComm(Process* this, const char* comm) {
    if (!this->procComm && !comm)
       return;
@@ -1188,6 +1334,7 @@ void Process_updateComm(Process* this, const char* comm) {
    free(this->procComm);
    this->procComm = comm ? xStrdup(comm) : NULL;
    this->mergedCommand.commChanged = true;
+   this->commandSerial++;
 }
 
 static int skipPotentialPath(const char* cmdline, int end) {
@@ -1228,6 +1375,7 @@ void Process_updateCmdline(Process* this, const char* cmdline, int basenameStart
    this->cmdlineBasenameStart = (basenameStart || !cmdline) ? basenameStart : skipPotentialPath(cmdline, basenameEnd);
    this->cmdlineBasenameEnd = basenameEnd;
    this->mergedCommand.cmdlineChanged = true;
+   this->commandSerial++;
 }
 
 void Process_updateExe(Process* this, const char* exe) {
@@ -1247,4 +1395,5 @@ void Process_updateExe(Process* this, const char* exe) {
       this->procExeBasenameOffset = 0;
    }
    this->mergedCommand.exeChanged = true;
+   this->commandSerial++;
 }
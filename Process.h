@@ -8,6 +8,7 @@ Released under the GNU GPLv2+, see the COPYING file
 in the source distribution for its full text.
 */
 
+#include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <sys/types.h>
@@ -228,6 +229,9 @@ typedef struct Process_ {
    /* Whether the process was updated during the current scan */
    bool updated;
 
+   /* Whether the last scan only read what the filters needed to reject it, the rest is stale */
+   bool partial;
+
    /* Whether the process was tagged by the user */
    bool tag;
 
@@ -259,6 +263,16 @@ typedef struct Process_ {
     * Internal state for merged Command display
     */
    ProcessMergedCommand mergedCommand;
+
+   /*
+    * Internal state for incremental filtering
+    */
+   char* filterCommand;                 /* case-folded copy of the Command string */
+   const char* filterCommandSrc;        /* Command string filterCommand was built from */
+   unsigned int commandSerial;          /* bumped whenever the Command string may have changed */
+   unsigned int filterCommandSerial;    /* commandSerial at the time filterCommand was built */
+   unsigned int filterSerial;           /* ProcessList filter serial the cached filterMatch belongs to */
+   bool filterMatch;
 } Process;
 
 typedef struct ProcessFieldData_ {
@@ -293,22 +307,41 @@ extern const ProcessFieldData Process_fields[LAST_PROCESSFIELD];
 extern int Process_pidDigits;
 extern int Process_uidDigits;
 
+typedef enum ProcessValueType_ {
+   PROCESS_VALUE_NONE,        /* not available */
+   PROCESS_VALUE_INTEGER,
+   PROCESS_VALUE_REAL,
+   PROCESS_VALUE_STRING,
+} ProcessValueType;
+
+/* Raw value of a column, for output without formatting; sizes are in bytes and times in seconds */
+typedef struct ProcessFieldValue_ {
+   ProcessValueType type;
+   long long integer;
+   double real;
+   const char* string;        /* owned by the process or pointing to buffer */
+   char buffer[8];            /* storage for short strings made up on the fly */
+} ProcessFieldValue;
+
 typedef Process* (*Process_New)(const struct Settings_*);
 typedef void (*Process_WriteField)(const Process*, RichString*, ProcessField);
 typedef int (*Process_CompareByKey)(const Process*, const Process*, ProcessField);
 typedef const char* (*Process_GetCommandStr)(const Process*);
+typedef void (*Process_GetFieldValue)(const Process*, ProcessField, ProcessFieldValue*);
 
 typedef struct ProcessClass_ {
    const ObjectClass super;
    const Process_WriteField writeField;
    const Process_CompareByKey compareByKey;
    const Process_GetCommandStr getCommandStr;
+   const Process_GetFieldValue getFieldValue;
 } ProcessClass;
 
 #define As_Process(this_)                              ((const ProcessClass*)((this_)->super.klass))
 
 #define Process_getCommand(this_)                      (As_Process(this_)->getCommandStr ? As_Process(this_)->getCommandStr((const Process*)(this_)) : Process_getCommandStr((const Process*)(this_)))
 #define Process_compareByKey(p1_, p2_, key_)           (As_Process(p1_)->compareByKey ? (As_Process(p1_)->compareByKey(p1_, p2_, key_)) : Process_compareByKey_Base(p1_, p2_, key_))
+#define Process_getFieldValue(this_, key_, value_)     (As_Process(this_)->getFieldValue ? (As_Process(this_)->getFieldValue(this_, key_, value_)) : Process_getFieldValue_Base(this_, key_, value_))
 
 static inline pid_t Process_getParentPid(const Process* this) {
    return this->tgid == this->pid ? this->ppid : this->tgid;
@@ -397,9 +430,36 @@ int Process_pidCompare(const void* v1, const void* v2);
 
 int Process_compareByKey_Base(const Process* p1, const Process* p2, ProcessField key);
 
+void Process_getFieldValue_Base(const Process* this, ProcessField key, ProcessFieldValue* value);
+
+static inline void ProcessFieldValue_setInteger(ProcessFieldValue* this, long long integer) {
+   this->type = PROCESS_VALUE_INTEGER;
+   this->integer = integer;
+}
+
+/* NAN stands for a value that is not available */
+static inline void ProcessFieldValue_setReal(ProcessFieldValue* this, double real) {
+   this->type = isnan(real) ? PROCESS_VALUE_NONE : PROCESS_VALUE_REAL;
+   this->real = real;
+}
+
+static inline void ProcessFieldValue_setString(ProcessFieldValue* this, const char* string) {
+   this->type = string ? PROCESS_VALUE_STRING : PROCESS_VALUE_NONE;
+   this->string = string;
+}
+
 // Avoid direct calls, use Process_getCommand instead
 const char* Process_getCommandStr(const Process* this);
 
+/* Letter shown in the STATE column */
+char Process_stateChar(ProcessState state);
+
+/* Returns NULL_PROCESSFIELD if there is no column of that name */
+ProcessField Process_fieldByName(const char* name);
+
+/* Returns a cached case-folded copy of Process_getCommand(), used for filtering */
+const char* Process_getFilterCommand(Process* this);
+
 void Process_updateComm(Process* this, const char* comm);
 void Process_updateCmdline(Process* this, const char* cmdline, int basenameStart, int basenameEnd);
 void Process_updateExe(Process* this, const char* exe);
@@ -0,0 +1,635 @@
+/*
+htop - ProcessFilter.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "ProcessFilter.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "Macros.h"
+#include "ProcessList.h"
+#include "XUtils.h"
+
+
+/*
+ * A filter expression is parsed into a small tree, the operands of every
+ * && and || chain are reordered so cheap predicates come first, and the
+ * tree is then flattened into a linear program. The program works on a
+ * single boolean accumulator: predicates set it, conditional jumps
+ * implement short-circuit evaluation.
+ */
+
+typedef enum {
+   FILTER_OP_NUMBER,          /* acc = number field <cmp> operand */
+   FILTER_OP_STRING,          /* acc = string field <cmp> operand */
+   FILTER_OP_NOT,             /* acc = !acc */
+   FILTER_OP_JUMP_IF_FALSE,
+   FILTER_OP_JUMP_IF_TRUE,
+} ProcessFilterOp;
+
+typedef enum {
+   FILTER_CMP_EQ,
+   FILTER_CMP_NE,
+   FILTER_CMP_LT,
+   FILTER_CMP_LE,
+   FILTER_CMP_GT,
+   FILTER_CMP_GE,
+   FILTER_CMP_MATCH,          /* case-insensitive substring */
+   FILTER_CMP_NOMATCH,
+} ProcessFilterCmp;
+
+typedef struct ProcessFilterField_ {
+   const char* name;
+   ProcessField field;
+   bool isString;
+   bool early;                /* known right after the basic process status was read */
+} ProcessFilterField;
+
+static const ProcessFilterField ProcessFilter_fields[] = {
+   { "pid",         PID,              false, true  },
+   { "ppid",        PPID,             false, true  },
+   { "tgid",        TGID,             false, true  },
+   { "pgrp",        PGRP,             false, true  },
+   { "session",     SESSION,          false, true  },
+   { "sid",         SESSION,          false, true  },
+   { "tpgid",       TPGID,            false, true  },
+   { "uid",         ST_UID,           false, true  },
+   { "nice",        NICE,             false, true  },
+   { "ni",          NICE,             false, true  },
+   { "priority",    PRIORITY,         false, true  },
+   { "pri",         PRIORITY,         false, true  },
+   { "threads",     NLWP,             false, true  },
+   { "nlwp",        NLWP,             false, true  },
+   { "processor",   PROCESSOR,        false, true  },
+   { "cpu",         PERCENT_CPU,      false, true  },
+   { "ncpu",        PERCENT_NORM_CPU, false, true  },
+   { "time",        TIME,             false, true  },
+   { "elapsed",     ELAPSED,          false, true  },
+   { "starttime",   STARTTIME,        false, true  },
+   { "minflt",      MINFLT,           false, true  },
+   { "majflt",      MAJFLT,           false, true  },
+   { "mem",         PERCENT_MEM,      false, false },
+   { "virt",        M_VIRT,           false, false },
+   { "rss",         M_RESIDENT,       false, false },
+   { "res",         M_RESIDENT,       false, false },
+   { "state",       STATE,            true,  true  },
+   { "user",        USER,             true,  true  },
+   { "tty",         TTY,              true,  true  },
+   { "command",     COMM,             true,  false },
+   { "cmd",         COMM,             true,  false },
+   { "comm",        PROC_COMM,        true,  false },
+   { "exe",         PROC_EXE,         true,  false },
+   { "cwd",         CWD,              true,  false },
+};
+
+/* ---------- Lexer ---------- */
+
+typedef enum {
+   TOK_END,
+   TOK_ERROR,
+   TOK_IDENT,
+   TOK_NUMBER,
+   TOK_STRING,
+   TOK_AND,
+   TOK_OR,
+   TOK_NOT,
+   TOK_LPAREN,
+   TOK_RPAREN,
+   TOK_CMP,
+} ProcessFilterToken;
+
+typedef struct ProcessFilterParser_ {
+   const char* pos;
+   ProcessFilterToken tok;
+   const char* text;          /* identifier or string contents */
+   size_t len;
+   double number;
+   ProcessFilterCmp cmp;
+   unsigned int depth;        /* of negations and parentheses around the current token */
+   const char* error;         /* why parsing stopped, if not a plain syntax error */
+} ProcessFilterParser;
+
+static bool isIdentChar(char c) {
+   return isalnum((unsigned char)c) || c == '_' || c == '.' || c == '-' || c == '/' || c == ':' || c == '@';
+}
+
+static double unitMultiplier(char c) {
+   switch (toupper((unsigned char)c)) {
+      case 'K': return 1024.0;
+      case 'M': return 1024.0 * 1024.0;
+      case 'G': return 1024.0 * 1024.0 * 1024.0;
+      case 'T': return 1024.0 * 1024.0 * 1024.0 * 1024.0;
+      default:  return 0.0;
+   }
+}
+
+static void ProcessFilterParser_next(ProcessFilterParser* this) {
+   const char* s = this->pos;
+   while (isspace((unsigned char)*s))
+      s++;
+
+   this->text = s;
+   this->len = 0;
+
+   if (*s == '\0') {
+      this->tok = TOK_END;
+      this->pos = s;
+      return;
+   }
+
+   if (isdigit((unsigned char)*s) || ((*s == '-' || *s == '.') && isdigit((unsigned char)s[1]))) {
+      char* end;
+      this->number = strtod(s, &end);
+      double multiplier = unitMultiplier(*end);
+      if (multiplier > 0.0) {
+         this->number *= multiplier;
+         end++;
+         if (*end == 'B' || *end == 'b')
+            end++;
+      }
+      this->tok = isIdentChar(*end) ? TOK_ERROR : TOK_NUMBER;
+      this->pos = end;
+      return;
+   }
+
+   if (isalpha((unsigned char)*s) || *s == '_') {
+      while (isIdentChar(*s))
+         s++;
+      this->len = s - this->text;
+      this->pos = s;
+      if (this->len == 3 && strncasecmp(this->text, "and", 3) == 0)
+         this->tok = TOK_AND;
+      else if (this->len == 2 && strncasecmp(this->text, "or", 2) == 0)
+         this->tok = TOK_OR;
+      else if (this->len == 3 && strncasecmp(this->text, "not", 3) == 0)
+         this->tok = TOK_NOT;
+      else
+         this->tok = TOK_IDENT;
+      return;
+   }
+
+   if (*s == '"' || *s == '\'') {
+      const char* close = strchr(s + 1, *s);
+      if (!close) {
+         this->tok = TOK_ERROR;
+         this->pos = s;
+         return;
+      }
+      this->text = s + 1;
+      this->len = close - (s + 1);
+      this->tok = TOK_STRING;
+      this->pos = close + 1;
+      return;
+   }
+
+   this->tok = TOK_CMP;
+   if (s[0] == '&' && s[1] == '&') {
+      this->tok = TOK_AND;
+      s += 2;
+   } else if (s[0] == '|' && s[1] == '|') {
+      this->tok = TOK_OR;
+      s += 2;
+   } else if (s[0] == '=' && s[1] == '=') {
+      this->cmp = FILTER_CMP_EQ;
+      s += 2;
+   } else if (s[0] == '!' && s[1] == '=') {
+      this->cmp = FILTER_CMP_NE;
+      s += 2;
+   } else if (s[0] == '!' && s[1] == '~') {
+      this->cmp = FILTER_CMP_NOMATCH;
+      s += 2;
+   } else if (s[0] == '<' && s[1] == '=') {
+      this->cmp = FILTER_CMP_LE;
+      s += 2;
+   } else if (s[0] == '>' && s[1] == '=') {
+      this->cmp = FILTER_CMP_GE;
+      s += 2;
+   } else if (s[0] == '=') {
+      this->cmp = FILTER_CMP_EQ;
+      s++;
+   } else if (s[0] == '<') {
+      this->cmp = FILTER_CMP_LT;
+      s++;
+   } else if (s[0] == '>') {
+      this->cmp = FILTER_CMP_GT;
+      s++;
+   } else if (s[0] == '~') {
+      this->cmp = FILTER_CMP_MATCH;
+      s++;
+   } else if (s[0] == '!') {
+      this->tok = TOK_NOT;
+      s++;
+   } else if (s[0] == '(') {
+      this->tok = TOK_LPAREN;
+      s++;
+   } else if (s[0] == ')') {
+      this->tok = TOK_RPAREN;
+      s++;
+   } else {
+      this->tok = TOK_ERROR;
+   }
+   this->pos = s;
+}
+
+/* ---------- Parser ---------- */
+
+typedef enum {
+   NODE_AND,
+   NODE_OR,
+   NODE_NOT,
+   NODE_PREDICATE,
+} ProcessFilterNodeKind;
+
+typedef struct ProcessFilterNode_ {
+   ProcessFilterNodeKind kind;
+   struct ProcessFilterNode_** children;
+   size_t count;
+   ProcessFilterInsn predicate;
+   unsigned int cost;
+   bool early;
+} ProcessFilterNode;
+
+static void ProcessFilterNode_delete(ProcessFilterNode* this) {
+   if (!this)
+      return;
+
+   for (size_t i = 0; i < this->count; i++)
+      ProcessFilterNode_delete(this->children[i]);
+   free(this->children);
+   free(this->predicate.string);
+   free(this);
+}
+
+static ProcessFilterNode* ProcessFilterNode_new(ProcessFilterNodeKind kind) {
+   ProcessFilterNode* this = xCalloc(1, sizeof(ProcessFilterNode));
+   this->kind = kind;
+   return this;
+}
+
+static void ProcessFilterNode_addChild(ProcessFilterNode* this, ProcessFilterNode* child) {
+   /* Flatten nested chains of the same junction */
+   if (child->kind == this->kind && (this->kind == NODE_AND || this->kind == NODE_OR)) {
+      for (size_t i = 0; i < child->count; i++)
+         ProcessFilterNode_addChild(this, child->children[i]);
+      child->count = 0;
+      ProcessFilterNode_delete(child);
+      return;
+   }
+
+   this->children = xReallocArray(this->children, this->count + 1, sizeof(ProcessFilterNode*));
+   this->children[this->count++] = child;
+}
+
+static ProcessFilterNode* ProcessFilterParser_parseOr(ProcessFilterParser* this);
+
+static ProcessFilterNode* ProcessFilterParser_parsePredicate(ProcessFilterParser* this) {
+   if (this->tok != TOK_IDENT)
+      return NULL;
+
+   const ProcessFilterField* field = NULL;
+   for (size_t i = 0; i < ARRAYSIZE(ProcessFilter_fields); i++) {
+      const char* name = ProcessFilter_fields[i].name;
+      if (strlen(name) == this->len && strncasecmp(name, this->text, this->len) == 0) {
+         field = &ProcessFilter_fields[i];
+         break;
+      }
+   }
+   if (!field)
+      return NULL;
+
+   ProcessFilterParser_next(this);
+   if (this->tok != TOK_CMP)
+      return NULL;
+
+   ProcessFilterCmp cmp = this->cmp;
+   ProcessFilterParser_next(this);
+
+   ProcessFilterNode* node = ProcessFilterNode_new(NODE_PREDICATE);
+   ProcessFilterInsn* pred = &node->predicate;
+   pred->cmp = cmp;
+   pred->field = (uint8_t)(field - ProcessFilter_fields);
+   node->early = field->early;
+
+   if (field->isString) {
+      if ((this->tok != TOK_STRING && this->tok != TOK_IDENT) || cmp == FILTER_CMP_LT || cmp == FILTER_CMP_LE || cmp == FILTER_CMP_GT || cmp == FILTER_CMP_GE)
+         goto error;
+
+      pred->op = FILTER_OP_STRING;
+      pred->string = xStrndup(this->text, this->len);
+      if (cmp == FILTER_CMP_MATCH || cmp == FILTER_CMP_NOMATCH) {
+         String_lowerCopy(pred->string, this->text, this->len);
+         node->cost = 4;
+      } else {
+         node->cost = 2;
+      }
+   } else {
+      if (this->tok != TOK_NUMBER || cmp == FILTER_CMP_MATCH || cmp == FILTER_CMP_NOMATCH)
+         goto error;
+
+      pred->op = FILTER_OP_NUMBER;
+      pred->number = this->number;
+      node->cost = 1;
+   }
+
+   ProcessFilterParser_next(this);
+   return node;
+
+error:
+   ProcessFilterNode_delete(node);
+   return NULL;
+}
+
+static ProcessFilterNode* ProcessFilterParser_parseUnary(ProcessFilterParser* this) {
+   if (this->tok == TOK_NOT || this->tok == TOK_LPAREN) {
+      /* each level is a few stack frames, which a long expression would exhaust */
+      if (this->depth == PROCESS_FILTER_MAX_DEPTH) {
+         this->error = "expression too deeply nested";
+         return NULL;
+      }
+   }
+
+   if (this->tok == TOK_NOT) {
+      ProcessFilterParser_next(this);
+      this->depth++;
+      ProcessFilterNode* child = ProcessFilterParser_parseUnary(this);
+      this->depth--;
+      if (!child)
+         return NULL;
+
+      ProcessFilterNode* node = ProcessFilterNode_new(NODE_NOT);
+      ProcessFilterNode_addChild(node, child);
+      node->cost = child->cost;
+      node->early = child->early;
+      return node;
+   }
+
+   if (this->tok == TOK_LPAREN) {
+      ProcessFilterParser_next(this);
+      this->depth++;
+      ProcessFilterNode* node = ProcessFilterParser_parseOr(this);
+      this->depth--;
+      if (!node)
+         return NULL;
+
+      if (this->tok != TOK_RPAREN) {
+         ProcessFilterNode_delete(node);
+         return NULL;
+      }
+      ProcessFilterParser_next(this);
+      return node;
+   }
+
+   return ProcessFilterParser_parsePredicate(this);
+}
+
+/* Orders the operands of a junction by their cost; stable, junctions are short */
+static void ProcessFilterNode_finishJunction(ProcessFilterNode* this) {
+   this->cost = 0;
+   this->early = true;
+   for (size_t i = 0; i < this->count; i++) {
+      ProcessFilterNode* child = this->children[i];
+      this->cost += child->cost;
+      this->early &= child->early;
+
+      size_t j = i;
+      while (j > 0 && this->children[j - 1]->cost > child->cost) {
+         this->children[j] = this->children[j - 1];
+         j--;
+      }
+      this->children[j] = child;
+   }
+}
+
+static ProcessFilterNode* ProcessFilterParser_parseJunction(ProcessFilterParser* this, ProcessFilterToken op) {
+   ProcessFilterNode* first = (op == TOK_OR) ? ProcessFilterParser_parseJunction(this, TOK_AND) : ProcessFilterParser_parseUnary(this);
+   if (!first || this->tok != op)
+      return first;
+
+   ProcessFilterNode* node = ProcessFilterNode_new(op == TOK_OR ? NODE_OR : NODE_AND);
+   ProcessFilterNode_addChild(node, first);
+   while (this->tok == op) {
+      ProcessFilterParser_next(this);
+      ProcessFilterNode* next = (op == TOK_OR) ? ProcessFilterParser_parseJunction(this, TOK_AND) : ProcessFilterParser_parseUnary(this);
+      if (!next) {
+         ProcessFilterNode_delete(node);
+         return NULL;
+      }
+      ProcessFilterNode_addChild(node, next);
+   }
+
+   ProcessFilterNode_finishJunction(node);
+   return node;
+}
+
+static ProcessFilterNode* ProcessFilterParser_parseOr(ProcessFilterParser* this) {
+   return ProcessFilterParser_parseJunction(this, TOK_OR);
+}
+
+/* ---------- Code generation ---------- */
+
+static size_t ProcessFilterProgram_emit(ProcessFilterProgram* this, ProcessFilterInsn insn) {
+   if (this->size == this->capacity) {
+      this->capacity = this->capacity ? this->capacity * 2 : 8;
+      this->code = xReallocArray(this->code, this->capacity, sizeof(ProcessFilterInsn));
+   }
+   this->code[this->size] = insn;
+   return this->size++;
+}
+
+static void ProcessFilterProgram_compile(ProcessFilterProgram* this, const ProcessFilterNode* node);
+
+static void ProcessFilterProgram_compileJunction(ProcessFilterProgram* this, ProcessFilterNode* const* children, size_t count, ProcessFilterOp jump) {
+   size_t* jumps = xCalloc(count, sizeof(size_t));
+   for (size_t i = 0; i < count; i++) {
+      ProcessFilterProgram_compile(this, children[i]);
+      if (i + 1 < count)
+         jumps[i] = ProcessFilterProgram_emit(this, (ProcessFilterInsn) { .op = jump });
+   }
+   for (size_t i = 0; i + 1 < count; i++)
+      this->code[jumps[i]].target = this->size;
+   free(jumps);
+}
+
+static void ProcessFilterProgram_compile(ProcessFilterProgram* this, const ProcessFilterNode* node) {
+   switch (node->kind) {
+      case NODE_PREDICATE: {
+         ProcessFilterInsn insn = node->predicate;
+         insn.string = insn.string ? xStrdup(insn.string) : NULL;
+         ProcessFilterProgram_emit(this, insn);
+         break;
+      }
+      case NODE_NOT:
+         ProcessFilterProgram_compile(this, node->children[0]);
+         ProcessFilterProgram_emit(this, (ProcessFilterInsn) { .op = FILTER_OP_NOT });
+         break;
+      case NODE_AND:
+         ProcessFilterProgram_compileJunction(this, node->children, node->count, FILTER_OP_JUMP_IF_FALSE);
+         break;
+      case NODE_OR:
+         ProcessFilterProgram_compileJunction(this, node->children, node->count, FILTER_OP_JUMP_IF_TRUE);
+         break;
+   }
+}
+
+static void ProcessFilterProgram_done(ProcessFilterProgram* this) {
+   for (size_t i = 0; i < this->size; i++)
+      free(this->code[i].string);
+   free(this->code);
+}
+
+ProcessFilter* ProcessFilter_new(const char* expression, char* error, size_t errorSize) {
+   ProcessFilterParser parser = { .pos = expression };
+   ProcessFilterParser_next(&parser);
+   ProcessFilterNode* root = ProcessFilterParser_parseOr(&parser);
+   if (!root || parser.tok != TOK_END) {
+      if (error)
+         xSnprintf(error, errorSize, "%s", parser.error ? parser.error : "invalid expression");
+      ProcessFilterNode_delete(root);
+      return NULL;
+   }
+
+   ProcessFilter* this = xCalloc(1, sizeof(ProcessFilter));
+   this->source = xStrdup(expression);
+   ProcessFilterProgram_compile(&this->program, root);
+
+   if (root->early) {
+      ProcessFilterProgram_compile(&this->early, root);
+   } else if (root->kind == NODE_AND) {
+      ProcessFilterNode** early = xCalloc(root->count, sizeof(ProcessFilterNode*));
+      size_t count = 0;
+      for (size_t i = 0; i < root->count; i++) {
+         if (root->children[i]->early)
+            early[count++] = root->children[i];
+      }
+      if (count)
+         ProcessFilterProgram_compileJunction(&this->early, early, count, FILTER_OP_JUMP_IF_FALSE);
+      free(early);
+   }
+
+   ProcessFilterNode_delete(root);
+   return this;
+}
+
+void ProcessFilter_delete(ProcessFilter* this) {
+   if (!this)
+      return;
+
+   ProcessFilterProgram_done(&this->program);
+   ProcessFilterProgram_done(&this->early);
+   free(this->source);
+   free(this);
+}
+
+/* ---------- Evaluation ---------- */
+
+static double ProcessFilter_getNumber(const Process* p, ProcessField field) {
+   ProcessFieldValue value;
+   Process_getFieldValue(p, field, &value);
+
+   switch (value.type) {
+      case PROCESS_VALUE_INTEGER: return (double)value.integer;
+      case PROCESS_VALUE_REAL:    return value.real;
+      default:                    return 0.0;
+   }
+}
+
+static const char* ProcessFilter_getString(Process* p, ProcessField field, bool folded, char* buffer) {
+   const char* value = NULL;
+
+   switch (field) {
+      case STATE:
+         buffer[0] = Process_stateChar(p->state);
+         buffer[1] = '\0';
+         value = buffer;
+         break;
+      case USER:      value = p->user; break;
+      case TTY:       value = p->tty_name; break;
+      case COMM:      value = folded ? Process_getFilterCommand(p) : Process_getCommand(p); break;
+      case PROC_COMM: value = p->procComm; break;
+      case PROC_EXE:  value = p->procExe; break;
+      case CWD:       value = p->procCwd; break;
+      default:        break;
+   }
+
+   return value ? value : "";
+}
+
+static bool ProcessFilter_predicate(const ProcessFilterInsn* insn, Process* p) {
+   ProcessField field = ProcessFilter_fields[insn->field].field;
+
+   if (insn->op == FILTER_OP_NUMBER) {
+      double value = ProcessFilter_getNumber(p, field);
+      switch (insn->cmp) {
+         case FILTER_CMP_EQ: return !(value < insn->number) && !(value > insn->number);
+         case FILTER_CMP_NE: return value < insn->number || value > insn->number;
+         case FILTER_CMP_LT: return value < insn->number;
+         case FILTER_CMP_LE: return value <= insn->number;
+         case FILTER_CMP_GT: return value > insn->number;
+         case FILTER_CMP_GE: return value >= insn->number;
+         default:            return false;
+      }
+   }
+
+   char buffer[2];
+   switch (insn->cmp) {
+      case FILTER_CMP_EQ:
+         return String_eq(ProcessFilter_getString(p, field, false, buffer), insn->string);
+      case FILTER_CMP_NE:
+         return !String_eq(ProcessFilter_getString(p, field, false, buffer), insn->string);
+      case FILTER_CMP_MATCH:
+      case FILTER_CMP_NOMATCH: {
+         const char* value = ProcessFilter_getString(p, field, true, buffer);
+         bool found = (field == COMM) ? strstr(value, insn->string) != NULL : String_contains_i(value, insn->string);
+         return found == (insn->cmp == FILTER_CMP_MATCH);
+      }
+      default:
+         return false;
+   }
+}
+
+static bool ProcessFilterProgram_run(const ProcessFilterProgram* this, Process* p) {
+   bool acc = true;
+   size_t pc = 0;
+   while (pc < this->size) {
+      const ProcessFilterInsn* insn = &this->code[pc];
+      switch (insn->op) {
+         case FILTER_OP_NUMBER:
+         case FILTER_OP_STRING:
+            acc = ProcessFilter_predicate(insn, p);
+            break;
+         case FILTER_OP_NOT:
+            acc = !acc;
+            break;
+         case FILTER_OP_JUMP_IF_FALSE:
+            if (!acc) {
+               pc = insn->target;
+               continue;
+            }
+            break;
+         case FILTER_OP_JUMP_IF_TRUE:
+            if (acc) {
+               pc = insn->target;
+               continue;
+            }
+            break;
+      }
+      pc++;
+   }
+   return acc;
+}
+
+bool ProcessFilter_matches(const ProcessFilter* this, Process* p) {
+   return ProcessFilterProgram_run(&this->program, p);
+}
+
+bool ProcessFilter_rejectsEarly(const ProcessFilter* this, Process* p) {
+   return this->early.size > 0 && !ProcessFilterProgram_run(&this->early, p);
+}
@@ -0,0 +1,63 @@
+#ifndef HEADER_ProcessFilter
+#define HEADER_ProcessFilter
+/*
+htop - ProcessFilter.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Process.h"
+
+
+/* Filters starting with this character are parsed as expressions */
+#define PROCESS_FILTER_EXPRESSION_PREFIX '='
+
+typedef struct ProcessFilterInsn_ {
+   uint8_t op;          /* FILTER_OP_* */
+   uint8_t cmp;         /* FILTER_CMP_* for predicates */
+   uint8_t field;       /* index into the field table for predicates */
+   uint32_t target;     /* jump target */
+   double number;       /* numeric operand */
+   char* string;        /* string operand (owned) */
+} ProcessFilterInsn;
+
+typedef struct ProcessFilterProgram_ {
+   ProcessFilterInsn* code;
+   size_t size;
+   size_t capacity;
+} ProcessFilterProgram;
+
+typedef struct ProcessFilter_ {
+   char* source;                    /* expression text the filter was compiled from */
+   ProcessFilterProgram program;    /* the whole expression */
+   ProcessFilterProgram early;      /* conjuncts using only cheap per-process fields, may be empty */
+} ProcessFilter;
+
+/* Negations and parentheses nested deeper than this are rejected */
+#define PROCESS_FILTER_MAX_DEPTH 100
+
+/* Compiles a filter expression; returns NULL and says why in error, if not NULL, when it is not valid */
+ProcessFilter* ProcessFilter_new(const char* expression, char* error, size_t errorSize);
+
+void ProcessFilter_delete(ProcessFilter* this);
+
+bool ProcessFilter_matches(const ProcessFilter* this, Process* p);
+
+/*
+ * Evaluates only the parts of a top-level conjunction which depend on fields
+ * known right after the basic per-process status has been read (PIDs, state,
+ * priorities, CPU time and usage, owner). Returns true if the process can
+ * already be excluded, so platforms may skip reading any further data for it.
+ */
+bool ProcessFilter_rejectsEarly(const ProcessFilter* this, Process* p);
+
+static inline bool ProcessFilter_isExpression(const char* filter) {
+   return filter && filter[0] == PROCESS_FILTER_EXPRESSION_PREFIX;
+}
+
+#endif
@@ -10,19 +10,29 @@ in the source distribution for its full text.
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
 
 #include "CRT.h"
 #include "DynamicColumn.h"
+#include "FlightRecorder.h"
 #include "Hashtable.h"
 #include "Macros.h"
 #include "Platform.h"
+#include "Profile.h"
+#include "Recorder.h"
+#include "Replay.h"
+#include "Server.h"
+#include "Settings.h"
 #include "Vector.h"
 #include "XUtils.h"
 
 
-ProcessList* ProcessList_init(ProcessList* this, const ObjectClass* klass, UsersTable* usersTable, Hashtable* dynamicMeters, Hashtable* dynamicColumns, Hashtable* pidMatchList, uid_t userId) {
+ProcessList* ProcessList_init(ProcessList* this, const ObjectClass* klass, Process_New processNew, UsersTable* usersTable, Hashtable* dynamicMeters, Hashtable* dynamicColumns, Hashtable* pidMatchList, uid_t userId) {
    this->processes = Vector_new(klass, true, DEFAULT_SIZE);
+   this->processNew = processNew;
    this->processes2 = Vector_new(klass, true, DEFAULT_SIZE); // tree-view auxiliary buffer
+   this->removed = Vector_new(klass, true, DEFAULT_SIZE);
 
    this->processTable = Hashtable_new(200, false);
    this->displayTreeSet = Hashtable_new(200, false);
@@ -63,6 +73,15 @@ ProcessList* ProcessList_init(ProcessList* this, const ObjectClass* klass, Users
 
    this->following = -1;
 
+   this->incFilterLower = NULL;
+   this->incFilterSerial = 1;
+   this->incFilterBase = 1;
+   this->incFilterExprText = NULL;
+   this->incFilterExpr = NULL;
+
+   this->yield = NULL;
+   this->yieldData = NULL;
+
    return this;
 }
 
@@ -73,10 +92,15 @@ void ProcessList_done(ProcessList* this) {
    }
 #endif
 
+   free(this->incFilterLower);
+   free(this->incFilterExprText);
+   ProcessFilter_delete(this->incFilterExpr);
+
    Hashtable_delete(this->draftingTreeSet);
    Hashtable_delete(this->displayTreeSet);
    Hashtable_delete(this->processTable);
 
+   Vector_delete(this->removed);
    Vector_delete(this->processes2);
    Vector_delete(this->processes);
 }
@@ -179,7 +203,13 @@ void ProcessList_remove(ProcessList* this, const Process* p) {
    int idx = Vector_indexOf(this->processes, p, Process_pidCompare);
    assert(idx != -1);
 
-   if (idx >= 0) {
+   /*
+    * The panel refers to processes until it is rebuilt, which may happen on
+    * another thread after several scans; they are freed only then.
+    */
+   if (idx >= 0 && this->panel) {
+      Vector_add(this->removed, Vector_take(this->processes, idx));
+   } else if (idx >= 0) {
       Vector_remove(this->processes, idx);
    }
 
@@ -488,12 +518,17 @@ static void ProcessList_buildTree(ProcessList* this) {
 }
 
 void ProcessList_sort(ProcessList* this) {
+   ProfileMark mark;
+   Profile_begin(&mark);
+
    if (this->settings->treeView) {
       ProcessList_updateTreeSet(this);
       Vector_quickSortCustomCompare(this->processes, ProcessList_treeProcessCompare);
    } else {
       Vector_insertionSort(this->processes);
    }
+
+   Profile_end(&mark, PROFILE_SORT);
 }
 
 ProcessField ProcessList_keyAt(const ProcessList* this, int at) {
@@ -528,9 +563,142 @@ void ProcessList_collapseAllBranches(ProcessList* this) {
    }
 }
 
-void ProcessList_rebuildPanel(ProcessList* this) {
+/*
+ * Folds the current filter and tracks how it relates to the previous one.
+ * A filter containing the previous one (e.g. after typing another character)
+ * can only reject more processes, so cached rejections stay valid across
+ * such a chain of extensions. Returns the case-folded filter, if any.
+ */
+static const char* ProcessList_prepareIncFilter(ProcessList* this) {
    const char* incFilter = this->incFilter;
 
+   if (!ProcessFilter_isExpression(incFilter)) {
+      free(this->incFilterExprText);
+      this->incFilterExprText = NULL;
+      ProcessFilter_delete(this->incFilterExpr);
+      this->incFilterExpr = NULL;
+   }
+
+   if (!incFilter || ProcessFilter_isExpression(incFilter)) {
+      free(this->incFilterLower);
+      this->incFilterLower = NULL;
+      return NULL;
+   }
+
+   size_t len = strlen(incFilter);
+   char* lower = xMalloc(len + 1);
+   String_lowerCopy(lower, incFilter, len);
+
+   if (this->incFilterLower && String_eq(lower, this->incFilterLower)) {
+      free(lower);
+      return this->incFilterLower;
+   }
+
+   this->incFilterSerial++;
+   if (!this->incFilterLower || !strstr(lower, this->incFilterLower))
+      this->incFilterBase = this->incFilterSerial;
+
+   free(this->incFilterLower);
+   this->incFilterLower = lower;
+   return lower;
+}
+
+static bool ProcessList_matchesIncFilter(const ProcessList* this, Process* p, const char* filter) {
+   /* Rebuilds the folded command if it changed, which also invalidates the cached result */
+   const char* command = Process_getFilterCommand(p);
+
+   if (p->filterSerial == this->incFilterSerial)
+      return p->filterMatch;
+
+   if (p->filterSerial >= this->incFilterBase && !p->filterMatch)
+      return false;
+
+   /* strstr on pre-folded strings uses the C library's vectorized search, unlike strcasestr */
+   p->filterMatch = strstr(command, filter) != NULL;
+   p->filterSerial = this->incFilterSerial;
+   return p->filterMatch;
+}
+
+/* Compiles the filter expression, if any, when its text changed */
+static bool ProcessList_prepareFilterExpression(ProcessList* this) {
+   if (!ProcessFilter_isExpression(this->incFilter))
+      return false;
+
+   const char* expression = this->incFilter + 1;
+   if (!this->incFilterExprText || !String_eq(this->incFilterExprText, expression)) {
+      free_and_xStrdup(&this->incFilterExprText, expression);
+      ProcessFilter_delete(this->incFilterExpr);
+      this->incFilterExpr = ProcessFilter_new(expression, NULL, 0);
+   }
+   return true;
+}
+
+/* The compiled filter expression, if one is active and valid */
+const ProcessFilter* ProcessList_getFilterExpression(const ProcessList* this) {
+   if (!this->incFilterExpr || !ProcessFilter_isExpression(this->incFilter))
+      return NULL;
+
+   return String_eq(this->incFilterExpr->source, this->incFilter + 1) ? this->incFilterExpr : NULL;
+}
+
+/* Recordings and server clients get all processes, whatever is displayed */
+static bool ProcessList_skipsHidden(const ProcessList* this) {
+   return !this->recorder && !this->flightRecorder && !this->server;
+}
+
+bool ProcessList_rejectsUser(const ProcessList* this, const Process* p) {
+   return this->userId != (uid_t) -1 && p->st_uid != this->userId && ProcessList_skipsHidden(this);
+}
+
+bool ProcessList_rejectsEarly(ProcessList* this, Process* p) {
+   if (!ProcessList_skipsHidden(this))
+      return false;
+
+   if (ProcessList_rejectsUser(this, p))
+      return true;
+
+   const ProcessFilter* filterExpr = ProcessList_getFilterExpression(this);
+   if (filterExpr)
+      return ProcessFilter_rejectsEarly(filterExpr, p);
+
+   /* The command line is not re-read in this case, so the cached command is current */
+   if (this->incFilterLower && !this->settings->updateProcessNames)
+      return !ProcessList_matchesIncFilter(this, p, this->incFilterLower);
+
+   return false;
+}
+
+static bool ProcessList_isShown(const ProcessList* this, Process* p, const char* incFilter, bool filterByExpression) {
+   const ProcessFilter* filterExpr = this->incFilterExpr;
+
+   /* A filter rejected it with the data of a previous scan; the next one reads it all */
+   return p->show
+      && !p->partial
+      && (this->userId == (uid_t) -1 || p->st_uid == this->userId)
+      && (!incFilter || ProcessList_matchesIncFilter(this, p, incFilter))
+      /* An invalid (e.g. incomplete) expression matches nothing */
+      && (!filterByExpression || (filterExpr && ProcessFilter_matches(filterExpr, p)))
+      && (!this->pidMatchList || Hashtable_get(this->pidMatchList, p->tgid));
+}
+
+void ProcessList_forEachShown(ProcessList* this, ProcessList_ProcessFunction f, void* data) {
+   const char* incFilter = ProcessList_prepareIncFilter(this);
+   const bool filterByExpression = ProcessList_prepareFilterExpression(this);
+
+   for (int i = 0; i < Vector_size(this->processes); i++) {
+      Process* p = (Process*) Vector_get(this->processes, i);
+      if (ProcessList_isShown(this, p, incFilter, filterByExpression))
+         f(p, data);
+   }
+}
+
+void ProcessList_rebuildPanel(ProcessList* this) {
+   ProfileMark mark;
+   Profile_begin(&mark);
+
+   const char* incFilter = ProcessList_prepareIncFilter(this);
+   const bool filterByExpression = ProcessList_prepareFilterExpression(this);
+
    const int currPos = Panel_getSelectedIndex(this->panel);
    const int currScrollV = this->panel->scrollV;
    const int currSize = Panel_size(this->panel);
@@ -553,10 +721,7 @@ void ProcessList_rebuildPanel(ProcessList* this) {
    for (int i = 0; i < processCount; i++) {
       Process* p = (Process*) Vector_get(this->processes, i);
 
-      if ( (!p->show)
-         || (this->userId != (uid_t) -1 && (p->st_uid != this->userId))
-         || (incFilter && !(String_contains_i(Process_getCommand(p), incFilter)))
-         || (this->pidMatchList && !Hashtable_get(this->pidMatchList, p->tgid)) )
+      if (!ProcessList_isShown(this, p, incFilter, filterByExpression))
          continue;
 
       Panel_set(this->panel, idx, (Object*)p);
@@ -584,6 +749,10 @@ void ProcessList_rebuildPanel(ProcessList* this) {
 
       this->panel->scrollV = currScrollV;
    }
+
+   Vector_prune(this->removed);
+
+   Profile_end(&mark, PROFILE_REBUILD);
 }
 
 Process* ProcessList_getProcess(ProcessList* this, pid_t pid, bool* preExisting, Process_New constructor) {
@@ -601,8 +770,12 @@ Process* ProcessList_getProcess(ProcessList* this, pid_t pid, bool* preExisting,
 }
 
 void ProcessList_scan(ProcessList* this, bool pauseProcessUpdate) {
-   // in pause mode only gather global data for meters (CPU/memory/...)
-   if (pauseProcessUpdate) {
+   // a refresh cycle starts with each scan
+   Profile_nextCycle();
+
+   // in pause mode only gather global data for meters (CPU/memory/...),
+   // a replay keeps putting the current sample in, which may have been seeked to
+   if (pauseProcessUpdate && !this->replay) {
       ProcessList_goThroughEntries(this, true);
       return;
    }
@@ -630,7 +803,15 @@ void ProcessList_scan(ProcessList* this, bool pauseProcessUpdate) {
       firstScanDone = true;
    }
 
-   ProcessList_goThroughEntries(this, false);
+   // bring the filters up to date so platforms can apply them while scanning
+   ProcessList_prepareIncFilter(this);
+   ProcessList_prepareFilterExpression(this);
+
+   if (this->replay) {
+      Replay_scan(this->replay, this, !pauseProcessUpdate);
+   } else {
+      ProcessList_goThroughEntries(this, false);
+   }
 
    uid_t maxUid = 0;
    for (int i = Vector_size(this->processes) - 1; i >= 0; i--) {
@@ -668,6 +849,50 @@ void ProcessList_scan(ProcessList* this, bool pauseProcessUpdate) {
       // len(this->displayTreeSet) == len(this->processes)
       Hashtable_clear(this->displayTreeSet);
 
+      ProfileMark mark;
+      Profile_begin(&mark);
       ProcessList_buildTree(this);
+      Profile_end(&mark, PROFILE_TREE);
+   }
+}
+
+bool ProcessList_afterScan(ProcessList* this) {
+   if (this->recorder)
+      Recorder_writeSample(this->recorder, this);
+
+   bool dumped = this->flightRecorder && FlightRecorder_addSample(this->flightRecorder, this);
+
+   if (this->server)
+      Server_update(this->server, this, true);
+
+   return dumped;
+}
+
+/* Upper bound for stretching the update interval to the CPU budget */
+#define MAX_BUDGETED_INTERVAL_MS 60000
+
+uint64_t ProcessList_cpuTimeUs(void) {
+   struct rusage usage;
+   if (getrusage(RUSAGE_SELF, &usage) != 0)
+      return 0;
+
+   return (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+          (uint64_t)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+void ProcessList_addUpdateCost(ProcessList* this, uint64_t costUs) {
+   this->updateCostUs = this->updateCostUs ? (3 * this->updateCostUs + costUs) / 4 : costUs;
+}
+
+uint64_t ProcessList_budgetedInterval(const ProcessList* this) {
+   const Settings* settings = this->settings;
+   uint64_t interval = (uint64_t)settings->delay * 100;
+
+   if (settings->updateBudget > 0) {
+      /* cost / interval <= budget, the budget being in tenths of a percent */
+      uint64_t needed = this->updateCostUs / (uint64_t)settings->updateBudget;
+      interval = MAXIMUM(interval, MINIMUM(needed, MAX_BUDGETED_INTERVAL_MS));
    }
+
+   return interval;
 }
@@ -19,6 +19,7 @@ in the source distribution for its full text.
 #include "Object.h"
 #include "Panel.h"
 #include "Process.h"
+#include "ProcessFilter.h"
 #include "RichString.h"
 #include "Settings.h"
 #include "UsersTable.h"
@@ -40,6 +41,8 @@ in the source distribution for its full text.
 typedef unsigned long long int memory_t;
 #define MEMORY_MAX ULLONG_MAX
 
+typedef void (*ProcessList_YieldFn)(void* data);
+
 typedef struct ProcessList_ {
    const Settings* settings;
 
@@ -57,13 +60,30 @@ typedef struct ProcessList_ {
    struct timeval realtime;   /* time of the current sample */
    uint64_t realtimeMs;       /* current time in milliseconds */
    uint64_t monotonicMs;      /* same, but from monotonic clock */
+   uint64_t updateIntervalMs; /* effective time between scans, 0 if not known */
+   uint64_t updateCostUs;     /* CPU time used per update cycle, smoothed */
 
    Panel* panel;
+   Vector* removed;           /* processes gone since the panel was last rebuilt, which may still show them */
    int following;
    uid_t userId;
    const char* incFilter;
+   char* incFilterLower;         /* case-folded copy of the filter last applied */
+   unsigned int incFilterSerial; /* bumped whenever the filter changes */
+   unsigned int incFilterBase;   /* serial of the first filter the current one extends */
+   char* incFilterExprText;      /* expression text of the filter last compiled */
+   ProcessFilter* incFilterExpr; /* compiled expression filter, NULL if not valid */
    Hashtable* pidMatchList;
 
+   Process_New processNew;       /* constructor of the platform process class */
+   struct Recorder_* recorder;   /* writes each scan to a recording, if set */
+   struct Replay_* replay;       /* replaces the platform scan by a recording, if set */
+   struct FlightRecorder_* flightRecorder; /* keeps the recent scans in memory, if set */
+   struct Server_* server;       /* serves each scan on a socket, if set */
+
+   ProcessList_YieldFn yield;    /* lets a scan running in the background pause, see ProcessList_yield */
+   void* yieldData;
+
    #ifdef HAVE_LIBHWLOC
    hwloc_topology_t topology;
    bool topologyOk;
@@ -96,7 +116,7 @@ void ProcessList_goThroughEntries(ProcessList* super, bool pauseProcessUpdate);
 bool ProcessList_isCPUonline(const ProcessList* super, unsigned int id);
 
 
-ProcessList* ProcessList_init(ProcessList* this, const ObjectClass* klass, UsersTable* usersTable, Hashtable* dynamicMeters, Hashtable* dynamicColumns, Hashtable* pidMatchList, uid_t userId);
+ProcessList* ProcessList_init(ProcessList* this, const ObjectClass* klass, Process_New processNew, UsersTable* usersTable, Hashtable* dynamicMeters, Hashtable* dynamicColumns, Hashtable* pidMatchList, uid_t userId);
 
 void ProcessList_done(ProcessList* this);
 
@@ -118,10 +138,49 @@ void ProcessList_collapseAllBranches(ProcessList* this);
 
 void ProcessList_rebuildPanel(ProcessList* this);
 
+typedef void(*ProcessList_ProcessFunction)(Process* p, void* data);
+
+/* Calls f for each process the panel would show, in display order */
+void ProcessList_forEachShown(ProcessList* this, ProcessList_ProcessFunction f, void* data);
+
+const ProcessFilter* ProcessList_getFilterExpression(const ProcessList* this);
+
+/*
+ * Whether a known process can be excluded from display using only the data
+ * read so far in a scan (basic status and owner), so platforms may skip
+ * reading anything else for it. Covers -u, expressions and substring filters.
+ */
+bool ProcessList_rejectsEarly(ProcessList* this, Process* p);
+
+/* Whether -u excludes a known process, so platforms may skip reading it at all */
+bool ProcessList_rejectsUser(const ProcessList* this, const Process* p);
+
 Process* ProcessList_getProcess(ProcessList* this, pid_t pid, bool* preExisting, Process_New constructor);
 
 void ProcessList_scan(ProcessList* this, bool pauseProcessUpdate);
 
+/* Hands a finished scan to the recording, the flight recorder and the server; true if the flight recorder dumped */
+bool ProcessList_afterScan(ProcessList* this);
+
+/* CPU time used by the whole process, so drawing the results is accounted for too */
+uint64_t ProcessList_cpuTimeUs(void);
+
+/* Folds the CPU time of one update cycle into updateCostUs */
+void ProcessList_addUpdateCost(ProcessList* this, uint64_t costUs);
+
+/* The delay, stretched as far as needed to keep the updates within the CPU budget */
+uint64_t ProcessList_budgetedInterval(const ProcessList* this);
+
+/*
+ * Called by platforms while scanning, between two fully updated processes.
+ * The scan may be paused here for the UI to read (but not change) the list;
+ * for this no process may be freed before the end of the platform scan.
+ */
+static inline void ProcessList_yield(ProcessList* this) {
+   if (this->yield)
+      this->yield(this->yieldData);
+}
+
 static inline Process* ProcessList_findProcess(ProcessList* this, pid_t pid) {
    return (Process*) Hashtable_get(this->processTable, pid);
 }
@@ -13,6 +13,7 @@ in the source distribution for its full text.
 #include <limits.h>
 #include <stdlib.h>
 
+#include "FunctionBar.h"
 #include "Panel.h"
 #include "Platform.h"
 #include "ProvideCurses.h"
@@ -20,6 +21,16 @@ in the source distribution for its full text.
 #include "XUtils.h"
 
 
+static const char* const ProcessLocksScreenFunctions[] = {"Search ", "Filter ", "Refresh", "All    ", "Done   ", NULL};
+
+static const char* const ProcessLocksScreenKeys[] = {"F3", "F4", "F5", "F6", "Esc"};
+
+static const int ProcessLocksScreenEvents[] = {KEY_F(3), KEY_F(4), KEY_F(5), KEY_F(6), 27};
+
+static const char* const ProcessLocksScreen_processHeader = "        ID  TYPE       EXCLUSION  READ/WRITE DEVICE:INODE                              START                  END  FILENAME";
+
+static const char* const ProcessLocksScreen_systemHeader = "DEVICE:INODE                WAITERS  STATE      PID  TYPE       EXCLUSION  READ/WRITE                START                  END  FILENAME";
+
 ProcessLocksScreen* ProcessLocksScreen_new(const Process* process) {
    ProcessLocksScreen* this = xMalloc(sizeof(ProcessLocksScreen));
    Object_setClass(this, Class(ProcessLocksScreen));
@@ -27,7 +38,9 @@ ProcessLocksScreen* ProcessLocksScreen_new(const Process* process) {
       this->pid = process->tgid;
    else
       this->pid = process->pid;
-   return (ProcessLocksScreen*) InfoScreen_init(&this->super, process, NULL, LINES - 2, "        ID  TYPE       EXCLUSION  READ/WRITE DEVICE:INODE                              START                  END  FILENAME");
+   this->all = false;
+   FunctionBar* fuBar = FunctionBar_new(ProcessLocksScreenFunctions, ProcessLocksScreenKeys, ProcessLocksScreenEvents);
+   return (ProcessLocksScreen*) InfoScreen_init(&this->super, process, fuBar, LINES - 2, ProcessLocksScreen_processHeader);
 }
 
 void ProcessLocksScreen_delete(Object* this) {
@@ -35,71 +48,200 @@ void ProcessLocksScreen_delete(Object* this) {
 }
 
 static void ProcessLocksScreen_draw(InfoScreen* this) {
-   InfoScreen_drawTitled(this, "Snapshot of file locks of process %d - %s", ((ProcessLocksScreen*)this)->pid, Process_getCommand(this->process));
+   if (((ProcessLocksScreen*)this)->all)
+      InfoScreen_drawTitled(this, "Snapshot of file locks of all processes, most waited for first");
+   else
+      InfoScreen_drawTitled(this, "Snapshot of file locks of process %d - %s", ((ProcessLocksScreen*)this)->pid, Process_getCommand(this->process));
 }
 
-static inline void FileLocks_Data_clear(FileLocks_Data* data) {
+void FileLocks_Data_clear(FileLocks_Data* data) {
    free(data->locktype);
    free(data->exclusive);
    free(data->readwrite);
    free(data->filename);
 }
 
-static void ProcessLocksScreen_scan(InfoScreen* this) {
-   Panel* panel = this->display;
+void FileLocks_ProcessData_delete(FileLocks_ProcessData* pdata) {
+   if (!pdata)
+      return;
+
+   FileLocks_LockData* ldata = pdata->locks;
+   while (ldata) {
+      FileLocks_LockData* next = ldata->next;
+      FileLocks_Data_clear(&ldata->data);
+      free(ldata);
+      ldata = next;
+   }
+   free(pdata);
+}
+
+static void FileLocks_Data_formatEnd(const FileLocks_Data* data, char* buffer, size_t size) {
+   if (ULLONG_MAX == data->end)
+      String_safeStrncpy(buffer, "<END OF FILE>", size);
+   else
+      xSnprintf(buffer, size, "%"PRIu64, data->end);
+}
+
+static void ProcessLocksScreen_addProcessLocks(InfoScreen* this, const FileLocks_LockData* ldata) {
+   for (; ldata; ldata = ldata->next) {
+      const FileLocks_Data* data = &ldata->data;
+
+      /* marked as in /proc/locks */
+      char locktype[32];
+      xSnprintf(locktype, sizeof(locktype), "%s%s", data->blocked ? "->" : "", data->locktype);
+      char end[32];
+      FileLocks_Data_formatEnd(data, end, sizeof(end));
+
+      char entry[512];
+      xSnprintf(entry, sizeof(entry), "%10d  %-10s %-10s %-10s %02x:%02x:%020"PRIu64" %20"PRIu64" %20s  %s",
+         data->id,
+         locktype, data->exclusive, data->readwrite,
+         data->dev[0], data->dev[1], data->inode,
+         data->start, end,
+         data->filename ? data->filename : "<N/A>"
+      );
+      InfoScreen_addLine(this, entry);
+   }
+}
+
+typedef struct FileLocks_Entry_ {
+   FileLocks_Data* data;
+   unsigned int waiters;      /* locks waiting for the same file */
+} FileLocks_Entry;
+
+static int FileLocks_Entry_compareFiles(const FileLocks_Entry* e1, const FileLocks_Entry* e2) {
+   const FileLocks_Data* d1 = e1->data;
+   const FileLocks_Data* d2 = e2->data;
+   if (d1->dev[0] != d2->dev[0])
+      return d1->dev[0] < d2->dev[0] ? -1 : 1;
+   if (d1->dev[1] != d2->dev[1])
+      return d1->dev[1] < d2->dev[1] ? -1 : 1;
+   if (d1->inode != d2->inode)
+      return d1->inode < d2->inode ? -1 : 1;
+   return 0;
+}
+
+/* holders before waiters of each file */
+static int FileLocks_Entry_compareByFile(const void* v1, const void* v2) {
+   const FileLocks_Entry* e1 = v1;
+   const FileLocks_Entry* e2 = v2;
+   int result = FileLocks_Entry_compareFiles(e1, e2);
+   if (result == 0)
+      result = (int)e1->data->blocked - (int)e2->data->blocked;
+   if (result == 0)
+      result = (e1->data->pid > e2->data->pid) - (e1->data->pid < e2->data->pid);
+   return result;
+}
+
+static int FileLocks_Entry_compareByWaiters(const void* v1, const void* v2) {
+   const FileLocks_Entry* e1 = v1;
+   const FileLocks_Entry* e2 = v2;
+   if (e1->waiters != e2->waiters)
+      return e1->waiters > e2->waiters ? -1 : 1;
+   return FileLocks_Entry_compareByFile(v1, v2);
+}
+
+/* One line per lock, those of each file together and the most waited for files first */
+static void ProcessLocksScreen_addSystemLocks(InfoScreen* this, FileLocks_LockData* locks) {
+   size_t count = 0;
+   for (const FileLocks_LockData* ldata = locks; ldata; ldata = ldata->next)
+      count++;
+
+   FileLocks_Entry* entries = xMallocArray(count, sizeof(FileLocks_Entry));
+   count = 0;
+   for (FileLocks_LockData* ldata = locks; ldata; ldata = ldata->next)
+      entries[count++] = (FileLocks_Entry) { .data = &ldata->data, .waiters = 0 };
+   qsort(entries, count, sizeof(FileLocks_Entry), FileLocks_Entry_compareByFile);
+
+   for (size_t first = 0, last; first < count; first = last) {
+      unsigned int waiters = 0;
+      const char* filename = NULL;
+      for (last = first; last < count && FileLocks_Entry_compareFiles(&entries[first], &entries[last]) == 0; last++) {
+         waiters += entries[last].data->blocked;
+         if (!filename)
+            filename = entries[last].data->filename;
+      }
+
+      /* locks of open file descriptions and of processes gone meanwhile have no name of their own */
+      for (size_t i = first; i < last; i++) {
+         entries[i].waiters = waiters;
+         if (!entries[i].data->filename && filename)
+            entries[i].data->filename = xStrdup(filename);
+      }
+   }
+   qsort(entries, count, sizeof(FileLocks_Entry), FileLocks_Entry_compareByWaiters);
+
+   for (size_t i = 0; i < count; i++) {
+      const FileLocks_Data* data = entries[i].data;
+      char end[32];
+      FileLocks_Data_formatEnd(data, end, sizeof(end));
+
+      char entry[512];
+      xSnprintf(entry, sizeof(entry), "%02x:%02x:%020"PRIu64" %8u  %-5s %8d  %-10s %-10s %-10s %20"PRIu64" %20s  %s",
+         data->dev[0], data->dev[1], data->inode,
+         entries[i].waiters,
+         data->blocked ? "waits" : "holds",
+         data->pid,
+         data->locktype, data->exclusive, data->readwrite,
+         data->start, end,
+         data->filename ? data->filename : "<N/A>"
+      );
+      InfoScreen_addLine(this, entry);
+   }
+   free(entries);
+}
+
+static void ProcessLocksScreen_scan(InfoScreen* super) {
+   ProcessLocksScreen* this = (ProcessLocksScreen*) super;
+   Panel* panel = super->display;
    int idx = Panel_getSelectedIndex(panel);
    Panel_prune(panel);
-   FileLocks_ProcessData* pdata = Platform_getProcessLocks(((ProcessLocksScreen*)this)->pid);
+   FileLocks_ProcessData* pdata = this->all ? Platform_getSystemLocks() : Platform_getProcessLocks(this->pid);
    if (!pdata) {
-      InfoScreen_addLine(this, "This feature is not supported on your platform.");
+      InfoScreen_addLine(super, "This feature is not supported on your platform.");
    } else if (pdata->error) {
-      InfoScreen_addLine(this, "Could not determine file locks.");
+      InfoScreen_addLine(super, "Could not determine file locks.");
+   } else if (!pdata->locks) {
+      InfoScreen_addLine(super, this->all ? "No locks have been found." : "No locks have been found for the selected process.");
+   } else if (this->all) {
+      ProcessLocksScreen_addSystemLocks(super, pdata->locks);
    } else {
-      FileLocks_LockData* ldata = pdata->locks;
-      if (!ldata) {
-         InfoScreen_addLine(this, "No locks have been found for the selected process.");
-      }
-      while (ldata) {
-         FileLocks_Data* data = &ldata->data;
-
-         char entry[512];
-         if (ULLONG_MAX == data->end) {
-            xSnprintf(entry, sizeof(entry), "%10d  %-10s %-10s %-10s %02x:%02x:%020"PRIu64" %20"PRIu64" %20s  %s",
-               data->id,
-               data->locktype, data->exclusive, data->readwrite,
-               data->dev[0], data->dev[1], data->inode,
-               data->start, "<END OF FILE>",
-               data->filename ? data->filename : "<N/A>"
-            );
-         } else {
-            xSnprintf(entry, sizeof(entry), "%10d  %-10s %-10s %-10s %02x:%02x:%020"PRIu64" %20"PRIu64" %20"PRIu64"  %s",
-               data->id,
-               data->locktype, data->exclusive, data->readwrite,
-               data->dev[0], data->dev[1], data->inode,
-               data->start, data->end,
-               data->filename ? data->filename : "<N/A>"
-            );
-         }
-
-         InfoScreen_addLine(this, entry);
-         FileLocks_Data_clear(&ldata->data);
-
-         FileLocks_LockData* old = ldata;
-         ldata = ldata->next;
-         free(old);
-      }
+      ProcessLocksScreen_addProcessLocks(super, pdata->locks);
+   }
+   FileLocks_ProcessData_delete(pdata);
+
+   /* the system-wide lines come in their order already */
+   if (!this->all) {
+      Vector_insertionSort(super->lines);
+      Vector_insertionSort(panel->items);
    }
-   free(pdata);
-   Vector_insertionSort(this->lines);
-   Vector_insertionSort(panel->items);
    Panel_setSelected(panel, idx);
 }
 
+static bool ProcessLocksScreen_onKey(InfoScreen* super, int ch) {
+   ProcessLocksScreen* this = (ProcessLocksScreen*) super;
+   switch (ch) {
+      case 'a':
+      case KEY_F(6):
+         this->all = !this->all;
+         FunctionBar_setLabel(super->display->defaultBar, KEY_F(6), this->all ? "Process" : "All    ");
+         Panel_setHeader(super->display, this->all ? ProcessLocksScreen_systemHeader : ProcessLocksScreen_processHeader);
+         Panel_setSelected(super->display, 0);
+         Vector_prune(super->lines);
+         ProcessLocksScreen_scan(super);
+         clear();
+         InfoScreen_draw(this);
+         return true;
+   }
+   return false;
+}
+
 const InfoScreenClass ProcessLocksScreen_class = {
    .super = {
       .extends = Class(Object),
       .delete = ProcessLocksScreen_delete
    },
    .scan = ProcessLocksScreen_scan,
-   .draw = ProcessLocksScreen_draw
+   .draw = ProcessLocksScreen_draw,
+   .onKey = ProcessLocksScreen_onKey
 };
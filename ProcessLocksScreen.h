@@ -19,6 +19,7 @@ in the source distribution for its full text.
 typedef struct ProcessLocksScreen_ {
    InfoScreen super;
    pid_t pid;
+   bool all;                  /* showing the locks of all processes, grouped by file */
 } ProcessLocksScreen;
 
 typedef struct FileLocks_Data_ {
@@ -27,6 +28,8 @@ typedef struct FileLocks_Data_ {
    char* readwrite;
    char* filename;
    int id;
+   pid_t pid;                 /* -1 for locks of open file descriptions */
+   bool blocked;              /* waiting for the lock */
    unsigned int dev[2];
    uint64_t inode;
    uint64_t start;
@@ -49,4 +52,8 @@ ProcessLocksScreen* ProcessLocksScreen_new(const Process* process);
 
 void ProcessLocksScreen_delete(Object* this);
 
+void FileLocks_Data_clear(FileLocks_Data* data);
+
+void FileLocks_ProcessData_delete(FileLocks_ProcessData* pdata);
+
 #endif
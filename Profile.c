@@ -0,0 +1,213 @@
+/*
+htop - Profile.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "Profile.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "Macros.h"
+
+
+typedef struct ProfileSample_ {
+   uint64_t ns;
+   uint64_t calls;
+   uint64_t files;
+   uint64_t allocations;
+} ProfileSample;
+
+typedef struct ProfilePhaseInfo_ {
+   const char* name;
+   ProfilePhase parent;
+} ProfilePhaseInfo;
+
+/* The per-process readers are named after the Linux procfs files they read */
+static const ProfilePhaseInfo Profile_phases[PROFILE_PHASES] = {
+   [PROFILE_SYSTEM]         = { "System data (stat, meminfo, ...)", PROFILE_PHASES },
+   [PROFILE_WALK]           = { "Process directory walk",           PROFILE_PHASES },
+   [PROFILE_READ_STAT]      = { "stat",                             PROFILE_WALK },
+   [PROFILE_READ_STATM]     = { "statm",                            PROFILE_WALK },
+   [PROFILE_READ_IO]        = { "io",                               PROFILE_WALK },
+   [PROFILE_READ_CMDLINE]   = { "cmdline",                          PROFILE_WALK },
+   [PROFILE_READ_SMAPS]     = { "smaps",                            PROFILE_WALK },
+   [PROFILE_READ_MAPS]      = { "maps",                             PROFILE_WALK },
+   [PROFILE_READ_CGROUP]    = { "cgroup",                           PROFILE_WALK },
+   [PROFILE_READ_DELAYACCT] = { "delay accounting",                 PROFILE_WALK },
+   [PROFILE_READ_OTHER]     = { "other process data",               PROFILE_WALK },
+   [PROFILE_TREE]           = { "Tree build",                       PROFILE_PHASES },
+   [PROFILE_RECORD]         = { "Recording",                        PROFILE_PHASES },
+   [PROFILE_SORT]           = { "Sort",                             PROFILE_PHASES },
+   [PROFILE_REBUILD]        = { "Panel rebuild",                    PROFILE_PHASES },
+   [PROFILE_DRAW]           = { "Draw",                             PROFILE_PHASES },
+};
+
+bool Profile_enabled = false;
+
+__thread uint64_t Profile_files = 0;
+__thread uint64_t Profile_allocations = 0;
+
+/* Totals of all periods the calling thread suspended so far */
+static __thread ProfileCounters Profile_excluded;
+
+static ProfileSample Profile_current[PROFILE_PHASES];
+static bool Profile_cycleStarted;
+
+/* Ring buffer of the last completed cycles, nested phases already subtracted */
+static ProfileSample Profile_history[PROFILE_HISTORY][PROFILE_PHASES];
+static unsigned int Profile_count;
+static unsigned int Profile_next;
+
+static uint64_t Profile_now(void) {
+#if defined(HAVE_CLOCK_GETTIME)
+   struct timespec ts;
+   if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+      return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#endif
+
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return (uint64_t)tv.tv_sec * 1000000000 + (uint64_t)tv.tv_usec * 1000;
+}
+
+void Profile_enable(void) {
+   Profile_enabled = true;
+}
+
+void Profile_begin(ProfileMark* mark) {
+   if (!Profile_enabled) {
+      mark->start.ns = 0;
+      return;
+   }
+
+   mark->start.ns = Profile_now();
+   mark->start.files = Profile_files;
+   mark->start.allocations = Profile_allocations;
+   mark->excluded = Profile_excluded;
+}
+
+void Profile_end(ProfileMark* mark, ProfilePhase phase) {
+   if (!mark->start.ns)
+      return;
+
+   ProfileSample* sample = &Profile_current[phase];
+   sample->calls++;
+   sample->ns += Profile_now() - mark->start.ns - (Profile_excluded.ns - mark->excluded.ns);
+   sample->files += Profile_files - mark->start.files - (Profile_excluded.files - mark->excluded.files);
+   sample->allocations += Profile_allocations - mark->start.allocations - (Profile_excluded.allocations - mark->excluded.allocations);
+}
+
+void Profile_suspend(ProfileMark* mark) {
+   Profile_begin(mark);
+}
+
+void Profile_resume(const ProfileMark* mark) {
+   if (!mark->start.ns)
+      return;
+
+   Profile_excluded.ns += Profile_now() - mark->start.ns;
+   Profile_excluded.files += Profile_files - mark->start.files;
+   Profile_excluded.allocations += Profile_allocations - mark->start.allocations;
+}
+
+void Profile_nextCycle(void) {
+   if (!Profile_enabled)
+      return;
+
+   /* The cycle profiling was enabled in is incomplete */
+   if (Profile_cycleStarted) {
+      ProfileSample* cycle = Profile_history[Profile_next];
+      memcpy(cycle, Profile_current, sizeof(Profile_current));
+
+      for (int phase = 0; phase < PROFILE_PHASES; phase++) {
+         ProfilePhase parent = Profile_phases[phase].parent;
+         if (parent == PROFILE_PHASES)
+            continue;
+
+         cycle[parent].ns -= MINIMUM(cycle[parent].ns, cycle[phase].ns);
+         cycle[parent].files -= MINIMUM(cycle[parent].files, cycle[phase].files);
+         cycle[parent].allocations -= MINIMUM(cycle[parent].allocations, cycle[phase].allocations);
+      }
+
+      Profile_next = (Profile_next + 1) % PROFILE_HISTORY;
+      if (Profile_count < PROFILE_HISTORY)
+         Profile_count++;
+   }
+
+   memset(Profile_current, 0, sizeof(Profile_current));
+   Profile_cycleStarted = true;
+}
+
+unsigned int Profile_cycles(void) {
+   return Profile_count;
+}
+
+static int Profile_compareNs(const void* v1, const void* v2) {
+   uint64_t ns1 = *(const uint64_t*)v1;
+   uint64_t ns2 = *(const uint64_t*)v2;
+   return (ns1 > ns2) - (ns1 < ns2);
+}
+
+/* Nearest-rank percentile of n sorted values */
+static uint64_t Profile_percentile(const uint64_t* sorted, unsigned int n, unsigned int percent) {
+   return sorted[(n * percent + 99) / 100 - 1];
+}
+
+/* Passing PROFILE_PHASES gives the statistics of whole cycles */
+void Profile_getStats(ProfilePhase phase, ProfileStats* stats) {
+   memset(stats, 0, sizeof(ProfileStats));
+
+   const unsigned int n = Profile_count;
+   if (n == 0)
+      return;
+
+   uint64_t values[PROFILE_HISTORY];
+   ProfileSample sum = { 0, 0, 0, 0 };
+   for (unsigned int i = 0; i < n; i++) {
+      const ProfileSample* cycle = Profile_history[i];
+      ProfileSample sample = { 0, 0, 0, 0 };
+      for (int p = 0; p < PROFILE_PHASES; p++) {
+         if (phase != PROFILE_PHASES && p != (int)phase)
+            continue;
+
+         sample.ns += cycle[p].ns;
+         sample.calls += cycle[p].calls;
+         sample.files += cycle[p].files;
+         sample.allocations += cycle[p].allocations;
+      }
+
+      values[i] = sample.ns;
+      sum.ns += sample.ns;
+      sum.calls += sample.calls;
+      sum.files += sample.files;
+      sum.allocations += sample.allocations;
+   }
+
+   qsort(values, n, sizeof(uint64_t), Profile_compareNs);
+
+   stats->calls = (double)sum.calls / n;
+   stats->files = (double)sum.files / n;
+   stats->allocations = (double)sum.allocations / n;
+   stats->avgMs = (double)sum.ns / n / 1e6;
+   stats->p50Ms = Profile_percentile(values, n, 50) / 1e6;
+   stats->p95Ms = Profile_percentile(values, n, 95) / 1e6;
+   stats->maxMs = values[n - 1] / 1e6;
+}
+
+const char* Profile_phaseName(ProfilePhase phase) {
+   assert(phase < PROFILE_PHASES);
+   return Profile_phases[phase].name;
+}
+
+ProfilePhase Profile_parent(ProfilePhase phase) {
+   assert(phase < PROFILE_PHASES);
+   return Profile_phases[phase].parent;
+}
@@ -0,0 +1,109 @@
+#ifndef HEADER_Profile
+#define HEADER_Profile
+/*
+htop - Profile.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * Self-profiling of the refresh cycle. Each cycle starts with a process scan
+ * and includes the sorting and drawing of its results. Phases are measured
+ * by wrapping them in Profile_begin/Profile_end while owning the process list,
+ * nested phases are subtracted from their parent phase.
+ */
+typedef enum ProfilePhase_ {
+   PROFILE_SYSTEM,            /* CPU, memory and other system wide data */
+   PROFILE_WALK,              /* walking the process directories, excluding the readers below */
+   PROFILE_READ_STAT,
+   PROFILE_READ_STATM,
+   PROFILE_READ_IO,
+   PROFILE_READ_CMDLINE,
+   PROFILE_READ_SMAPS,
+   PROFILE_READ_MAPS,
+   PROFILE_READ_CGROUP,
+   PROFILE_READ_DELAYACCT,
+   PROFILE_READ_OTHER,
+   PROFILE_TREE,
+   PROFILE_RECORD,
+   PROFILE_SORT,
+   PROFILE_REBUILD,
+   PROFILE_DRAW,
+   PROFILE_PHASES
+} ProfilePhase;
+
+/* Number of refresh cycles the statistics are computed over */
+#define PROFILE_HISTORY 128
+
+typedef struct ProfileCounters_ {
+   uint64_t ns;
+   uint64_t files;
+   uint64_t allocations;
+} ProfileCounters;
+
+typedef struct ProfileMark_ {
+   ProfileCounters start;
+   ProfileCounters excluded;
+} ProfileMark;
+
+typedef struct ProfileStats_ {
+   double calls;              /* per cycle, on average */
+   double files;
+   double allocations;
+   double avgMs;
+   double p50Ms;
+   double p95Ms;
+   double maxMs;
+} ProfileStats;
+
+extern bool Profile_enabled;
+
+/*
+ * Running totals, kept up to date by the I/O and memory helpers while
+ * profiling. Each thread counts its own, as each phase is measured on
+ * the one thread doing it.
+ */
+extern __thread uint64_t Profile_files;
+extern __thread uint64_t Profile_allocations;
+
+static inline void Profile_countFile(void) {
+   if (Profile_enabled)
+      Profile_files++;
+}
+
+static inline void Profile_countAllocation(void) {
+   if (Profile_enabled)
+      Profile_allocations++;
+}
+
+/* Starts collecting, nothing is measured before */
+void Profile_enable(void);
+
+void Profile_begin(ProfileMark* mark);
+
+void Profile_end(ProfileMark* mark, ProfilePhase phase);
+
+/* Excludes everything between the two calls from the phases currently measured */
+void Profile_suspend(ProfileMark* mark);
+
+void Profile_resume(const ProfileMark* mark);
+
+/* Completes the current refresh cycle */
+void Profile_nextCycle(void);
+
+/* Number of completed cycles the statistics cover */
+unsigned int Profile_cycles(void);
+
+void Profile_getStats(ProfilePhase phase, ProfileStats* stats);
+
+const char* Profile_phaseName(ProfilePhase phase);
+
+/* The phase a phase is nested in, PROFILE_PHASES for top-level phases */
+ProfilePhase Profile_parent(ProfilePhase phase);
+
+#endif
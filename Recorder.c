@@ -0,0 +1,402 @@
+/*
+htop - Recorder.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "Recorder.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Macros.h"
+#include "Meter.h"
+#include "Process.h"
+#include "ProcessList.h"
+#include "Profile.h"
+#include "Recording.h"
+#include "Vector.h"
+#include "XUtils.h"
+
+
+typedef struct RecorderProcess_ {
+   uint64_t slots[RECORDING_FIELDS];
+   unsigned int generation;
+} RecorderProcess;
+
+/* Appends size zeroed bytes, returns their offset */
+static size_t RecorderBuffer_append(RecorderBuffer* this, size_t size) {
+   if (this->size + size > this->capacity) {
+      this->capacity = MAXIMUM(this->size + size, 2 * this->capacity);
+      this->data = xRealloc(this->data, this->capacity);
+   }
+   size_t offset = this->size;
+   memset(this->data + offset, 0, size);
+   this->size += size;
+   return offset;
+}
+
+static void RecorderBuffer_appendData(RecorderBuffer* this, const void* data, size_t size) {
+   if (!size)
+      return;
+
+   size_t offset = RecorderBuffer_append(this, size);
+   memcpy(this->data + offset, data, size);
+}
+
+/* Pads everything since the block header at offset and fills in the payload size */
+static void RecorderBuffer_endBlock(RecorderBuffer* this, size_t offset) {
+   uint32_t size = (uint32_t)(this->size - offset - sizeof(RecordingBlock));
+   RecorderBuffer_append(this, Recording_align(size) - size);
+   ((RecordingBlock*)(this->data + offset))->size = size;
+}
+
+static void Recorder_write(Recorder* this, const void* data, size_t size) {
+   if (this->fd < 0) {
+      RecorderBuffer_appendData(&this->output, data, size);
+      return;
+   }
+
+   const char* p = data;
+   while (size > 0 && !this->error) {
+      ssize_t written = write(this->fd, p, size);
+      if (written < 0) {
+         if (errno != EINTR)
+            this->error = errno;
+         continue;
+      }
+      p += written;
+      size -= (size_t)written;
+   }
+}
+
+static Recorder* Recorder_create(int fd) {
+   Recorder* this = xCalloc(1, sizeof(Recorder));
+   this->fd = fd;
+   this->processes = Hashtable_new(200, true);
+
+   /* id 0 stands for no string */
+   this->stringCapacity = 64;
+   this->strings = xCalloc(this->stringCapacity, sizeof(char*));
+   this->hashes = xCalloc(this->stringCapacity, sizeof(uint32_t));
+   this->stringCount = 1;
+   this->lookupSize = 128;
+   this->lookup = xCalloc(this->lookupSize, sizeof(uint32_t));
+
+   RecordingFileHeader header = { .version = RECORDING_VERSION, .byteOrder = RECORDING_BYTE_ORDER };
+   memcpy(header.magic, RECORDING_MAGIC, sizeof(header.magic));
+   Recorder_write(this, &header, sizeof(header));
+
+   return this;
+}
+
+Recorder* Recorder_new(const char* path) {
+   int fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_APPEND | O_CLOEXEC, 0666);
+   if (fd < 0)
+      return NULL;
+
+   Recorder* this = Recorder_create(fd);
+   if (this->error) {
+      int error = this->error;
+      unlink(path);
+      Recorder_delete(this);
+      errno = error;
+      return NULL;
+   }
+
+   return this;
+}
+
+Recorder* Recorder_newBuffer(void) {
+   return Recorder_create(-1);
+}
+
+void Recorder_delete(Recorder* this) {
+   if (!this)
+      return;
+
+   if (this->fd >= 0)
+      close(this->fd);
+   Hashtable_delete(this->processes);
+   for (uint32_t i = 0; i < this->stringCount; i++)
+      free(this->strings[i]);
+   free(this->strings);
+   free(this->hashes);
+   free(this->lookup);
+   free(this->gone);
+   free(this->stringBlocks.data);
+   free(this->sample.data);
+   free(this->meters.data);
+   free(this->output.data);
+   free(this);
+}
+
+static uint32_t Recorder_hash(const char* str) {
+   /* FNV-1a */
+   uint32_t hash = 2166136261U;
+   for (; *str; str++)
+      hash = (hash ^ (unsigned char)*str) * 16777619U;
+   return hash;
+}
+
+static void Recorder_growLookup(Recorder* this) {
+   free(this->lookup);
+   this->lookupSize *= 2;
+   this->lookup = xCalloc(this->lookupSize, sizeof(uint32_t));
+   for (uint32_t id = 1; id < this->stringCount; id++) {
+      uint32_t i = this->hashes[id] & (this->lookupSize - 1);
+      while (this->lookup[i])
+         i = (i + 1) & (this->lookupSize - 1);
+      this->lookup[i] = id;
+   }
+}
+
+/* Returns the id of str, defining it in the next sample if it is new */
+static uint32_t Recorder_intern(Recorder* this, const char* str) {
+   uint32_t hash = Recorder_hash(str);
+   uint32_t i = hash & (this->lookupSize - 1);
+   for (uint32_t id; (id = this->lookup[i]); i = (i + 1) & (this->lookupSize - 1)) {
+      if (this->hashes[id] == hash && String_eq(this->strings[id], str))
+         return id;
+   }
+
+   if (this->stringCount == this->stringCapacity) {
+      this->strings = xReallocArrayZero(this->strings, this->stringCapacity, 2 * this->stringCapacity, sizeof(char*));
+      this->hashes = xReallocArrayZero(this->hashes, this->stringCapacity, 2 * this->stringCapacity, sizeof(uint32_t));
+      this->stringCapacity *= 2;
+   }
+   uint32_t id = this->stringCount++;
+   this->strings[id] = xStrdup(str);
+   this->hashes[id] = hash;
+   this->lookup[i] = id;
+   if (2 * this->stringCount > this->lookupSize)
+      Recorder_growLookup(this);
+
+   size_t length = strlen(str);
+   size_t block = RecorderBuffer_append(&this->stringBlocks, sizeof(RecordingBlock));
+   ((RecordingBlock*)(this->stringBlocks.data + block))->type = RECORDING_STRING;
+   RecordingString header = { .id = id, .length = (uint32_t)length };
+   RecorderBuffer_appendData(&this->stringBlocks, &header, sizeof(header));
+   RecorderBuffer_appendData(&this->stringBlocks, str, length + 1);
+   RecorderBuffer_endBlock(&this->stringBlocks, block);
+
+   return id;
+}
+
+/* Most strings stay the same from one sample to the next, compare before looking up */
+static uint64_t Recorder_stringSince(Recorder* this, const char* str, uint64_t previous) {
+   if (!str)
+      return 0;
+   if (previous && String_eq(this->strings[previous], str))
+      return previous;
+   return Recorder_intern(this, str);
+}
+
+static inline uint64_t Recorder_integer(long long value) {
+   return (uint64_t)value;
+}
+
+static inline uint64_t Recorder_real(double value) {
+   uint64_t slot;
+   memcpy(&slot, &value, sizeof(slot));
+   return slot;
+}
+
+static void Recorder_fillSlots(Recorder* this, const Process* p, const uint64_t* previous, uint64_t* slots) {
+   slots[RECORDING_PPID] = Recorder_integer(p->ppid);
+   slots[RECORDING_TGID] = Recorder_integer(p->tgid);
+   slots[RECORDING_PGRP] = Recorder_integer(p->pgrp);
+   slots[RECORDING_SESSION] = Recorder_integer(p->session);
+   slots[RECORDING_TTY_NR] = Recorder_integer((long long)p->tty_nr);
+   slots[RECORDING_TPGID] = Recorder_integer(p->tpgid);
+   slots[RECORDING_ST_UID] = Recorder_integer(p->st_uid);
+   slots[RECORDING_STATE] = Recorder_integer(p->state);
+   slots[RECORDING_FLAGS] = (p->isKernelThread ? RECORDING_KERNEL_THREAD : 0) |
+                            (p->isUserlandThread ? RECORDING_USERLAND_THREAD : 0) |
+                            (p->procExeDeleted ? RECORDING_EXE_DELETED : 0) |
+                            (p->usesDeletedLib ? RECORDING_DELETED_LIB : 0);
+   slots[RECORDING_NICE] = Recorder_integer(p->nice);
+   slots[RECORDING_PRIORITY] = Recorder_integer(p->priority);
+   slots[RECORDING_NLWP] = Recorder_integer(p->nlwp);
+   slots[RECORDING_PROCESSOR] = Recorder_integer(p->processor);
+   slots[RECORDING_PERCENT_CPU] = Recorder_real(p->percent_cpu);
+   slots[RECORDING_PERCENT_MEM] = Recorder_real(p->percent_mem);
+   slots[RECORDING_M_VIRT] = Recorder_integer(p->m_virt);
+   slots[RECORDING_M_RESIDENT] = Recorder_integer(p->m_resident);
+   slots[RECORDING_TIME] = Recorder_integer((long long)p->time);
+   slots[RECORDING_STARTTIME] = Recorder_integer(p->starttime_ctime);
+   slots[RECORDING_MINFLT] = Recorder_integer((long long)p->minflt);
+   slots[RECORDING_MAJFLT] = Recorder_integer((long long)p->majflt);
+   slots[RECORDING_USER] = Recorder_stringSince(this, p->user, previous[RECORDING_USER]);
+   slots[RECORDING_TTY] = Recorder_stringSince(this, p->tty_name, previous[RECORDING_TTY]);
+   slots[RECORDING_CMDLINE] = Recorder_stringSince(this, p->cmdline, previous[RECORDING_CMDLINE]);
+   slots[RECORDING_BASENAME] = ((uint64_t)(uint32_t)p->cmdlineBasenameStart << 32) | (uint32_t)p->cmdlineBasenameEnd;
+   slots[RECORDING_COMM] = Recorder_stringSince(this, p->procComm, previous[RECORDING_COMM]);
+   slots[RECORDING_EXE] = Recorder_stringSince(this, p->procExe, previous[RECORDING_EXE]);
+}
+
+void Recorder_addMeter(Recorder* this, const Meter* meter) {
+   if (this->error)
+      return;
+
+   uint32_t items = meter->values ? meter->curItems : 0;
+   size_t textLength = strlen(meter->txtBuffer);
+   RecordingMeter header = {
+      .name = Recorder_intern(this, Meter_name(meter)),
+      .param = meter->param,
+      .items = items,
+      .textLength = (uint32_t)textLength,
+      .total = meter->total,
+   };
+   RecorderBuffer_appendData(&this->meters, &header, sizeof(header));
+   RecorderBuffer_appendData(&this->meters, meter->values, items * sizeof(double));
+   RecorderBuffer_appendData(&this->meters, meter->txtBuffer, textLength + 1);
+   RecorderBuffer_append(&this->meters, Recording_align((uint32_t)textLength + 1) - (textLength + 1));
+   this->meterCount++;
+}
+
+typedef struct RecorderGoneData_ {
+   Recorder* recorder;
+   size_t count;
+} RecorderGoneData;
+
+static void Recorder_collectGone(ht_key_t key, void* value, void* data) {
+   const RecorderProcess* entry = value;
+   RecorderGoneData* gone = data;
+   Recorder* this = gone->recorder;
+
+   if (entry->generation == this->generation)
+      return;
+
+   if (gone->count == this->goneCapacity) {
+      this->goneCapacity = MAXIMUM(64, 2 * this->goneCapacity);
+      this->gone = xReallocArray(this->gone, this->goneCapacity, sizeof(pid_t));
+   }
+   this->gone[gone->count++] = (pid_t)key;
+}
+
+/* Adds the fields of a process to the sample, as far as they changed since the previous one */
+static void Recorder_putProcess(Recorder* this, RecorderProcess* entry, bool isNew, pid_t pid, const uint64_t* slots) {
+   uint32_t mask = 0;
+   for (int f = 0; f < RECORDING_FIELDS; f++) {
+      if (this->keyframe || isNew || slots[f] != entry->slots[f])
+         mask |= 1U << f;
+   }
+   memcpy(entry->slots, slots, sizeof(entry->slots));
+   entry->generation = this->generation;
+
+   if (!mask)
+      return;
+
+   RecordingProcess rp = { .pid = (uint32_t)pid, .mask = mask };
+   RecorderBuffer_appendData(&this->sample, &rp, sizeof(rp));
+   for (int f = 0; f < RECORDING_FIELDS; f++) {
+      if (mask & (1U << f))
+         RecorderBuffer_appendData(&this->sample, &slots[f], sizeof(slots[f]));
+   }
+   this->sampleProcesses++;
+}
+
+void Recorder_beginSample(Recorder* this) {
+   this->keyframe = this->generation % RECORDING_KEYFRAME_INTERVAL == 0;
+   this->generation++;
+
+   this->sample.size = 0;
+   RecorderBuffer_append(&this->sample, sizeof(RecordingBlock) + sizeof(RecordingSample));
+   this->sampleProcesses = 0;
+}
+
+uint32_t Recorder_string(Recorder* this, const char* str) {
+   return str ? Recorder_intern(this, str) : 0;
+}
+
+void Recorder_addProcess(Recorder* this, pid_t pid, const uint64_t* slots) {
+   RecorderProcess* entry = Hashtable_get(this->processes, pid);
+   bool isNew = !entry;
+   if (isNew) {
+      entry = xCalloc(1, sizeof(RecorderProcess));
+      Hashtable_put(this->processes, pid, entry);
+   }
+
+   Recorder_putProcess(this, entry, isNew, pid, slots);
+}
+
+void Recorder_endSample(Recorder* this, const RecordingSample* counts) {
+   RecorderBuffer* sample = &this->sample;
+
+   /* a keyframe replaces all processes, gone ones need no entry there */
+   RecorderGoneData gone = { .recorder = this, .count = 0 };
+   Hashtable_foreach(this->processes, Recorder_collectGone, &gone);
+   for (size_t i = 0; i < gone.count; i++) {
+      free(Hashtable_remove(this->processes, (ht_key_t)this->gone[i]));
+      if (!this->keyframe) {
+         RecordingProcess rp = { .pid = (uint32_t)this->gone[i], .mask = RECORDING_GONE };
+         RecorderBuffer_appendData(sample, &rp, sizeof(rp));
+         this->sampleProcesses++;
+      }
+   }
+
+   RecorderBuffer_appendData(sample, this->meters.data, this->meters.size);
+
+   RecordingSample* rs = (RecordingSample*)(sample->data + sizeof(RecordingBlock));
+   *rs = *counts;
+   rs->flags = this->keyframe ? RECORDING_KEYFRAME : 0;
+   rs->processes = this->sampleProcesses;
+   rs->meters = this->meterCount;
+   ((RecordingBlock*)sample->data)->type = RECORDING_SAMPLE;
+   RecorderBuffer_endBlock(sample, 0);
+
+   /* the strings a sample refers to go first, so a cut off recording never misses any */
+   if (!this->error) {
+      Recorder_write(this, this->stringBlocks.data, this->stringBlocks.size);
+      Recorder_write(this, sample->data, sample->size);
+   }
+   this->stringBlocks.size = 0;
+   this->meters.size = 0;
+   this->meterCount = 0;
+}
+
+void Recorder_writeSample(Recorder* this, const ProcessList* pl) {
+   if (this->error)
+      return;
+
+   ProfileMark mark;
+   Profile_begin(&mark);
+
+   Recorder_beginSample(this);
+
+   for (int i = 0; i < Vector_size(pl->processes); i++) {
+      const Process* p = (const Process*) Vector_get(pl->processes, i);
+      if (p->tombStampMs > 0)
+         continue;
+
+      RecorderProcess* entry = Hashtable_get(this->processes, p->pid);
+      bool isNew = !entry;
+      if (isNew) {
+         entry = xCalloc(1, sizeof(RecorderProcess));
+         Hashtable_put(this->processes, p->pid, entry);
+      }
+
+      uint64_t slots[RECORDING_FIELDS];
+      Recorder_fillSlots(this, p, entry->slots, slots);
+      Recorder_putProcess(this, entry, isNew, p->pid, slots);
+   }
+
+   RecordingSample counts = {
+      .realtimeMs = pl->realtimeMs,
+      .totalTasks = pl->totalTasks,
+      .runningTasks = pl->runningTasks,
+      .userlandThreads = pl->userlandThreads,
+      .kernelThreads = pl->kernelThreads,
+   };
+   Recorder_endSample(this, &counts);
+
+   Profile_end(&mark, PROFILE_RECORD);
+}
@@ -0,0 +1,87 @@
+#ifndef HEADER_Recorder
+#define HEADER_Recorder
+/*
+htop - Recorder.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "Hashtable.h"
+#include "Recording.h"
+
+
+struct Meter_;
+struct ProcessList_;
+
+typedef struct RecorderBuffer_ {
+   char* data;
+   size_t size;
+   size_t capacity;
+} RecorderBuffer;
+
+/*
+ * Writes the scans to a recording, see Recording.h for the format.
+ * Meters are added as they are updated and written with the next sample.
+ */
+typedef struct Recorder_ {
+   int fd;                    /* -1 when writing to output */
+   int error;                 /* errno of the first failed write, nothing is written after it */
+
+   Hashtable* processes;      /* pid -> fields last written */
+   unsigned int generation;   /* number of samples written */
+   bool keyframe;             /* whether the sample being written is one */
+   uint32_t sampleProcesses;  /* entries in the sample being written */
+
+   /* interned strings, indexed by id */
+   char** strings;
+   uint32_t* hashes;
+   uint32_t stringCount;
+   uint32_t stringCapacity;
+   uint32_t* lookup;          /* open addressing table of string ids */
+   uint32_t lookupSize;
+
+   pid_t* gone;
+   size_t goneCapacity;
+
+   RecorderBuffer stringBlocks;
+   RecorderBuffer sample;
+   RecorderBuffer meters;
+   uint32_t meterCount;
+
+   RecorderBuffer output;     /* everything written and not yet taken, if not writing to a file */
+} Recorder;
+
+/* Creates a new recording at path, which must not exist; returns NULL with errno set on failure */
+Recorder* Recorder_new(const char* path);
+
+/* Creates a new recording which is written to the output buffer, for passing it on */
+Recorder* Recorder_newBuffer(void);
+
+void Recorder_delete(Recorder* this);
+
+void Recorder_addMeter(Recorder* this, const struct Meter_* meter);
+
+/* Writes the current state of the process list along with the meters added since the last sample */
+void Recorder_writeSample(Recorder* this, const struct ProcessList_* pl);
+
+/*
+ * Writing a sample piece by piece, for processes which are not in a process
+ * list: begin it, add each process with its fields, string fields holding
+ * ids from Recorder_string, then end it with the realtime and task counts.
+ */
+void Recorder_beginSample(Recorder* this);
+
+/* Returns the id of str in this recording, 0 for NULL */
+uint32_t Recorder_string(Recorder* this, const char* str);
+
+void Recorder_addProcess(Recorder* this, pid_t pid, const uint64_t* slots);
+
+void Recorder_endSample(Recorder* this, const RecordingSample* counts);
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef HEADER_Recording
+#define HEADER_Recording
+/*
+htop - Recording.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdint.h>
+
+
+/*
+ * On-disk format shared by the Recorder and the Replay.
+ *
+ * A recording is a file header followed by blocks, each one a block header
+ * and its payload padded to 8 bytes. Blocks are only ever appended, so a
+ * recording cut short by a crash is valid up to its last complete block.
+ * All values are in the byte order of the recording machine and 8-byte
+ * aligned relative to the start of the file, which allows reading them
+ * in place from a mapping of the file.
+ *
+ * STRING blocks define the strings samples refer to by id, before their
+ * first use. Id 0 stands for no string.
+ *
+ * SAMPLE blocks hold one scan: the sample header, then for each process a
+ * RecordingProcess followed by one 8-byte slot per bit set in its mask, in
+ * order of the RecordingField bits, and then the meters. Keyframes list all
+ * processes with all their fields, other samples only the processes and
+ * fields which changed since the previous sample, and the processes gone.
+ * Meters are written in full with each sample.
+ */
+
+#define RECORDING_MAGIC "HTOPREC"
+#define RECORDING_VERSION 1
+#define RECORDING_BYTE_ORDER 0x01020304
+
+/* A keyframe is written every that many samples */
+#define RECORDING_KEYFRAME_INTERVAL 60
+
+typedef struct RecordingFileHeader_ {
+   char magic[8];
+   uint32_t version;
+   uint32_t byteOrder;
+} RecordingFileHeader;
+
+typedef enum RecordingBlockType_ {
+   RECORDING_STRING = 1,
+   RECORDING_SAMPLE = 2,
+} RecordingBlockType;
+
+typedef struct RecordingBlock_ {
+   uint32_t type;
+   uint32_t size;             /* of the payload, without padding */
+} RecordingBlock;
+
+typedef struct RecordingString_ {
+   uint32_t id;
+   uint32_t length;           /* followed by the characters and a NUL */
+} RecordingString;
+
+#define RECORDING_KEYFRAME 0x1
+
+typedef struct RecordingSample_ {
+   uint64_t realtimeMs;
+   uint32_t flags;
+   uint32_t processes;
+   uint32_t meters;
+   uint32_t totalTasks;
+   uint32_t runningTasks;
+   uint32_t userlandThreads;
+   uint32_t kernelThreads;
+   uint32_t reserved;
+} RecordingSample;
+
+typedef enum RecordingField_ {
+   RECORDING_PPID,
+   RECORDING_TGID,
+   RECORDING_PGRP,
+   RECORDING_SESSION,
+   RECORDING_TTY_NR,
+   RECORDING_TPGID,
+   RECORDING_ST_UID,
+   RECORDING_STATE,
+   RECORDING_FLAGS,           /* see below */
+   RECORDING_NICE,
+   RECORDING_PRIORITY,
+   RECORDING_NLWP,
+   RECORDING_PROCESSOR,
+   RECORDING_PERCENT_CPU,     /* double */
+   RECORDING_PERCENT_MEM,     /* double */
+   RECORDING_M_VIRT,
+   RECORDING_M_RESIDENT,
+   RECORDING_TIME,
+   RECORDING_STARTTIME,
+   RECORDING_MINFLT,
+   RECORDING_MAJFLT,
+   RECORDING_USER,            /* string id */
+   RECORDING_TTY,             /* string id */
+   RECORDING_CMDLINE,         /* string id */
+   RECORDING_BASENAME,        /* start of the cmdline basename in the high, end in the low 32 bits */
+   RECORDING_COMM,            /* string id */
+   RECORDING_EXE,             /* string id */
+   RECORDING_FIELDS
+} RecordingField;
+
+/* Bits of the RECORDING_FLAGS field */
+#define RECORDING_KERNEL_THREAD   0x1
+#define RECORDING_USERLAND_THREAD 0x2
+#define RECORDING_EXE_DELETED     0x4
+#define RECORDING_DELETED_LIB     0x8
+
+/* Set instead of field bits for a process which is gone */
+#define RECORDING_GONE 0x80000000U
+
+typedef struct RecordingProcess_ {
+   uint32_t pid;
+   uint32_t mask;
+} RecordingProcess;
+
+/* Followed by the values, then the text with a NUL padded to 8 bytes */
+typedef struct RecordingMeter_ {
+   uint32_t name;             /* string id */
+   uint32_t param;
+   uint32_t items;
+   uint32_t textLength;
+   double total;
+} RecordingMeter;
+
+static inline uint32_t Recording_align(uint32_t size) {
+   return (size + 7) & ~7U;
+}
+
+#endif
@@ -0,0 +1,661 @@
+/*
+htop - Replay.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "Replay.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "Macros.h"
+#include "Meter.h"
+#include "Process.h"
+#include "ProcessList.h"
+#include "Recording.h"
+#include "Server.h"
+#include "Settings.h"
+#include "XUtils.h"
+
+
+/* Bounds for the playback speed, as log2 */
+#define REPLAY_MIN_SPEED (-3)
+#define REPLAY_MAX_SPEED 6
+
+/* Bounds for the real time between two samples */
+#define REPLAY_MIN_INTERVAL_MS 50
+#define REPLAY_MAX_INTERVAL_MS 10000
+
+/* How often an attached replay looks for new samples */
+#define REPLAY_LIVE_INTERVAL_MS 100
+
+#define REPLAY_ATTACH_TIMEOUT_MS 60000
+
+/* Room made for reading from the server */
+#define REPLAY_RECEIVE_SIZE 65536
+
+#define REPLAY_ALL_FIELDS ((1U << RECORDING_FIELDS) - 1)
+
+#define REPLAY_STRING_FIELDS ((1U << RECORDING_USER) | (1U << RECORDING_TTY) | \
+                              (1U << RECORDING_CMDLINE) | (1U << RECORDING_COMM) | (1U << RECORDING_EXE))
+
+typedef struct ReplayProcess_ {
+   uint64_t slots[RECORDING_FIELDS];
+   uint32_t changed;          /* fields changed since last put into the process list */
+} ReplayProcess;
+
+static inline const RecordingSample* Replay_sampleAt(const Replay* this, size_t index) {
+   return (const RecordingSample*)(this->map + this->samples[index].offset);
+}
+
+static unsigned int Replay_countBits(uint32_t mask) {
+   unsigned int count = 0;
+   for (; mask; mask &= mask - 1)
+      count++;
+   return count;
+}
+
+/*
+ * Checks everything in a sample is within its block and refers to strings
+ * defined before, so it can be played without further checks. Returns the
+ * offset of the meters, 0 if the sample is broken.
+ */
+static size_t Replay_checkSample(const Replay* this, size_t at, size_t end) {
+   const RecordingSample* rs = (const RecordingSample*)(this->map + at);
+   at += sizeof(RecordingSample);
+
+   for (uint32_t i = 0; i < rs->processes; i++) {
+      if (end - at < sizeof(RecordingProcess))
+         return 0;
+      const RecordingProcess* rp = (const RecordingProcess*)(this->map + at);
+      at += sizeof(RecordingProcess);
+      if (rp->mask == RECORDING_GONE)
+         continue;
+      if (rp->mask & ~REPLAY_ALL_FIELDS)
+         return 0;
+
+      const uint64_t* slot = (const uint64_t*)(this->map + at);
+      unsigned int slots = Replay_countBits(rp->mask);
+      if ((end - at) / sizeof(uint64_t) < slots)
+         return 0;
+      for (int f = 0; f < RECORDING_FIELDS; f++) {
+         if (!(rp->mask & (1U << f)))
+            continue;
+         if ((REPLAY_STRING_FIELDS & (1U << f)) && *slot >= this->stringCount)
+            return 0;
+         slot++;
+      }
+      at += slots * sizeof(uint64_t);
+   }
+
+   size_t meters = at;
+   for (uint32_t i = 0; i < rs->meters; i++) {
+      if (end - at < sizeof(RecordingMeter))
+         return 0;
+      const RecordingMeter* rm = (const RecordingMeter*)(this->map + at);
+      at += sizeof(RecordingMeter);
+      if (rm->name == 0 || rm->name >= this->stringCount)
+         return 0;
+      if ((end - at) / sizeof(double) < rm->items)
+         return 0;
+      at += rm->items * sizeof(double);
+      if (rm->textLength >= end - at || end - at < Recording_align(rm->textLength + 1) || this->map[at + rm->textLength] != '\0')
+         return 0;
+      at += Recording_align(rm->textLength + 1);
+   }
+
+   return meters;
+}
+
+/*
+ * Indexes the complete blocks from where it left off; a recording may have
+ * been cut off at any point, and more may come from a server. Returns false
+ * if a block is broken.
+ */
+static bool Replay_indexBlocks(Replay* this) {
+   size_t at = this->indexed;
+   bool valid = true;
+
+   while (at <= this->mapSize && this->mapSize - at >= sizeof(RecordingBlock)) {
+      const RecordingBlock* block = (const RecordingBlock*)(this->map + at);
+      size_t payload = at + sizeof(RecordingBlock);
+      if (block->size > this->mapSize - payload)
+         break;
+      size_t end = payload + block->size;
+
+      if (block->type == RECORDING_STRING) {
+         const RecordingString* rs = (const RecordingString*)(this->map + payload);
+         if (block->size < sizeof(RecordingString) ||
+             rs->id != this->stringCount ||
+             rs->length >= block->size - sizeof(RecordingString) ||
+             this->map[payload + sizeof(RecordingString) + rs->length] != '\0') {
+            valid = false;
+            break;
+         }
+
+         if (this->stringCount == this->stringCapacity) {
+            this->strings = xReallocArray(this->strings, 2 * this->stringCapacity, sizeof(char*));
+            this->stringCapacity *= 2;
+         }
+         char* str = this->map + payload + sizeof(RecordingString);
+         this->strings[this->stringCount++] = this->fd < 0 ? str : xStrdup(str);
+      } else if (block->type == RECORDING_SAMPLE) {
+         size_t meters = block->size < sizeof(RecordingSample) ? 0 : Replay_checkSample(this, payload, end);
+         if (!meters) {
+            valid = false;
+            break;
+         }
+
+         if (this->sampleCount == this->sampleCapacity) {
+            this->samples = xReallocArray(this->samples, 2 * this->sampleCapacity, sizeof(ReplaySample));
+            this->sampleCapacity *= 2;
+         }
+         const RecordingSample* rs = (const RecordingSample*)(this->map + payload);
+         this->samples[this->sampleCount++] = (ReplaySample) {
+            .offset = payload,
+            .meters = meters,
+            .realtimeMs = rs->realtimeMs,
+            .keyframe = rs->flags & RECORDING_KEYFRAME,
+         };
+      }
+
+      /* the padding of the last block in a file may be cut off, from a server it is still to come */
+      at = payload + Recording_align(block->size);
+      if (this->fd < 0)
+         at = MINIMUM(at, this->mapSize);
+   }
+
+   this->indexed = at;
+   return valid;
+}
+
+/* Returns what is wrong with the header, NULL if nothing */
+static const char* Replay_checkHeader(const RecordingFileHeader* header) {
+   if (memcmp(header->magic, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0)
+      return "not a recording";
+   if (header->byteOrder != RECORDING_BYTE_ORDER)
+      return "recorded on a machine of different byte order";
+   if (header->version != RECORDING_VERSION)
+      return "unsupported recording version";
+   return NULL;
+}
+
+static Replay* Replay_create(char* map, size_t mapSize, int fd) {
+   Replay* this = xCalloc(1, sizeof(Replay));
+   this->map = map;
+   this->mapSize = mapSize;
+   this->fd = fd;
+   this->processes = Hashtable_new(200, true);
+
+   /* id 0 stands for no string */
+   this->stringCapacity = 256;
+   this->strings = xCalloc(this->stringCapacity, sizeof(char*));
+   this->stringCount = 1;
+   this->sampleCapacity = 256;
+   this->samples = xCalloc(this->sampleCapacity, sizeof(ReplaySample));
+   return this;
+}
+
+Replay* Replay_new(const char* path, char* error, size_t errorSize) {
+   int fd = open(path, O_RDONLY | O_CLOEXEC);
+   if (fd < 0) {
+      xSnprintf(error, errorSize, "%s", strerror(errno));
+      return NULL;
+   }
+
+   struct stat st;
+   if (fstat(fd, &st) != 0) {
+      xSnprintf(error, errorSize, "%s", strerror(errno));
+      close(fd);
+      return NULL;
+   }
+
+   if ((size_t)st.st_size < sizeof(RecordingFileHeader)) {
+      xSnprintf(error, errorSize, "not a recording");
+      close(fd);
+      return NULL;
+   }
+
+   void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   int mapError = errno;
+   close(fd);
+   if (map == MAP_FAILED) {
+      xSnprintf(error, errorSize, "%s", strerror(mapError));
+      return NULL;
+   }
+
+   const char* problem = Replay_checkHeader(map);
+   if (problem) {
+      xSnprintf(error, errorSize, "%s", problem);
+      munmap(map, (size_t)st.st_size);
+      return NULL;
+   }
+
+   Replay* this = Replay_create(map, (size_t)st.st_size, -1);
+   this->indexed = sizeof(RecordingFileHeader);
+   Replay_indexBlocks(this);
+   if (this->sampleCount == 0) {
+      xSnprintf(error, errorSize, "recording contains no samples");
+      Replay_delete(this);
+      return NULL;
+   }
+
+   return this;
+}
+
+/* Reads what the server sent so far; returns false if the connection is gone */
+static bool Replay_receive(Replay* this) {
+   for (;;) {
+      if (this->mapCapacity - this->mapSize < REPLAY_RECEIVE_SIZE) {
+         this->mapCapacity = MAXIMUM(2 * this->mapCapacity, this->mapSize + REPLAY_RECEIVE_SIZE);
+         this->map = xRealloc(this->map, this->mapCapacity);
+      }
+
+      ssize_t n = read(this->fd, this->map + this->mapSize, this->mapCapacity - this->mapSize);
+      if (n > 0) {
+         this->mapSize += (size_t)n;
+      } else if (n == 0) {
+         return false;
+      } else if (errno != EINTR) {
+         return errno == EAGAIN || errno == EWOULDBLOCK;
+      }
+   }
+}
+
+Replay* Replay_attach(const char* path, char* error, size_t errorSize) {
+   struct sockaddr_un addr;
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   if (strlen(path) >= sizeof(addr.sun_path)) {
+      xSnprintf(error, errorSize, "path too long");
+      return NULL;
+   }
+   String_safeStrncpy(addr.sun_path, path, sizeof(addr.sun_path));
+
+   int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd < 0 || connect(fd, (const struct sockaddr*)&addr, sizeof(addr)) != 0) {
+      xSnprintf(error, errorSize, "%s", strerror(errno));
+      if (fd >= 0)
+         close(fd);
+      return NULL;
+   }
+
+   static const char request[] = SERVER_PROTOCOL " record\n";
+   if (write(fd, request, strlen(request)) != (ssize_t)strlen(request) || fcntl(fd, F_SETFL, O_NONBLOCK) != 0 || fcntl(fd, F_SETFD, FD_CLOEXEC) != 0) {
+      xSnprintf(error, errorSize, "%s", strerror(errno));
+      close(fd);
+      return NULL;
+   }
+
+   Replay* this = Replay_create(NULL, 0, fd);
+
+   /* the server sends the first sample with its next update */
+   const char* problem = NULL;
+   while (!problem && this->sampleCount == 0) {
+      struct pollfd pfd = { .fd = fd, .events = POLLIN };
+      int ready = poll(&pfd, 1, REPLAY_ATTACH_TIMEOUT_MS);
+      if (ready < 0 && errno == EINTR)
+         continue;
+      if (ready <= 0) {
+         problem = "no answer from the server";
+         break;
+      }
+
+      bool connected = Replay_receive(this);
+      if (this->indexed == 0 && this->mapSize > 0 && this->map[0] == '{') {
+         /* a JSON error line */
+         const char* newline = memchr(this->map, '\n', this->mapSize);
+         if (newline) {
+            xSnprintf(error, errorSize, "%.*s", (int)(newline - this->map), this->map);
+            Replay_delete(this);
+            return NULL;
+         }
+      } else if (this->indexed == 0 && this->mapSize >= sizeof(RecordingFileHeader)) {
+         problem = Replay_checkHeader((const RecordingFileHeader*)this->map);
+         this->indexed = sizeof(RecordingFileHeader);
+      }
+      if (!problem && this->indexed > 0 && !Replay_indexBlocks(this))
+         problem = "invalid data from the server";
+      if (!problem && !connected && this->sampleCount == 0)
+         problem = "connection closed by the server";
+   }
+
+   if (problem) {
+      xSnprintf(error, errorSize, "%s", problem);
+      Replay_delete(this);
+      return NULL;
+   }
+
+   return this;
+}
+
+void Replay_delete(Replay* this) {
+   if (!this)
+      return;
+
+   if (this->fd >= 0) {
+      close(this->fd);
+      free(this->map);
+      for (uint32_t i = 1; i < this->stringCount; i++)
+         free(this->strings[i]);
+   } else {
+      munmap(this->map, this->mapSize);
+   }
+   free(this->strings);
+   free(this->samples);
+   Hashtable_delete(this->processes);
+   free(this);
+}
+
+/* Applies a sample to the state of the processes */
+static void Replay_load(Replay* this, size_t index) {
+   const RecordingSample* rs = Replay_sampleAt(this, index);
+   if (rs->flags & RECORDING_KEYFRAME)
+      Hashtable_clear(this->processes);
+
+   size_t at = this->samples[index].offset + sizeof(RecordingSample);
+   for (uint32_t i = 0; i < rs->processes; i++) {
+      const RecordingProcess* rp = (const RecordingProcess*)(this->map + at);
+      at += sizeof(RecordingProcess);
+      if (rp->mask == RECORDING_GONE) {
+         free(Hashtable_remove(this->processes, rp->pid));
+         continue;
+      }
+
+      ReplayProcess* entry = Hashtable_get(this->processes, rp->pid);
+      if (!entry) {
+         entry = xCalloc(1, sizeof(ReplayProcess));
+         entry->changed = REPLAY_ALL_FIELDS;
+         Hashtable_put(this->processes, rp->pid, entry);
+      }
+
+      const uint64_t* slot = (const uint64_t*)(this->map + at);
+      for (int f = 0; f < RECORDING_FIELDS; f++) {
+         if (rp->mask & (1U << f))
+            entry->slots[f] = *slot++;
+      }
+      entry->changed |= rp->mask;
+      at = (size_t)((const char*)slot - this->map);
+   }
+}
+
+static inline const char* Replay_string(const Replay* this, uint64_t id) {
+   return id ? this->strings[id] : NULL;
+}
+
+static inline double Replay_real(uint64_t slot) {
+   double value;
+   memcpy(&value, &slot, sizeof(value));
+   return value;
+}
+
+static void Replay_updateCmdline(const Replay* this, Process* p, const uint64_t* slots) {
+   const char* cmdline = Replay_string(this, slots[RECORDING_CMDLINE]);
+   int start = 0;
+   int end = 0;
+   if (cmdline) {
+      int length = (int)strlen(cmdline);
+      start = (int)(uint32_t)(slots[RECORDING_BASENAME] >> 32);
+      end = CLAMP((int)(uint32_t)slots[RECORDING_BASENAME], 0, length);
+      if (start < 0 || start >= end)
+         start = 0;
+   }
+   Process_updateCmdline(p, cmdline, start, end);
+}
+
+typedef struct ReplayScanData_ {
+   const Replay* replay;
+   ProcessList* pl;
+} ReplayScanData;
+
+static void Replay_putProcess(ht_key_t key, void* value, void* data) {
+   ReplayProcess* entry = value;
+   const ReplayScanData* scan = data;
+   const Replay* this = scan->replay;
+   ProcessList* pl = scan->pl;
+   const Settings* settings = pl->settings;
+   const uint64_t* slots = entry->slots;
+
+   bool preExisting;
+   Process* p = ProcessList_getProcess(pl, (pid_t)key, &preExisting, pl->processNew);
+   if (!preExisting)
+      entry->changed = REPLAY_ALL_FIELDS;
+
+   p->ppid = (pid_t)slots[RECORDING_PPID];
+   p->tgid = (pid_t)slots[RECORDING_TGID];
+   p->pgrp = (int)slots[RECORDING_PGRP];
+   p->session = (int)slots[RECORDING_SESSION];
+   p->tty_nr = (unsigned long int)slots[RECORDING_TTY_NR];
+   p->tpgid = (int)slots[RECORDING_TPGID];
+   p->st_uid = (uid_t)slots[RECORDING_ST_UID];
+   p->state = (ProcessState)slots[RECORDING_STATE];
+   p->isKernelThread = slots[RECORDING_FLAGS] & RECORDING_KERNEL_THREAD;
+   p->isUserlandThread = slots[RECORDING_FLAGS] & RECORDING_USERLAND_THREAD;
+   p->procExeDeleted = slots[RECORDING_FLAGS] & RECORDING_EXE_DELETED;
+   p->usesDeletedLib = slots[RECORDING_FLAGS] & RECORDING_DELETED_LIB;
+   p->nice = (long int)slots[RECORDING_NICE];
+   p->priority = (long int)slots[RECORDING_PRIORITY];
+   p->nlwp = (long int)slots[RECORDING_NLWP];
+   p->processor = (int)slots[RECORDING_PROCESSOR];
+   p->percent_cpu = (float)Replay_real(slots[RECORDING_PERCENT_CPU]);
+   p->percent_mem = (float)Replay_real(slots[RECORDING_PERCENT_MEM]);
+   p->m_virt = (long)slots[RECORDING_M_VIRT];
+   p->m_resident = (long)slots[RECORDING_M_RESIDENT];
+   p->time = (unsigned long long int)slots[RECORDING_TIME];
+   p->starttime_ctime = (time_t)slots[RECORDING_STARTTIME];
+   p->minflt = (unsigned long int)slots[RECORDING_MINFLT];
+   p->majflt = (unsigned long int)slots[RECORDING_MAJFLT];
+
+   if (entry->changed & (1U << RECORDING_USER))
+      p->user = Replay_string(this, slots[RECORDING_USER]);
+
+   if (entry->changed & (1U << RECORDING_TTY)) {
+      const char* tty = Replay_string(this, slots[RECORDING_TTY]);
+      if (tty) {
+         free_and_xStrdup(&p->tty_name, tty);
+      } else {
+         free(p->tty_name);
+         p->tty_name = NULL;
+      }
+   }
+
+   if (entry->changed & ((1U << RECORDING_CMDLINE) | (1U << RECORDING_BASENAME)))
+      Replay_updateCmdline(this, p, slots);
+
+   if (entry->changed & (1U << RECORDING_COMM))
+      Process_updateComm(p, Replay_string(this, slots[RECORDING_COMM]));
+
+   if (entry->changed & (1U << RECORDING_EXE))
+      Process_updateExe(p, Replay_string(this, slots[RECORDING_EXE]));
+
+   if (entry->changed & (1U << RECORDING_STARTTIME))
+      Process_fillStarttimeBuffer(p);
+
+   entry->changed = 0;
+
+   p->show = !((settings->hideKernelThreads && Process_isKernelThread(p)) || (settings->hideUserlandThreads && Process_isUserlandThread(p)));
+   p->updated = true;
+
+   if (!preExisting)
+      ProcessList_add(pl, p);
+}
+
+/* Drops everything before the current sample, which is all an attached replay needs */
+static void Replay_compact(Replay* this) {
+   ReplaySample current = this->samples[this->position - 1];
+   size_t keep = current.offset - sizeof(RecordingBlock);
+
+   memmove(this->map, this->map + keep, this->mapSize - keep);
+   this->mapSize -= keep;
+   this->indexed -= keep;
+   current.offset -= keep;
+   current.meters -= keep;
+   this->samples[0] = current;
+   this->sampleCount = 1;
+   this->position = 1;
+}
+
+/* Takes in what the server sent, and plays up to its latest sample if advancing */
+static void Replay_follow(Replay* this, bool advance) {
+   if (!this->detached && (!Replay_receive(this) || !Replay_indexBlocks(this)))
+      this->detached = true;
+
+   if (!advance)
+      return;
+
+   while (this->position < this->sampleCount)
+      Replay_load(this, this->position++);
+   Replay_compact(this);
+}
+
+void Replay_scan(Replay* this, ProcessList* pl, bool advance) {
+   if (this->fd >= 0) {
+      Replay_follow(this, advance || this->position == 0);
+   } else if (!advance) {
+      /* stay on the current sample, or the first one */
+      if (this->position == 0)
+         Replay_load(this, this->position++);
+   } else if (this->held) {
+      this->held = false;
+   } else if (this->position < this->sampleCount) {
+      Replay_load(this, this->position);
+      this->position++;
+   }
+
+   ReplayScanData data = { .replay = this, .pl = pl };
+   Hashtable_foreach(this->processes, Replay_putProcess, &data);
+
+   const RecordingSample* rs = Replay_sampleAt(this, this->position - 1);
+   pl->realtimeMs = rs->realtimeMs;
+   pl->realtime.tv_sec = (time_t)(rs->realtimeMs / 1000);
+   pl->realtime.tv_usec = (suseconds_t)(rs->realtimeMs % 1000 * 1000);
+   pl->totalTasks = rs->totalTasks;
+   pl->runningTasks = rs->runningTasks;
+   pl->userlandThreads = rs->userlandThreads;
+   pl->kernelThreads = rs->kernelThreads;
+}
+
+void Replay_updateMeter(const Replay* this, Meter* meter) {
+   if (this->position == 0)
+      return;
+
+   const ReplaySample* sample = &this->samples[this->position - 1];
+   const RecordingSample* rs = (const RecordingSample*)(this->map + sample->offset);
+   const char* name = Meter_name(meter);
+
+   size_t at = sample->meters;
+   for (uint32_t i = 0; i < rs->meters; i++) {
+      const RecordingMeter* rm = (const RecordingMeter*)(this->map + at);
+      const double* values = (const double*)(rm + 1);
+      const char* text = (const char*)(values + rm->items);
+      at += sizeof(RecordingMeter) + rm->items * sizeof(double) + Recording_align(rm->textLength + 1);
+
+      if (rm->param != meter->param || !String_eq(this->strings[rm->name], name))
+         continue;
+
+      /* meters made up of others, like AllCPUs, update these in turn */
+      if (rm->items == 0 && rm->textLength == 0) {
+         As_Meter(meter)->updateValues(meter);
+         return;
+      }
+
+      uint8_t items = (uint8_t)MINIMUM(rm->items, As_Meter(meter)->maxItems);
+      if (items)
+         memcpy(meter->values, values, items * sizeof(double));
+      meter->curItems = items;
+      meter->total = rm->total;
+      String_safeStrncpy(meter->txtBuffer, text, sizeof(meter->txtBuffer));
+      return;
+   }
+
+   meter->curItems = 0;
+   xSnprintf(meter->txtBuffer, sizeof(meter->txtBuffer), "not recorded");
+}
+
+void Replay_seek(Replay* this, int64_t deltaMs) {
+   if (this->position == 0 || this->fd >= 0)
+      return;
+
+   size_t current = this->position - 1;
+   size_t target = current;
+   uint64_t now = this->samples[current].realtimeMs;
+   if (deltaMs > 0) {
+      uint64_t time = now + (uint64_t)deltaMs;
+      while (target + 1 < this->sampleCount && this->samples[target].realtimeMs < time)
+         target++;
+   } else {
+      uint64_t time = now > (uint64_t)-deltaMs ? now - (uint64_t)-deltaMs : 0;
+      while (target > 0 && this->samples[target].realtimeMs > time)
+         target--;
+   }
+   if (target == current)
+      return;
+
+   size_t keyframe = target;
+   while (keyframe > 0 && !this->samples[keyframe].keyframe)
+      keyframe--;
+
+   Hashtable_clear(this->processes);
+   for (size_t i = keyframe; i <= target; i++)
+      Replay_load(this, i);
+
+   this->position = target + 1;
+   this->held = true;
+}
+
+void Replay_changeSpeed(Replay* this, int doublings) {
+   this->speed = CLAMP(this->speed + doublings, REPLAY_MIN_SPEED, REPLAY_MAX_SPEED);
+}
+
+uint64_t Replay_interval(const Replay* this) {
+   if (this->fd >= 0)
+      return REPLAY_LIVE_INTERVAL_MS;
+   if (this->held || this->position == 0)
+      return 0;
+   if (Replay_atEnd(this))
+      return REPLAY_MAX_INTERVAL_MS;
+
+   uint64_t last = this->samples[this->position - 1].realtimeMs;
+   uint64_t next = this->samples[this->position].realtimeMs;
+   uint64_t interval = next > last ? next - last : 0;
+   interval = this->speed >= 0 ? interval >> this->speed : interval << -this->speed;
+   return CLAMP(interval, REPLAY_MIN_INTERVAL_MS, REPLAY_MAX_INTERVAL_MS);
+}
+
+void Replay_status(const Replay* this, char* buffer, size_t size) {
+   char speed[16];
+   if (this->speed >= 0) {
+      xSnprintf(speed, sizeof(speed), "%dx", 1 << this->speed);
+   } else {
+      xSnprintf(speed, sizeof(speed), "1/%dx", 1 << -this->speed);
+   }
+
+   size_t current = this->position ? this->position - 1 : 0;
+   time_t seconds = (time_t)(this->samples[current].realtimeMs / 1000);
+   struct tm result;
+   char date[32] = "";
+   const struct tm* lt = localtime_r(&seconds, &result);
+   if (lt)
+      strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", lt);
+
+   if (this->fd >= 0) {
+      xSnprintf(buffer, size, "%s %s", this->detached ? "DETACHED" : "ATTACHED", date);
+      return;
+   }
+
+   xSnprintf(buffer, size, "REPLAY %s %s %zu/%zu%s", speed, date, current + 1, this->sampleCount,
+             Replay_atEnd(this) ? " END" : "");
+}
@@ -0,0 +1,91 @@
+#ifndef HEADER_Replay
+#define HEADER_Replay
+/*
+htop - Replay.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Hashtable.h"
+
+
+struct Meter_;
+struct ProcessList_;
+
+typedef struct ReplaySample_ {
+   size_t offset;             /* of the RecordingSample in the file */
+   size_t meters;             /* of its first RecordingMeter */
+   uint64_t realtimeMs;
+   bool keyframe;
+} ReplaySample;
+
+/*
+ * Plays back a recording written by the Recorder, which is mapped and
+ * indexed as a whole when opened. The processes of the current sample are
+ * replayed into the process list in place of a platform scan, the meters
+ * from Meter_updateValues.
+ *
+ * Attached to a server (see Server.h) instead, the recording is read from
+ * its socket as it comes and always played at its latest sample; the data
+ * before that one is dropped.
+ */
+typedef struct Replay_ {
+   char* map;                 /* read-only if mapped from a file */
+   size_t mapSize;
+
+   int fd;                    /* socket when attached to a server, -1 otherwise */
+   size_t mapCapacity;        /* when attached */
+   size_t indexed;            /* offset of the first block not yet indexed */
+   bool detached;             /* the server closed the connection or sent garbage */
+
+   char** strings;            /* indexed by id, pointing into the mapping or owned when attached */
+   uint32_t stringCount;
+   uint32_t stringCapacity;
+
+   ReplaySample* samples;
+   size_t sampleCount;
+   size_t sampleCapacity;
+
+   Hashtable* processes;      /* pid -> fields as of the current sample */
+   size_t position;           /* number of samples played, the current one is the last */
+   bool held;                 /* do not move on with the next scan, after seeking */
+   int speed;                 /* log2 of the playback speed */
+} Replay;
+
+/* Opens the recording at path; returns NULL and describes the problem in error on failure */
+Replay* Replay_new(const char* path, char* error, size_t errorSize);
+
+/* Attaches to the server at the socket path, waiting for its first sample; returns NULL and describes the problem in error on failure */
+Replay* Replay_attach(const char* path, char* error, size_t errorSize);
+
+void Replay_delete(Replay* this);
+
+/* Moves on to the next sample, if any and advancing, and puts its processes into the process list */
+void Replay_scan(Replay* this, struct ProcessList_* pl, bool advance);
+
+/* Whether the last sample has been played, for good */
+static inline bool Replay_atEnd(const Replay* this) {
+   return this->position >= this->sampleCount && (this->fd < 0 || this->detached);
+}
+
+/* Sets the values of the meter as recorded with the current sample */
+void Replay_updateMeter(const Replay* this, struct Meter_* meter);
+
+/* Jumps by the given recorded time; the process list is updated with the next scan */
+void Replay_seek(Replay* this, int64_t deltaMs);
+
+/* Makes playback that many times faster (or slower, if negative) */
+void Replay_changeSpeed(Replay* this, int doublings);
+
+/* Real time to wait until the next sample is due at the current speed */
+uint64_t Replay_interval(const Replay* this);
+
+/* Describes position and speed, for showing in the function bar */
+void Replay_status(const Replay* this, char* buffer, size_t size);
+
+#endif
@@ -8,6 +8,7 @@ in the source distribution for its full text.
 #include "RichString.h"
 
 #include <ctype.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -52,15 +53,62 @@ void RichString_rewind(RichString* this, int count) {
 
 #ifdef HAVE_LIBNCURSESW
 
+/*
+ * Length of the leading run of ASCII bytes in data, up to len and stopping at
+ * a null byte. Checks a machine word at a time: a byte is non-ASCII or null
+ * if its high bit is set either in the byte itself or after subtracting one.
+ */
+static inline int RichString_asciiPrefix(const char* data, int len) {
+   const uint64_t ones = UINT64_C(0x0101010101010101);
+   const uint64_t highs = UINT64_C(0x8080808080808080);
+
+   int i = 0;
+   for (; i + (int)sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, data + i, sizeof(word));
+      if (((word - ones) | word) & highs)
+         break;
+   }
+   for (; i < len; i++) {
+      unsigned char c = data[i];
+      if (c == '\0' || c >= 0x80)
+         break;
+   }
+   return i;
+}
+
+/* Copies ASCII characters as they are, the multibyte decoder is not needed for them */
+static inline void RichString_writeAsciiPrefix(RichString* this, int attrs, const char* data, int from, int len) {
+   for (int i = from, j = 0; j < len; i++, j++) {
+      unsigned char c = data[j];
+      this->chptr[i] = (CharType) { .attr = attrs & 0xffffff, .chars = { (c >= 0x20 && c < 0x7f) ? c : '?' } };
+   }
+}
+
 static inline int RichString_writeFromWide(RichString* this, int attrs, const char* data_c, int from, int len) {
-   wchar_t data[len + 1];
-   len = mbstowcs(data, data_c, len);
+   int ascii = RichString_asciiPrefix(data_c, len);
+   if (ascii == len || data_c[ascii] == '\0') {
+      if (ascii <= 0)
+         return 0;
+
+      RichString_setLen(this, from + ascii);
+      RichString_writeAsciiPrefix(this, attrs, data_c, from, ascii);
+      return ascii;
+   }
+
+   wchar_t data[len - ascii + 1];
+   int wideLen = mbstowcs(data, data_c + ascii, len - ascii);
+   if (wideLen < 0)
+      return 0;
+
+   len = ascii + wideLen;
    if (len <= 0)
       return 0;
 
    int newLen = from + len;
    RichString_setLen(this, newLen);
-   for (int i = from, j = 0; i < newLen; i++, j++) {
+   RichString_writeAsciiPrefix(this, attrs, data_c, from, ascii);
+   for (int i = from + ascii, j = 0; i < newLen; i++, j++) {
       this->chptr[i] = (CharType) { .attr = attrs & 0xffffff, .chars = { (iswprint(data[j]) ? data[j] : '?') } };
    }
 
@@ -68,17 +116,37 @@ static inline int RichString_writeFromWide(RichString* this, int attrs, const ch
 }
 
 int RichString_appendnWideColumns(RichString* this, int attrs, const char* data_c, int len, int* columns) {
-   wchar_t data[len + 1];
-   len = mbstowcs(data, data_c, len);
+   int from = this->chlen;
+
+   /* Each ASCII character takes one column */
+   int ascii = RichString_asciiPrefix(data_c, len);
+   if (ascii > *columns || ascii == len || data_c[ascii] == '\0') {
+      ascii = MINIMUM(ascii, *columns);
+      if (ascii <= 0)
+         return 0;
+
+      RichString_setLen(this, from + ascii);
+      RichString_writeAsciiPrefix(this, attrs, data_c, from, ascii);
+      *columns = ascii;
+      return ascii;
+   }
+
+   wchar_t data[len - ascii + 1];
+   int wideLen = mbstowcs(data, data_c + ascii, len - ascii);
+   if (wideLen < 0)
+      return 0;
+
+   len = ascii + wideLen;
    if (len <= 0)
       return 0;
 
-   int from = this->chlen;
    int newLen = from + len;
    RichString_setLen(this, newLen);
-   int columnsWritten = 0;
-   int pos = from;
-   for (int j = 0; j < len; j++) {
+   RichString_writeAsciiPrefix(this, attrs, data_c, from, ascii);
+   int columnsWritten = ascii;
+   *columns -= ascii;
+   int pos = from + ascii;
+   for (int j = 0; j < wideLen; j++) {
       wchar_t c = iswprint(data[j]) ? data[j] : '?';
       int cwidth = wcwidth(c);
       if (cwidth > *columns)
@@ -0,0 +1,221 @@
+/*
+htop - Sampler.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "Sampler.h"
+
+#include <signal.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "CRT.h"
+#include "EventLoop.h"
+#include "Header.h"
+#include "Macros.h"
+#include "Platform.h"
+#include "ProcessList.h"
+#include "Profile.h"
+#include "Replay.h"
+#include "XUtils.h"
+
+
+static void Sampler_waitMs(Sampler* this, uint64_t ms) {
+   struct timeval now;
+   gettimeofday(&now, NULL);
+
+   uint64_t nsec = (uint64_t)now.tv_usec * 1000 + (ms % 1000) * 1000000;
+   struct timespec deadline = {
+      .tv_sec = now.tv_sec + (time_t)(ms / 1000) + (time_t)(nsec / 1000000000),
+      .tv_nsec = (long)(nsec % 1000000000),
+   };
+   pthread_cond_timedwait(&this->changed, &this->lock, &deadline);
+}
+
+/* May only be called while the UI thread does not hold the data */
+static uint64_t Sampler_interval(const Sampler* this) {
+   /* a replay goes by the time between the recorded samples */
+   if (this->state->pl->replay)
+      return Replay_interval(this->state->pl->replay);
+
+   return ProcessList_budgetedInterval(this->state->pl);
+}
+
+/* Called with the lock held; returns false when the thread should quit */
+static bool Sampler_waitForScan(Sampler* this) {
+   for (;;) {
+      if (this->quit)
+         return false;
+
+      /* The settings may only be read while the UI does not hold the data */
+      if (this->uiHolds) {
+         pthread_cond_wait(&this->changed, &this->lock);
+         continue;
+      }
+
+      if (this->scanRequested)
+         return true;
+
+      uint64_t now;
+      Platform_gettime_monotonic(&now);
+      uint64_t interval = Sampler_interval(this);
+      if (now - this->lastScanMs >= interval)
+         return true;
+
+      Sampler_waitMs(this, interval - (now - this->lastScanMs));
+   }
+}
+
+static void* Sampler_run(void* data) {
+   Sampler* this = data;
+   ProcessList* pl = this->state->pl;
+
+   /* Leave asynchronous signals to the UI thread, its handlers restore the terminal */
+   sigset_t signals;
+   sigfillset(&signals);
+   sigdelset(&signals, SIGABRT);
+   sigdelset(&signals, SIGBUS);
+   sigdelset(&signals, SIGFPE);
+   sigdelset(&signals, SIGILL);
+   sigdelset(&signals, SIGSEGV);
+   pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+   uint64_t lastCpuUs = ProcessList_cpuTimeUs();
+
+   pthread_mutex_lock(&this->lock);
+   while (Sampler_waitForScan(this)) {
+      bool pauseProcessUpdate = this->state->pauseProcessUpdate;
+      this->scanRequested = false;
+      this->scanning = true;
+      pthread_mutex_unlock(&this->lock);
+
+      Platform_gettime_realtime(&pl->realtime, &pl->realtimeMs);
+      ProcessList_scan(pl, pauseProcessUpdate);
+
+      /* Everything since the previous scan, including the UI work it caused */
+      uint64_t cpuUs = ProcessList_cpuTimeUs();
+      uint64_t costUs = cpuUs - lastCpuUs;
+      lastCpuUs = cpuUs;
+      ProcessList_addUpdateCost(pl, costUs);
+      pl->updateIntervalMs = Sampler_interval(this);
+
+      // always update header, especially to avoid gaps in graph meters
+      Header_updateData(this->state->header);
+
+      ProcessList_afterScan(pl);
+
+      pthread_mutex_lock(&this->lock);
+      this->scanning = false;
+      this->generation++;
+      Platform_gettime_monotonic(&this->lastScanMs);
+      pthread_cond_broadcast(&this->changed);
+      if (this->state->events)
+         EventLoop_wakeup(this->state->events);
+   }
+   pthread_mutex_unlock(&this->lock);
+
+   return NULL;
+}
+
+/* Installed as the ProcessList yield hook, runs on the sampler thread */
+static void Sampler_yield(void* data) {
+   Sampler* this = data;
+
+   pthread_mutex_lock(&this->lock);
+   if (this->uiWantsPause) {
+      /* The time paused and the UI work meanwhile are not part of the scan */
+      ProfileMark mark;
+      Profile_suspend(&mark);
+
+      this->paused = true;
+      pthread_cond_broadcast(&this->changed);
+      while (this->uiWantsPause || this->uiHolds)
+         pthread_cond_wait(&this->changed, &this->lock);
+      this->paused = false;
+
+      Profile_resume(&mark);
+   }
+   pthread_mutex_unlock(&this->lock);
+}
+
+Sampler* Sampler_new(State* state) {
+   Sampler* this = xCalloc(1, sizeof(Sampler));
+   this->state = state;
+   this->uiHolds = true;
+   Platform_gettime_monotonic(&this->lastScanMs);
+
+   pthread_mutex_init(&this->lock, NULL);
+   pthread_cond_init(&this->changed, NULL);
+
+   state->pl->yield = Sampler_yield;
+   state->pl->yieldData = this;
+
+   if (pthread_create(&this->thread, NULL, Sampler_run, this) != 0)
+      CRT_fatalError("Could not start the sampler thread");
+
+   return this;
+}
+
+void Sampler_delete(Sampler* this) {
+   pthread_mutex_lock(&this->lock);
+   this->quit = true;
+   pthread_cond_broadcast(&this->changed);
+   pthread_mutex_unlock(&this->lock);
+
+   pthread_join(this->thread, NULL);
+
+   this->state->pl->yield = NULL;
+   this->state->pl->yieldData = NULL;
+
+   pthread_cond_destroy(&this->changed);
+   pthread_mutex_destroy(&this->lock);
+   free(this);
+}
+
+void Sampler_acquire(Sampler* this) {
+   pthread_mutex_lock(&this->lock);
+   while (this->scanning)
+      pthread_cond_wait(&this->changed, &this->lock);
+   this->uiHolds = true;
+   pthread_mutex_unlock(&this->lock);
+}
+
+bool Sampler_tryAcquire(Sampler* this) {
+   pthread_mutex_lock(&this->lock);
+   bool acquired = !this->scanning;
+   if (acquired)
+      this->uiHolds = true;
+   pthread_mutex_unlock(&this->lock);
+   return acquired;
+}
+
+bool Sampler_acquirePaused(Sampler* this) {
+   pthread_mutex_lock(&this->lock);
+   this->uiWantsPause = true;
+   while (this->scanning && !this->paused)
+      pthread_cond_wait(&this->changed, &this->lock);
+   bool paused = this->paused;
+   this->uiWantsPause = false;
+   this->uiHolds = true;
+   pthread_mutex_unlock(&this->lock);
+   return paused;
+}
+
+void Sampler_release(Sampler* this) {
+   pthread_mutex_lock(&this->lock);
+   this->uiHolds = false;
+   pthread_cond_broadcast(&this->changed);
+   pthread_mutex_unlock(&this->lock);
+}
+
+void Sampler_requestScan(Sampler* this) {
+   pthread_mutex_lock(&this->lock);
+   this->scanRequested = true;
+   pthread_cond_broadcast(&this->changed);
+   pthread_mutex_unlock(&this->lock);
+}
@@ -0,0 +1,74 @@
+#ifndef HEADER_Sampler
+#define HEADER_Sampler
+/*
+htop - Sampler.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Action.h"
+
+
+/*
+ * Runs ProcessList_scan and Header_updateData on a background thread.
+ *
+ * The process list and the header data are shared with the UI thread, which
+ * takes them with Sampler_acquire while it draws or handles a key and gives
+ * them back with Sampler_release before waiting for input. A running scan
+ * can be paused with Sampler_acquirePaused where the platform scan yields,
+ * so the UI can keep scrolling through the previous panel contents. Only the
+ * Linux process enumeration yields (every 64 processes); elsewhere, and while
+ * system data or the header are updated, the UI waits for the scan.
+ */
+typedef struct Sampler_ {
+   pthread_t thread;
+   pthread_mutex_t lock;      /* protects the fields below */
+   pthread_cond_t changed;    /* signaled on any change of the fields below */
+
+   State* state;
+   uint64_t lastScanMs;       /* monotonic time the last scan finished */
+   unsigned int generation;   /* number of completed scans */
+   unsigned int shownGeneration; /* scans the panel was rebuilt for, only used by the UI thread */
+   bool scanning;             /* the sampler thread owns the data */
+   bool paused;               /* a running scan waits for the UI */
+   bool uiHolds;              /* the UI thread owns the data */
+   bool uiWantsPause;         /* the UI thread waits for a running scan to pause */
+   bool scanRequested;
+   bool quit;
+} Sampler;
+
+/* Starts the sampler thread, the calling thread holds the data afterwards */
+Sampler* Sampler_new(State* state);
+
+/* Stops the sampler thread, must be called while holding the data */
+void Sampler_delete(Sampler* this);
+
+/* Waits until no scan is running and takes the data */
+void Sampler_acquire(Sampler* this);
+
+/* Takes the data only if no scan is running */
+bool Sampler_tryAcquire(Sampler* this);
+
+/*
+ * Takes the data, pausing a running scan. Returns true if a scan was paused,
+ * in which case the process list is partially updated and may only be read,
+ * e.g. to draw and move around in the panel as it is.
+ */
+bool Sampler_acquirePaused(Sampler* this);
+
+void Sampler_release(Sampler* this);
+
+/* Starts the next scan as soon as the data is released */
+void Sampler_requestScan(Sampler* this);
+
+/* Completed scans so far, only stable while holding the data */
+static inline unsigned int Sampler_generation(const Sampler* this) {
+   return this->generation;
+}
+
+#endif
@@ -0,0 +1,305 @@
+/*
+htop - SamplingScreen.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "SamplingScreen.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "CRT.h"
+#include "FunctionBar.h"
+#include "Macros.h"
+#include "Panel.h"
+#include "Platform.h"
+#include "ProvideCurses.h"
+#include "Vector.h"
+#include "XUtils.h"
+
+
+static const char* const SamplingScreenFunctions[] = {"Search ", "Filter ", "Stacks ", "Slower ", "Faster ", "Reset  ", "Done   ", NULL};
+
+static const char* const SamplingScreenKeys[] = {"F3", "F4", "F6", "F7", "F8", "F9", "Esc"};
+
+static const int SamplingScreenEvents[] = {KEY_F(3), KEY_F(4), KEY_F(6), KEY_F(7), KEY_F(8), KEY_F(9), 27};
+
+static const char* const SamplingScreen_callsHeader = " SAMPLES       %      TID  THREAD           ACTIVITY";
+
+static const char* const SamplingScreen_stacksHeader = " SAMPLES       %      TID  THREAD           KERNEL STACK (INNERMOST FIRST)";
+
+/* milliseconds between samples */
+static const int SamplingScreen_intervals[] = { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000 };
+
+#define SAMPLINGSCREEN_DEFAULT_RATE 4
+#define SAMPLINGSCREEN_REFRESH_MS 1000
+
+SamplingScreen* SamplingScreen_new(const Process* process) {
+   SamplingScreen* this = xCalloc(1, sizeof(SamplingScreen));
+   Object_setClass(this, Class(SamplingScreen));
+   this->pid = Process_isThread(process) ? process->tgid : process->pid;
+   this->rate = SAMPLINGSCREEN_DEFAULT_RATE;
+   this->threadsByTid = Hashtable_new(16, false);
+   FunctionBar* fuBar = FunctionBar_new(SamplingScreenFunctions, SamplingScreenKeys, SamplingScreenEvents);
+   /* samples are taken between keys, at their own pace */
+   CRT_disableDelay();
+   InfoScreen_init(&this->super, process, fuBar, LINES - 2, SamplingScreen_callsHeader);
+   this->super.waitMs = 0;
+   return this;
+}
+
+static void SamplingScreen_reset(SamplingScreen* this) {
+   for (size_t i = 0; i < this->threadCount; i++) {
+      free(this->threads[i]->counts);
+      free(this->threads[i]);
+   }
+   free(this->threads);
+   this->threads = NULL;
+   this->threadCount = 0;
+   Hashtable_clear(this->threadsByTid);
+
+   for (size_t i = 0; i < this->activityCount; i++)
+      free(this->activities[i]);
+   free(this->activities);
+   this->activities = NULL;
+   this->activityCount = 0;
+
+   this->samples = 0;
+   this->stacksUnreadable = false;
+}
+
+void SamplingScreen_delete(Object* cast) {
+   SamplingScreen* this = (SamplingScreen*) cast;
+   SamplingScreen_reset(this);
+   Hashtable_delete(this->threadsByTid);
+   free(this->current);
+   CRT_enableDelay();
+   free(InfoScreen_done(&this->super));
+}
+
+static void SamplingScreen_draw(InfoScreen* super) {
+   const SamplingScreen* this = (const SamplingScreen*) super;
+   InfoScreen_drawTitled(super, "Sampling %sprocess %d every %d ms, %u samples%s%s - %s",
+      this->stacks ? "kernel stacks of " : "",
+      this->pid, SamplingScreen_intervals[this->rate], this->samples,
+      this->failed ? " (stopped)" : "",
+      this->stacksUnreadable ? " (stacks need root)" : "",
+      Process_getCommand(super->process));
+}
+
+static size_t SamplingScreen_activity(SamplingScreen* this, const ThreadSample* sample) {
+   char activity[sizeof(sample->stack) + 8];
+   if (sample->state == 'R')
+      String_safeStrncpy(activity, "running", sizeof(activity));
+   else if (this->stacks && sample->stack[0])
+      xSnprintf(activity, sizeof(activity), "%c %s", sample->state, sample->stack);
+   else if (sample->syscall[0] && sample->wchan[0])
+      xSnprintf(activity, sizeof(activity), "%c %s (%s)", sample->state, sample->syscall, sample->wchan);
+   else if (sample->syscall[0])
+      xSnprintf(activity, sizeof(activity), "%c %s", sample->state, sample->syscall);
+   else if (sample->wchan[0])
+      xSnprintf(activity, sizeof(activity), "%c (%s)", sample->state, sample->wchan);
+   else
+      xSnprintf(activity, sizeof(activity), "%c", sample->state);
+
+   /* there are only a few distinct ones */
+   for (size_t i = 0; i < this->activityCount; i++) {
+      if (String_eq(this->activities[i], activity))
+         return i;
+   }
+
+   this->activities = xReallocArray(this->activities, this->activityCount + 1, sizeof(char*));
+   this->activities[this->activityCount] = xStrdup(activity);
+   return this->activityCount++;
+}
+
+static void SamplingScreen_sample(SamplingScreen* this) {
+   size_t count = 0;
+   this->failed = !Platform_sampleThreads(this->pid, this->stacks, &this->current, &count, &this->currentCapacity);
+   if (this->failed)
+      return;
+
+   this->samples++;
+   for (size_t i = 0; i < count; i++) {
+      const ThreadSample* sample = &this->current[i];
+      if (this->stacks && sample->state != 'R' && !sample->stack[0])
+         this->stacksUnreadable = true;
+
+      SamplingThread* thread = Hashtable_get(this->threadsByTid, sample->tid);
+      if (!thread) {
+         thread = xCalloc(1, sizeof(SamplingThread));
+         thread->tid = sample->tid;
+         this->threads = xReallocArray(this->threads, this->threadCount + 1, sizeof(SamplingThread*));
+         this->threads[this->threadCount++] = thread;
+         Hashtable_put(this->threadsByTid, sample->tid, thread);
+      }
+      String_safeStrncpy(thread->name, sample->name, sizeof(thread->name));
+
+      size_t activity = SamplingScreen_activity(this, sample);
+      if (activity >= thread->countCapacity) {
+         size_t capacity = MAXIMUM(this->activityCount, 2 * thread->countCapacity);
+         thread->counts = xReallocArrayZero(thread->counts, thread->countCapacity, capacity, sizeof(unsigned int));
+         thread->countCapacity = capacity;
+      }
+      thread->counts[activity]++;
+      thread->samples++;
+   }
+}
+
+typedef struct SamplingScreen_Row_ {
+   const SamplingThread* thread;  /* NULL for all threads together */
+   size_t activity;
+   unsigned int count;
+} SamplingScreen_Row;
+
+static int SamplingScreen_compareRows(const void* v1, const void* v2) {
+   const SamplingScreen_Row* r1 = v1;
+   const SamplingScreen_Row* r2 = v2;
+   pid_t tid1 = r1->thread ? r1->thread->tid : 0;
+   pid_t tid2 = r2->thread ? r2->thread->tid : 0;
+   if (tid1 != tid2)
+      return tid1 < tid2 ? -1 : 1;
+   if (r1->count != r2->count)
+      return r1->count > r2->count ? -1 : 1;
+   return (r1->activity > r2->activity) - (r1->activity < r2->activity);
+}
+
+/* The histogram of all threads together, then the one of each thread, the most frequent activities first */
+static void SamplingScreen_scan(InfoScreen* super) {
+   SamplingScreen* this = (SamplingScreen*) super;
+   Panel* panel = super->display;
+   int idx = Panel_getSelectedIndex(panel);
+   Panel_prune(panel);
+
+   if (this->samples == 0)
+      SamplingScreen_sample(this);
+   if (this->samples == 0) {
+      InfoScreen_addLine(super, "Could not sample the threads of the process.");
+      Panel_setSelected(panel, idx);
+      return;
+   }
+
+   unsigned int* totals = xCalloc(this->activityCount, sizeof(unsigned int));
+   unsigned int total = 0;
+   size_t rowCount = 0;
+   for (size_t i = 0; i < this->threadCount; i++) {
+      const SamplingThread* thread = this->threads[i];
+      for (size_t a = 0; a < MINIMUM(thread->countCapacity, this->activityCount); a++) {
+         totals[a] += thread->counts[a];
+         rowCount += thread->counts[a] > 0;
+      }
+      total += thread->samples;
+   }
+
+   SamplingScreen_Row* rows = xMallocArray(rowCount + this->activityCount, sizeof(SamplingScreen_Row));
+   size_t n = 0;
+   for (size_t a = 0; a < this->activityCount; a++) {
+      if (totals[a])
+         rows[n++] = (SamplingScreen_Row) { .thread = NULL, .activity = a, .count = totals[a] };
+   }
+   for (size_t i = 0; i < this->threadCount; i++) {
+      const SamplingThread* thread = this->threads[i];
+      for (size_t a = 0; a < thread->countCapacity; a++) {
+         if (thread->counts[a])
+            rows[n++] = (SamplingScreen_Row) { .thread = thread, .activity = a, .count = thread->counts[a] };
+      }
+   }
+   qsort(rows, n, sizeof(SamplingScreen_Row), SamplingScreen_compareRows);
+
+   for (size_t i = 0; i < n; i++) {
+      const SamplingScreen_Row* row = &rows[i];
+      char tid[16];
+      if (row->thread)
+         xSnprintf(tid, sizeof(tid), "%d", row->thread->tid);
+      else
+         String_safeStrncpy(tid, "all", sizeof(tid));
+
+      if (i > 0 && row->thread != rows[i - 1].thread)
+         InfoScreen_addLine(super, "");
+
+      char entry[1200];
+      unsigned int of = row->thread ? row->thread->samples : total;
+      xSnprintf(entry, sizeof(entry), "%8u %6.1f%%  %7s  %-15s  %s",
+         row->count, 100.0 * row->count / MAXIMUM(of, 1u), tid,
+         row->thread ? row->thread->name : "", this->activities[row->activity]);
+      InfoScreen_addLine(super, entry);
+   }
+
+   free(rows);
+   free(totals);
+   Panel_setSelected(panel, idx);
+}
+
+static void SamplingScreen_refresh(SamplingScreen* this) {
+   Vector_prune(this->super.lines);
+   SamplingScreen_scan(&this->super);
+   InfoScreen_draw(this);
+}
+
+/* Called whenever no key was pressed in time; waits for the next key at most until the next sample is due */
+static void SamplingScreen_onErr(InfoScreen* super) {
+   SamplingScreen* this = (SamplingScreen*) super;
+   uint64_t now;
+   Platform_gettime_monotonic(&now);
+
+   if (now >= this->nextSample) {
+      SamplingScreen_sample(this);
+      this->nextSample += SamplingScreen_intervals[this->rate];
+      if (this->nextSample <= now)
+         this->nextSample = now + SamplingScreen_intervals[this->rate];
+   }
+   if (now >= this->nextRefresh) {
+      SamplingScreen_refresh(this);
+      this->nextRefresh = now + SAMPLINGSCREEN_REFRESH_MS;
+   }
+
+   uint64_t next = MINIMUM(this->nextSample, this->nextRefresh);
+   super->waitMs = next > now ? (int)(next - now) : 0;
+}
+
+static bool SamplingScreen_onKey(InfoScreen* super, int ch) {
+   SamplingScreen* this = (SamplingScreen*) super;
+   switch (ch) {
+      case 's':
+      case KEY_F(6):
+         /* the histograms of both are not comparable */
+         this->stacks = !this->stacks;
+         FunctionBar_setLabel(super->display->defaultBar, KEY_F(6), this->stacks ? "Calls  " : "Stacks ");
+         Panel_setHeader(super->display, this->stacks ? SamplingScreen_stacksHeader : SamplingScreen_callsHeader);
+         SamplingScreen_reset(this);
+         SamplingScreen_refresh(this);
+         return true;
+      case '-':
+      case KEY_F(7):
+         if (this->rate + 1 < ARRAYSIZE(SamplingScreen_intervals))
+            this->rate++;
+         InfoScreen_draw(this);
+         return true;
+      case '+':
+      case KEY_F(8):
+         if (this->rate > 0)
+            this->rate--;
+         InfoScreen_draw(this);
+         return true;
+      case KEY_F(9):
+         SamplingScreen_reset(this);
+         SamplingScreen_refresh(this);
+         return true;
+   }
+   return false;
+}
+
+const InfoScreenClass SamplingScreen_class = {
+   .super = {
+      .extends = Class(Object),
+      .delete = SamplingScreen_delete
+   },
+   .scan = SamplingScreen_scan,
+   .draw = SamplingScreen_draw,
+   .onErr = SamplingScreen_onErr,
+   .onKey = SamplingScreen_onKey
+};
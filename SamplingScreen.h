@@ -0,0 +1,72 @@
+#ifndef HEADER_SamplingScreen
+#define HEADER_SamplingScreen
+/*
+htop - SamplingScreen.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "Hashtable.h"
+#include "InfoScreen.h"
+#include "Object.h"
+#include "Process.h"
+
+
+/* What a thread was doing when it was sampled */
+typedef struct ThreadSample_ {
+   pid_t tid;
+   char state;                /* letter as in /proc/PID/stat */
+   char name[16];
+   char syscall[32];          /* system call it is blocked in, empty if none */
+   char wchan[64];            /* kernel function it waits in, empty if none */
+   char stack[1024];          /* kernel functions it waits in, innermost first, empty if unknown */
+} ThreadSample;
+
+typedef struct SamplingThread_ {
+   pid_t tid;
+   char name[16];
+   unsigned int samples;
+   unsigned int* counts;      /* by activity */
+   size_t countCapacity;
+} SamplingThread;
+
+/*
+ * Samples what the threads of a process are doing, from the outside and at
+ * a rate of its own, and keeps a histogram of it per thread; an alternative
+ * to tracing which does not slow the process down.
+ */
+typedef struct SamplingScreen_ {
+   InfoScreen super;
+   pid_t pid;
+   size_t rate;               /* index into the sampling intervals */
+   uint64_t nextSample;       /* monotonic time in milliseconds */
+   uint64_t nextRefresh;
+   unsigned int samples;
+   bool failed;               /* the last sample could not be taken */
+   bool stacks;               /* sample kernel stacks instead of system calls */
+   bool stacksUnreadable;     /* waiting threads were sampled without their stack */
+
+   ThreadSample* current;
+   size_t currentCapacity;
+
+   char** activities;
+   size_t activityCount;
+
+   SamplingThread** threads;
+   size_t threadCount;
+   Hashtable* threadsByTid;
+} SamplingScreen;
+
+extern const InfoScreenClass SamplingScreen_class;
+
+SamplingScreen* SamplingScreen_new(const Process* process);
+
+void SamplingScreen_delete(Object* cast);
+
+#endif
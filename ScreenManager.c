@@ -11,15 +11,20 @@ in the source distribution for its full text.
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <sys/time.h>
 
 #include "CRT.h"
+#include "EventLoop.h"
 #include "FunctionBar.h"
+#include "Macros.h"
 #include "Object.h"
 #include "Platform.h"
 #include "ProcessList.h"
+#include "Profile.h"
 #include "ProvideCurses.h"
+#include "Sampler.h"
 #include "XUtils.h"
 
 
@@ -108,6 +113,7 @@ static void checkRecalculation(ScreenManager* this, double* oldTime, int* sortTi
       ProcessList_scan(pl, this->state->pauseProcessUpdate);
       // always update header, especially to avoid gaps in graph meters
       Header_updateData(this->header);
+      ProcessList_afterScan(pl);
       if (!this->state->pauseProcessUpdate && (*sortTimeout == 0 || this->settings->treeView)) {
          ProcessList_sort(pl);
          *sortTimeout = 1;
@@ -120,12 +126,125 @@ static void checkRecalculation(ScreenManager* this, double* oldTime, int* sortTi
    }
    if (*redraw) {
       ProcessList_rebuildPanel(pl);
+
+      ProfileMark mark;
+      Profile_begin(&mark);
       Header_draw(this->header);
+      Profile_end(&mark, PROFILE_DRAW);
    }
    *rescan = false;
 }
 
+/* Like checkRecalculation, but picks up the scans done by the sampler thread */
+static void checkSampler(ScreenManager* this, Sampler* sampler, int* uidDigits, int* sortTimeout, bool* redraw, bool* rescan, bool* force_redraw) {
+   ProcessList* pl = this->header->pl;
+
+   if (*rescan) {
+      Sampler_requestScan(sampler);
+      *rescan = false;
+   }
+
+   /* shared with nested screen managers, so none misses a scan another one picked up */
+   if (Sampler_generation(sampler) != sampler->shownGeneration) {
+      sampler->shownGeneration = Sampler_generation(sampler);
+      if (!this->state->pauseProcessUpdate && (*sortTimeout == 0 || this->settings->treeView)) {
+         ProcessList_sort(pl);
+         *sortTimeout = 1;
+      }
+      // force redraw if the number of UID digits was changed
+      if (Process_uidDigits != *uidDigits) {
+         *uidDigits = Process_uidDigits;
+         *force_redraw = true;
+      }
+      *redraw = true;
+   }
+   if (*redraw) {
+      ProcessList_rebuildPanel(pl);
+
+      ProfileMark mark;
+      Profile_begin(&mark);
+      Header_draw(this->header);
+      Profile_end(&mark, PROFILE_DRAW);
+   }
+}
+
+/* Keys which only move around in a panel, these are handled while a scan is paused */
+static bool isNavigationKey(int ch) {
+   switch (ch) {
+   case KEY_UP:
+   case KEY_DOWN:
+   case KEY_LEFT:
+   case KEY_RIGHT:
+   case KEY_CTRL('P'):
+   case KEY_CTRL('N'):
+   case KEY_CTRL('B'):
+   case KEY_CTRL('F'):
+   case KEY_ALT('H'):
+   case KEY_ALT('J'):
+   case KEY_ALT('K'):
+   case KEY_ALT('L'):
+   case KEY_PPAGE:
+   case KEY_NPAGE:
+   case KEY_HOME:
+   case KEY_END:
+   case KEY_WHEELUP:
+   case KEY_WHEELDOWN:
+      return true;
+   default:
+      return false;
+   }
+}
+
+static void ScreenManager_drawProfileLine(int y, const Panel* panel, int attr, const char* line) {
+   attrset(CRT_colors[attr]);
+   mvhline(y, panel->x, ' ', panel->w);
+   mvaddnstr(y, panel->x, line, panel->w);
+   attrset(CRT_colors[RESET_COLOR]);
+}
+
+/* Shows the refresh cycle profile over the bottom of the given panel */
+static void ScreenManager_drawProfile(const Panel* panel) {
+   enum { LINES_BEFORE = 2, LINES_AFTER = 1 };
+   const int top = panel->y + 1;
+   const int bottom = panel->y + panel->h;
+   int y = MAXIMUM(top, bottom - (LINES_BEFORE + PROFILE_PHASES + LINES_AFTER));
+   char buffer[256];
+   ProfileStats stats;
+
+   unsigned int cycles = Profile_cycles();
+   if (cycles) {
+      xSnprintf(buffer, sizeof(buffer), " Refresh cycle profile, last %u cycles (press ! to hide)", cycles);
+   } else {
+      xSnprintf(buffer, sizeof(buffer), " Refresh cycle profile, waiting for the first complete cycle (press ! to hide)");
+   }
+   ScreenManager_drawProfileLine(y++, panel, PANEL_SELECTION_UNFOCUS, buffer);
+
+   xSnprintf(buffer, sizeof(buffer), " %-34s %7s %7s %8s %8s %8s %8s %8s",
+             "Phase", "calls", "files", "allocs", "avg ms", "p50 ms", "p95 ms", "max ms");
+   ScreenManager_drawProfileLine(y++, panel, PANEL_HEADER_FOCUS, buffer);
+
+   for (int phase = 0; phase < PROFILE_PHASES && y < bottom; phase++) {
+      Profile_getStats(phase, &stats);
+      bool nested = Profile_parent(phase) != PROFILE_PHASES;
+      xSnprintf(buffer, sizeof(buffer), " %s%-*s %7.1f %7.1f %8.1f %8.2f %8.2f %8.2f %8.2f",
+                nested ? "  " : "", nested ? 32 : 34, Profile_phaseName(phase),
+                stats.calls, stats.files, stats.allocations, stats.avgMs, stats.p50Ms, stats.p95Ms, stats.maxMs);
+      ScreenManager_drawProfileLine(y++, panel, DEFAULT_COLOR, buffer);
+   }
+
+   if (y < bottom) {
+      Profile_getStats(PROFILE_PHASES, &stats);
+      xSnprintf(buffer, sizeof(buffer), " %-34s %7s %7.1f %8.1f %8.2f %8.2f %8.2f %8.2f",
+                "Total", "", stats.files, stats.allocations, stats.avgMs, stats.p50Ms, stats.p95Ms, stats.maxMs);
+      ScreenManager_drawProfileLine(y, panel, PANEL_HEADER_UNFOCUS, buffer);
+   }
+}
+
 static void ScreenManager_drawPanels(ScreenManager* this, int focus, bool force_redraw) {
+   const Panel* profilePanel = NULL;
+   ProfileMark mark;
+   Profile_begin(&mark);
+
    const int nPanels = this->panelCount;
    for (int i = 0; i < nPanels; i++) {
       Panel* panel = (Panel*) Vector_get(this->panels, i);
@@ -135,7 +254,15 @@ static void ScreenManager_drawPanels(ScreenManager* this, int focus, bool force_
                  panel != (Panel*)this->state->mainPanel || !this->state->hideProcessSelection,
                  State_hideFunctionBar(this->state));
       mvvline(panel->y, panel->x + panel->w, ' ', panel->h + (State_hideFunctionBar(this->state) ? 1 : 0));
+
+      if (panel == (Panel*)this->state->mainPanel && this->state->showProfile)
+         profilePanel = panel;
    }
+
+   Profile_end(&mark, PROFILE_DRAW);
+
+   if (profilePanel)
+      ScreenManager_drawProfile(profilePanel);
 }
 
 void ScreenManager_run(ScreenManager* this, Panel** lastFocus, int* lastKey) {
@@ -156,12 +283,28 @@ void ScreenManager_run(ScreenManager* this, Panel** lastFocus, int* lastKey) {
    int sortTimeout = 0;
    int resetSortTimeout = 5;
 
+   /*
+    * With a sampler thread the data is held (as on entry) except while
+    * waiting for input. While a scan is running, navigation keys are handled
+    * as soon as it pauses (see Sampler_acquirePaused), on the panel as it is;
+    * any other key waits for the scan and a rebuilt panel.
+    */
+   Sampler* sampler = (this->header && this->state) ? this->state->sampler : NULL;
+   EventLoop* events = sampler ? this->state->events : NULL;
+   int uidDigits = Process_uidDigits;
+   bool holding = true;
+   bool paused = false;
+
    while (!quit) {
       if (this->header) {
-         checkRecalculation(this, &oldTime, &sortTimeout, &redraw, &rescan, &timedOut, &force_redraw);
+         if (!sampler) {
+            checkRecalculation(this, &oldTime, &sortTimeout, &redraw, &rescan, &timedOut, &force_redraw);
+         } else if (holding && !paused) {
+            checkSampler(this, sampler, &uidDigits, &sortTimeout, &redraw, &rescan, &force_redraw);
+         }
       }
 
-      if (redraw || force_redraw) {
+      if ((redraw || force_redraw) && holding) {
          ScreenManager_drawPanels(this, focus, force_redraw);
          force_redraw = false;
       }
@@ -170,7 +313,44 @@ void ScreenManager_run(ScreenManager* this, Panel** lastFocus, int* lastKey) {
 #ifdef HAVE_SET_ESCDELAY
       set_escdelay(25);
 #endif
-      ch = getch();
+      uint64_t waitStart = 0;
+      if (sampler) {
+         if (holding)
+            Sampler_release(sampler);
+         holding = false;
+         paused = false;
+         Platform_gettime_monotonic(&waitStart);
+      }
+
+      if (events) {
+         /* the sampler wakes the wait up after each scan */
+         CRT_disableDelay();
+         ch = EventLoop_getch(events);
+         CRT_enableDelay();
+      } else {
+         ch = getch();
+      }
+
+      if (sampler) {
+         uint64_t waitEnd;
+         Platform_gettime_monotonic(&waitEnd);
+         /* Only an immediate return without a key hints at a closed terminal */
+         timedOut = waitEnd - waitStart >= 50;
+
+         if (ch == ERR) {
+            holding = Sampler_tryAcquire(sampler);
+         } else if (isNavigationKey(ch)) {
+            paused = Sampler_acquirePaused(sampler);
+            holding = true;
+         } else {
+            Sampler_acquire(sampler);
+            holding = true;
+         }
+
+         /* a scan finishing meanwhile leaves the panel with processes no longer listed */
+         if (holding && !paused && ch != ERR)
+            checkSampler(this, sampler, &uidDigits, &sortTimeout, &redraw, &rescan, &force_redraw);
+      }
 
       HandlerResult result = IGNORED;
 #ifdef HAVE_GETMOUSE
@@ -324,6 +504,13 @@ defaultHandler:
       }
    }
 
+   /* Callers get the data back the way they handed it over */
+   if (sampler && (!holding || paused)) {
+      if (holding)
+         Sampler_release(sampler);
+      Sampler_acquire(sampler);
+   }
+
    if (lastFocus) {
       *lastFocus = panelFocus;
    }
@@ -0,0 +1,449 @@
+/*
+htop - Server.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "Server.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "BatchOutput.h"
+#include "Macros.h"
+#include "Platform.h"
+#include "Process.h"
+#include "ProcessList.h"
+#include "Recorder.h"
+#include "XUtils.h"
+
+
+/* Clients with more output pending are too slow and get disconnected */
+#define SERVER_MAX_PENDING (16 * 1024 * 1024)
+
+#ifdef MSG_NOSIGNAL
+#define SERVER_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SERVER_SEND_FLAGS 0
+#endif
+
+static bool Server_setNonBlocking(int fd) {
+   int flags = fcntl(fd, F_GETFL);
+   return flags >= 0 &&
+          fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0 &&
+          fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+}
+
+/* A socket left behind by a server which is gone can be replaced */
+static bool Server_isStale(const struct sockaddr_un* addr) {
+   struct stat st;
+   if (lstat(addr->sun_path, &st) != 0 || !S_ISSOCK(st.st_mode))
+      return false;
+
+   int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd < 0)
+      return false;
+
+   bool stale = connect(fd, (const struct sockaddr*)addr, sizeof(*addr)) != 0 && errno == ECONNREFUSED;
+   close(fd);
+   return stale;
+}
+
+static int Server_bind(int fd, const struct sockaddr_un* addr) {
+   /* the socket gets the permissions of the umask */
+   mode_t mask = umask(S_IRWXG | S_IRWXO);
+   int r = bind(fd, (const struct sockaddr*)addr, sizeof(*addr));
+   umask(mask);
+   return r;
+}
+
+Server* Server_new(const char* path, const ProcessField* defaultFields, char* error, size_t errorSize) {
+   struct sockaddr_un addr;
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   if (strlen(path) >= sizeof(addr.sun_path)) {
+      xSnprintf(error, errorSize, "path too long");
+      return NULL;
+   }
+   String_safeStrncpy(addr.sun_path, path, sizeof(addr.sun_path));
+
+   int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd < 0 || !Server_setNonBlocking(fd)) {
+      xSnprintf(error, errorSize, "%s", strerror(errno));
+      if (fd >= 0)
+         close(fd);
+      return NULL;
+   }
+
+   int r = Server_bind(fd, &addr);
+   if (r != 0 && errno == EADDRINUSE && Server_isStale(&addr)) {
+      unlink(path);
+      r = Server_bind(fd, &addr);
+   }
+   if (r != 0 || listen(fd, 16) != 0) {
+      xSnprintf(error, errorSize, "%s", strerror(errno));
+      close(fd);
+      return NULL;
+   }
+
+   size_t count = 0;
+   while (defaultFields[count])
+      count++;
+
+   Server* this = xCalloc(1, sizeof(Server));
+   this->path = xStrdup(path);
+   this->fd = fd;
+   this->defaultFields = xCalloc(count + 1, sizeof(ProcessField));
+   memcpy(this->defaultFields, defaultFields, count * sizeof(ProcessField));
+   return this;
+}
+
+static void ServerClient_delete(ServerClient* this) {
+   close(this->fd);
+   free(this->fields);
+   free(this->pids);
+   free(this->user);
+   Recorder_delete(this->recorder);
+   free(this->pending);
+   free(this);
+}
+
+void Server_delete(Server* this) {
+   if (!this)
+      return;
+
+   for (size_t i = 0; i < this->clientCount; i++)
+      ServerClient_delete(this->clients[i]);
+   free(this->clients);
+   close(this->fd);
+   unlink(this->path);
+   free(this->path);
+   free(this->defaultFields);
+   free(this);
+}
+
+static void ServerClient_append(ServerClient* this, const char* data, size_t size) {
+   if (this->pendingStart > 0 && this->pendingStart == this->pendingSize)
+      this->pendingStart = this->pendingSize = 0;
+
+   if (this->pendingSize + size > this->pendingCapacity) {
+      /* drop what was written before growing */
+      memmove(this->pending, this->pending + this->pendingStart, this->pendingSize - this->pendingStart);
+      this->pendingSize -= this->pendingStart;
+      this->pendingStart = 0;
+   }
+   if (this->pendingSize + size > this->pendingCapacity) {
+      this->pendingCapacity = MAXIMUM(this->pendingSize + size, 2 * this->pendingCapacity);
+      this->pending = xRealloc(this->pending, this->pendingCapacity);
+   }
+   memcpy(this->pending + this->pendingSize, data, size);
+   this->pendingSize += size;
+}
+
+/* Returns false if the client is gone */
+static bool ServerClient_flush(ServerClient* this) {
+   while (this->pendingStart < this->pendingSize) {
+      ssize_t written = send(this->fd, this->pending + this->pendingStart, this->pendingSize - this->pendingStart, SERVER_SEND_FLAGS);
+      if (written < 0) {
+         if (errno == EINTR)
+            continue;
+         return errno == EAGAIN || errno == EWOULDBLOCK;
+      }
+      this->pendingStart += (size_t)written;
+   }
+   return this->mode != SERVER_CLOSING;
+}
+
+/* Discards anything sent after the request; returns false if the client is gone */
+static bool ServerClient_drain(ServerClient* this) {
+   char buffer[256];
+   for (;;) {
+      ssize_t n = read(this->fd, buffer, sizeof(buffer));
+      if (n == 0)
+         return false;
+      if (n < 0)
+         return errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK;
+   }
+}
+
+static void ServerClient_fail(ServerClient* this, const char* message) {
+   char line[256];
+   xSnprintf(line, sizeof(line), "{\"error\":\"%s\"}\n", message);
+   ServerClient_append(this, line, strlen(line));
+   this->mode = SERVER_CLOSING;
+}
+
+static bool ServerClient_parseFields(ServerClient* this, const char* list) {
+   size_t count = 0;
+   char** names = String_split(list, ',', &count);
+   free(this->fields);
+   this->fields = xCalloc(count + 1, sizeof(ProcessField));
+
+   bool valid = count > 0;
+   for (size_t i = 0; i < count && valid; i++) {
+      this->fields[i] = Process_fieldByName(names[i]);
+      valid = this->fields[i] != NULL_PROCESSFIELD;
+   }
+   String_freeArray(names);
+   return valid;
+}
+
+static bool ServerClient_parsePids(ServerClient* this, const char* list) {
+   size_t count = 0;
+   char** pids = String_split(list, ',', &count);
+   free(this->pids);
+   this->pids = xCalloc(MAXIMUM(count, 1), sizeof(pid_t));
+   this->pidCount = count;
+
+   bool valid = count > 0;
+   for (size_t i = 0; i < count && valid; i++) {
+      char* end;
+      long pid = strtol(pids[i], &end, 10);
+      valid = end != pids[i] && *end == '\0' && pid > 0 && pid <= INT32_MAX;
+      this->pids[i] = (pid_t)pid;
+   }
+   String_freeArray(pids);
+   return valid;
+}
+
+static void ServerClient_parseRequest(ServerClient* this, const char* line) {
+   size_t count = 0;
+   char** words = String_split(line, ' ', &count);
+
+   if (count < 2 || !String_eq(words[0], SERVER_PROTOCOL)) {
+      ServerClient_fail(this, "unsupported protocol, expected " SERVER_PROTOCOL);
+      goto out;
+   }
+
+   if (String_eq(words[1], "snapshot")) {
+      this->mode = SERVER_SNAPSHOT;
+   } else if (String_eq(words[1], "watch")) {
+      this->mode = SERVER_WATCH;
+   } else if (String_eq(words[1], "record")) {
+      this->mode = SERVER_RECORD;
+      this->recorder = Recorder_newBuffer();
+   } else {
+      ServerClient_fail(this, "unknown mode");
+      goto out;
+   }
+
+   for (size_t i = 2; i < count; i++) {
+      if (String_startsWith(words[i], "fields=")) {
+         if (!ServerClient_parseFields(this, words[i] + strlen("fields="))) {
+            ServerClient_fail(this, "invalid fields");
+            goto out;
+         }
+      } else if (String_startsWith(words[i], "pid=")) {
+         if (!ServerClient_parsePids(this, words[i] + strlen("pid="))) {
+            ServerClient_fail(this, "invalid pid");
+            goto out;
+         }
+      } else if (String_startsWith(words[i], "user=") && words[i][strlen("user=")]) {
+         free_and_xStrdup(&this->user, words[i] + strlen("user="));
+      } else {
+         ServerClient_fail(this, "invalid option");
+         goto out;
+      }
+   }
+
+out:
+   String_freeArray(words);
+}
+
+/* Reads the request line as far as it came; returns false if the client is gone */
+static bool ServerClient_read(ServerClient* this) {
+   for (;;) {
+      char* newline = memchr(this->request, '\n', this->requestSize);
+      if (newline) {
+         *newline = '\0';
+         if (newline > this->request && newline[-1] == '\r')
+            newline[-1] = '\0';
+         ServerClient_parseRequest(this, this->request);
+         return true;
+      }
+      if (this->requestSize == sizeof(this->request)) {
+         ServerClient_fail(this, "request too long");
+         return true;
+      }
+
+      ssize_t n = read(this->fd, this->request + this->requestSize, sizeof(this->request) - this->requestSize);
+      if (n == 0)
+         return false;
+      if (n < 0) {
+         if (errno == EINTR)
+            continue;
+         return errno == EAGAIN || errno == EWOULDBLOCK;
+      }
+      this->requestSize += (size_t)n;
+   }
+}
+
+static bool Server_matches(const Process* p, void* data) {
+   const ServerClient* client = data;
+
+   if (client->pidCount) {
+      bool found = false;
+      for (size_t i = 0; i < client->pidCount && !found; i++)
+         found = client->pids[i] == p->pid;
+      if (!found)
+         return false;
+   }
+
+   if (client->user) {
+      char uid[16];
+      xSnprintf(uid, sizeof(uid), "%u", (unsigned int)p->st_uid);
+      if (!String_eq(client->user, uid) && !(p->user && String_eq(client->user, p->user)))
+         return false;
+   }
+
+   return true;
+}
+
+static void Server_writeJson(const Server* this, ServerClient* client, ProcessList* pl) {
+   char* data = NULL;
+   size_t size = 0;
+   FILE* out = open_memstream(&data, &size);
+   if (!out) {
+      ServerClient_fail(client, "out of memory");
+      return;
+   }
+
+   BatchOutput_writeJson(out, pl, client->fields ? client->fields : this->defaultFields, Server_matches, client);
+   fclose(out);
+   ServerClient_append(client, data, size);
+   free(data);
+}
+
+static void Server_accept(Server* this) {
+   for (;;) {
+      int fd = accept(this->fd, NULL, NULL);
+      if (fd < 0) {
+         if (errno == EINTR)
+            continue;
+         return;
+      }
+      if (!Server_setNonBlocking(fd)) {
+         close(fd);
+         continue;
+      }
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+      int on = 1;
+      setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+      if (this->clientCount == this->clientCapacity) {
+         this->clientCapacity = MAXIMUM(8, 2 * this->clientCapacity);
+         this->clients = xReallocArray(this->clients, this->clientCapacity, sizeof(ServerClient*));
+      }
+      ServerClient* client = xCalloc(1, sizeof(ServerClient));
+      client->fd = fd;
+      client->mode = SERVER_REQUEST;
+      this->clients[this->clientCount++] = client;
+   }
+}
+
+void Server_addMeter(Server* this, const struct Meter_* meter) {
+   for (size_t i = 0; i < this->clientCount; i++) {
+      ServerClient* client = this->clients[i];
+      if (client->mode == SERVER_RECORD && client->started)
+         Recorder_addMeter(client->recorder, meter);
+   }
+}
+
+/* Answers the client as far as it is due; returns false if it is gone */
+static bool Server_serve(Server* this, ServerClient* client, ProcessList* pl, bool updated) {
+   if (client->mode == SERVER_REQUEST && !ServerClient_read(client))
+      return false;
+
+   switch (client->mode) {
+      case SERVER_SNAPSHOT:
+         Server_writeJson(this, client, pl);
+         client->mode = SERVER_CLOSING;
+         break;
+      case SERVER_WATCH:
+         if (updated)
+            Server_writeJson(this, client, pl);
+         break;
+      case SERVER_RECORD:
+         if (updated && client->started) {
+            Recorder* recorder = client->recorder;
+            Recorder_writeSample(recorder, pl);
+            ServerClient_append(client, recorder->output.data, recorder->output.size);
+            recorder->output.size = 0;
+         }
+         break;
+      default:
+         break;
+   }
+
+   if (!ServerClient_flush(client))
+      return false;
+
+   /* after the first update, the meters of the next one are collected */
+   if (client->mode == SERVER_RECORD)
+      client->started = true;
+
+   return client->pendingSize - client->pendingStart <= SERVER_MAX_PENDING;
+}
+
+void Server_update(Server* this, ProcessList* pl, bool updated) {
+   Server_accept(this);
+
+   size_t kept = 0;
+   for (size_t i = 0; i < this->clientCount; i++) {
+      ServerClient* client = this->clients[i];
+      if (Server_serve(this, client, pl, updated)) {
+         this->clients[kept++] = client;
+      } else {
+         ServerClient_delete(client);
+      }
+   }
+   this->clientCount = kept;
+}
+
+void Server_wait(Server* this, ProcessList* pl, uint64_t ms) {
+   uint64_t now;
+   Platform_gettime_monotonic(&now);
+   uint64_t deadline = now + ms;
+
+   struct pollfd* fds = NULL;
+   while (now < deadline) {
+      /* the listening socket, clients still to send their request and ones with output pending */
+      fds = xReallocArray(fds, this->clientCount + 1, sizeof(struct pollfd));
+      fds[0] = (struct pollfd) { .fd = this->fd, .events = POLLIN };
+      for (size_t i = 0; i < this->clientCount; i++) {
+         const ServerClient* client = this->clients[i];
+         short events = POLLIN;
+         if (client->pendingStart < client->pendingSize)
+            events |= POLLOUT;
+         fds[i + 1] = (struct pollfd) { .fd = client->fd, .events = events };
+      }
+
+      int timeout = (int)MINIMUM(deadline - now, (uint64_t)INT32_MAX);
+      int ready = poll(fds, (nfds_t)(this->clientCount + 1), timeout);
+      if (ready > 0) {
+         for (size_t i = 0; i < this->clientCount; i++) {
+            ServerClient* client = this->clients[i];
+            if (client->mode != SERVER_REQUEST && (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) && !ServerClient_drain(client)) {
+               client->mode = SERVER_CLOSING;
+               client->pendingStart = client->pendingSize;
+            }
+         }
+         Server_update(this, pl, false);
+      }
+
+      Platform_gettime_monotonic(&now);
+   }
+   free(fds);
+}
@@ -0,0 +1,99 @@
+#ifndef HEADER_Server
+#define HEADER_Server
+/*
+htop - Server.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "Process.h"
+
+
+struct Meter_;
+struct ProcessList_;
+struct Recorder_;
+
+/*
+ * Protocol: the client sends one request line,
+ *
+ *    HTOP/1 <mode> [fields=COLUMN,...] [pid=PID,...] [user=NAME|UID]
+ *
+ * where mode is one of
+ *
+ *    snapshot  one JSON line of the processes, as by --batch=json, then the
+ *              connection is closed
+ *    watch     one such line with every update
+ *    record    a recording (see Recording.h) of every update from now on,
+ *              with all processes and the header meters, as read by --attach
+ *
+ * Columns default to the ones configured on the server, the filters apply to
+ * the JSON modes only. A bad request is answered with {"error":"..."} and the
+ * connection closed.
+ */
+#define SERVER_PROTOCOL "HTOP/1"
+
+typedef enum ServerMode_ {
+   SERVER_REQUEST,            /* waiting for the request line */
+   SERVER_SNAPSHOT,
+   SERVER_WATCH,
+   SERVER_RECORD,
+   SERVER_CLOSING,            /* closed once its output is written */
+} ServerMode;
+
+typedef struct ServerClient_ {
+   int fd;
+   ServerMode mode;
+
+   char request[1024];
+   size_t requestSize;
+
+   ProcessField* fields;
+   pid_t* pids;
+   size_t pidCount;
+   char* user;
+   bool started;              /* a record client's meters are collected from the update after it connected */
+   struct Recorder_* recorder;
+
+   /* output not yet written */
+   char* pending;
+   size_t pendingStart;
+   size_t pendingSize;
+   size_t pendingCapacity;
+} ServerClient;
+
+/*
+ * Serves the process list on a Unix domain socket, see above. All work is
+ * done by the thread which scans, after each scan, so clients are answered
+ * with the next update; clients which do not keep up are disconnected.
+ */
+typedef struct Server_ {
+   char* path;
+   int fd;
+   ProcessField* defaultFields;
+
+   ServerClient** clients;
+   size_t clientCount;
+   size_t clientCapacity;
+} Server;
+
+/* Listens on a new socket at path, accessible to the user only; returns NULL and describes the problem in error on failure */
+Server* Server_new(const char* path, const ProcessField* defaultFields, char* error, size_t errorSize);
+
+void Server_delete(Server* this);
+
+/* Passes a meter updated for the next sample on to the record clients */
+void Server_addMeter(Server* this, const struct Meter_* meter);
+
+/* Accepts and answers clients; updated is whether the process list was scanned since the last call */
+void Server_update(Server* this, struct ProcessList_* pl, bool updated);
+
+/* Waits for the given time, answering snapshot requests right away instead of with the next update */
+void Server_wait(Server* this, struct ProcessList_* pl, uint64_t ms);
+
+#endif
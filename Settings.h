@@ -38,6 +38,7 @@ typedef struct Settings_ {
    uint32_t flags;
    int colorScheme;
    int delay;
+   int updateBudget;  /* CPU usage the updates may cause, in tenths of a percent of one CPU; 0 - fixed interval */
 
    int direction;
    int treeDirection;
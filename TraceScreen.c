@@ -21,6 +21,7 @@ in the source distribution for its full text.
 #include <sys/wait.h>
 
 #include "CRT.h"
+#include "EventLoop.h"
 #include "FunctionBar.h"
 #include "Panel.h"
 #include "ProvideCurses.h"
@@ -33,6 +34,9 @@ static const char* const TraceScreenKeys[] = {"F3", "F4", "F8", "F9", "Esc"};
 
 static const int TraceScreenEvents[] = {KEY_F(3), KEY_F(4), KEY_F(8), KEY_F(9), 27};
 
+/* the trace of a busy process grows quickly, so only its most recent lines are kept */
+#define TRACESCREEN_MAX_LINES 50000
+
 TraceScreen* TraceScreen_new(const Process* process) {
    // This initializes all TraceScreen variables to "false" so only default = true ones need to be set below
    TraceScreen* this = xCalloc(1, sizeof(TraceScreen));
@@ -40,7 +44,9 @@ TraceScreen* TraceScreen_new(const Process* process) {
    this->tracing = true;
    FunctionBar* fuBar = FunctionBar_new(TraceScreenFunctions, TraceScreenKeys, TraceScreenEvents);
    CRT_disableDelay();
-   return (TraceScreen*) InfoScreen_init(&this->super, process, fuBar, LINES - 2, " ");
+   InfoScreen_init(&this->super, process, fuBar, LINES - 2, " ");
+   InfoScreen_setMaxLines(&this->super, TRACESCREEN_MAX_LINES);
+   return this;
 }
 
 void TraceScreen_delete(Object* cast) {
@@ -51,6 +57,8 @@ void TraceScreen_delete(Object* cast) {
    }
 
    if (this->strace) {
+      if (this->super.events)
+         EventLoop_removeSource(this->super.events, fileno(this->strace));
       fclose(this->strace);
    }
 
@@ -104,6 +112,11 @@ bool TraceScreen_forkTracer(TraceScreen* this) {
 
    this->child = child;
    this->strace = fd;
+
+   /* the trace is read whenever the wait for keys ends, so the pipe only needs to end it too */
+   if (this->super.events)
+      EventLoop_addSource(this->super.events, fdpair[0], false, NULL, NULL);
+
    return true;
 
 err:
@@ -127,14 +140,19 @@ static void TraceScreen_updateTrace(InfoScreen* super) {
    struct timeval tv = { .tv_sec = 0, .tv_usec = 500 };
    int ready = select(fd_strace + 1, &fds, NULL, NULL, &tv);
 
-   size_t nread = 0;
+   /* read unbuffered, data held back by stdio would not wake the event loop */
+   ssize_t nread = 0;
    if (ready > 0 && FD_ISSET(fd_strace, &fds))
-      nread = fread(buffer, 1, sizeof(buffer) - 1, this->strace);
+      nread = read(fd_strace, buffer, sizeof(buffer) - 1);
+
+   /* the pipe stays readable once strace exited */
+   if (nread == 0 && ready > 0 && this->super.events)
+      EventLoop_removeSource(this->super.events, fd_strace);
 
-   if (nread && this->tracing) {
+   if (nread > 0 && this->tracing) {
       const char* line = buffer;
       buffer[nread] = '\0';
-      for (size_t i = 0; i < nread; i++) {
+      for (ssize_t i = 0; i < nread; i++) {
          if (buffer[i] == '\n') {
             buffer[i] = '\0';
             if (this->contLine) {
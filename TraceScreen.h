@@ -32,6 +32,7 @@ TraceScreen* TraceScreen_new(const Process* process);
 
 void TraceScreen_delete(Object* cast);
 
+/* Call after InfoScreen_setState, so new trace lines also end the wait for keys */
 bool TraceScreen_forkTracer(TraceScreen* this);
 
 #endif
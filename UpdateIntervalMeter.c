@@ -0,0 +1,70 @@
+/*
+htop - UpdateIntervalMeter.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "UpdateIntervalMeter.h"
+
+#include "CRT.h"
+#include "Macros.h"
+#include "Object.h"
+#include "ProcessList.h"
+#include "RichString.h"
+#include "Settings.h"
+#include "XUtils.h"
+
+
+static const int UpdateIntervalMeter_attributes[] = {
+   METER_VALUE
+};
+
+static uint64_t UpdateIntervalMeter_intervalMs(const Meter* this) {
+   const ProcessList* pl = this->pl;
+   return pl->updateIntervalMs ? pl->updateIntervalMs : (uint64_t)pl->settings->delay * 100;
+}
+
+static void UpdateIntervalMeter_updateValues(Meter* this) {
+   uint64_t interval = UpdateIntervalMeter_intervalMs(this);
+   this->values[0] = interval / 1000.0;
+   this->total = MAXIMUM(this->total, this->values[0]);
+
+   xSnprintf(this->txtBuffer, sizeof(this->txtBuffer), "%.1fs", this->values[0]);
+}
+
+static void UpdateIntervalMeter_display(const Object* cast, RichString* out) {
+   const Meter* this = (const Meter*)cast;
+   const ProcessList* pl = this->pl;
+   const Settings* settings = pl->settings;
+   char buffer[64];
+   int len;
+
+   bool stretched = UpdateIntervalMeter_intervalMs(this) > (uint64_t)settings->delay * 100;
+   RichString_appendAscii(out, CRT_colors[stretched ? METER_VALUE_NOTICE : METER_VALUE], this->txtBuffer);
+
+   if (settings->updateBudget <= 0)
+      return;
+
+   len = xSnprintf(buffer, sizeof(buffer), " (%d.%d%% budget, %.1fms CPU per update)",
+                   settings->updateBudget / 10, settings->updateBudget % 10, pl->updateCostUs / 1000.0);
+   RichString_appendnAscii(out, CRT_colors[METER_TEXT], buffer, len);
+}
+
+const MeterClass UpdateIntervalMeter_class = {
+   .super = {
+      .extends = Class(Meter),
+      .delete = Meter_delete,
+      .display = UpdateIntervalMeter_display,
+   },
+   .updateValues = UpdateIntervalMeter_updateValues,
+   .defaultMode = TEXT_METERMODE,
+   .maxItems = 1,
+   .total = 1.0,
+   .attributes = UpdateIntervalMeter_attributes,
+   .name = "UpdateInterval",
+   .uiName = "Update interval",
+   .caption = "Update: "
+};
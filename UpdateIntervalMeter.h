@@ -0,0 +1,15 @@
+#ifndef HEADER_UpdateIntervalMeter
+#define HEADER_UpdateIntervalMeter
+/*
+htop - UpdateIntervalMeter.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "Meter.h"
+
+
+extern const MeterClass UpdateIntervalMeter_class;
+
+#endif
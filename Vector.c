@@ -232,6 +232,20 @@ Object* Vector_take(Vector* this, int idx) {
    return removed;
 }
 
+void Vector_removeRange(Vector* this, int idx, int count) {
+   assert(idx >= 0 && count >= 0 && idx + count <= this->items);
+   assert(Vector_isConsistent(this));
+   if (this->owner) {
+      for (int i = idx; i < idx + count; i++)
+         Object_delete(this->array[i]);
+   }
+   this->items -= count;
+   if (idx < this->items) {
+      memmove(&this->array[idx], &this->array[idx + count], (this->items - idx) * sizeof(this->array[0]));
+   }
+   assert(Vector_isConsistent(this));
+}
+
 Object* Vector_remove(Vector* this, int idx) {
    Object* removed = Vector_take(this, idx);
    if (this->owner) {
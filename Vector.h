@@ -44,6 +44,9 @@ Object* Vector_take(Vector* this, int idx);
 
 Object* Vector_remove(Vector* this, int idx);
 
+/* Removes count items at once, moving the following ones only once */
+void Vector_removeRange(Vector* this, int idx, int count);
+
 void Vector_moveUp(Vector* this, int idx);
 
 void Vector_moveDown(Vector* this, int idx);
@@ -10,6 +10,7 @@ in the source distribution for its full text.
 #include "XUtils.h"
 
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <stdarg.h>
@@ -19,6 +20,7 @@ in the source distribution for its full text.
 #include <unistd.h>
 
 #include "CRT.h"
+#include "Profile.h"
 
 
 void fail() {
@@ -30,6 +32,7 @@ void fail() {
 
 void* xMalloc(size_t size) {
    assert(size > 0);
+   Profile_countAllocation();
    void* data = malloc(size);
    if (!data) {
       fail();
@@ -52,6 +55,7 @@ void* xCalloc(size_t nmemb, size_t size) {
    if (SIZE_MAX / nmemb < size) {
       fail();
    }
+   Profile_countAllocation();
    void* data = calloc(nmemb, size);
    if (!data) {
       fail();
@@ -61,6 +65,7 @@ void* xCalloc(size_t nmemb, size_t size) {
 
 void* xRealloc(void* ptr, size_t size) {
    assert(size > 0);
+   Profile_countAllocation();
    void* data = realloc(ptr, size); // deepcode ignore MemoryLeakOnRealloc: this goes to fail()
    if (!data) {
       free(ptr);
@@ -98,6 +103,12 @@ inline bool String_contains_i(const char* s1, const char* s2) {
    return strcasestr(s1, s2) != NULL;
 }
 
+void String_lowerCopy(char* restrict dest, const char* restrict src, size_t n) {
+   for (size_t i = 0; i < n; i++)
+      dest[i] = (char) tolower((unsigned char) src[i]);
+   dest[n] = '\0';
+}
+
 char* String_cat(const char* s1, const char* s2) {
    const size_t l1 = strlen(s1);
    const size_t l2 = strlen(s2);
@@ -225,9 +236,55 @@ size_t String_safeStrncpy(char* restrict dest, const char* restrict src, size_t
    return i;
 }
 
+static const char String_digitPairs[201] =
+   "0001020304050607080910111213141516171819"
+   "2021222324252627282930313233343536373839"
+   "4041424344454647484950515253545556575859"
+   "6061626364656667686970717273747576777879"
+   "8081828384858687888990919293949596979899";
+
+size_t String_formatUnsigned(char* buffer, unsigned long long value, size_t width, char pad) {
+   char digits[20];
+   char* start = digits + sizeof(digits);
+
+   /* Two digits per division, looked up from a table */
+   while (value >= 100) {
+      unsigned int pair = (unsigned int)(value % 100) * 2;
+      value /= 100;
+      start -= 2;
+      memcpy(start, &String_digitPairs[pair], 2);
+   }
+   if (value >= 10) {
+      start -= 2;
+      memcpy(start, &String_digitPairs[value * 2], 2);
+   } else {
+      *--start = (char)('0' + value);
+   }
+
+   size_t len = (size_t)(digits + sizeof(digits) - start);
+   size_t fill = width > len ? width - len : 0;
+   memset(buffer, pad, fill);
+   memcpy(buffer + fill, start, len);
+   return fill + len;
+}
+
+size_t String_formatSigned(char* buffer, long long value, size_t width) {
+   if (value >= 0)
+      return String_formatUnsigned(buffer, (unsigned long long)value, width, ' ');
+
+   char digits[20];
+   size_t len = String_formatUnsigned(digits, -(unsigned long long)value, 0, ' ');
+   size_t fill = width > len + 1 ? width - len - 1 : 0;
+   memset(buffer, ' ', fill);
+   buffer[fill] = '-';
+   memcpy(buffer + fill + 1, digits, len);
+   return fill + 1 + len;
+}
+
 int xAsprintf(char** strp, const char* fmt, ...) {
    va_list vl;
    va_start(vl, fmt);
+   Profile_countAllocation();
    int r = vasprintf(strp, fmt, vl);
    va_end(vl);
 
@@ -252,6 +309,7 @@ int xSnprintf(char* buf, size_t len, const char* fmt, ...) {
 }
 
 char* xStrdup(const char* str) {
+   Profile_countAllocation();
    char* data = strdup(str);
    if (!data) {
       fail();
@@ -268,6 +326,7 @@ void free_and_xStrdup(char** ptr, const char* str) {
 }
 
 char* xStrndup(const char* str, size_t len) {
+   Profile_countAllocation();
    char* data = strndup(str, len);
    if (!data) {
       fail();
@@ -309,6 +368,7 @@ static ssize_t readfd_internal(int fd, void* buffer, size_t count) {
 }
 
 ssize_t xReadfile(const char* pathname, void* buffer, size_t count) {
+   Profile_countFile();
    int fd = open(pathname, O_RDONLY);
    if (fd < 0)
       return -errno;
@@ -317,6 +377,7 @@ ssize_t xReadfile(const char* pathname, void* buffer, size_t count) {
 }
 
 ssize_t xReadfileat(openat_arg_t dirfd, const char* pathname, void* buffer, size_t count) {
+   Profile_countFile();
    int fd = Compat_openat(dirfd, pathname, O_RDONLY);
    if (fd < 0)
       return -errno;
@@ -42,6 +42,9 @@ static inline bool String_startsWith(const char* s, const char* match) {
 
 bool String_contains_i(const char* s1, const char* s2);
 
+/* Copies the first n bytes of src into dest, case-folded; dest is null-terminated and must hold n + 1 bytes */
+void String_lowerCopy(char* restrict dest, const char* restrict src, size_t n);
+
 static inline bool String_eq(const char* s1, const char* s2) {
    return strcmp(s1, s2) == 0;
 }
@@ -61,6 +64,15 @@ char* String_readLine(FILE* fd) ATTR_MALLOC;
 /* Always null-terminates dest. Caller must pass a strictly positive size. */
 size_t String_safeStrncpy(char* restrict dest, const char* restrict src, size_t size);
 
+/*
+ * Fast replacements for "%*llu" and "%*lld" in rendering paths: writes the
+ * number right-aligned in a field of at least width characters, padded with
+ * pad (spaces for signed numbers). The result is not null-terminated; buffer
+ * must hold MAXIMUM(width, 20) characters. Returns the number of characters written.
+ */
+size_t String_formatUnsigned(char* buffer, unsigned long long value, size_t width, char pad);
+size_t String_formatSigned(char* buffer, long long value, size_t width);
+
 ATTR_FORMAT(printf, 2, 3)
 int xAsprintf(char** strp, const char* fmt, ...);
 
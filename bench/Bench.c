@@ -0,0 +1,63 @@
+/*
+htop - bench/Bench.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "bench/Bench.h"
+
+#include <locale.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "CRT.h"
+#include "Settings.h"
+
+
+/* the fastest of these runs is reported, the others absorb warm-up and noise */
+#define BENCH_RUNS 5
+
+volatile uint64_t Bench_sink;
+
+static Settings Bench_settings = { .delay = DEFAULT_DELAY };
+
+void Bench_init(void) {
+   /* the wide character paths need a UTF-8 locale, the same one for every run */
+   if (!setlocale(LC_CTYPE, "C.UTF-8"))
+      setlocale(LC_CTYPE, "");
+
+   CRT_initHeadless(&Bench_settings);
+}
+
+uint64_t Bench_nowNs(void) {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void Bench_run(const char* name, size_t ops, Bench_Function setup, Bench_Function fn, void* data) {
+   uint64_t best = UINT64_MAX;
+   for (int i = 0; i < BENCH_RUNS; i++) {
+      if (setup)
+         setup(data, ops);
+
+      uint64_t start = Bench_nowNs();
+      fn(data, ops);
+      uint64_t elapsed = Bench_nowNs() - start;
+      if (elapsed < best)
+         best = elapsed;
+   }
+   Bench_report(name, ops, best);
+}
+
+void Bench_report(const char* name, size_t ops, uint64_t ns) {
+   printf("  %-48s %12.1f ns/op %10zu ops\n", name, (double)ns / (double)(ops ? ops : 1), ops);
+   fflush(stdout);
+}
+
+void Bench_section(const char* title) {
+   printf("%s\n", title);
+}
@@ -0,0 +1,33 @@
+#ifndef HEADER_Bench
+#define HEADER_Bench
+/*
+htop - bench/Bench.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* Runs the measured operation ops times */
+typedef void(*Bench_Function)(void* data, size_t ops);
+
+/* Results stored here are not optimized away */
+extern volatile uint64_t Bench_sink;
+
+/* Sets up the locale and the headless color scheme the drawing code needs */
+void Bench_init(void);
+
+uint64_t Bench_nowNs(void);
+
+/* Runs fn a few times and prints the fastest run in ns per operation, setup (if any) runs untimed before each run */
+void Bench_run(const char* name, size_t ops, Bench_Function setup, Bench_Function fn, void* data);
+
+/* Prints a time measured by the benchmark itself */
+void Bench_report(const char* name, size_t ops, uint64_t ns);
+
+void Bench_section(const char* title);
+
+#endif
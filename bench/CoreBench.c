@@ -0,0 +1,510 @@
+/*
+htop - bench/CoreBench.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Hashtable.h"
+#include "Macros.h"
+#include "Object.h"
+#include "RichString.h"
+#include "Vector.h"
+#include "XUtils.h"
+#include "bench/Bench.h"
+
+#ifdef HTOP_LINUX
+#include "linux/LinuxProcessList.h"
+#endif
+
+
+/* Microbenchmarks of the containers and string helpers the hot paths are built from */
+
+#define HASHTABLE_KEYS 100000
+#define HASHTABLE_SIZE 65521   /* a prime, so Hashtable_new() keeps it and the load factor is exact */
+#define VECTOR_ITEMS 10000
+#define CALLS 1000000
+
+/* added to a key replaced in the churn, beyond all keys made up front */
+#define CHURN_OFFSET (2 * 32 * HASHTABLE_KEYS)
+
+static uint32_t CoreBench_seed = 2463534242U;
+
+/* xorshift32, the same sequence on every run */
+static uint32_t CoreBench_random(void) {
+   CoreBench_seed ^= CoreBench_seed << 13;
+   CoreBench_seed ^= CoreBench_seed >> 17;
+   CoreBench_seed ^= CoreBench_seed << 5;
+   return CoreBench_seed;
+}
+
+static char CoreBench_value;
+
+/* Hashtable */
+
+typedef struct HashtableBench_ {
+   Hashtable* table;
+   ht_key_t* keys;
+   ht_key_t* missing;
+   size_t count;
+} HashtableBench;
+
+static void HashtableBench_put(void* data, size_t ops) {
+   HashtableBench* this = data;
+   Hashtable* table = Hashtable_new(0, false);
+   for (size_t i = 0; i < ops; i++)
+      Hashtable_put(table, this->keys[i], &CoreBench_value);
+   Hashtable_delete(table);
+}
+
+static void HashtableBench_get(void* data, size_t ops) {
+   const HashtableBench* this = data;
+   uint64_t found = 0;
+   for (size_t i = 0; i < ops; i++)
+      found += Hashtable_get(this->table, this->keys[i % this->count]) != NULL;
+   Bench_sink = found;
+}
+
+static void HashtableBench_getMissing(void* data, size_t ops) {
+   const HashtableBench* this = data;
+   uint64_t found = 0;
+   for (size_t i = 0; i < ops; i++)
+      found += Hashtable_get(this->table, this->missing[i % this->count]) != NULL;
+   Bench_sink = found;
+}
+
+static void HashtableBench_fill(void* data, size_t ops) {
+   HashtableBench* this = data;
+   if (this->table)
+      Hashtable_delete(this->table);
+   this->table = Hashtable_new(0, false);
+   for (size_t i = 0; i < ops; i++)
+      Hashtable_put(this->table, this->keys[i], &CoreBench_value);
+}
+
+/* Removes every key, as when all processes of a big list went away */
+static void HashtableBench_drain(void* data, size_t ops) {
+   const HashtableBench* this = data;
+   for (size_t i = 0; i < ops; i++)
+      Hashtable_remove(this->table, this->keys[i]);
+}
+
+/* Replaces one key by a new one, as processes come and go */
+static void HashtableBench_churn(void* data, size_t ops) {
+   HashtableBench* this = data;
+   for (size_t i = 0; i < ops; i++) {
+      size_t slot = i % this->count;
+      Hashtable_remove(this->table, this->keys[slot]);
+      this->keys[slot] += CHURN_OFFSET;
+      Hashtable_put(this->table, this->keys[slot], &CoreBench_value);
+   }
+}
+
+/*
+ * Like PIDs: ascending with gaps, spread over a range much larger than the
+ * table. The keys are even, the missing keys are the odd ones in between.
+ */
+static void CoreBench_makeKeys(ht_key_t* keys, ht_key_t* missing) {
+   ht_key_t pid = 1;
+   for (size_t i = 0; i < HASHTABLE_KEYS; i++) {
+      pid += 1 + CoreBench_random() % 32;
+      keys[i] = 2 * pid;
+      missing[i] = 2 * pid + 1;
+   }
+}
+
+static void HashtableBench_run(void) {
+   Bench_section("Hashtable");
+
+   HashtableBench bench = {
+      .keys = xMallocArray(HASHTABLE_KEYS, sizeof(ht_key_t)),
+      .missing = xMallocArray(HASHTABLE_KEYS, sizeof(ht_key_t)),
+   };
+
+   CoreBench_makeKeys(bench.keys, bench.missing);
+
+   bench.count = HASHTABLE_KEYS;
+   Bench_run("put, growing from the default size", HASHTABLE_KEYS, NULL, HashtableBench_put, &bench);
+
+   static const struct {
+      const char* get;
+      const char* miss;
+      const char* churn;
+      double load;
+   } loads[] = {
+      { "get, load factor 0.25", "get missing key, load factor 0.25", "remove and put, load factor 0.25", 0.25 },
+      { "get, load factor 0.50", "get missing key, load factor 0.50", "remove and put, load factor 0.50", 0.50 },
+      { "get, load factor 0.70", "get missing key, load factor 0.70", "remove and put, load factor 0.70", 0.70 },
+   };
+   for (size_t l = 0; l < ARRAYSIZE(loads); l++) {
+      bench.count = (size_t)(loads[l].load * HASHTABLE_SIZE);
+      bench.table = Hashtable_new(HASHTABLE_SIZE, false);
+      for (size_t i = 0; i < bench.count; i++)
+         Hashtable_put(bench.table, bench.keys[i], &CoreBench_value);
+
+      Bench_run(loads[l].get, CALLS, NULL, HashtableBench_get, &bench);
+      Bench_run(loads[l].miss, CALLS, NULL, HashtableBench_getMissing, &bench);
+      Bench_run(loads[l].churn, CALLS / 10, NULL, HashtableBench_churn, &bench);
+
+      Hashtable_delete(bench.table);
+      bench.table = NULL;
+   }
+
+   /* the churn changed the keys, start over for the removals */
+   CoreBench_makeKeys(bench.keys, bench.missing);
+   bench.count = HASHTABLE_KEYS;
+   Bench_run("remove all, shrinking", HASHTABLE_KEYS / 10, HashtableBench_fill, HashtableBench_drain, &bench);
+
+   Hashtable_delete(bench.table);
+   free(bench.keys);
+   free(bench.missing);
+}
+
+/* Vector */
+
+typedef struct BenchItem_ {
+   Object super;
+   int value;
+} BenchItem;
+
+static int BenchItem_compare(const void* v1, const void* v2) {
+   const BenchItem* i1 = v1;
+   const BenchItem* i2 = v2;
+   return SPACESHIP_NUMBER(i1->value, i2->value);
+}
+
+static const ObjectClass BenchItem_class = {
+   .extends = Class(Object),
+   .compare = BenchItem_compare
+};
+
+typedef struct VectorBench_ {
+   Vector* vector;
+   BenchItem* items;
+} VectorBench;
+
+static void VectorBench_add(void* data, size_t ops) {
+   VectorBench* this = data;
+   Vector* vector = Vector_new(Class(BenchItem), false, DEFAULT_SIZE);
+   for (size_t i = 0; i < ops; i++)
+      Vector_add(vector, &this->items[i]);
+   Vector_delete(vector);
+}
+
+static void VectorBench_fill(VectorBench* this, size_t ops) {
+   Vector_prune(this->vector);
+   for (size_t i = 0; i < ops; i++)
+      Vector_add(this->vector, &this->items[i]);
+}
+
+/* Sorted but for a few swapped neighbours, like a process list between two refreshes */
+static void VectorBench_fillNearlySorted(void* data, size_t ops) {
+   VectorBench* this = data;
+   for (size_t i = 0; i < ops; i++)
+      this->items[i].value = (int)i;
+   for (size_t i = 0; i < ops / 100; i++) {
+      size_t at = CoreBench_random() % (ops - 1);
+      int tmp = this->items[at].value;
+      this->items[at].value = this->items[at + 1].value;
+      this->items[at + 1].value = tmp;
+   }
+   VectorBench_fill(this, ops);
+}
+
+static void VectorBench_fillShuffled(void* data, size_t ops) {
+   VectorBench* this = data;
+   for (size_t i = 0; i < ops; i++)
+      this->items[i].value = (int)(CoreBench_random() % ops);
+   VectorBench_fill(this, ops);
+}
+
+static void VectorBench_insertionSort(void* data, ATTR_UNUSED size_t ops) {
+   VectorBench* this = data;
+   Vector_insertionSort(this->vector);
+}
+
+static void VectorBench_quickSort(void* data, ATTR_UNUSED size_t ops) {
+   VectorBench* this = data;
+   Vector_quickSortCustomCompare(this->vector, BenchItem_compare);
+}
+
+static void VectorBench_prune(void* data, ATTR_UNUSED size_t ops) {
+   VectorBench* this = data;
+   Vector_prune(this->vector);
+}
+
+static void VectorBench_insertFront(void* data, size_t ops) {
+   VectorBench* this = data;
+   for (size_t i = 0; i < ops; i++)
+      Vector_insert(this->vector, 0, &this->items[i]);
+}
+
+static void VectorBench_takeFront(void* data, size_t ops) {
+   VectorBench* this = data;
+   for (size_t i = 0; i < ops; i++)
+      Bench_sink += (uint64_t)(uintptr_t)Vector_take(this->vector, 0);
+}
+
+static void VectorBench_fillAny(void* data, size_t ops) {
+   VectorBench_fill(data, ops);
+}
+
+static void VectorBench_run(void) {
+   Bench_section("Vector");
+
+   VectorBench bench = {
+      .vector = Vector_new(Class(BenchItem), false, DEFAULT_SIZE),
+      .items = xCalloc(VECTOR_ITEMS, sizeof(BenchItem)),
+   };
+   for (size_t i = 0; i < VECTOR_ITEMS; i++) {
+      Object_setClass(&bench.items[i], Class(BenchItem));
+      bench.items[i].value = (int)i;
+   }
+
+   /* the sorts are reported per item sorted */
+   Bench_run("add", VECTOR_ITEMS, NULL, VectorBench_add, &bench);
+   Bench_run("insertionSort, nearly sorted (per item)", VECTOR_ITEMS, VectorBench_fillNearlySorted, VectorBench_insertionSort, &bench);
+   Bench_run("quickSortCustomCompare, nearly sorted (per item)", VECTOR_ITEMS, VectorBench_fillNearlySorted, VectorBench_quickSort, &bench);
+   Bench_run("quickSortCustomCompare, shuffled (per item)", VECTOR_ITEMS, VectorBench_fillShuffled, VectorBench_quickSort, &bench);
+   Bench_run("insert at the front", VECTOR_ITEMS, VectorBench_prune, VectorBench_insertFront, &bench);
+   Bench_run("take from the front", VECTOR_ITEMS, VectorBench_fillAny, VectorBench_takeFront, &bench);
+
+   Vector_delete(bench.vector);
+   free(bench.items);
+}
+
+/* RichString and String_contains_i, on command lines */
+
+static const char* const CoreBench_commands[] = {
+   "/usr/lib/systemd/systemd --switched-root --system --deserialize 31",
+   "/usr/bin/python3 -s /usr/bin/jupyter-lab --no-browser --port=8888",
+   "postgres: checkpointer",
+   "/usr/lib/firefox/firefox -contentproc -childID 12 -isForBrowser -prefsLen 31337 -parentBuildID 20221010",
+   "[kworker/u16:2-events_unbound]",
+   "/opt/app/bin/java -Xmx4g -XX:+UseG1GC -jar /opt/app/lib/service.jar --spring.profiles.active=prod",
+   "sshd: admin@pts/0",
+   "bash",
+};
+
+static const char* const CoreBench_wideCommands[] = {
+   "/usr/bin/python3 /home/jörg/Übungen/täglich.py --größe=10",
+   "/usr/bin/mpv /srv/media/音楽/東京の夜.flac",
+   "vim /home/user/notes/résumé-draft-ñ.md",
+};
+
+typedef struct StringBench_ {
+   const char* const* strings;
+   size_t count;
+   const char* needle;
+} StringBench;
+
+static void StringBench_appendAscii(void* data, size_t ops) {
+   const StringBench* this = data;
+   for (size_t i = 0; i < ops; i++) {
+      RichString_begin(str);
+      RichString_appendAscii(&str, 0, this->strings[i % this->count]);
+      Bench_sink += (uint64_t)RichString_sizeVal(str);
+      RichString_delete(&str);
+   }
+}
+
+static void StringBench_appendWide(void* data, size_t ops) {
+   const StringBench* this = data;
+   for (size_t i = 0; i < ops; i++) {
+      RichString_begin(str);
+      RichString_appendWide(&str, 0, this->strings[i % this->count]);
+      Bench_sink += (uint64_t)RichString_sizeVal(str);
+      RichString_delete(&str);
+   }
+}
+
+static void StringBench_appendnWideColumns(void* data, size_t ops) {
+   const StringBench* this = data;
+   for (size_t i = 0; i < ops; i++) {
+      const char* s = this->strings[i % this->count];
+      int columns = 40;
+      RichString_begin(str);
+      RichString_appendnWideColumns(&str, 0, s, strlen(s), &columns);
+      Bench_sink += (uint64_t)RichString_sizeVal(str);
+      RichString_delete(&str);
+   }
+}
+
+static void StringBench_appendChr(ATTR_UNUSED void* data, size_t ops) {
+   for (size_t i = 0; i < ops; i++) {
+      RichString_begin(str);
+      RichString_appendChr(&str, 0, ' ', 24);
+      Bench_sink += (uint64_t)RichString_sizeVal(str);
+      RichString_delete(&str);
+   }
+}
+
+static void StringBench_contains(void* data, size_t ops) {
+   const StringBench* this = data;
+   uint64_t found = 0;
+   for (size_t i = 0; i < ops; i++)
+      found += String_contains_i(this->strings[i % this->count], this->needle);
+   Bench_sink = found;
+}
+
+static void StringBench_run(void) {
+   StringBench ascii = { .strings = CoreBench_commands, .count = ARRAYSIZE(CoreBench_commands) };
+   StringBench wide = { .strings = CoreBench_wideCommands, .count = ARRAYSIZE(CoreBench_wideCommands) };
+
+   Bench_section("RichString, per command line");
+   Bench_run("appendAscii", CALLS, NULL, StringBench_appendAscii, &ascii);
+   Bench_run("appendWide, ASCII", CALLS, NULL, StringBench_appendWide, &ascii);
+   Bench_run("appendWide, UTF-8", CALLS, NULL, StringBench_appendWide, &wide);
+   Bench_run("appendnWideColumns 40 columns, ASCII", CALLS, NULL, StringBench_appendnWideColumns, &ascii);
+   Bench_run("appendnWideColumns 40 columns, UTF-8", CALLS, NULL, StringBench_appendnWideColumns, &wide);
+   Bench_run("appendChr, 24 spaces", CALLS, NULL, StringBench_appendChr, NULL);
+
+   Bench_section("String_contains_i, per command line");
+   ascii.needle = "JAVA";
+   Bench_run("matching some", CALLS, NULL, StringBench_contains, &ascii);
+   ascii.needle = "nosuchcommand";
+   Bench_run("matching none", CALLS, NULL, StringBench_contains, &ascii);
+}
+
+/* xReadfileat */
+
+typedef struct ReadfileBench_ {
+   int dirfd;
+   const char* name;
+} ReadfileBench;
+
+static void ReadfileBench_read(void* data, size_t ops) {
+   const ReadfileBench* this = data;
+   char buffer[4096];
+   for (size_t i = 0; i < ops; i++)
+      Bench_sink += (uint64_t)xReadfileat(this->dirfd, this->name, buffer, sizeof(buffer));
+}
+
+static void ReadfileBench_run(void) {
+   Bench_section("xReadfileat");
+
+   char dir[] = "/tmp/htop-bench-XXXXXX";
+   if (!mkdtemp(dir)) {
+      perror("mkdtemp");
+      return;
+   }
+
+   /* a /proc/PID/stat line */
+   static const char stat[] =
+      "1234 (postgres) S 1 1234 1234 0 -1 4194560 2841 0 12 0 153 97 0 0 20 0 1 0 4211 "
+      "224493568 6016 18446744073709551615 1 1 0 0 0 0 0 16785408 27137 0 0 0 17 3 0 0 0 0 0 0 0 0 0 0 0 0 0\n";
+
+   ReadfileBench bench = { .dirfd = open(dir, O_RDONLY | O_DIRECTORY), .name = "stat" };
+   int fd = openat(bench.dirfd, "stat", O_WRONLY | O_CREAT | O_TRUNC, 0600);
+   if (bench.dirfd >= 0 && fd >= 0 && write(fd, stat, sizeof(stat) - 1) == (ssize_t)(sizeof(stat) - 1))
+      Bench_run("stat file of 200 bytes, on a regular file system", CALLS / 10, NULL, ReadfileBench_read, &bench);
+   if (fd >= 0)
+      close(fd);
+
+   if (bench.dirfd >= 0) {
+      unlinkat(bench.dirfd, "stat", 0);
+      close(bench.dirfd);
+   }
+   rmdir(dir);
+
+#ifdef HTOP_LINUX
+   bench.dirfd = open("/proc/self", O_RDONLY | O_DIRECTORY);
+   if (bench.dirfd >= 0) {
+      Bench_run("/proc/self/stat", CALLS / 10, NULL, ReadfileBench_read, &bench);
+      bench.name = "statm";
+      Bench_run("/proc/self/statm", CALLS / 10, NULL, ReadfileBench_read, &bench);
+      close(bench.dirfd);
+   }
+#endif
+}
+
+/* fast_strtoull_* */
+
+#ifdef HTOP_LINUX
+
+static const char* const CoreBench_mapsLines[] = {
+   "55d4c0a00000-55d4c0a2e000 r--p 00000000 fd:01 1835019                    /usr/bin/bash",
+   "7f3a2c000000-7f3a2c021000 rw-p 00000000 00:00 0 ",
+   "7f3a2e4b1000-7f3a2e646000 r-xp 00028000 fd:01 2097305                    /usr/lib/x86_64-linux-gnu/libc.so.6",
+   "7ffd5e9f2000-7ffd5ea13000 rw-p 00000000 00:00 0                          [stack]",
+};
+
+/* The fields read from a maps line: start, end, offset, device and inode */
+static void StrtoullBench_fast(ATTR_UNUSED void* data, size_t ops) {
+   uint64_t sum = 0;
+   for (size_t i = 0; i < ops; i++) {
+      char* p = (char*) (uintptr_t) CoreBench_mapsLines[i % ARRAYSIZE(CoreBench_mapsLines)];
+      sum += fast_strtoull_hex(&p, 16);
+      p++;
+      sum += fast_strtoull_hex(&p, 16);
+      p += 6;
+      sum += fast_strtoull_hex(&p, 16);
+      p++;
+      sum += fast_strtoull_hex(&p, 4);
+      p++;
+      sum += fast_strtoull_hex(&p, 4);
+      p++;
+      sum += fast_strtoull_dec(&p, 20);
+   }
+   Bench_sink = sum;
+}
+
+static void StrtoullBench_libc(ATTR_UNUSED void* data, size_t ops) {
+   uint64_t sum = 0;
+   for (size_t i = 0; i < ops; i++) {
+      char* p = (char*) (uintptr_t) CoreBench_mapsLines[i % ARRAYSIZE(CoreBench_mapsLines)];
+      sum += strtoull(p, &p, 16);
+      sum += strtoull(p + 1, &p, 16);
+      sum += strtoull(p + 6, &p, 16);
+      sum += strtoull(p + 1, &p, 16);
+      sum += strtoull(p + 1, &p, 16);
+      sum += strtoull(p + 1, &p, 10);
+   }
+   Bench_sink = sum;
+}
+
+static void StrtoullBench_run(void) {
+   Bench_section("fast_strtoull_*, per maps line (six numbers)");
+   Bench_run("fast_strtoull_hex and fast_strtoull_dec", CALLS, NULL, StrtoullBench_fast, NULL);
+   Bench_run("strtoull, for comparison", CALLS, NULL, StrtoullBench_libc, NULL);
+}
+
+#endif
+
+int main(int argc, char** argv) {
+   static const struct {
+      const char* name;
+      void (*run)(void);
+   } groups[] = {
+      { "hashtable", HashtableBench_run },
+      { "vector", VectorBench_run },
+      { "string", StringBench_run },
+      { "readfile", ReadfileBench_run },
+#ifdef HTOP_LINUX
+      { "strtoull", StrtoullBench_run },
+#endif
+   };
+
+   Bench_init();
+
+   /* the groups named on the command line, all without */
+   for (size_t i = 0; i < ARRAYSIZE(groups); i++) {
+      bool wanted = argc < 2;
+      for (int a = 1; a < argc; a++)
+         wanted |= String_eq(argv[a], groups[i].name);
+      if (wanted)
+         groups[i].run();
+   }
+
+   return 0;
+}
@@ -0,0 +1,560 @@
+/*
+htop - bench/FormatBench.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include <limits.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "CRT.h"
+#include "Macros.h"
+#include "Process.h"
+#include "RichString.h"
+#include "XUtils.h"
+#include "bench/Bench.h"
+
+
+/*
+ * The process column formatters against the printf based versions they
+ * replaced, which are kept below as they were: first checks that both
+ * give the same cells for a range of values, then times them.
+ */
+
+#define SAMPLES 4096
+#define CHECKS 500000
+#define ROWS 200000
+
+static uint64_t FormatBench_seed = 88172645463325252ULL;
+
+/* xorshift64, the same sequence on every run */
+static uint64_t FormatBench_random(void) {
+   FormatBench_seed ^= FormatBench_seed << 13;
+   FormatBench_seed ^= FormatBench_seed >> 7;
+   FormatBench_seed ^= FormatBench_seed << 17;
+   return FormatBench_seed;
+}
+
+/* Spread over all magnitudes, as sizes, counts and times are */
+static unsigned long long FormatBench_randomMagnitude(unsigned int maxBits) {
+   unsigned int bits = (unsigned int)(FormatBench_random() % (maxBits + 1));
+   if (bits == 0)
+      return 0;
+   return FormatBench_random() >> (64 - bits);
+}
+
+/* Values with two decimals or less, a quarter of them exactly halfway for the rounding */
+static double FormatBench_randomFixed(double max, unsigned int decimals) {
+   double scale = decimals == 1 ? 10 : 100;
+   double value = (double)(FormatBench_random() % (unsigned long long)(max * scale)) / scale;
+   if (FormatBench_random() % 4 == 0)
+      value += 0.5 / scale;
+   else
+      value += (double)(FormatBench_random() % 1000) / (1000 * scale);
+   return value;
+}
+
+/* The printf based versions */
+
+static void FormatBench_printfBytes(RichString* str, unsigned long long number, bool coloring) {
+   char buffer[16];
+   int len;
+
+   int largeNumberColor = coloring ? CRT_colors[LARGE_NUMBER] : CRT_colors[PROCESS];
+   int processMegabytesColor = coloring ? CRT_colors[PROCESS_MEGABYTES] : CRT_colors[PROCESS];
+   int processGigabytesColor = coloring ? CRT_colors[PROCESS_GIGABYTES] : CRT_colors[PROCESS];
+   int shadowColor = coloring ? CRT_colors[PROCESS_SHADOW] : CRT_colors[PROCESS];
+   int processColor = CRT_colors[PROCESS];
+
+   if (number == ULLONG_MAX) {
+      //Invalid number
+      RichString_appendAscii(str, shadowColor, "  N/A ");
+      return;
+   }
+
+   number /= ONE_K;
+
+   if (number < 1000) {
+      //Plain number, no markings
+      len = xSnprintf(buffer, sizeof(buffer), "%5llu ", number);
+      RichString_appendnAscii(str, processColor, buffer, len);
+   } else if (number < 100000) {
+      //2 digit MB, 3 digit KB
+      len = xSnprintf(buffer, sizeof(buffer), "%2llu", number / 1000);
+      RichString_appendnAscii(str, processMegabytesColor, buffer, len);
+      number %= 1000;
+      len = xSnprintf(buffer, sizeof(buffer), "%03llu ", number);
+      RichString_appendnAscii(str, processColor, buffer, len);
+   } else if (number < 1000 * ONE_K) {
+      //3 digit MB
+      number /= ONE_K;
+      len = xSnprintf(buffer, sizeof(buffer), "%4lluM ", number);
+      RichString_appendnAscii(str, processMegabytesColor, buffer, len);
+   } else if (number < 10000 * ONE_K) {
+      //1 digit GB, 3 digit MB
+      number /= ONE_K;
+      len = xSnprintf(buffer, sizeof(buffer), "%1llu", number / 1000);
+      RichString_appendnAscii(str, processGigabytesColor, buffer, len);
+      number %= 1000;
+      len = xSnprintf(buffer, sizeof(buffer), "%03lluM ", number);
+      RichString_appendnAscii(str, processMegabytesColor, buffer, len);
+   } else if (number < 100000 * ONE_K) {
+      //2 digit GB, 1 digit MB
+      number /= 100 * ONE_K;
+      len = xSnprintf(buffer, sizeof(buffer), "%2llu", number / 10);
+      RichString_appendnAscii(str, processGigabytesColor, buffer, len);
+      number %= 10;
+      len = xSnprintf(buffer, sizeof(buffer), ".%1llu", number);
+      RichString_appendnAscii(str, processMegabytesColor, buffer, len);
+      RichString_appendAscii(str, processGigabytesColor, "G ");
+   } else if (number < 1000 * ONE_M) {
+      //3 digit GB
+      number /= ONE_M;
+      len = xSnprintf(buffer, sizeof(buffer), "%4lluG ", number);
+      RichString_appendnAscii(str, processGigabytesColor, buffer, len);
+   } else if (number < 10000ULL * ONE_M) {
+      //1 digit TB, 3 digit GB
+      number /= ONE_M;
+      len = xSnprintf(buffer, sizeof(buffer), "%1llu", number / 1000);
+      RichString_appendnAscii(str, largeNumberColor, buffer, len);
+      number %= 1000;
+      len = xSnprintf(buffer, sizeof(buffer), "%03lluG ", number);
+      RichString_appendnAscii(str, processGigabytesColor, buffer, len);
+   } else if (number < 100000 * ONE_M) {
+      //2 digit TB, 1 digit GB
+      number /= 100 * ONE_M;
+      len = xSnprintf(buffer, sizeof(buffer), "%2llu", number / 10);
+      RichString_appendnAscii(str, largeNumberColor, buffer, len);
+      number %= 10;
+      len = xSnprintf(buffer, sizeof(buffer), ".%1llu", number);
+      RichString_appendnAscii(str, processGigabytesColor, buffer, len);
+      RichString_appendAscii(str, largeNumberColor, "T ");
+   } else if (number < 10000ULL * ONE_G) {
+      //3 digit TB or 1 digit PB, 3 digit TB
+      number /= ONE_G;
+      len = xSnprintf(buffer, sizeof(buffer), "%4lluT ", number);
+      RichString_appendnAscii(str, largeNumberColor, buffer, len);
+   } else {
+      //2 digit PB and above
+      len = xSnprintf(buffer, sizeof(buffer), "%4.1lfP ", (double)number / ONE_T);
+      RichString_appendnAscii(str, largeNumberColor, buffer, len);
+   }
+}
+
+static void FormatBench_printfCount(RichString* str, unsigned long long number, bool coloring) {
+   char buffer[13];
+
+   int largeNumberColor = coloring ? CRT_colors[LARGE_NUMBER] : CRT_colors[PROCESS];
+   int processMegabytesColor = coloring ? CRT_colors[PROCESS_MEGABYTES] : CRT_colors[PROCESS];
+   int processColor = CRT_colors[PROCESS];
+   int processShadowColor = coloring ? CRT_colors[PROCESS_SHADOW] : CRT_colors[PROCESS];
+
+   if (number == ULLONG_MAX) {
+      RichString_appendAscii(str, CRT_colors[PROCESS_SHADOW], "        N/A ");
+   } else if (number >= 100000LL * ONE_DECIMAL_T) {
+      xSnprintf(buffer, sizeof(buffer), "%11llu ", number / ONE_DECIMAL_G);
+      RichString_appendnAscii(str, largeNumberColor, buffer, 12);
+   } else if (number >= 100LL * ONE_DECIMAL_T) {
+      xSnprintf(buffer, sizeof(buffer), "%11llu ", number / ONE_DECIMAL_M);
+      RichString_appendnAscii(str, largeNumberColor, buffer, 8);
+      RichString_appendnAscii(str, processMegabytesColor, buffer + 8, 4);
+   } else if (number >= 10LL * ONE_DECIMAL_G) {
+      xSnprintf(buffer, sizeof(buffer), "%11llu ", number / ONE_DECIMAL_K);
+      RichString_appendnAscii(str, largeNumberColor, buffer, 5);
+      RichString_appendnAscii(str, processMegabytesColor, buffer + 5, 3);
+      RichString_appendnAscii(str, processColor, buffer + 8, 4);
+   } else {
+      xSnprintf(buffer, sizeof(buffer), "%11llu ", number);
+      RichString_appendnAscii(str, largeNumberColor, buffer, 2);
+      RichString_appendnAscii(str, processMegabytesColor, buffer + 2, 3);
+      RichString_appendnAscii(str, processColor, buffer + 5, 3);
+      RichString_appendnAscii(str, processShadowColor, buffer + 8, 4);
+   }
+}
+
+static void FormatBench_printfTime(RichString* str, unsigned long long totalHundredths, bool coloring) {
+   char buffer[10];
+   int len;
+
+   unsigned long long totalSeconds = totalHundredths / 100;
+   unsigned long long hours = totalSeconds / 3600;
+   unsigned long long days = totalSeconds / 86400;
+   int minutes = (totalSeconds / 60) % 60;
+   int seconds = totalSeconds % 60;
+   int hundredths = totalHundredths - (totalSeconds * 100);
+
+   int yearColor = coloring ? CRT_colors[LARGE_NUMBER]      : CRT_colors[PROCESS];
+   int dayColor  = coloring ? CRT_colors[PROCESS_GIGABYTES] : CRT_colors[PROCESS];
+   int hourColor = coloring ? CRT_colors[PROCESS_MEGABYTES] : CRT_colors[PROCESS];
+   int defColor  = CRT_colors[PROCESS];
+
+   if (days >= /* Ignore leapyears */365) {
+      int years = days / 365;
+      int daysLeft = days - 365 * years;
+
+      if (daysLeft >= 100) {
+         len = xSnprintf(buffer, sizeof(buffer), "%3dy", years);
+         RichString_appendnAscii(str, yearColor, buffer, len);
+         len = xSnprintf(buffer, sizeof(buffer), "%3dd ", daysLeft);
+         RichString_appendnAscii(str, dayColor, buffer, len);
+      } else if (daysLeft >= 10) {
+         len = xSnprintf(buffer, sizeof(buffer), "%4dy", years);
+         RichString_appendnAscii(str, yearColor, buffer, len);
+         len = xSnprintf(buffer, sizeof(buffer), "%2dd ", daysLeft);
+         RichString_appendnAscii(str, dayColor, buffer, len);
+      } else {
+         len = xSnprintf(buffer, sizeof(buffer), "%5dy", years);
+         RichString_appendnAscii(str, yearColor, buffer, len);
+         len = xSnprintf(buffer, sizeof(buffer), "%1dd ", daysLeft);
+         RichString_appendnAscii(str, dayColor, buffer, len);
+      }
+   } else if (days >= 100) {
+      int hoursLeft = hours - days * 24;
+
+      if (hoursLeft >= 10) {
+         len = xSnprintf(buffer, sizeof(buffer), "%4llud", days);
+         RichString_appendnAscii(str, dayColor, buffer, len);
+         len = xSnprintf(buffer, sizeof(buffer), "%2dh ", hoursLeft);
+         RichString_appendnAscii(str, hourColor, buffer, len);
+      } else {
+         len = xSnprintf(buffer, sizeof(buffer), "%5llud", days);
+         RichString_appendnAscii(str, dayColor, buffer, len);
+         len = xSnprintf(buffer, sizeof(buffer), "%1dh ", hoursLeft);
+         RichString_appendnAscii(str, hourColor, buffer, len);
+      }
+   } else if (hours >= 100) {
+      int minutesLeft = totalSeconds / 60 - hours * 60;
+
+      if (minutesLeft >= 10) {
+         len = xSnprintf(buffer, sizeof(buffer), "%4lluh", hours);
+         RichString_appendnAscii(str, hourColor, buffer, len);
+         len = xSnprintf(buffer, sizeof(buffer), "%2dm ", minutesLeft);
+         RichString_appendnAscii(str, defColor, buffer, len);
+      } else {
+         len = xSnprintf(buffer, sizeof(buffer), "%5lluh", hours);
+         RichString_appendnAscii(str, hourColor, buffer, len);
+         len = xSnprintf(buffer, sizeof(buffer), "%1dm ", minutesLeft);
+         RichString_appendnAscii(str, defColor, buffer, len);
+      }
+   } else if (hours > 0) {
+      len = xSnprintf(buffer, sizeof(buffer), "%2lluh", hours);
+      RichString_appendnAscii(str, hourColor, buffer, len);
+      len = xSnprintf(buffer, sizeof(buffer), "%02d:%02d ", minutes, seconds);
+      RichString_appendnAscii(str, defColor, buffer, len);
+   } else {
+      len = xSnprintf(buffer, sizeof(buffer), "%2d:%02d.%02d ", minutes, seconds, hundredths);
+      RichString_appendnAscii(str, defColor, buffer, len);
+   }
+}
+
+static void FormatBench_printfRate(RichString* str, double rate, bool coloring) {
+   char buffer[16];
+
+   int largeNumberColor = CRT_colors[LARGE_NUMBER];
+   int processMegabytesColor = CRT_colors[PROCESS_MEGABYTES];
+   int processColor = CRT_colors[PROCESS];
+   int shadowColor = CRT_colors[PROCESS_SHADOW];
+
+   if (!coloring) {
+      largeNumberColor = CRT_colors[PROCESS];
+      processMegabytesColor = CRT_colors[PROCESS];
+   }
+
+   if (isnan(rate)) {
+      RichString_appendAscii(str, shadowColor, "        N/A ");
+   } else if (rate < 0.005) {
+      int len = snprintf(buffer, sizeof(buffer), "%7.2f B/s ", rate);
+      RichString_appendnAscii(str, shadowColor, buffer, len);
+   } else if (rate < ONE_K) {
+      int len = snprintf(buffer, sizeof(buffer), "%7.2f B/s ", rate);
+      RichString_appendnAscii(str, processColor, buffer, len);
+   } else if (rate < ONE_M) {
+      int len = snprintf(buffer, sizeof(buffer), "%7.2f K/s ", rate / ONE_K);
+      RichString_appendnAscii(str, processColor, buffer, len);
+   } else if (rate < ONE_G) {
+      int len = snprintf(buffer, sizeof(buffer), "%7.2f M/s ", rate / ONE_M);
+      RichString_appendnAscii(str, processMegabytesColor, buffer, len);
+   } else if (rate < ONE_T) {
+      int len = snprintf(buffer, sizeof(buffer), "%7.2f G/s ", rate / ONE_G);
+      RichString_appendnAscii(str, largeNumberColor, buffer, len);
+   } else if (rate < ONE_P) {
+      int len = snprintf(buffer, sizeof(buffer), "%7.2f T/s ", rate / ONE_T);
+      RichString_appendnAscii(str, largeNumberColor, buffer, len);
+   } else {
+      int len = snprintf(buffer, sizeof(buffer), "%7.2f P/s ", rate / ONE_P);
+      RichString_appendnAscii(str, largeNumberColor, buffer, len);
+   }
+}
+
+static void FormatBench_printfPercentage(float val, char* buffer, int n, int* attr) {
+   if (val >= 0) {
+      if (val < 99.9F) {
+         if (val < 0.05F) {
+            *attr = CRT_colors[PROCESS_SHADOW];
+         }
+         xSnprintf(buffer, n, "%4.1f ", val);
+      } else if (val < 999) {
+         *attr = CRT_colors[PROCESS_MEGABYTES];
+         xSnprintf(buffer, n, "%3d. ", (int)val);
+      } else {
+         *attr = CRT_colors[PROCESS_MEGABYTES];
+         xSnprintf(buffer, n, "%4d ", (int)val);
+      }
+   } else {
+      *attr = CRT_colors[PROCESS_SHADOW];
+      xSnprintf(buffer, n, " N/A ");
+   }
+}
+
+/* The same check for both */
+
+typedef struct FormatBench_Row_ {
+   unsigned long long bytes[3];
+   unsigned long long time;
+   float percent[2];
+   double rate;
+} FormatBench_Row;
+
+typedef struct FormatBench_ {
+   FormatBench_Row rows[SAMPLES];
+   unsigned long long numbers[SAMPLES];
+   double rates[SAMPLES];
+   float percents[SAMPLES];
+} FormatBench;
+
+static bool FormatBench_same(const RichString* a, const RichString* b) {
+   return a->chlen == b->chlen && memcmp(a->chptr, b->chptr, (size_t)a->chlen * sizeof(CharType)) == 0;
+}
+
+static void FormatBench_describe(const RichString* str, char* out, size_t size) {
+   size_t n = 0;
+   for (int i = 0; i < str->chlen && n + 1 < size; i++)
+      out[n++] = (char)RichString_getCharVal(*str, i);
+   out[n] = '\0';
+}
+
+static bool FormatBench_checkNumber(const char* name, void (*printf_)(RichString*, unsigned long long, bool), void (*fast)(RichString*, unsigned long long, bool), unsigned long long number) {
+   bool same = true;
+   for (int coloring = 0; coloring <= 1; coloring++) {
+      RichString_begin(expected);
+      RichString_begin(actual);
+      printf_(&expected, number, coloring);
+      fast(&actual, number, coloring);
+      if (!FormatBench_same(&expected, &actual)) {
+         char e[64];
+         char a[64];
+         FormatBench_describe(&expected, e, sizeof(e));
+         FormatBench_describe(&actual, a, sizeof(a));
+         fprintf(stderr, "%s(%llu): \"%s\" instead of \"%s\"\n", name, number, a, e);
+         same = false;
+      }
+      RichString_delete(&expected);
+      RichString_delete(&actual);
+   }
+   return same;
+}
+
+static bool FormatBench_checkRate(double rate) {
+   bool same = true;
+   for (int coloring = 0; coloring <= 1; coloring++) {
+      RichString_begin(expected);
+      RichString_begin(actual);
+      FormatBench_printfRate(&expected, rate, coloring);
+      Process_printRate(&actual, rate, coloring);
+      if (!FormatBench_same(&expected, &actual)) {
+         char e[64];
+         char a[64];
+         FormatBench_describe(&expected, e, sizeof(e));
+         FormatBench_describe(&actual, a, sizeof(a));
+         fprintf(stderr, "Process_printRate(%.17g): \"%s\" instead of \"%s\"\n", rate, a, e);
+         same = false;
+      }
+      RichString_delete(&expected);
+      RichString_delete(&actual);
+   }
+   return same;
+}
+
+static bool FormatBench_checkPercentage(float val) {
+   char expected[16];
+   char actual[16];
+   int expectedAttr = 0;
+   int actualAttr = 0;
+   FormatBench_printfPercentage(val, expected, sizeof(expected), &expectedAttr);
+   Process_printPercentage(val, actual, sizeof(actual), &actualAttr);
+   if (String_eq(expected, actual) && expectedAttr == actualAttr)
+      return true;
+
+   fprintf(stderr, "Process_printPercentage(%.9g): \"%s\" instead of \"%s\"\n", (double)val, actual, expected);
+   return false;
+}
+
+static bool FormatBench_check(void) {
+   static const double rateEdges[] = { 0, 0.004999, 0.005, 1023.994, 1023.995, 1023.996, ONE_K, ONE_M - 1, ONE_M, ONE_G, ONE_T, ONE_P, INFINITY, NAN };
+   static const float percentEdges[] = { -1.0F, 0, 0.04F, 0.05F, 0.25F, 99.85F, 99.9F, 99.95F, 100, 998.9F, 999, 1000, 123456 };
+
+   unsigned int failures = 0;
+
+   for (size_t i = 0; i < ARRAYSIZE(rateEdges); i++)
+      failures += !FormatBench_checkRate(rateEdges[i]);
+   for (size_t i = 0; i < ARRAYSIZE(percentEdges); i++)
+      failures += !FormatBench_checkPercentage(percentEdges[i]);
+   failures += !FormatBench_checkNumber("Process_printBytes", FormatBench_printfBytes, Process_printBytes, ULLONG_MAX);
+   failures += !FormatBench_checkNumber("Process_printCount", FormatBench_printfCount, Process_printCount, ULLONG_MAX);
+
+   for (unsigned int i = 0; i < CHECKS && failures < 20; i++) {
+      unsigned long long number = FormatBench_randomMagnitude(63);
+      failures += !FormatBench_checkNumber("Process_printBytes", FormatBench_printfBytes, Process_printBytes, number);
+      failures += !FormatBench_checkNumber("Process_printCount", FormatBench_printfCount, Process_printCount, number);
+      /* more than 68 years of CPU time do not fit the int the old version used */
+      failures += !FormatBench_checkNumber("Process_printTime", FormatBench_printfTime, Process_printTime, FormatBench_randomMagnitude(37));
+
+      double unit = (double)(1ULL << (10 * (FormatBench_random() % 6)));
+      failures += !FormatBench_checkRate(FormatBench_randomFixed(1024, 2) * unit);
+      failures += !FormatBench_checkPercentage((float)FormatBench_randomFixed(1200, 1));
+   }
+
+   if (failures)
+      fprintf(stderr, "%u differences to the printf based formatting\n", failures);
+   else
+      printf("  same output as the printf based formatting for %d random values each\n", CHECKS);
+   return failures == 0;
+}
+
+/* Timing */
+
+static void FormatBench_fill(FormatBench* this) {
+   for (size_t i = 0; i < SAMPLES; i++) {
+      FormatBench_Row* row = &this->rows[i];
+      /* virtual, resident and shared memory */
+      row->bytes[0] = (FormatBench_random() % (64ULL * ONE_G)) & ~4095ULL;
+      row->bytes[1] = (FormatBench_random() % (4ULL * ONE_G)) & ~4095ULL;
+      row->bytes[2] = row->bytes[1] / 4;
+      row->time = FormatBench_randomMagnitude(30);
+      row->percent[0] = (float)FormatBench_randomFixed(100, 1);
+      row->percent[1] = (float)FormatBench_randomFixed(10, 1);
+      row->rate = FormatBench_randomFixed(1024, 2) * (double)(1ULL << (10 * (FormatBench_random() % 3)));
+
+      this->numbers[i] = FormatBench_randomMagnitude(40);
+      this->rates[i] = row->rate;
+      this->percents[i] = row->percent[0];
+   }
+}
+
+static void FormatBench_printfRow(void* data, size_t ops) {
+   const FormatBench* this = data;
+   for (size_t i = 0; i < ops; i++) {
+      const FormatBench_Row* row = &this->rows[i % SAMPLES];
+      char buffer[16];
+      int attr = 0;
+      RichString_begin(str);
+      FormatBench_printfBytes(&str, row->bytes[0], true);
+      FormatBench_printfBytes(&str, row->bytes[1], true);
+      FormatBench_printfBytes(&str, row->bytes[2], true);
+      FormatBench_printfPercentage(row->percent[0], buffer, sizeof(buffer), &attr);
+      RichString_appendAscii(&str, attr, buffer);
+      FormatBench_printfPercentage(row->percent[1], buffer, sizeof(buffer), &attr);
+      RichString_appendAscii(&str, attr, buffer);
+      FormatBench_printfTime(&str, row->time, true);
+      FormatBench_printfRate(&str, row->rate, true);
+      Bench_sink += (uint64_t)RichString_sizeVal(str);
+      RichString_delete(&str);
+   }
+}
+
+static void FormatBench_fastRow(void* data, size_t ops) {
+   const FormatBench* this = data;
+   for (size_t i = 0; i < ops; i++) {
+      const FormatBench_Row* row = &this->rows[i % SAMPLES];
+      char buffer[16];
+      int attr = 0;
+      RichString_begin(str);
+      Process_printBytes(&str, row->bytes[0], true);
+      Process_printBytes(&str, row->bytes[1], true);
+      Process_printBytes(&str, row->bytes[2], true);
+      Process_printPercentage(row->percent[0], buffer, sizeof(buffer), &attr);
+      RichString_appendAscii(&str, attr, buffer);
+      Process_printPercentage(row->percent[1], buffer, sizeof(buffer), &attr);
+      RichString_appendAscii(&str, attr, buffer);
+      Process_printTime(&str, row->time, true);
+      Process_printRate(&str, row->rate, true);
+      Bench_sink += (uint64_t)RichString_sizeVal(str);
+      RichString_delete(&str);
+   }
+}
+
+#define FORMAT_BENCH_NUMBER(name_, fn_, samples_)                  \
+   static void name_(void* data, size_t ops) {                     \
+      const FormatBench* this = data;                              \
+      for (size_t i = 0; i < ops; i++) {                           \
+         RichString_begin(str);                                    \
+         fn_(&str, this->samples_[i % SAMPLES], true);             \
+         Bench_sink += (uint64_t)RichString_sizeVal(str);          \
+         RichString_delete(&str);                                  \
+      }                                                            \
+   }
+
+FORMAT_BENCH_NUMBER(FormatBench_printfBytesCell, FormatBench_printfBytes, numbers)
+FORMAT_BENCH_NUMBER(FormatBench_fastBytesCell, Process_printBytes, numbers)
+FORMAT_BENCH_NUMBER(FormatBench_printfCountCell, FormatBench_printfCount, numbers)
+FORMAT_BENCH_NUMBER(FormatBench_fastCountCell, Process_printCount, numbers)
+FORMAT_BENCH_NUMBER(FormatBench_printfTimeCell, FormatBench_printfTime, numbers)
+FORMAT_BENCH_NUMBER(FormatBench_fastTimeCell, Process_printTime, numbers)
+FORMAT_BENCH_NUMBER(FormatBench_printfRateCell, FormatBench_printfRate, rates)
+FORMAT_BENCH_NUMBER(FormatBench_fastRateCell, Process_printRate, rates)
+
+static void FormatBench_printfPercentageCell(void* data, size_t ops) {
+   const FormatBench* this = data;
+   char buffer[16];
+   int attr = 0;
+   for (size_t i = 0; i < ops; i++) {
+      FormatBench_printfPercentage(this->percents[i % SAMPLES], buffer, sizeof(buffer), &attr);
+      Bench_sink += (uint64_t)buffer[2];
+   }
+}
+
+static void FormatBench_fastPercentageCell(void* data, size_t ops) {
+   const FormatBench* this = data;
+   char buffer[16];
+   int attr = 0;
+   for (size_t i = 0; i < ops; i++) {
+      Process_printPercentage(this->percents[i % SAMPLES], buffer, sizeof(buffer), &attr);
+      Bench_sink += (uint64_t)buffer[2];
+   }
+}
+
+int main(void) {
+   Bench_init();
+
+   Bench_section("Process column formatting, checked against printf");
+   if (!FormatBench_check())
+      return 1;
+
+   static FormatBench bench;
+   FormatBench_fill(&bench);
+
+   Bench_section("Process column formatting, one row of three sizes, two percentages, a time and a rate");
+   Bench_run("printf", ROWS, NULL, FormatBench_printfRow, &bench);
+   Bench_run("String_formatUnsigned and friends", ROWS, NULL, FormatBench_fastRow, &bench);
+
+   Bench_section("Process column formatting, per cell: printf, then without");
+   Bench_run("Process_printBytes, printf", ROWS, NULL, FormatBench_printfBytesCell, &bench);
+   Bench_run("Process_printBytes", ROWS, NULL, FormatBench_fastBytesCell, &bench);
+   Bench_run("Process_printCount, printf", ROWS, NULL, FormatBench_printfCountCell, &bench);
+   Bench_run("Process_printCount", ROWS, NULL, FormatBench_fastCountCell, &bench);
+   Bench_run("Process_printTime, printf", ROWS, NULL, FormatBench_printfTimeCell, &bench);
+   Bench_run("Process_printTime", ROWS, NULL, FormatBench_fastTimeCell, &bench);
+   Bench_run("Process_printRate, printf", ROWS, NULL, FormatBench_printfRateCell, &bench);
+   Bench_run("Process_printRate", ROWS, NULL, FormatBench_fastRateCell, &bench);
+   Bench_run("Process_printPercentage, printf", ROWS, NULL, FormatBench_printfPercentageCell, &bench);
+   Bench_run("Process_printPercentage", ROWS, NULL, FormatBench_fastPercentageCell, &bench);
+
+   return 0;
+}
@@ -0,0 +1,377 @@
+/*
+htop - bench/ProcFixture.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "bench/ProcFixture.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "Macros.h"
+#include "XUtils.h"
+
+
+#define BOOT_TIME 1666000000ULL
+
+typedef struct ProcFixtureCommand_ {
+   const char* comm;
+   /* The PID goes between head and tail, none without a tail; spaces separate the arguments unless the process rewrote its command line */
+   const char* head;
+   const char* tail;
+   bool rewritten;
+} ProcFixtureCommand;
+
+static const ProcFixtureCommand ProcFixture_commands[] = {
+   { "bash", "-bash", NULL, false },
+   { "sshd", "sshd: admin@pts/", "", true },
+   { "python3", "/usr/bin/python3 -u /srv/app/worker.py --queue=jobs --worker-id=", "", false },
+   { "java", "/usr/lib/jvm/java-17-openjdk/bin/java -Xmx2g -XX:+UseG1GC -jar /opt/service/service.jar --server.port=", "", false },
+   { "postgres", "postgres: app app 10.0.0.", "(5432) idle", true },
+   { "nginx", "nginx: worker process", NULL, true },
+   { "chrome", "/opt/google/chrome/chrome --type=renderer --lang=en-US --num-raster-threads=4 --renderer-client-id=", "", false },
+   { "node", "node /srv/web/server.js --port ", "", false },
+   { "systemd", "/usr/lib/systemd/systemd --user", NULL, false },
+   { "containerd-shim", "/usr/bin/containerd-shim-runc-v2 -namespace moby -id ", " -address /run/containerd/containerd.sock", false },
+};
+
+/* xorshift64, the same fixture on every run */
+static uint64_t ProcFixture_random(ProcFixture* this) {
+   this->seed ^= this->seed << 13;
+   this->seed ^= this->seed >> 7;
+   this->seed ^= this->seed << 17;
+   return this->seed;
+}
+
+static bool ProcFixture_writeAt(int dirFd, const char* name, const char* data, size_t len) {
+   int fd = openat(dirFd, name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+   if (fd < 0)
+      return false;
+
+   bool ok = write(fd, data, len) == (ssize_t)len;
+   return close(fd) == 0 && ok;
+}
+
+static bool ProcFixture_writeString(int dirFd, const char* name, const char* data) {
+   return ProcFixture_writeAt(dirFd, name, data, strlen(data));
+}
+
+static bool ProcFixture_removeAt(int parentFd, const char* name) {
+   int fd = openat(parentFd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+   if (fd < 0)
+      return unlinkat(parentFd, name, 0) == 0;
+
+   DIR* dir = fdopendir(fd);
+   if (!dir) {
+      close(fd);
+      return false;
+   }
+
+   bool ok = true;
+   const struct dirent* entry;
+   while ((entry = readdir(dir)) != NULL) {
+      if (String_eq(entry->d_name, ".") || String_eq(entry->d_name, ".."))
+         continue;
+
+      if (entry->d_type == DT_DIR)
+         ok &= ProcFixture_removeAt(dirfd(dir), entry->d_name);
+      else
+         ok &= unlinkat(dirfd(dir), entry->d_name, 0) == 0;
+   }
+   closedir(dir);
+
+   return unlinkat(parentFd, name, AT_REMOVEDIR) == 0 && ok;
+}
+
+/* System wide files */
+
+static bool ProcFixture_writeStat(ProcFixture* this) {
+   long cpus = sysconf(_SC_NPROCESSORS_CONF);
+   if (cpus < 1)
+      cpus = 1;
+
+   size_t size = 256 + (size_t)cpus * 128;
+   char* buffer = xMalloc(size);
+   unsigned long long t = this->ticks;
+   int len = snprintf(buffer, size, "cpu  %llu %llu %llu %llu 0 0 0 0 0 0\n", t * cpus / 4, t * cpus / 64, t * cpus / 8, t * cpus / 2);
+   for (long i = 0; i < cpus; i++)
+      len += snprintf(buffer + len, size - len, "cpu%ld %llu %llu %llu %llu 0 0 0 0 0 0\n", i, t / 4, t / 64, t / 8, t / 2);
+   len += snprintf(buffer + len, size - len,
+      "intr 0\nctxt %llu\nbtime %llu\nprocesses %d\nprocs_running 2\nprocs_blocked 0\n",
+      t * 1000, BOOT_TIME, (int)this->nextPid);
+
+   bool ok = len < (int)size && ProcFixture_writeAt(this->dirFd, "stat", buffer, len);
+   free(buffer);
+   return ok;
+}
+
+static bool ProcFixture_writeSystem(ProcFixture* this) {
+   static const char meminfo[] =
+      "MemTotal:       32768000 kB\n"
+      "MemFree:         8192000 kB\n"
+      "MemAvailable:   20480000 kB\n"
+      "Buffers:          512000 kB\n"
+      "Cached:         10240000 kB\n"
+      "SwapCached:            0 kB\n"
+      "Shmem:            819200 kB\n"
+      "SReclaimable:     614400 kB\n"
+      "SwapTotal:       8388604 kB\n"
+      "SwapFree:        8388604 kB\n";
+   static const char ttyDrivers[] =
+      "/dev/tty             /dev/tty        5       0 system:/dev/tty\n"
+      "/dev/console         /dev/console    5       1 system:console\n"
+      "/dev/ptmx            /dev/ptmx       5       2 system\n"
+      "pty_slave            /dev/pts      136 0-1048575 pty:slave\n"
+      "serial               /dev/ttyS       4 64-111 serial\n";
+
+   (void) mkdirat(this->dirFd, "sys", 0755);
+   (void) mkdirat(this->dirFd, "sys/kernel", 0755);
+   (void) mkdirat(this->dirFd, "tty", 0755);
+
+   return ProcFixture_writeStat(this) &&
+          ProcFixture_writeString(this->dirFd, "meminfo", meminfo) &&
+          ProcFixture_writeString(this->dirFd, "loadavg", "1.25 0.98 0.76 3/1024 4242\n") &&
+          ProcFixture_writeString(this->dirFd, "uptime", "86400.00 300000.00\n") &&
+          ProcFixture_writeString(this->dirFd, "sys/kernel/pid_max", "4194304\n") &&
+          ProcFixture_writeString(this->dirFd, "tty/drivers", ttyDrivers);
+}
+
+/* Processes */
+
+static void ProcFixture_comm(const ProcFixtureProcess* process, char* comm, size_t size) {
+   if (process->kernelThread)
+      xSnprintf(comm, size, "kworker/%d:1-events", (int)(process->pid % 64));
+   else
+      xSnprintf(comm, size, "%s", ProcFixture_commands[process->command].comm);
+}
+
+static bool ProcFixture_writeTask(const ProcFixture* this, const ProcFixtureProcess* process, int dirFd, pid_t tid) {
+   char comm[32];
+   ProcFixture_comm(process, comm, sizeof(comm));
+
+   unsigned int threads = process->kernelThread ? 1 : this->tasksPerProcess;
+   char state = process->utime % 7 == 0 ? 'R' : 'S';
+   pid_t session = process->kernelThread ? 0 : process->pid;
+   char buffer[1024];
+   int len = xSnprintf(buffer, sizeof(buffer),
+      "%d (%s) %c %d %d %d 0 -1 4194560 %llu 0 %llu 0 %llu %llu 0 0 20 0 %u 0 %llu %lu %lu 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 %u 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+      (int)tid, comm, state, (int)process->ppid, (int)session, (int)session,
+      process->utime * 3, process->utime / 50, process->utime, process->stime,
+      threads, process->starttime, process->vsize * 4096, process->rss, (unsigned int)(tid % 8));
+   if (!ProcFixture_writeAt(dirFd, "stat", buffer, len))
+      return false;
+
+   len = xSnprintf(buffer, sizeof(buffer), "%lu %lu %lu %lu 0 %lu 0\n",
+      process->vsize, process->rss, process->rss / 4, process->rss / 16, process->vsize / 2);
+   if (!ProcFixture_writeAt(dirFd, "statm", buffer, len))
+      return false;
+
+   len = xSnprintf(buffer, sizeof(buffer),
+      "Name:\t%s\nUmask:\t0022\nState:\t%c\nTgid:\t%d\nNgid:\t0\nPid:\t%d\nPPid:\t%d\nTracerPid:\t0\n"
+      "Uid:\t1000\t1000\t1000\t1000\nGid:\t1000\t1000\t1000\t1000\nFDSize:\t64\nGroups:\t1000\n"
+      "VmPeak:\t%8lu kB\nVmSize:\t%8lu kB\nVmRSS:\t%8lu kB\nThreads:\t%u\nSigQ:\t0/127431\n"
+      "Cpus_allowed_list:\t0-7\nvoluntary_ctxt_switches:\t%llu\nnonvoluntary_ctxt_switches:\t%llu\n",
+      comm, state, (int)process->pid, (int)tid, (int)process->ppid,
+      process->vsize * 4, process->vsize * 4, process->rss * 4, threads, process->utime * 11, process->utime / 3);
+   if (!ProcFixture_writeAt(dirFd, "status", buffer, len))
+      return false;
+
+   len = xSnprintf(buffer, sizeof(buffer),
+      "rchar: %llu\nwchar: %llu\nsyscr: %llu\nsyscw: %llu\nread_bytes: %llu\nwrite_bytes: %llu\ncancelled_write_bytes: 0\n",
+      process->utime * 40960, process->utime * 8192, process->utime * 12, process->utime * 4, process->utime * 4096, process->utime * 1024);
+   if (!ProcFixture_writeAt(dirFd, "io", buffer, len))
+      return false;
+
+   len = xSnprintf(buffer, sizeof(buffer), "%s\n", comm);
+   if (!ProcFixture_writeAt(dirFd, "comm", buffer, len))
+      return false;
+
+   /* Kernel threads have an empty command line */
+   len = 0;
+   if (!process->kernelThread) {
+      const ProcFixtureCommand* command = &ProcFixture_commands[process->command];
+      if (command->tail)
+         len = xSnprintf(buffer, sizeof(buffer), "%s%d%s", command->head, (int)process->pid, command->tail) + 1;
+      else
+         len = xSnprintf(buffer, sizeof(buffer), "%s", command->head) + 1;
+      if (!command->rewritten) {
+         for (int i = 0; i < len; i++)
+            if (buffer[i] == ' ')
+               buffer[i] = '\0';
+      }
+   }
+   return ProcFixture_writeAt(dirFd, "cmdline", buffer, len);
+}
+
+/* Writes the process directory, its files are those of its main thread */
+static bool ProcFixture_writeProcess(const ProcFixture* this, const ProcFixtureProcess* process) {
+   char name[16];
+   xSnprintf(name, sizeof(name), "%d", (int)process->pid);
+   if (mkdirat(this->dirFd, name, 0755) != 0)
+      return false;
+
+   int processFd = openat(this->dirFd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+   if (processFd < 0)
+      return false;
+
+   bool ok = ProcFixture_writeTask(this, process, processFd, process->pid) && mkdirat(processFd, "task", 0755) == 0;
+
+   unsigned int threads = process->kernelThread ? 1 : this->tasksPerProcess;
+   for (unsigned int i = 0; ok && i < threads; i++) {
+      char tid[16];
+      xSnprintf(tid, sizeof(tid), "task/%d", (int)(process->pid + i));
+      ok = mkdirat(processFd, tid, 0755) == 0;
+
+      int taskFd = ok ? openat(processFd, tid, O_RDONLY | O_DIRECTORY | O_CLOEXEC) : -1;
+      ok = taskFd >= 0 && ProcFixture_writeTask(this, process, taskFd, process->pid + i);
+      if (taskFd >= 0)
+         close(taskFd);
+   }
+
+   close(processFd);
+   return ok;
+}
+
+/* Only the main thread of a process that used CPU is written again */
+static bool ProcFixture_writeMainStat(const ProcFixture* this, const ProcFixtureProcess* process) {
+   char name[32];
+   xSnprintf(name, sizeof(name), "%d", (int)process->pid);
+   int processFd = openat(this->dirFd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+   if (processFd < 0)
+      return false;
+
+   bool ok = ProcFixture_writeTask(this, process, processFd, process->pid);
+   close(processFd);
+   return ok;
+}
+
+static bool ProcFixture_start(ProcFixture* this, pid_t pid, pid_t ppid, bool kernelThread) {
+   if (this->count == this->capacity) {
+      this->capacity = this->capacity ? this->capacity * 2 : 1024;
+      this->processes = xReallocArray(this->processes, this->capacity, sizeof(ProcFixtureProcess));
+   }
+
+   ProcFixtureProcess* process = &this->processes[this->count];
+   *process = (ProcFixtureProcess) {
+      .pid = pid,
+      .ppid = ppid,
+      .kernelThread = kernelThread,
+      .command = (unsigned int)(ProcFixture_random(this) % ARRAYSIZE(ProcFixture_commands)),
+      .utime = ProcFixture_random(this) % 100000,
+      .stime = ProcFixture_random(this) % 20000,
+      .starttime = this->ticks,
+      .vsize = kernelThread ? 0 : 4096 + ProcFixture_random(this) % (1 << 20),
+   };
+   process->rss = process->vsize / (2 + ProcFixture_random(this) % 16);
+
+   if (!ProcFixture_writeProcess(this, process))
+      return false;
+
+   this->count++;
+   this->tasks += kernelThread ? 1 : this->tasksPerProcess;
+   return true;
+}
+
+/* New processes are children of init, kthreadd or any other process, the tree gets a few levels deep */
+static bool ProcFixture_startNew(ProcFixture* this) {
+   bool kernelThread = ProcFixture_random(this) % 10 == 0;
+   pid_t ppid = 2;
+   if (!kernelThread) {
+      const ProcFixtureProcess* parent = &this->processes[ProcFixture_random(this) % this->count];
+      ppid = parent->kernelThread ? 1 : parent->pid;
+   }
+
+   pid_t pid = this->nextPid;
+   this->nextPid += kernelThread ? 1 : this->tasksPerProcess;
+   return ProcFixture_start(this, pid, ppid, kernelThread);
+}
+
+static bool ProcFixture_exit(ProcFixture* this, unsigned int index) {
+   ProcFixtureProcess* process = &this->processes[index];
+   char name[16];
+   xSnprintf(name, sizeof(name), "%d", (int)process->pid);
+   if (!ProcFixture_removeAt(this->dirFd, name))
+      return false;
+
+   this->tasks -= process->kernelThread ? 1 : this->tasksPerProcess;
+   *process = this->processes[--this->count];
+   return true;
+}
+
+ProcFixture* ProcFixture_new(const char* dir, unsigned int tasks, unsigned int tasksPerProcess) {
+   int dirFd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+   if (dirFd < 0)
+      return NULL;
+
+   ProcFixture* this = xCalloc(1, sizeof(ProcFixture));
+   this->dirFd = dirFd;
+   this->targetTasks = tasks;
+   this->tasksPerProcess = MAXIMUM(tasksPerProcess, 1);
+   this->nextPid = 300;
+   this->ticks = 8640000;
+   this->seed = 88172645463325252ULL;
+
+   bool ok = ProcFixture_writeSystem(this) &&
+             ProcFixture_start(this, 1, 0, false) &&
+             ProcFixture_start(this, 2, 0, true);
+   while (ok && this->tasks < this->targetTasks)
+      ok = ProcFixture_startNew(this);
+
+   if (!ok) {
+      ProcFixture_delete(this);
+      return NULL;
+   }
+   return this;
+}
+
+void ProcFixture_delete(ProcFixture* this) {
+   while (this->count > 0)
+      (void) ProcFixture_exit(this, this->count - 1);
+
+   static const char* const files[] = { "stat", "meminfo", "loadavg", "uptime", "sys/kernel/pid_max", "tty/drivers" };
+   for (size_t i = 0; i < ARRAYSIZE(files); i++)
+      (void) unlinkat(this->dirFd, files[i], 0);
+
+   static const char* const dirs[] = { "sys/kernel", "sys", "tty" };
+   for (size_t i = 0; i < ARRAYSIZE(dirs); i++)
+      (void) unlinkat(this->dirFd, dirs[i], AT_REMOVEDIR);
+
+   close(this->dirFd);
+   free(this->processes);
+   free(this);
+}
+
+bool ProcFixture_churn(ProcFixture* this, unsigned int percent) {
+   unsigned int changes = MAXIMUM(this->count * percent / 100, 1);
+   this->ticks += 150;
+
+   /* init and kthreadd stay */
+   for (unsigned int i = 0; i < changes && this->count > 2; i++) {
+      if (!ProcFixture_exit(this, 2 + (unsigned int)(ProcFixture_random(this) % (this->count - 2))))
+         return false;
+   }
+
+   while (this->tasks < this->targetTasks) {
+      if (!ProcFixture_startNew(this))
+         return false;
+   }
+
+   for (unsigned int i = 0; i < changes; i++) {
+      ProcFixtureProcess* process = &this->processes[ProcFixture_random(this) % this->count];
+      process->utime += 1 + ProcFixture_random(this) % 100;
+      process->stime += ProcFixture_random(this) % 20;
+      if (!ProcFixture_writeMainStat(this, process))
+         return false;
+   }
+
+   return ProcFixture_writeStat(this);
+}
@@ -0,0 +1,55 @@
+#ifndef HEADER_ProcFixture
+#define HEADER_ProcFixture
+/*
+htop - bench/ProcFixture.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+
+typedef struct ProcFixtureProcess_ {
+   pid_t pid;
+   pid_t ppid;
+   bool kernelThread;
+   unsigned int command;
+   unsigned long long utime;
+   unsigned long long stime;
+   unsigned long long starttime;
+   unsigned long vsize;
+   unsigned long rss;
+} ProcFixtureProcess;
+
+/*
+ * A generated Linux proc filesystem for htop to read with --procfs: the
+ * system wide files htop reads and processes with their threads under
+ * task/. A tenth of the processes are kernel threads, which have no
+ * threads of their own.
+ */
+typedef struct ProcFixture_ {
+   int dirFd;
+   ProcFixtureProcess* processes;
+   unsigned int count;
+   unsigned int capacity;
+   unsigned int tasks;
+   unsigned int targetTasks;
+   unsigned int tasksPerProcess;
+   pid_t nextPid;
+   unsigned long long ticks;
+   uint64_t seed;
+} ProcFixture;
+
+/* Writes the system wide files and processes of tasksPerProcess tasks up to about tasks tasks into dir, which has to exist; NULL on errors */
+ProcFixture* ProcFixture_new(const char* dir, unsigned int tasks, unsigned int tasksPerProcess);
+
+/* Removes all it wrote, the directory stays */
+void ProcFixture_delete(ProcFixture* this);
+
+/* Moves time on: percent of the processes exit, new ones start up to the tasks asked for and as many again use some CPU */
+bool ProcFixture_churn(ProcFixture* this, unsigned int percent);
+
+#endif
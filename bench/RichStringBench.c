@@ -0,0 +1,377 @@
+/*
+htop - bench/RichStringBench.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include <ctype.h>
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Macros.h"
+#include "RichString.h"
+#include "XUtils.h"
+#include "bench/Bench.h"
+
+
+/*
+ * The wide character appends of RichString, which copy a leading run of
+ * ASCII without the multibyte decoder, against the versions that decoded
+ * the whole string, which are kept below as they were: first checks that
+ * both give the same cells, then times them on command lines, the ASCII
+ * ones and those that are not.
+ */
+
+#define CALLS 200000
+
+/* Longer command lines are cut, which keeps the kept versions to the built-in buffer */
+#define MAX_COMMAND (RICHSTRING_MAXLEN / 2)
+
+#define MAX_PROCESSES 4096
+
+#ifdef HAVE_LIBNCURSESW
+
+/* The versions decoding the whole string */
+
+static void RichStringBench_setLen(RichString* this, int len) {
+   RichString_setChar(this, len, 0);
+   this->chlen = len;
+}
+
+static int RichStringBench_wideWriteFromWide(RichString* this, int attrs, const char* data_c, int from, int len) {
+   wchar_t data[len + 1];
+   len = mbstowcs(data, data_c, len);
+   if (len <= 0)
+      return 0;
+
+   int newLen = from + len;
+   RichStringBench_setLen(this, newLen);
+   for (int i = from, j = 0; i < newLen; i++, j++) {
+      this->chptr[i] = (CharType) { .attr = attrs & 0xffffff, .chars = { (iswprint(data[j]) ? data[j] : '?') } };
+   }
+
+   return len;
+}
+
+static int RichStringBench_wideAppendnWideColumns(RichString* this, int attrs, const char* data_c, int len, int* columns) {
+   wchar_t data[len + 1];
+   len = mbstowcs(data, data_c, len);
+   if (len <= 0)
+      return 0;
+
+   int from = this->chlen;
+   int newLen = from + len;
+   RichStringBench_setLen(this, newLen);
+   int columnsWritten = 0;
+   int pos = from;
+   for (int j = 0; j < len; j++) {
+      wchar_t c = iswprint(data[j]) ? data[j] : '?';
+      int cwidth = wcwidth(c);
+      if (cwidth > *columns)
+         break;
+
+      *columns -= cwidth;
+      columnsWritten += cwidth;
+
+      this->chptr[pos] = (CharType) { .attr = attrs & 0xffffff, .chars = { c, '\0' } };
+      pos++;
+   }
+
+   RichStringBench_setLen(this, pos);
+   *columns = columnsWritten;
+
+   return pos - from;
+}
+
+/* Inputs */
+
+static const char* const RichStringBench_asciiCommands[] = {
+   "/usr/lib/systemd/systemd --switched-root --system --deserialize 31",
+   "/usr/bin/python3 -s /usr/bin/jupyter-lab --no-browser --port=8888",
+   "postgres: checkpointer",
+   "/usr/lib/firefox/firefox -contentproc -childID 12 -isForBrowser -prefsLen 31337 -parentBuildID 20221010",
+   "[kworker/u16:2-events_unbound]",
+   "/opt/app/bin/java -Xmx4g -XX:+UseG1GC -jar /opt/app/lib/service.jar --spring.profiles.active=prod",
+   "sshd: admin@pts/0",
+   "bash",
+};
+
+/* ASCII up to a file or user name that is not */
+static const char* const RichStringBench_utf8Commands[] = {
+   "/usr/bin/python3 /home/jörg/Übungen/täglich.py --größe=10",
+   "vim /home/user/notes/résumé-draft-ñ.md",
+   "/usr/bin/evince /home/user/Documents/Rechnung Müller.pdf",
+   "sshd: renée@pts/3",
+};
+
+/* Mostly double width characters */
+static const char* const RichStringBench_cjkCommands[] = {
+   "/usr/bin/mpv /srv/media/音楽/東京の夜.flac",
+   "libreoffice --writer /home/用户/文档/报告二〇二二年.odt",
+   "音楽プレーヤー --最小化",
+};
+
+/* Only checked: characters which are not printable, combining or wider, and bytes which are not UTF-8 */
+static const char* const RichStringBench_oddCommands[] = {
+   "",
+   "a",
+   "tab\there, escape\033[31m, delete\177",
+   "combining e\xcc\x81 and \xe2\x80\x8b zero width",
+   "emoji \xf0\x9f\x98\x80 at the end",
+   "invalid \xff byte",
+   "truncated \xe6\x9d",
+   "\xc3\xa9 first",
+   "0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz\xc3\xa9",
+   "0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz\xff",
+};
+
+typedef struct RichStringBench_ {
+   char** strings;
+   size_t count;
+   int columns;
+} RichStringBench;
+
+static bool RichStringBench_isAscii(const char* s) {
+   for (; *s; s++)
+      if ((unsigned char)*s >= 0x80)
+         return false;
+   return true;
+}
+
+static void RichStringBench_add(RichStringBench* this, const char* s) {
+   this->strings = xReallocArray(this->strings, this->count + 1, sizeof(*this->strings));
+   this->strings[this->count++] = xStrndup(s, MAX_COMMAND);
+}
+
+static void RichStringBench_addAll(RichStringBench* this, const char* const* strings, size_t count) {
+   for (size_t i = 0; i < count; i++)
+      RichStringBench_add(this, strings[i]);
+}
+
+/* The command lines of the running processes, arguments separated by spaces as htop shows them */
+static void RichStringBench_addRunning(RichStringBench* ascii, RichStringBench* other) {
+   DIR* dir = opendir("/proc");
+   if (!dir)
+      return;
+
+   const struct dirent* entry;
+   size_t found = 0;
+   while ((entry = readdir(dir)) != NULL && found < MAX_PROCESSES) {
+      if (!isdigit((unsigned char)entry->d_name[0]))
+         continue;
+
+      char path[64];
+      xSnprintf(path, sizeof(path), "/proc/%s/cmdline", entry->d_name);
+      char command[MAX_COMMAND + 1];
+      ssize_t len = xReadfile(path, command, sizeof(command));
+      if (len <= 0)
+         continue;
+
+      while (len > 0 && command[len - 1] == '\0')
+         len--;
+      for (ssize_t i = 0; i < len; i++)
+         if (command[i] == '\0')
+            command[i] = ' ';
+      command[len] = '\0';
+      if (len == 0)
+         continue;
+
+      RichStringBench_add(RichStringBench_isAscii(command) ? ascii : other, command);
+      found++;
+   }
+
+   closedir(dir);
+}
+
+static void RichStringBench_done(RichStringBench* this) {
+   for (size_t i = 0; i < this->count; i++)
+      free(this->strings[i]);
+   free(this->strings);
+}
+
+/* Check */
+
+static bool RichStringBench_same(const RichString* a, const RichString* b) {
+   if (a->chlen != b->chlen)
+      return false;
+
+   for (int i = 0; i < a->chlen; i++) {
+      if (a->chptr[i].attr != b->chptr[i].attr || memcmp(a->chptr[i].chars, b->chptr[i].chars, sizeof(a->chptr[i].chars)) != 0)
+         return false;
+   }
+   return true;
+}
+
+static bool RichStringBench_checkOne(const char* s, int len, int columns) {
+   const int attrs = A_BOLD | 0x1234;
+   bool same = true;
+
+   RichString_begin(expected);
+   RichString_begin(actual);
+   RichString_appendAscii(&expected, 0, "> ");
+   RichString_appendAscii(&actual, 0, "> ");
+   RichStringBench_wideWriteFromWide(&expected, attrs, s, expected.chlen, len);
+   RichString_appendnWide(&actual, attrs, s, len);
+   if (!RichStringBench_same(&expected, &actual)) {
+      fprintf(stderr, "appendnWide(\"%s\", %d): %d cells instead of %d\n", s, len, actual.chlen, expected.chlen);
+      same = false;
+   }
+   RichString_delete(&expected);
+   RichString_delete(&actual);
+
+   int expectedColumns = columns;
+   int actualColumns = columns;
+   RichString_beginAllocated(expected);
+   RichString_beginAllocated(actual);
+   int expectedLen = RichStringBench_wideAppendnWideColumns(&expected, attrs, s, len, &expectedColumns);
+   int actualLen = RichString_appendnWideColumns(&actual, attrs, s, len, &actualColumns);
+   /*
+    * The only intended difference: the ASCII before the column limit is
+    * written even if the string goes on to bytes which are not UTF-8,
+    * where the whole string was dropped.
+    */
+   bool dropped = expectedLen == 0 && mbstowcs(NULL, s, 0) == (size_t)-1;
+   if (!dropped && (expectedLen != actualLen || expectedColumns != actualColumns || !RichStringBench_same(&expected, &actual))) {
+      fprintf(stderr, "appendnWideColumns(\"%s\", %d, %d): %d cells in %d columns instead of %d in %d\n", s, len, columns, actualLen, actualColumns, expectedLen, expectedColumns);
+      same = false;
+   }
+   RichString_delete(&expected);
+   RichString_delete(&actual);
+
+   return same;
+}
+
+static bool RichStringBench_check(const RichStringBench* this) {
+   static const int lens[] = { 0, 1, 7, 8, 9, 16, 40 };
+   static const int columns[] = { 0, 1, 7, 8, 9, 40, 80, RICHSTRING_MAXLEN };
+
+   bool same = true;
+   for (size_t i = 0; i < this->count; i++) {
+      const char* s = this->strings[i];
+      int full = (int)strlen(s);
+      for (size_t l = 0; l <= ARRAYSIZE(lens); l++) {
+         int len = l < ARRAYSIZE(lens) ? MINIMUM(lens[l], full) : full;
+         for (size_t c = 0; c < ARRAYSIZE(columns); c++)
+            same &= RichStringBench_checkOne(s, len, columns[c]);
+      }
+   }
+   return same;
+}
+
+/* Timing */
+
+static void RichStringBench_decodeAppendWide(void* data, size_t ops) {
+   const RichStringBench* this = data;
+   for (size_t i = 0; i < ops; i++) {
+      const char* s = this->strings[i % this->count];
+      RichString_begin(str);
+      RichStringBench_wideWriteFromWide(&str, 0, s, str.chlen, strlen(s));
+      Bench_sink += (uint64_t)RichString_sizeVal(str);
+      RichString_delete(&str);
+   }
+}
+
+static void RichStringBench_appendWide(void* data, size_t ops) {
+   const RichStringBench* this = data;
+   for (size_t i = 0; i < ops; i++) {
+      RichString_begin(str);
+      RichString_appendWide(&str, 0, this->strings[i % this->count]);
+      Bench_sink += (uint64_t)RichString_sizeVal(str);
+      RichString_delete(&str);
+   }
+}
+
+static void RichStringBench_decodeAppendnWideColumns(void* data, size_t ops) {
+   const RichStringBench* this = data;
+   for (size_t i = 0; i < ops; i++) {
+      const char* s = this->strings[i % this->count];
+      int columns = this->columns;
+      RichString_begin(str);
+      RichStringBench_wideAppendnWideColumns(&str, 0, s, strlen(s), &columns);
+      Bench_sink += (uint64_t)RichString_sizeVal(str);
+      RichString_delete(&str);
+   }
+}
+
+static void RichStringBench_appendnWideColumns(void* data, size_t ops) {
+   const RichStringBench* this = data;
+   for (size_t i = 0; i < ops; i++) {
+      const char* s = this->strings[i % this->count];
+      int columns = this->columns;
+      RichString_begin(str);
+      RichString_appendnWideColumns(&str, 0, s, strlen(s), &columns);
+      Bench_sink += (uint64_t)RichString_sizeVal(str);
+      RichString_delete(&str);
+   }
+}
+
+static void RichStringBench_run(const char* title, RichStringBench* this) {
+   if (this->count == 0)
+      return;
+
+   char section[128];
+   xSnprintf(section, sizeof(section), "%s (%zu), per command line: decoding all, then the ASCII prefix without", title, this->count);
+   Bench_section(section);
+   Bench_run("appendWide, decoding all", CALLS, NULL, RichStringBench_decodeAppendWide, this);
+   Bench_run("appendWide", CALLS, NULL, RichStringBench_appendWide, this);
+   this->columns = 80;
+   Bench_run("appendnWideColumns 80 columns, decoding all", CALLS, NULL, RichStringBench_decodeAppendnWideColumns, this);
+   Bench_run("appendnWideColumns 80 columns", CALLS, NULL, RichStringBench_appendnWideColumns, this);
+   this->columns = RICHSTRING_MAXLEN;
+   Bench_run("appendnWideColumns unlimited, decoding all", CALLS, NULL, RichStringBench_decodeAppendnWideColumns, this);
+   Bench_run("appendnWideColumns unlimited", CALLS, NULL, RichStringBench_appendnWideColumns, this);
+}
+
+int main(void) {
+   Bench_init();
+
+   RichStringBench ascii = { 0 };
+   RichStringBench utf8 = { 0 };
+   RichStringBench cjk = { 0 };
+   RichStringBench runningAscii = { 0 };
+   RichStringBench runningOther = { 0 };
+   RichStringBench odd = { 0 };
+   RichStringBench_addAll(&ascii, RichStringBench_asciiCommands, ARRAYSIZE(RichStringBench_asciiCommands));
+   RichStringBench_addAll(&utf8, RichStringBench_utf8Commands, ARRAYSIZE(RichStringBench_utf8Commands));
+   RichStringBench_addAll(&cjk, RichStringBench_cjkCommands, ARRAYSIZE(RichStringBench_cjkCommands));
+   RichStringBench_addAll(&odd, RichStringBench_oddCommands, ARRAYSIZE(RichStringBench_oddCommands));
+   RichStringBench_addRunning(&runningAscii, &runningOther);
+
+   Bench_section("RichString wide appends, checked against decoding all");
+   bool same = true;
+   const RichStringBench* const checked[] = { &ascii, &utf8, &cjk, &odd, &runningAscii, &runningOther };
+   for (size_t i = 0; i < ARRAYSIZE(checked); i++)
+      same &= RichStringBench_check(checked[i]);
+   if (!same)
+      return 1;
+
+   RichStringBench_run("ASCII command lines", &ascii);
+   RichStringBench_run("Running processes, ASCII", &runningAscii);
+   RichStringBench_run("Running processes, not ASCII", &runningOther);
+   RichStringBench_run("UTF-8 after an ASCII prefix", &utf8);
+   RichStringBench_run("Mostly double width", &cjk);
+
+   RichStringBench_done(&ascii);
+   RichStringBench_done(&utf8);
+   RichStringBench_done(&cjk);
+   RichStringBench_done(&runningAscii);
+   RichStringBench_done(&runningOther);
+   RichStringBench_done(&odd);
+
+   return 0;
+}
+
+#else /* HAVE_LIBNCURSESW */
+
+int main(void) {
+   Bench_section("RichString wide appends: needs ncursesw, skipped");
+   return 0;
+}
+
+#endif /* HAVE_LIBNCURSESW */
@@ -0,0 +1,289 @@
+/*
+htop - bench/ScanBench.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include <getopt.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Action.h"
+#include "CRT.h"
+#include "CommandLine.h"
+#include "DynamicColumn.h"
+#include "DynamicMeter.h"
+#include "Hashtable.h"
+#include "MainPanel.h"
+#include "Macros.h"
+#include "Object.h"
+#include "Panel.h"
+#include "Platform.h"
+#include "Process.h"
+#include "ProcessList.h"
+#include "ProvideCurses.h"
+#include "Settings.h"
+#include "UsersTable.h"
+#include "XUtils.h"
+#include "bench/Bench.h"
+#include "bench/ProcFixture.h"
+#include "linux/LinuxProcessList.h"
+
+
+/*
+ * A refresh cycle of the process list on a generated proc filesystem,
+ * read through --procfs: the scan, the sort as a list and as a tree, the
+ * rebuild of the panel and drawing it to a terminal writing to /dev/null.
+ * Before each refresh some processes exit and others start.
+ */
+
+#define CHURN_PERCENT 2
+#define TASKS_PER_PROCESS 4
+#define PANEL_ROWS 50
+#define PANEL_COLUMNS 200
+#define DRAWS 200
+#define CYCLES 3
+
+/*
+ * Larger lists are left to --tasks: building the tree is quadratic in the
+ * number of tasks, a single scan in tree view takes minutes at 100000
+ */
+static const unsigned int ScanBench_defaultTasks[] = { 1000, 10000 };
+
+typedef struct ScanBench_ {
+   ProcFixture* fixture;
+   ProcessList* pl;
+   MainPanel* panel;
+} ScanBench;
+
+static void ScanBench_draw(const ScanBench* this) {
+   for (int i = 0; i < DRAWS; i++)
+      Panel_draw((Panel*) this->panel, true, true, true, false);
+}
+
+/* Each cycle is a refresh as htop does it, the fastest time of each step is reported */
+static bool ScanBench_runCycles(const ScanBench* this, const char* view, unsigned int cycles, bool draw) {
+   uint64_t scan = UINT64_MAX;
+   uint64_t sort = UINT64_MAX;
+   uint64_t rebuild = UINT64_MAX;
+   uint64_t drawing = UINT64_MAX;
+
+   for (unsigned int i = 0; i < cycles; i++) {
+      if (!ProcFixture_churn(this->fixture, CHURN_PERCENT)) {
+         perror("Error: can not update the proc filesystem");
+         return false;
+      }
+
+      uint64_t start = Bench_nowNs();
+      ProcessList_scan(this->pl, false);
+      uint64_t scanned = Bench_nowNs();
+      ProcessList_sort(this->pl);
+      uint64_t sorted = Bench_nowNs();
+      ProcessList_rebuildPanel(this->pl);
+      uint64_t rebuilt = Bench_nowNs();
+      if (draw)
+         ScanBench_draw(this);
+      uint64_t drawn = Bench_nowNs();
+
+      scan = MINIMUM(scan, scanned - start);
+      sort = MINIMUM(sort, sorted - scanned);
+      rebuild = MINIMUM(rebuild, rebuilt - sorted);
+      drawing = MINIMUM(drawing, drawn - rebuilt);
+   }
+
+   unsigned int tasks = this->fixture->tasks;
+   char name[64];
+   xSnprintf(name, sizeof(name), "ProcessList_scan, %s", view);
+   Bench_report(name, tasks, scan);
+   xSnprintf(name, sizeof(name), "ProcessList_sort, %s", view);
+   Bench_report(name, tasks, sort);
+   xSnprintf(name, sizeof(name), "ProcessList_rebuildPanel, %s", view);
+   Bench_report(name, tasks, rebuild);
+
+   /* Only the visible rows are drawn, this is per screen rather than per task */
+   if (draw) {
+      xSnprintf(name, sizeof(name), "Panel_draw %dx%d, %s, per screen", PANEL_COLUMNS, PANEL_ROWS, view);
+      Bench_report(name, DRAWS, drawing);
+   }
+   return true;
+}
+
+static bool ScanBench_run(const char* procfs, unsigned int tasks, unsigned int tasksPerProcess, unsigned int cycles, UsersTable* ut, Hashtable* dm, Hashtable* dc, bool draw) {
+   ScanBench bench = { .fixture = ProcFixture_new(procfs, tasks, tasksPerProcess) };
+   if (!bench.fixture) {
+      perror("Error: can not write the proc filesystem");
+      return false;
+   }
+
+   bench.pl = ProcessList_new(ut, dm, dc, NULL, (uid_t)-1);
+   Settings* settings = Settings_new(bench.pl->activeCPUs, dc);
+   bench.pl->settings = settings;
+   settings->treeView = false;
+
+   bench.panel = MainPanel_new();
+   ProcessList_setPanel(bench.pl, (Panel*) bench.panel);
+   Panel_move((Panel*) bench.panel, 0, 1);
+   Panel_resize((Panel*) bench.panel, PANEL_COLUMNS, PANEL_ROWS);
+
+   State state = {
+      .settings = settings,
+      .ut = ut,
+      .pl = bench.pl,
+      .mainPanel = bench.panel,
+   };
+   MainPanel_setState(bench.panel, &state);
+
+   char section[128];
+   xSnprintf(section, sizeof(section), "%u tasks in %u processes, %d%% of them replaced before each refresh, per task",
+      bench.fixture->tasks, bench.fixture->count, CHURN_PERCENT);
+   Bench_section(section);
+
+   uint64_t start = Bench_nowNs();
+   ProcessList_scan(bench.pl, false);
+   Bench_report("ProcessList_scan, first", bench.fixture->tasks, Bench_nowNs() - start);
+
+   /* Reading anything else than the generated processes would make the numbers meaningless */
+   bool ok = bench.pl->totalTasks == bench.fixture->tasks;
+   if (!ok)
+      fprintf(stderr, "Error: %u tasks read from %s instead of %u\n", bench.pl->totalTasks, procfs, bench.fixture->tasks);
+
+   ok = ok && ScanBench_runCycles(&bench, "list", cycles, draw);
+   settings->treeView = true;
+   ok = ok && ScanBench_runCycles(&bench, "tree", cycles, draw);
+
+   ProcessList_setPanel(bench.pl, NULL);
+   Object_delete(bench.panel);
+   ProcessList_delete(bench.pl);
+   Settings_delete(settings);
+   ProcFixture_delete(bench.fixture);
+   return ok;
+}
+
+/* The generated directory is handed to htop the way a user would, as --procfs=DIR */
+static CommandLineStatus ScanBench_parseArguments(int argc, char** argv, unsigned int** tasks, size_t* sizes, unsigned int* tasksPerProcess, unsigned int* cycles) {
+   static const struct option longOptions[] = {
+      {"tasks",             required_argument, 0, 't'},
+      {"tasks-per-process", required_argument, 0, 'm'},
+      {"cycles",            required_argument, 0, 'c'},
+      PLATFORM_LONG_OPTIONS
+      {0, 0, 0, 0}
+   };
+
+   int opt;
+   while ((opt = getopt_long(argc, argv, "t:m:c:", longOptions, NULL)) != -1) {
+      switch (opt) {
+         case 't': {
+            *sizes = 0;
+            char* saveptr;
+            for (char* size = strtok_r(optarg, ",", &saveptr); size; size = strtok_r(NULL, ",", &saveptr)) {
+               *tasks = xReallocArray(*tasks, *sizes + 1, sizeof(**tasks));
+               (*tasks)[(*sizes)++] = (unsigned int)strtoul(size, NULL, 10);
+            }
+            break;
+         }
+         case 'm':
+            *tasksPerProcess = (unsigned int)strtoul(optarg, NULL, 10);
+            break;
+         case 'c':
+            *cycles = MAXIMUM((unsigned int)strtoul(optarg, NULL, 10), 1);
+            break;
+         case '?':
+            fprintf(stderr, "Usage: %s [--procfs=DIR] [--tasks=N,...] [--tasks-per-process=M] [--cycles=N]\n", argv[0]);
+            return STATUS_ERROR_EXIT;
+         default: {
+            CommandLineStatus status = Platform_getLongOption(opt, argc, argv);
+            if (status != STATUS_OK)
+               return status;
+            break;
+         }
+      }
+   }
+   return STATUS_OK;
+}
+
+int main(int argc, char** argv) {
+   unsigned int* tasks = xMallocArray(ARRAYSIZE(ScanBench_defaultTasks), sizeof(*tasks));
+   memcpy(tasks, ScanBench_defaultTasks, sizeof(ScanBench_defaultTasks));
+   size_t sizes = ARRAYSIZE(ScanBench_defaultTasks);
+   unsigned int tasksPerProcess = TASKS_PER_PROCESS;
+   unsigned int cycles = CYCLES;
+
+   if (ScanBench_parseArguments(argc, argv, &tasks, &sizes, &tasksPerProcess, &cycles) != STATUS_OK)
+      return 1;
+
+   /* Without --procfs a temporary directory is passed as one */
+   char tempDir[PATH_MAX] = "";
+   if (String_eq(LinuxProcessList_procDir, PROCDIR)) {
+      const char* tmp = getenv("TMPDIR");
+      xSnprintf(tempDir, sizeof(tempDir), "%s/htop-scan-bench-XXXXXX", tmp ? tmp : "/tmp");
+      if (!mkdtemp(tempDir)) {
+         perror("Error: can not create a temporary directory");
+         return 1;
+      }
+
+      char option[PATH_MAX + 16];
+      xSnprintf(option, sizeof(option), "--procfs=%s", tempDir);
+      char* args[] = { argv[0], option, NULL };
+      optind = 1;
+      if (ScanBench_parseArguments(2, args, &tasks, &sizes, &tasksPerProcess, &cycles) != STATUS_OK)
+         return 1;
+   } else if (access(LinuxProcessList_procDir, W_OK) != 0) {
+      fprintf(stderr, "Error: the proc filesystem is generated in %s, which has to be writable\n", LinuxProcessList_procDir);
+      return 1;
+   }
+
+   /* The defaults, not the configuration of whoever runs this */
+   char rcfile[PATH_MAX + 16];
+   xSnprintf(rcfile, sizeof(rcfile), "%s/htoprc", LinuxProcessList_procDir);
+   setenv("HTOPRC", rcfile, 1);
+
+   Bench_init();
+
+   /* The panel is drawn to a terminal that is never refreshed */
+   FILE* out = fopen("/dev/null", "w");
+   FILE* in = fopen("/dev/null", "r");
+   SCREEN* screen = out && in ? newterm("xterm", out, in) : NULL;
+   if (screen)
+      resizeterm(PANEL_ROWS + 2, PANEL_COLUMNS);
+   else
+      Bench_section("No terminal to draw to, Panel_draw is skipped");
+
+   bool ok = Platform_init();
+
+   Process_setupColumnWidths();
+   UsersTable* ut = UsersTable_new();
+   Hashtable* dc = DynamicColumns_new();
+   Hashtable* dm = DynamicMeters_new();
+   if (!dc)
+      dc = Hashtable_new(0, true);
+
+   for (size_t i = 0; ok && i < sizes; i++)
+      ok = ScanBench_run(LinuxProcessList_procDir, tasks[i], tasksPerProcess, cycles, ut, dm, dc, screen != NULL);
+
+   Platform_done();
+   UsersTable_delete(ut);
+   DynamicColumns_delete(dc);
+   DynamicMeters_delete(dm);
+
+   if (screen) {
+      endwin();
+      delscreen(screen);
+   }
+   if (out)
+      fclose(out);
+   if (in)
+      fclose(in);
+
+   if (tempDir[0])
+      rmdir(tempDir);
+   free(tasks);
+
+   return ok ? 0 : 1;
+}
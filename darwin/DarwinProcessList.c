@@ -91,7 +91,7 @@ static struct kinfo_proc* ProcessList_getKInfoProcs(size_t* count) {
 ProcessList* ProcessList_new(UsersTable* usersTable, Hashtable* dynamicMeters, Hashtable* dynamicColumns, Hashtable* pidMatchList, uid_t userId) {
    DarwinProcessList* this = xCalloc(1, sizeof(DarwinProcessList));
 
-   ProcessList_init(&this->super, Class(DarwinProcess), usersTable, dynamicMeters, dynamicColumns, pidMatchList, userId);
+   ProcessList_init(&this->super, Class(DarwinProcess), DarwinProcess_new, usersTable, dynamicMeters, dynamicColumns, pidMatchList, userId);
 
    /* Initialize the CPU information */
    this->super.activeCPUs = ProcessList_allocateCPULoadInfo(&this->prev_load);
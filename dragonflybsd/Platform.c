@@ -28,6 +28,7 @@ in the source distribution for its full text.
 #include "SwapMeter.h"
 #include "SysArchMeter.h"
 #include "TasksMeter.h"
+#include "UpdateIntervalMeter.h"
 #include "UptimeMeter.h"
 #include "dragonflybsd/DragonFlyBSDProcess.h"
 #include "dragonflybsd/DragonFlyBSDProcessList.h"
@@ -86,6 +87,7 @@ const MeterClass* const Platform_meterTypes[] = {
    &SwapMeter_class,
    &TasksMeter_class,
    &UptimeMeter_class,
+   &UpdateIntervalMeter_class,
    &BatteryMeter_class,
    &HostnameMeter_class,
    &SysArchMeter_class,
@@ -101,6 +103,9 @@ const MeterClass* const Platform_meterTypes[] = {
    &RightCPUs4Meter_class,
    &LeftCPUs8Meter_class,
    &RightCPUs8Meter_class,
+   &CPUHeatmapMeter_class,
+   &CPUHeatmapNUMAMeter_class,
+   &CPUHeatmapPackageMeter_class,
    &BlankMeter_class,
    NULL
 };
@@ -119,6 +124,11 @@ void Platform_setBindings(Htop_Action* keys) {
    (void) keys;
 }
 
+void Platform_addEventSources(State* st) {
+   /* no platform-specific event sources */
+   (void) st;
+}
+
 int Platform_getUptime() {
    struct timeval bootTime, currTime;
    int mib[2] = { CTL_KERN, KERN_BOOTTIME };
@@ -232,6 +242,25 @@ FileLocks_ProcessData* Platform_getProcessLocks(pid_t pid) {
    return NULL;
 }
 
+FileLocks_ProcessData* Platform_getSystemLocks(void) {
+   return NULL;
+}
+
+OpenFiles_ProcessData* Platform_getProcessOpenFiles(pid_t pid, OpenFiles_ProcessData* previous) {
+   (void)pid;
+   (void)previous;
+   return NULL;
+}
+
+bool Platform_sampleThreads(pid_t pid, bool stacks, ThreadSample** samples, size_t* count, size_t* capacity) {
+   (void)pid;
+   (void)stacks;
+   (void)samples;
+   (void)count;
+   (void)capacity;
+   return false;
+}
+
 bool Platform_getDiskIO(DiskIOData* data) {
    // TODO
    (void)data;
@@ -20,8 +20,10 @@ in the source distribution for its full text.
 #include "Macros.h"
 #include "Meter.h"
 #include "NetworkIOMeter.h"
+#include "OpenFilesScreen.h"
 #include "Process.h"
 #include "ProcessLocksScreen.h"
+#include "SamplingScreen.h"
 #include "SignalsPanel.h"
 #include "CommandLine.h"
 #include "generic/gettime.h"
@@ -43,6 +45,8 @@ void Platform_done(void);
 
 void Platform_setBindings(Htop_Action* keys);
 
+void Platform_addEventSources(State* st);
+
 int Platform_getUptime(void);
 
 void Platform_getLoadAverage(double* one, double* five, double* fifteen);
@@ -61,6 +65,12 @@ char* Platform_getInodeFilename(pid_t pid, ino_t inode);
 
 FileLocks_ProcessData* Platform_getProcessLocks(pid_t pid);
 
+FileLocks_ProcessData* Platform_getSystemLocks(void);
+
+OpenFiles_ProcessData* Platform_getProcessOpenFiles(pid_t pid, OpenFiles_ProcessData* previous);
+
+bool Platform_sampleThreads(pid_t pid, bool stacks, ThreadSample** samples, size_t* count, size_t* capacity);
+
 bool Platform_getDiskIO(DiskIOData* data);
 
 bool Platform_getNetworkIO(NetworkIOData* data);
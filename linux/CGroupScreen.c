@@ -0,0 +1,408 @@
+/*
+htop - linux/CGroupScreen.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "linux/CGroupScreen.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FunctionBar.h"
+#include "ListItem.h"
+#include "Macros.h"
+#include "Panel.h"
+#include "Platform.h"
+#include "ProvideCurses.h"
+#include "Vector.h"
+#include "XUtils.h"
+#include "linux/LinuxProcessList.h"
+
+
+static const char* const CGroupScreenFunctions[] = {"Search ", "Filter ", "Refresh", "Members", "Done   ", NULL};
+
+static const char* const CGroupScreenKeys[] = {"F3", "F4", "F5", "Enter", "Esc"};
+
+static const int CGroupScreenEvents[] = {KEY_F(3), KEY_F(4), KEY_F(5), KEY_ENTER, 27};
+
+/* where the cgroup2 hierarchy is mounted, alone or next to the v1 controllers */
+static const char* const CGroupScreen_roots[] = { "/sys/fs/cgroup", "/sys/fs/cgroup/unified" };
+
+/* nesting deeper than this is not descended into */
+#define CGROUP_MAX_DEPTH 32
+
+CGroupScreen* CGroupScreen_new(const Process* process) {
+   CGroupScreen* this = xCalloc(1, sizeof(CGroupScreen));
+   Object_setClass(this, Class(CGroupScreen));
+
+   for (size_t i = 0; i < ARRAYSIZE(CGroupScreen_roots); i++) {
+      char path[128];
+      xSnprintf(path, sizeof(path), "%s/cgroup.controllers", CGroupScreen_roots[i]);
+      if (access(path, F_OK) == 0) {
+         String_safeStrncpy(this->root, CGroupScreen_roots[i], sizeof(this->root));
+         break;
+      }
+   }
+
+   /* start at the cgroup of the process, "0::/PATH" being the one in the cgroup2 hierarchy */
+   char path[64];
+   xSnprintf(path, sizeof(path), "%s/%d/cgroup", LinuxProcessList_procDir, process->pid);
+   char buffer[4096];
+   if (xReadfile(path, buffer, sizeof(buffer)) > 0) {
+      for (const char* line = buffer; line; line = strchr(line, '\n') ? strchr(line, '\n') + 1 : NULL) {
+         if (String_startsWith(line, "0::/")) {
+            this->selectPath = xStrndup(line + 4, strcspn(line + 4, "\n"));
+            break;
+         }
+      }
+   }
+
+   FunctionBar* fuBar = FunctionBar_new(CGroupScreenFunctions, CGroupScreenKeys, CGroupScreenEvents);
+   return (CGroupScreen*) InfoScreen_init(&this->super, process, fuBar, LINES - 2,
+      "  CPU%  THR%  THROTTLED     MEM_KB    ANON_KB    FILE_KB  READ_KB/s WRITE_KB/s  PSI10  PROCS  CGROUP");
+}
+
+static void CGroupScreen_clear(CGroup_Entry* entries, size_t* count) {
+   for (size_t i = 0; i < *count; i++)
+      free(entries[i].path);
+   *count = 0;
+}
+
+void CGroupScreen_delete(Object* cast) {
+   CGroupScreen* this = (CGroupScreen*) cast;
+   CGroupScreen_clear(this->entries, &this->count);
+   CGroupScreen_clear(this->previous, &this->previousCount);
+   free(this->entries);
+   free(this->previous);
+   free(this->selectPath);
+   free(InfoScreen_done(&this->super));
+}
+
+static void CGroupScreen_draw(InfoScreen* super) {
+   const CGroupScreen* this = (const CGroupScreen*) super;
+   InfoScreen_drawTitled(super, "Control groups under %s: %zu, rates per second",
+      this->root[0] ? this->root : "/sys/fs/cgroup", this->count);
+}
+
+/* The value of the line "NAME VALUE" in a flat keyed file like cpu.stat */
+static unsigned long long CGroupScreen_field(const char* buffer, const char* name) {
+   size_t len = strlen(name);
+   for (const char* line = buffer; line; line = strchr(line, '\n') ? strchr(line, '\n') + 1 : NULL) {
+      if (strncmp(line, name, len) == 0 && line[len] == ' ')
+         return strtoull(line + len + 1, NULL, 10);
+   }
+   return 0;
+}
+
+/* The number of processes in cgroup.procs, or their PIDs too; it is read in chunks as it lists all of them for the root */
+static unsigned int CGroupScreen_readProcs(int dirfd, pid_t** pids, size_t* capacity) {
+   int fd = openat(dirfd, "cgroup.procs", O_RDONLY | O_CLOEXEC);
+   if (fd < 0)
+      return 0;
+
+   unsigned int count = 0;
+   pid_t pid = 0;
+   char buffer[4096];
+   for (;;) {
+      ssize_t res = read(fd, buffer, sizeof(buffer));
+      if (res < 0 && errno == EINTR)
+         continue;
+      if (res <= 0)
+         break;
+
+      for (ssize_t i = 0; i < res; i++) {
+         if (buffer[i] >= '0' && buffer[i] <= '9') {
+            pid = pid * 10 + (buffer[i] - '0');
+            continue;
+         }
+
+         if (pids) {
+            if (count == *capacity) {
+               *capacity = MAXIMUM(2 * *capacity, 64);
+               *pids = xReallocArray(*pids, *capacity, sizeof(pid_t));
+            }
+            (*pids)[count] = pid;
+         }
+         count++;
+         pid = 0;
+      }
+   }
+
+   close(fd);
+   return count;
+}
+
+static void CGroupScreen_readEntry(CGroupScreen* this, int dirfd, const char* path, int depth) {
+   if (this->count == this->capacity) {
+      this->capacity = MAXIMUM(2 * this->capacity, 64);
+      this->entries = xReallocArray(this->entries, this->capacity, sizeof(CGroup_Entry));
+   }
+   CGroup_Entry* entry = &this->entries[this->count++];
+   *entry = (CGroup_Entry) {
+      .path = xStrdup(path),
+      .depth = depth,
+      .cpuPercent = -1,
+      .throttledPercent = -1,
+      .readRate = -1,
+      .writeRate = -1,
+   };
+
+   char buffer[8192];
+   if (xReadfileat(dirfd, "cpu.stat", buffer, sizeof(buffer)) > 0) {
+      entry->usageUsec = CGroupScreen_field(buffer, "usage_usec");
+      entry->nrThrottled = CGroupScreen_field(buffer, "nr_throttled");
+      entry->throttledUsec = CGroupScreen_field(buffer, "throttled_usec");
+   }
+
+   if (xReadfileat(dirfd, "memory.current", buffer, sizeof(buffer)) > 0) {
+      entry->memoryCurrent = strtoull(buffer, NULL, 10);
+      entry->hasMemory = true;
+   }
+
+   if (xReadfileat(dirfd, "memory.stat", buffer, sizeof(buffer)) > 0) {
+      entry->anon = CGroupScreen_field(buffer, "anon");
+      entry->file = CGroupScreen_field(buffer, "file");
+   }
+
+   /* a line per device, "MAJ:MIN rbytes=N wbytes=N rios=N ..." */
+   if (xReadfileat(dirfd, "io.stat", buffer, sizeof(buffer)) > 0) {
+      for (const char* field = buffer; (field = strchr(field, ' ')); field++) {
+         if (String_startsWith(field + 1, "rbytes="))
+            entry->readBytes += strtoull(field + 8, NULL, 10);
+         else if (String_startsWith(field + 1, "wbytes="))
+            entry->writeBytes += strtoull(field + 8, NULL, 10);
+      }
+   }
+
+   if (xReadfileat(dirfd, "cpu.pressure", buffer, sizeof(buffer)) > 0)
+      entry->hasPressure = sscanf(buffer, "some avg10=%32lf", &entry->cpuSome10) == 1;
+
+   entry->procs = CGroupScreen_readProcs(dirfd, NULL, NULL);
+}
+
+/* Takes over dirfd */
+static void CGroupScreen_walk(CGroupScreen* this, int dirfd, const char* path, int depth) {
+   CGroupScreen_readEntry(this, dirfd, path, depth);
+
+   DIR* dir = depth < CGROUP_MAX_DEPTH ? fdopendir(dirfd) : NULL;
+   if (!dir) {
+      close(dirfd);
+      return;
+   }
+
+   const struct dirent* dirent;
+   while ((dirent = readdir(dir))) {
+      if (dirent->d_type != DT_DIR || dirent->d_name[0] == '.')
+         continue;
+
+      int child = openat(dirfd, dirent->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+      if (child < 0)
+         continue;
+
+      char* childPath = path[0] ? String_cat(path, "/") : NULL;
+      char* fullPath = String_cat(childPath ? childPath : "", dirent->d_name);
+      CGroupScreen_walk(this, child, fullPath, depth + 1);
+      free(fullPath);
+      free(childPath);
+   }
+
+   closedir(dir);
+}
+
+/* By path, but with the separator first, so each cgroup is followed by its children */
+static int CGroup_Entry_compare(const void* v1, const void* v2) {
+   const unsigned char* p1 = (const unsigned char*) ((const CGroup_Entry*)v1)->path;
+   const unsigned char* p2 = (const unsigned char*) ((const CGroup_Entry*)v2)->path;
+   while (*p1 && *p1 == *p2) {
+      p1++;
+      p2++;
+   }
+   int c1 = *p1 == '/' ? 1 : *p1;
+   int c2 = *p2 == '/' ? 1 : *p2;
+   return c1 - c2;
+}
+
+static void CGroupScreen_read(CGroupScreen* this) {
+   /* the entries read last become the previous ones, to take the rates from */
+   CGroupScreen_clear(this->previous, &this->previousCount);
+   CGroup_Entry* entries = this->previous;
+   size_t capacity = this->previousCapacity;
+   this->previous = this->entries;
+   this->previousCount = this->count;
+   this->previousCapacity = this->capacity;
+   this->previousMs = this->lastMs;
+   this->entries = entries;
+   this->count = 0;
+   this->capacity = capacity;
+
+   Platform_gettime_monotonic(&this->lastMs);
+   if (!this->root[0])
+      return;
+
+   int dirfd = open(this->root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+   if (dirfd < 0)
+      return;
+
+   CGroupScreen_walk(this, dirfd, "", 0);
+   qsort(this->entries, this->count, sizeof(CGroup_Entry), CGroup_Entry_compare);
+
+   double seconds = (double)(this->lastMs - this->previousMs) / 1000.0;
+   for (size_t i = 0; i < this->count; i++) {
+      CGroup_Entry* entry = &this->entries[i];
+      const CGroup_Entry* before = bsearch(entry, this->previous, this->previousCount, sizeof(CGroup_Entry), CGroup_Entry_compare);
+      if (!before)
+         continue;
+
+      entry->expanded = before->expanded;
+      /* counters of a cgroup recreated under the same name start over */
+      if (seconds <= 0 || entry->usageUsec < before->usageUsec)
+         continue;
+
+      entry->cpuPercent = (double)(entry->usageUsec - before->usageUsec) / seconds / 10000.0;
+      entry->throttledPercent = (double)(entry->throttledUsec - before->throttledUsec) / seconds / 10000.0;
+      entry->readRate = (double)(entry->readBytes - before->readBytes) / seconds / ONE_K;
+      entry->writeRate = (double)(entry->writeBytes - before->writeBytes) / seconds / ONE_K;
+   }
+}
+
+/* The key of a line is the index of its cgroup plus one, 0 for none */
+static void CGroupScreen_addLine(InfoScreen* super, const char* line, size_t index) {
+   InfoScreen_addLine(super, line);
+   ListItem* item = (ListItem*) Vector_get(super->lines, Vector_size(super->lines) - 1);
+   item->key = (int)index + 1;
+}
+
+static void CGroupScreen_addMembers(CGroupScreen* this, size_t index) {
+   const CGroup_Entry* entry = &this->entries[index];
+   char path[4096];
+   xSnprintf(path, sizeof(path), "%s/%s", this->root, entry->path);
+   int dirfd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+   if (dirfd < 0)
+      return;
+
+   pid_t* pids = NULL;
+   size_t capacity = 0;
+   unsigned int count = CGroupScreen_readProcs(dirfd, &pids, &capacity);
+   close(dirfd);
+
+   int indent = 2 * MINIMUM(entry->depth, 20) + 2;
+   for (unsigned int i = 0; i < count; i++) {
+      char comm[64] = "";
+      xSnprintf(path, sizeof(path), "%s/%d/comm", LinuxProcessList_procDir, pids[i]);
+      if (xReadfile(path, comm, sizeof(comm)) > 0)
+         comm[strcspn(comm, "\n")] = '\0';
+
+      char line[256];
+      xSnprintf(line, sizeof(line), "%96s%*s%d %s", "", indent, "", pids[i], comm);
+      CGroupScreen_addLine(&this->super, line, index);
+   }
+   free(pids);
+}
+
+static void CGroupScreen_build(CGroupScreen* this) {
+   InfoScreen* super = &this->super;
+   Panel* panel = super->display;
+   int idx = Panel_getSelectedIndex(panel);
+   Panel_prune(panel);
+   Vector_prune(super->lines);
+
+   if (!this->root[0]) {
+      InfoScreen_addLine(super, "No cgroup v2 hierarchy is mounted.");
+      return;
+   }
+
+   for (size_t i = 0; i < this->count; i++) {
+      const CGroup_Entry* entry = &this->entries[i];
+      const char* name = strrchr(entry->path, '/');
+      name = entry->depth == 0 ? "/" : name ? name + 1 : entry->path;
+
+      char cpu[16] = "     -";
+      char throttled[16] = "    -";
+      char read[16] = "         -";
+      char write[16] = "         -";
+      if (entry->cpuPercent >= 0) {
+         xSnprintf(cpu, sizeof(cpu), "%6.1f", entry->cpuPercent);
+         xSnprintf(throttled, sizeof(throttled), "%5.1f", entry->throttledPercent);
+         xSnprintf(read, sizeof(read), "%10.1f", entry->readRate);
+         xSnprintf(write, sizeof(write), "%10.1f", entry->writeRate);
+      }
+      char memory[16] = "         -";
+      if (entry->hasMemory)
+         xSnprintf(memory, sizeof(memory), "%10llu", entry->memoryCurrent / ONE_K);
+      char pressure[16] = "     -";
+      if (entry->hasPressure)
+         xSnprintf(pressure, sizeof(pressure), "%6.2f", entry->cpuSome10);
+
+      if (this->selectPath && String_eq(this->selectPath, entry->path))
+         idx = Vector_size(super->lines);
+
+      char line[4200];
+      xSnprintf(line, sizeof(line), "%s %s %10llu %s %10llu %10llu %s %s %s %6u  %*s%s%s",
+         cpu, throttled, entry->nrThrottled, memory, entry->anon / ONE_K, entry->file / ONE_K,
+         read, write, pressure, entry->procs,
+         2 * MINIMUM(entry->depth, 20), "", entry->expanded ? "-" : "+", name);
+      CGroupScreen_addLine(super, line, i);
+
+      if (entry->expanded)
+         CGroupScreen_addMembers(this, i);
+   }
+
+   free(this->selectPath);
+   this->selectPath = NULL;
+   Panel_setSelected(panel, idx);
+}
+
+static void CGroupScreen_scan(InfoScreen* super) {
+   CGroupScreen* this = (CGroupScreen*) super;
+   CGroupScreen_read(this);
+   CGroupScreen_build(this);
+}
+
+/* Called whenever no key was pressed within the refresh delay */
+static void CGroupScreen_onErr(InfoScreen* super) {
+   CGroupScreen_scan(super);
+   InfoScreen_draw(super);
+}
+
+static bool CGroupScreen_onKey(InfoScreen* super, int ch) {
+   CGroupScreen* this = (CGroupScreen*) super;
+   switch (ch) {
+      case '\n':
+      case '\r':
+      case KEY_ENTER: {
+         const ListItem* item = (const ListItem*) Panel_getSelected(super->display);
+         if (!item || item->key == 0)
+            return true;
+
+         /* a member line collapses its cgroup again */
+         CGroup_Entry* entry = &this->entries[item->key - 1];
+         entry->expanded = !entry->expanded;
+         if (!entry->expanded)
+            this->selectPath = xStrdup(entry->path);
+         CGroupScreen_build(this);
+         InfoScreen_draw(this);
+         return true;
+      }
+   }
+   return false;
+}
+
+const InfoScreenClass CGroupScreen_class = {
+   .super = {
+      .extends = Class(Object),
+      .delete = CGroupScreen_delete
+   },
+   .scan = CGroupScreen_scan,
+   .draw = CGroupScreen_draw,
+   .onErr = CGroupScreen_onErr,
+   .onKey = CGroupScreen_onKey
+};
@@ -0,0 +1,72 @@
+#ifndef HEADER_CGroupScreen
+#define HEADER_CGroupScreen
+/*
+htop - linux/CGroupScreen.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "InfoScreen.h"
+#include "Object.h"
+#include "Process.h"
+
+
+/* The counters of one cgroup, read from its files in the cgroup2 hierarchy */
+typedef struct CGroup_Entry_ {
+   char* path;                /* relative to the mount, empty for the root */
+   int depth;
+   bool expanded;             /* its member processes are listed */
+
+   unsigned long long usageUsec;
+   unsigned long long nrThrottled;
+   unsigned long long throttledUsec;
+   unsigned long long readBytes;
+   unsigned long long writeBytes;
+   unsigned long long memoryCurrent;  /* in bytes, none for the root */
+   unsigned long long anon;
+   unsigned long long file;
+   double cpuSome10;          /* cpu.pressure, "some" over 10 seconds in percent */
+   unsigned int procs;
+   bool hasMemory;
+   bool hasPressure;
+
+   /* per second since the previous refresh, negative before there was one */
+   double cpuPercent;
+   double throttledPercent;
+   double readRate;
+   double writeRate;
+} CGroup_Entry;
+
+/*
+ * Sums up resource usage per cgroup instead of per process: reads the
+ * counters each cgroup keeps itself, so the cost grows with the number of
+ * cgroups (e.g. containers and services), not with the processes in them.
+ */
+typedef struct CGroupScreen_ {
+   InfoScreen super;
+   char root[64];             /* mount of the cgroup2 hierarchy, empty if there is none */
+   char* selectPath;          /* cgroup to select once it was read */
+
+   CGroup_Entry* entries;     /* sorted by path, so in tree order */
+   size_t count;
+   size_t capacity;
+
+   CGroup_Entry* previous;    /* of the last refresh, for the rates */
+   size_t previousCount;
+   size_t previousCapacity;
+   uint64_t previousMs;
+   uint64_t lastMs;
+} CGroupScreen;
+
+extern const InfoScreenClass CGroupScreen_class;
+
+CGroupScreen* CGroupScreen_new(const Process* process);
+
+void CGroupScreen_delete(Object* cast);
+
+#endif
@@ -21,6 +21,7 @@ in the source distribution for its full text.
 #include "RichString.h"
 #include "XUtils.h"
 #include "linux/IOPriority.h"
+#include "linux/LinuxProcessList.h"
 
 
 /* semi-global */
@@ -159,15 +160,16 @@ bool LinuxProcess_setIOPriority(Process* this, Arg ioprio) {
 }
 
 bool LinuxProcess_isAutogroupEnabled(void) {
+   char path[4096];
    char buf[16];
-   if (xReadfile(PROCDIR "/sys/kernel/sched_autogroup_enabled", buf, sizeof(buf)) < 0)
+   if (xReadfile(LinuxProcessList_procPath(path, sizeof(path), "sys/kernel/sched_autogroup_enabled"), buf, sizeof(buf)) < 0)
       return false;
    return buf[0] == '1';
 }
 
 bool LinuxProcess_changeAutogroupPriorityBy(Process* this, Arg delta) {
    char buffer[256];
-   xSnprintf(buffer, sizeof(buffer), PROCDIR "/%d/autogroup", this->pid);
+   xSnprintf(buffer, sizeof(buffer), "%s/%d/autogroup", LinuxProcessList_procDir, this->pid);
 
    FILE* file = fopen(buffer, "r+");
    if (!file)
@@ -395,6 +397,97 @@ static int LinuxProcess_compareByKey(const Process* v1, const Process* v2, Proce
    }
 }
 
+static void LinuxProcess_getFieldValue(const Process* this, ProcessField field, ProcessFieldValue* value) {
+   const LinuxProcess* lp = (const LinuxProcess*) this;
+
+   switch (field) {
+   case CMINFLT: ProcessFieldValue_setInteger(value, lp->cminflt); break;
+   case CMAJFLT: ProcessFieldValue_setInteger(value, lp->cmajflt); break;
+   case M_DRS: ProcessFieldValue_setInteger(value, (long long)lp->m_drs * pageSize); break;
+   case M_LRS:
+      if (lp->m_lrs)
+         ProcessFieldValue_setInteger(value, (long long)lp->m_lrs * pageSize);
+      else
+         value->type = PROCESS_VALUE_NONE;
+      break;
+   case M_TRS: ProcessFieldValue_setInteger(value, (long long)lp->m_trs * pageSize); break;
+   case M_SHARE: ProcessFieldValue_setInteger(value, (long long)lp->m_share * pageSize); break;
+   case M_PSS: ProcessFieldValue_setInteger(value, (long long)lp->m_pss * 1024); break;
+   case M_SWAP: ProcessFieldValue_setInteger(value, (long long)lp->m_swap * 1024); break;
+   case M_PSSWP: ProcessFieldValue_setInteger(value, (long long)lp->m_psswp * 1024); break;
+   case UTIME: ProcessFieldValue_setReal(value, lp->utime / 100.0); break;
+   case STIME: ProcessFieldValue_setReal(value, lp->stime / 100.0); break;
+   case CUTIME: ProcessFieldValue_setReal(value, lp->cutime / 100.0); break;
+   case CSTIME: ProcessFieldValue_setReal(value, lp->cstime / 100.0); break;
+   case RCHAR: ProcessFieldValue_setInteger(value, lp->io_rchar); break;
+   case WCHAR: ProcessFieldValue_setInteger(value, lp->io_wchar); break;
+   case SYSCR: ProcessFieldValue_setInteger(value, lp->io_syscr); break;
+   case SYSCW: ProcessFieldValue_setInteger(value, lp->io_syscw); break;
+   case RBYTES: ProcessFieldValue_setInteger(value, lp->io_read_bytes); break;
+   case WBYTES: ProcessFieldValue_setInteger(value, lp->io_write_bytes); break;
+   case CNCLWB: ProcessFieldValue_setInteger(value, lp->io_cancelled_write_bytes); break;
+   case IO_READ_RATE: ProcessFieldValue_setReal(value, lp->io_rate_read_bps); break;
+   case IO_WRITE_RATE: ProcessFieldValue_setReal(value, lp->io_rate_write_bps); break;
+   case IO_RATE:
+      if (isnan(lp->io_rate_read_bps))
+         ProcessFieldValue_setReal(value, lp->io_rate_write_bps);
+      else if (isnan(lp->io_rate_write_bps))
+         ProcessFieldValue_setReal(value, lp->io_rate_read_bps);
+      else
+         ProcessFieldValue_setReal(value, lp->io_rate_read_bps + lp->io_rate_write_bps);
+      break;
+   #ifdef HAVE_OPENVZ
+   case CTID: ProcessFieldValue_setString(value, lp->ctid); break;
+   case VPID: ProcessFieldValue_setInteger(value, lp->vpid); break;
+   #endif
+   #ifdef HAVE_VSERVER
+   case VXID: ProcessFieldValue_setInteger(value, lp->vxid); break;
+   #endif
+   case CGROUP: ProcessFieldValue_setString(value, lp->cgroup); break;
+   case OOM: ProcessFieldValue_setInteger(value, lp->oom); break;
+   case IO_PRIORITY: {
+      int klass = IOPriority_class(lp->ioPriority);
+      if (klass == IOPRIO_CLASS_NONE) {
+         // see note [1] above
+         xSnprintf(value->buffer, sizeof(value->buffer), "B%d", (int) (this->nice + 20) / 5);
+      } else if (klass == IOPRIO_CLASS_BE) {
+         xSnprintf(value->buffer, sizeof(value->buffer), "B%d", IOPriority_data(lp->ioPriority));
+      } else if (klass == IOPRIO_CLASS_RT) {
+         xSnprintf(value->buffer, sizeof(value->buffer), "R%d", IOPriority_data(lp->ioPriority));
+      } else if (klass == IOPRIO_CLASS_IDLE) {
+         xSnprintf(value->buffer, sizeof(value->buffer), "id");
+      } else {
+         value->type = PROCESS_VALUE_NONE;
+         break;
+      }
+      ProcessFieldValue_setString(value, value->buffer);
+      break;
+   }
+   #ifdef HAVE_DELAYACCT
+   case PERCENT_CPU_DELAY: ProcessFieldValue_setReal(value, lp->cpu_delay_percent); break;
+   case PERCENT_IO_DELAY: ProcessFieldValue_setReal(value, lp->blkio_delay_percent); break;
+   case PERCENT_SWAP_DELAY: ProcessFieldValue_setReal(value, lp->swapin_delay_percent); break;
+   #endif
+   case CTXT: ProcessFieldValue_setInteger(value, lp->ctxt_diff); break;
+   case SECATTR: ProcessFieldValue_setString(value, lp->secattr); break;
+   case AUTOGROUP_ID:
+      if (lp->autogroup_id != -1)
+         ProcessFieldValue_setInteger(value, lp->autogroup_id);
+      else
+         value->type = PROCESS_VALUE_NONE;
+      break;
+   case AUTOGROUP_NICE:
+      if (lp->autogroup_id != -1)
+         ProcessFieldValue_setInteger(value, lp->autogroup_nice);
+      else
+         value->type = PROCESS_VALUE_NONE;
+      break;
+   default:
+      Process_getFieldValue_Base(this, field, value);
+      break;
+   }
+}
+
 const ProcessClass LinuxProcess_class = {
    .super = {
       .extends = Class(Process),
@@ -403,5 +496,6 @@ const ProcessClass LinuxProcess_class = {
       .compare = Process_compare
    },
    .writeField = LinuxProcess_writeField,
-   .compareByKey = LinuxProcess_compareByKey
+   .compareByKey = LinuxProcess_compareByKey,
+   .getFieldValue = LinuxProcess_getFieldValue
 };
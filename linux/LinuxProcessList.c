@@ -43,6 +43,7 @@ in the source distribution for its full text.
 #include "Macros.h"
 #include "Object.h"
 #include "Process.h"
+#include "Profile.h"
 #include "Settings.h"
 #include "XUtils.h"
 #include "linux/LinuxProcess.h"
@@ -63,13 +64,23 @@ in the source distribution for its full text.
 #endif
 
 
+const char* LinuxProcessList_procDir = PROCDIR;
+
 static long long btime = -1;
 
 static long jiffy;
 
+ATTR_NORETURN
+static void LinuxProcessList_fatalError(const char* what, const char* path) {
+   char message[4200];
+   xSnprintf(message, sizeof(message), "%s %s", what, path);
+   CRT_fatalError(message);
+}
+
 static FILE* fopenat(openat_arg_t openatArg, const char* pathname, const char* mode) {
    assert(String_eq(mode, "r")); /* only currently supported mode */
 
+   Profile_countFile();
    int fd = Compat_openat(openatArg, pathname, O_RDONLY);
    if (fd < 0)
       return NULL;
@@ -95,8 +106,9 @@ static int sortTtyDrivers(const void* va, const void* vb) {
 static void LinuxProcessList_initTtyDrivers(LinuxProcessList* this) {
    TtyDriver* ttyDrivers;
 
+   char path[4096];
    char buf[16384];
-   ssize_t r = xReadfile(PROCTTYDRIVERSFILE, buf, sizeof(buf));
+   ssize_t r = xReadfile(LinuxProcessList_procPath(path, sizeof(path), "tty/drivers"), buf, sizeof(buf));
    if (r < 0)
       return;
 
@@ -244,7 +256,7 @@ ProcessList* ProcessList_new(UsersTable* usersTable, Hashtable* dynamicMeters, H
    LinuxProcessList* this = xCalloc(1, sizeof(LinuxProcessList));
    ProcessList* pl = &(this->super);
 
-   ProcessList_init(pl, Class(LinuxProcess), usersTable, dynamicMeters, dynamicColumns, pidMatchList, userId);
+   ProcessList_init(pl, Class(LinuxProcess), LinuxProcess_new, usersTable, dynamicMeters, dynamicColumns, pidMatchList, userId);
    LinuxProcessList_initTtyDrivers(this);
 
    // Initialize page size
@@ -259,12 +271,13 @@ ProcessList* ProcessList_new(UsersTable* usersTable, Hashtable* dynamicMeters, H
       CRT_fatalError("Cannot get clock ticks by sysconf(_SC_CLK_TCK)");
 
    // Test /proc/PID/smaps_rollup availability (faster to parse, Linux 4.14+)
-   this->haveSmapsRollup = (access(PROCDIR "/self/smaps_rollup", R_OK) == 0);
+   char path[4096];
+   this->haveSmapsRollup = (access(LinuxProcessList_procPath(path, sizeof(path), "self/smaps_rollup"), R_OK) == 0);
 
    // Read btime (the kernel boot time, as number of seconds since the epoch)
-   FILE* statfile = fopen(PROCSTATFILE, "r");
+   FILE* statfile = fopen(LinuxProcessList_procPath(path, sizeof(path), "stat"), "r");
    if (statfile == NULL)
-      CRT_fatalError("Cannot open " PROCSTATFILE);
+      LinuxProcessList_fatalError("Cannot open", path);
    while (true) {
       char buffer[PROC_LINE_LENGTH + 1];
       if (fgets(buffer, sizeof(buffer), statfile) == NULL)
@@ -273,13 +286,13 @@ ProcessList* ProcessList_new(UsersTable* usersTable, Hashtable* dynamicMeters, H
          continue;
       if (sscanf(buffer, "btime %lld\n", &btime) == 1)
          break;
-      CRT_fatalError("Failed to parse btime from " PROCSTATFILE);
+      LinuxProcessList_fatalError("Failed to parse btime from", path);
    }
 
    fclose(statfile);
 
    if (btime == -1)
-      CRT_fatalError("No btime in " PROCSTATFILE);
+      LinuxProcessList_fatalError("No btime in", path);
 
    // Initialize CPU count
    LinuxProcessList_updateCPUcount(pl);
@@ -529,48 +542,6 @@ typedef struct LibraryData_ {
    bool exec;
 } LibraryData;
 
-static inline uint64_t fast_strtoull_dec(char** str, int maxlen) {
-   register uint64_t result = 0;
-
-   if (!maxlen)
-      --maxlen;
-
-   while (maxlen-- && **str >= '0' && **str <= '9') {
-      result *= 10;
-      result += **str - '0';
-      (*str)++;
-   }
-
-   return result;
-}
-
-static inline uint64_t fast_strtoull_hex(char** str, int maxlen) {
-   register uint64_t result = 0;
-   register int nibble, letter;
-   const long valid_mask = 0x03FF007E;
-
-   if (!maxlen)
-      --maxlen;
-
-   while (maxlen--) {
-      nibble = (unsigned char)**str;
-      if (!(valid_mask & (1 << (nibble & 0x1F))))
-         break;
-      if ((nibble < '0') || (nibble & ~0x20) > 'F')
-         break;
-      letter = (nibble & 0x40) ? 'A' - '9' - 1 : 0;
-      nibble &=~0x20; // to upper
-      nibble ^= 0x10; // switch letters and digits
-      nibble -= letter;
-      nibble &= 0x0f;
-      result <<= 4;
-      result += (uint64_t)nibble;
-      (*str)++;
-   }
-
-   return result;
-}
-
 static void LinuxProcessList_calcLibSize_helper(ATTR_UNUSED ht_key_t key, void* value, void* data) {
    if (!data)
       return;
@@ -759,7 +730,8 @@ static bool LinuxProcessList_readSmapsFile(LinuxProcess* process, openat_arg_t p
 #ifdef HAVE_OPENVZ
 
 static void LinuxProcessList_readOpenVZData(LinuxProcess* process, openat_arg_t procFd) {
-   if (access(PROCDIR "/vz", R_OK) != 0) {
+   char path[4096];
+   if (access(LinuxProcessList_procPath(path, sizeof(path), "vz"), R_OK) != 0) {
       free(process->ctid);
       process->ctid = NULL;
       process->vpid = process->super.pid;
@@ -1342,12 +1314,46 @@ static char* LinuxProcessList_updateTtyDevice(TtyDriver* ttyDrivers, unsigned lo
    return out;
 }
 
+/* The thread group of a task, 0 if its status can not be read */
+static pid_t LinuxProcessList_readTgid(openat_arg_t procFd) {
+   FILE* file = fopenat(procFd, "status", "r");
+   if (!file)
+      return 0;
+
+   char buffer[PROC_LINE_LENGTH + 1];
+   int tgid = 0;
+   while (fgets(buffer, sizeof(buffer), file)) {
+      if (String_startsWith(buffer, "Tgid:")) {
+         if (sscanf(buffer, "Tgid:\t%32d", &tgid) != 1)
+            tgid = 0;
+         break;
+      }
+   }
+   fclose(file);
+   return tgid;
+}
+
+typedef struct MatchPids_ {
+   pid_t* pids;
+   size_t count;
+   size_t capacity;
+} MatchPids;
+
+static void LinuxProcessList_collectMatchPid(ht_key_t key, ATTR_UNUSED void* value, void* data) {
+   MatchPids* match = data;
+   if (match->count == match->capacity) {
+      match->capacity = match->capacity ? match->capacity * 2 : 8;
+      match->pids = xReallocArray(match->pids, match->capacity, sizeof(pid_t));
+   }
+   match->pids[match->count++] = (pid_t) key;
+}
+
 static bool LinuxProcessList_recurseProcTree(LinuxProcessList* this, openat_arg_t parentFd, const char* dirname, const Process* parent, double period) {
    ProcessList* pl = (ProcessList*) this;
-   const struct dirent* entry;
    const Settings* settings = pl->settings;
 
 #ifdef HAVE_OPENAT
+   Profile_countFile();
    int dirFd = openat(parentFd, dirname, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
    if (dirFd < 0)
       return false;
@@ -1365,14 +1371,46 @@ static bool LinuxProcessList_recurseProcTree(LinuxProcessList* this, openat_arg_
    const unsigned int activeCPUs = pl->activeCPUs;
    const bool hideKernelThreads = settings->hideKernelThreads;
    const bool hideUserlandThreads = settings->hideUserlandThreads;
-   while ((entry = readdir(dir)) != NULL) {
-      const char* name = entry->d_name;
 
-      // Ignore all non-directories
-      if (entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN) {
-         continue;
+   /*
+    * With a PID list (-p) only the listed processes can be displayed,
+    * so open their directories directly instead of listing all of /proc.
+    */
+   MatchPids match = { .pids = NULL, .count = 0, .capacity = 0 };
+   size_t matchIndex = 0;
+   const bool listedOnly = !parent && pl->pidMatchList;
+   if (listedOnly) {
+      Hashtable_foreach(pl->pidMatchList, LinuxProcessList_collectMatchPid, &match);
+   }
+
+   for (unsigned int scanned = 0; ; scanned++) {
+      char pidName[16];
+      const char* entryName;
+
+      if (!parent && scanned % 64 == 63)
+         ProcessList_yield(pl);
+
+      if (listedOnly) {
+         if (matchIndex >= match.count)
+            break;
+
+         xSnprintf(pidName, sizeof(pidName), "%d", (int) match.pids[matchIndex++]);
+         entryName = pidName;
+      } else {
+         const struct dirent* entry = readdir(dir);
+         if (!entry)
+            break;
+
+         // Ignore all non-directories
+         if (entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN) {
+            continue;
+         }
+
+         entryName = entry->d_name;
       }
 
+      const char* name = entryName;
+
       // The RedHat kernel hides threads with a dot.
       // I believe this is non-standard.
       if (name[0] == '.') {
@@ -1398,6 +1436,8 @@ static bool LinuxProcessList_recurseProcTree(LinuxProcessList* this, openat_arg_
       if (parent && pid == parent->pid)
          continue;
 
+      ProfileMark mark;
+      bool ok;
       bool preExisting;
       Process* proc = ProcessList_getProcess(pl, pid, &preExisting, LinuxProcess_new);
       LinuxProcess* lp = (LinuxProcess*) proc;
@@ -1406,16 +1446,39 @@ static bool LinuxProcessList_recurseProcTree(LinuxProcessList* this, openat_arg_
       proc->isUserlandThread = proc->pid != proc->tgid;
 
 #ifdef HAVE_OPENAT
-      int procFd = openat(dirFd, entry->d_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+      Profile_countFile();
+      int procFd = openat(dirFd, entryName, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
       if (procFd < 0)
          goto errorReadingProcess;
 #else
       char procFd[4096];
-      xSnprintf(procFd, sizeof(procFd), "%s/%s", dirFd, entry->d_name);
+      xSnprintf(procFd, sizeof(procFd), "%s/%s", dirFd, entryName);
 #endif
 
+      /* A PID from the list (-p) may name a thread, which is not a process of its own */
+      if (listedOnly && !preExisting && LinuxProcessList_readTgid(procFd) != pid)
+         goto errorReadingProcess;
+
+      if (! LinuxProcessList_updateUser(pl, proc, procFd))
+         goto errorReadingProcess;
+
+      /* Threads are counted and kept even if their process is skipped */
       LinuxProcessList_recurseProcTree(this, procFd, "task", proc, period);
 
+      /* Known processes of other users are not displayed with -u, skip them */
+      if (preExisting && ProcessList_rejectsUser(pl, proc)) {
+         if (Process_isKernelThread(proc)) {
+            pl->kernelThreads++;
+         } else if (Process_isUserlandThread(proc)) {
+            pl->userlandThreads++;
+         }
+         proc->updated = true;
+         proc->partial = true;
+         pl->totalTasks++;
+         Compat_openatArgClose(procFd);
+         continue;
+      }
+
       /*
        * These conditions will not trigger on first occurrence, cause we need to
        * add the process to the ProcessList and do all one time scans
@@ -1439,12 +1502,54 @@ static bool LinuxProcessList_recurseProcTree(LinuxProcessList* this, openat_arg_
          continue;
       }
 
-      if (settings->flags & PROCESS_FLAG_IO)
+      char statCommand[MAX_NAME + 1];
+      unsigned long long int lasttimes = (lp->utime + lp->stime);
+      unsigned long int tty_nr = proc->tty_nr;
+      Profile_begin(&mark);
+      ok = LinuxProcessList_readStatFile(proc, procFd, statCommand, sizeof(statCommand));
+      Profile_end(&mark, PROFILE_READ_STAT);
+      if (!ok)
+         goto errorReadingProcess;
+
+      if (tty_nr != proc->tty_nr && this->ttyDrivers) {
+         free(proc->tty_name);
+         proc->tty_name = LinuxProcessList_updateTtyDevice(this->ttyDrivers, proc->tty_nr);
+      }
+
+      /* period might be 0 after system sleep */
+      float percent_cpu = (period < 1E-6) ? 0.0F : ((lp->utime + lp->stime - lasttimes) / period * 100.0);
+      proc->percent_cpu = CLAMP(percent_cpu, 0.0F, activeCPUs * 100.0F);
+
+      /* Skip all further reads for known processes the filters already reject */
+      if (preExisting && ProcessList_rejectsEarly(pl, proc)) {
+         if (Process_isKernelThread(proc)) {
+            pl->kernelThreads++;
+         } else if (Process_isUserlandThread(proc)) {
+            pl->userlandThreads++;
+         }
+         proc->updated = true;
+         proc->partial = true;
+         pl->totalTasks++;
+         Compat_openatArgClose(procFd);
+         continue;
+      }
+
+      proc->partial = false;
+
+      if (settings->flags & PROCESS_FLAG_IO) {
+         Profile_begin(&mark);
          LinuxProcessList_readIoFile(lp, procFd, pl->realtimeMs);
+         Profile_end(&mark, PROFILE_READ_IO);
+      }
 
-      if (!LinuxProcessList_readStatmFile(lp, procFd))
+      Profile_begin(&mark);
+      ok = LinuxProcessList_readStatmFile(lp, procFd);
+      Profile_end(&mark, PROFILE_READ_STATM);
+      if (!ok)
          goto errorReadingProcess;
 
+      proc->percent_mem = proc->m_resident / (double)(pl->totalMem) * 100.0;
+
       {
          bool prev = proc->usesDeletedLib;
 
@@ -1457,7 +1562,9 @@ static bool LinuxProcessList_recurseProcTree(LinuxProcessList* this, openat_arg_
 
             if (passedTimeInMs > recheck) {
                lp->last_mlrs_calctime = pl->realtimeMs;
+               Profile_begin(&mark);
                LinuxProcessList_readMaps(lp, procFd, settings->flags & PROCESS_FLAG_LINUX_LRS_FIX, settings->highlightDeletedExe);
+               Profile_end(&mark, PROFILE_READ_MAPS);
             }
          } else {
             /* Copy from process structure in threads and reset if setting got disabled */
@@ -1472,7 +1579,9 @@ static bool LinuxProcessList_recurseProcTree(LinuxProcessList* this, openat_arg_
             // Read smaps file of each process only every second pass to improve performance
             static int smaps_flag = 0;
             if ((pid & 1) == smaps_flag) {
+               Profile_begin(&mark);
                LinuxProcessList_readSmapsFile(lp, procFd, this->haveSmapsRollup);
+               Profile_end(&mark, PROFILE_READ_SMAPS);
             }
             if (pid == 1) {
                smaps_flag = !smaps_flag;
@@ -1482,29 +1591,12 @@ static bool LinuxProcessList_recurseProcTree(LinuxProcessList* this, openat_arg_
          }
       }
 
-      char statCommand[MAX_NAME + 1];
-      unsigned long long int lasttimes = (lp->utime + lp->stime);
-      unsigned long int tty_nr = proc->tty_nr;
-      if (! LinuxProcessList_readStatFile(proc, procFd, statCommand, sizeof(statCommand)))
-         goto errorReadingProcess;
-
-      if (tty_nr != proc->tty_nr && this->ttyDrivers) {
-         free(proc->tty_name);
-         proc->tty_name = LinuxProcessList_updateTtyDevice(this->ttyDrivers, proc->tty_nr);
-      }
-
       if (settings->flags & PROCESS_FLAG_LINUX_IOPRIO) {
+         Profile_begin(&mark);
          LinuxProcess_updateIOPriority(lp);
+         Profile_end(&mark, PROFILE_READ_OTHER);
       }
 
-      /* period might be 0 after system sleep */
-      float percent_cpu = (period < 1E-6) ? 0.0F : ((lp->utime + lp->stime - lasttimes) / period * 100.0);
-      proc->percent_cpu = CLAMP(percent_cpu, 0.0F, activeCPUs * 100.0F);
-      proc->percent_mem = proc->m_resident / (double)(pl->totalMem) * 100.0;
-
-      if (! LinuxProcessList_updateUser(pl, proc, procFd))
-         goto errorReadingProcess;
-
       if (!preExisting) {
 
          #ifdef HAVE_OPENVZ
@@ -1519,7 +1611,10 @@ static bool LinuxProcessList_recurseProcTree(LinuxProcessList* this, openat_arg_
          }
          #endif
 
-         if (! LinuxProcessList_readCmdlineFile(proc, procFd)) {
+         Profile_begin(&mark);
+         ok = LinuxProcessList_readCmdlineFile(proc, procFd);
+         Profile_end(&mark, PROFILE_READ_CMDLINE);
+         if (!ok) {
             goto errorReadingProcess;
          }
 
@@ -1528,7 +1623,10 @@ static bool LinuxProcessList_recurseProcTree(LinuxProcessList* this, openat_arg_
          ProcessList_add(pl, proc);
       } else {
          if (settings->updateProcessNames && proc->state != ZOMBIE) {
-            if (! LinuxProcessList_readCmdlineFile(proc, procFd)) {
+            Profile_begin(&mark);
+            ok = LinuxProcessList_readCmdlineFile(proc, procFd);
+            Profile_end(&mark, PROFILE_READ_CMDLINE);
+            if (!ok) {
                goto errorReadingProcess;
             }
          }
@@ -1536,14 +1634,20 @@ static bool LinuxProcessList_recurseProcTree(LinuxProcessList* this, openat_arg_
 
       #ifdef HAVE_DELAYACCT
       if (settings->flags & PROCESS_FLAG_LINUX_DELAYACCT) {
+         Profile_begin(&mark);
          LinuxProcessList_readDelayAcctData(this, lp);
+         Profile_end(&mark, PROFILE_READ_DELAYACCT);
       }
       #endif
 
       if (settings->flags & PROCESS_FLAG_LINUX_CGROUP) {
+         Profile_begin(&mark);
          LinuxProcessList_readCGroupFile(lp, procFd);
+         Profile_end(&mark, PROFILE_READ_CGROUP);
       }
 
+      Profile_begin(&mark);
+
       if (settings->flags & PROCESS_FLAG_LINUX_OOM) {
          LinuxProcessList_readOomData(lp, procFd);
       }
@@ -1564,6 +1668,8 @@ static bool LinuxProcessList_recurseProcTree(LinuxProcessList* this, openat_arg_
          LinuxProcessList_readAutogroup(lp, procFd);
       }
 
+      Profile_end(&mark, PROFILE_READ_OTHER);
+
       if (!proc->cmdline && statCommand[0] &&
           (proc->state == ZOMBIE || Process_isKernelThread(proc) || settings->showThreadNames)) {
          Process_updateCmdline(proc, statCommand, 0, strlen(statCommand));
@@ -1593,13 +1699,13 @@ errorReadingProcess:
             close(procFd);
 #endif
 
-         if (preExisting) {
-            ProcessList_remove(pl, proc);
-         } else {
+         /* Known processes are not marked as updated, ProcessList_scan removes them */
+         if (!preExisting) {
             Process_delete((Object*)proc);
          }
       }
    }
+   free(match.pids);
    closedir(dir);
    return true;
 }
@@ -1616,9 +1722,10 @@ static inline void LinuxProcessList_scanMemoryInfo(ProcessList* this) {
    memory_t swapFreeMem = 0;
    memory_t sreclaimableMem = 0;
 
-   FILE* file = fopen(PROCMEMINFOFILE, "r");
+   char path[4096];
+   FILE* file = fopen(LinuxProcessList_procPath(path, sizeof(path), "meminfo"), "r");
    if (!file)
-      CRT_fatalError("Cannot open " PROCMEMINFOFILE);
+      LinuxProcessList_fatalError("Cannot open", path);
 
    char buffer[128];
    while (fgets(buffer, sizeof(buffer), file)) {
@@ -1795,7 +1902,8 @@ static inline void LinuxProcessList_scanZfsArcstats(LinuxProcessList* lpl) {
    memory_t dnodeSize = 0;
    memory_t bonusSize = 0;
 
-   FILE* file = fopen(PROCARCSTATSFILE, "r");
+   char path[4096];
+   FILE* file = fopen(LinuxProcessList_procPath(path, sizeof(path), "spl/kstat/zfs/arcstats"), "r");
    if (file == NULL) {
       lpl->zfs.enabled = 0;
       return;
@@ -1866,9 +1974,10 @@ static inline double LinuxProcessList_scanCPUTime(ProcessList* super) {
 
    LinuxProcessList_updateCPUcount(super);
 
-   FILE* file = fopen(PROCSTATFILE, "r");
+   char path[4096];
+   FILE* file = fopen(LinuxProcessList_procPath(path, sizeof(path), "stat"), "r");
    if (!file)
-      CRT_fatalError("Cannot open " PROCSTATFILE);
+      LinuxProcessList_fatalError("Cannot open", path);
 
    unsigned int existingCPUs = super->existingCPUs;
    unsigned int lastAdjCpuId = 0;
@@ -2026,7 +2135,8 @@ static int scanCPUFreqencyFromSysCPUFreq(LinuxProcessList* this) {
 }
 
 static void scanCPUFreqencyFromCPUinfo(LinuxProcessList* this) {
-   FILE* file = fopen(PROCCPUINFOFILE, "r");
+   char path[4096];
+   FILE* file = fopen(LinuxProcessList_procPath(path, sizeof(path), "cpuinfo"), "r");
    if (file == NULL)
       return;
 
@@ -2093,6 +2203,9 @@ void ProcessList_goThroughEntries(ProcessList* super, bool pauseProcessUpdate) {
    LinuxProcessList* this = (LinuxProcessList*) super;
    const Settings* settings = super->settings;
 
+   ProfileMark mark;
+   Profile_begin(&mark);
+
    LinuxProcessList_scanMemoryInfo(super);
    LinuxProcessList_scanHugePages(this);
    LinuxProcessList_scanZfsArcstats(this);
@@ -2109,6 +2222,8 @@ void ProcessList_goThroughEntries(ProcessList* super, bool pauseProcessUpdate) {
       LibSensors_getCPUTemperatures(this->cpuData, this->super.existingCPUs, this->super.activeCPUs);
    #endif
 
+   Profile_end(&mark, PROFILE_SYSTEM);
+
    // in pause mode only gather global data for meters (CPU/memory/...)
    if (pauseProcessUpdate) {
       return;
@@ -2124,15 +2239,17 @@ void ProcessList_goThroughEntries(ProcessList* super, bool pauseProcessUpdate) {
       this->haveAutogroup = false;
    }
 
-   /* PROCDIR is an absolute path */
-   assert(PROCDIR[0] == '/');
+   /* The procfs path is absolute */
+   assert(LinuxProcessList_procDir[0] == '/');
 #ifdef HAVE_OPENAT
    openat_arg_t rootFd = AT_FDCWD;
 #else
    openat_arg_t rootFd = "";
 #endif
 
-   LinuxProcessList_recurseProcTree(this, rootFd, PROCDIR, NULL, period);
+   Profile_begin(&mark);
+   LinuxProcessList_recurseProcTree(this, rootFd, LinuxProcessList_procDir, NULL, period);
+   Profile_end(&mark, PROFILE_WALK);
 }
 
 bool ProcessList_isCPUonline(const ProcessList* super, unsigned int id) {
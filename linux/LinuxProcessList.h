@@ -10,11 +10,14 @@ in the source distribution for its full text.
 #include "config.h"
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <sys/types.h>
 
 #include "Hashtable.h"
 #include "ProcessList.h"
 #include "UsersTable.h"
+#include "XUtils.h"
 #include "ZramStats.h"
 #include "zfs/ZfsArcStats.h"
 
@@ -91,25 +94,57 @@ typedef struct LinuxProcessList_ {
 #define PROCDIR "/proc"
 #endif
 
-#ifndef PROCCPUINFOFILE
-#define PROCCPUINFOFILE PROCDIR "/cpuinfo"
-#endif
-
-#ifndef PROCSTATFILE
-#define PROCSTATFILE PROCDIR "/stat"
-#endif
-
-#ifndef PROCMEMINFOFILE
-#define PROCMEMINFOFILE PROCDIR "/meminfo"
-#endif
-
-#ifndef PROCARCSTATSFILE
-#define PROCARCSTATSFILE PROCDIR "/spl/kstat/zfs/arcstats"
-#endif
-
-#ifndef PROCTTYDRIVERSFILE
-#define PROCTTYDRIVERSFILE PROCDIR "/tty/drivers"
-#endif
+/* Absolute path of the proc filesystem, PROCDIR unless set with --procfs */
+extern const char* LinuxProcessList_procDir;
+
+/* Formats the path of an entry below the proc filesystem into buffer */
+static inline const char* LinuxProcessList_procPath(char* buffer, size_t size, const char* name) {
+   xSnprintf(buffer, size, "%s/%s", LinuxProcessList_procDir, name);
+   return buffer;
+}
+
+/* Parsers for the numbers in the maps files, stop after maxlen digits (0 for no limit) */
+static inline uint64_t fast_strtoull_dec(char** str, int maxlen) {
+   register uint64_t result = 0;
+
+   if (!maxlen)
+      --maxlen;
+
+   while (maxlen-- && **str >= '0' && **str <= '9') {
+      result *= 10;
+      result += **str - '0';
+      (*str)++;
+   }
+
+   return result;
+}
+
+static inline uint64_t fast_strtoull_hex(char** str, int maxlen) {
+   register uint64_t result = 0;
+   register int nibble, letter;
+   const long valid_mask = 0x03FF007E;
+
+   if (!maxlen)
+      --maxlen;
+
+   while (maxlen--) {
+      nibble = (unsigned char)**str;
+      if (!(valid_mask & (1 << (nibble & 0x1F))))
+         break;
+      if ((nibble < '0') || (nibble & ~0x20) > 'F')
+         break;
+      letter = (nibble & 0x40) ? 'A' - '9' - 1 : 0;
+      nibble &=~0x20; // to upper
+      nibble ^= 0x10; // switch letters and digits
+      nibble -= letter;
+      nibble &= 0x0f;
+      result <<= 4;
+      result += (uint64_t)nibble;
+      (*str)++;
+   }
+
+   return result;
+}
 
 #ifndef PROC_LINE_LENGTH
 #define PROC_LINE_LENGTH 4096
@@ -0,0 +1,375 @@
+/*
+htop - linux/MemoryMapsScreen.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "linux/MemoryMapsScreen.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FunctionBar.h"
+#include "Macros.h"
+#include "Panel.h"
+#include "ProvideCurses.h"
+#include "Vector.h"
+#include "XUtils.h"
+#include "linux/LinuxProcessList.h"
+
+
+static const char* const MemoryMapsScreenFunctions[] = {"Search ", "Filter ", "Refresh", "SortBy ", "Group  ", "Done   ", NULL};
+
+static const char* const MemoryMapsScreenKeys[] = {"F3", "F4", "F5", "F6", "F7", "Esc"};
+
+static const int MemoryMapsScreenEvents[] = {KEY_F(3), KEY_F(4), KEY_F(5), KEY_F(6), KEY_F(7), 27};
+
+/* smaps is read in chunks of this size, no name is longer than a chunk */
+#define MEMORYMAPS_BUFFER_SIZE 16384
+
+/* the fields of /proc/PID/smaps summed up, all in kB */
+static const struct {
+   const char* field;
+   size_t len;
+   const char* title;
+} MemoryMaps_columns[MEMORYMAPS_COLUMNS] = {
+   [MEMORYMAPS_RSS]           = { "Rss:",           4, "RSS" },
+   [MEMORYMAPS_PSS]           = { "Pss:",           4, "PSS" },
+   [MEMORYMAPS_SWAP]          = { "Swap:",          5, "SWAP" },
+   [MEMORYMAPS_ANONHUGE]      = { "AnonHugePages:", 14, "ANON_HUGE" },
+   [MEMORYMAPS_PRIVATE_DIRTY] = { "Private_Dirty:", 14, "PRIV_DIRTY" },
+};
+
+static const char* const MemoryMaps_groupings[MEMORYMAPS_GROUPINGS] = {
+   [MEMORYMAPS_BY_MAPPING]  = "mapping",
+   [MEMORYMAPS_BY_FILE]     = "file",
+   [MEMORYMAPS_BY_CATEGORY] = "category",
+};
+
+MemoryMapsScreen* MemoryMapsScreen_new(const Process* process) {
+   MemoryMapsScreen* this = xCalloc(1, sizeof(MemoryMapsScreen));
+   Object_setClass(this, Class(MemoryMapsScreen));
+   this->pid = Process_isThread(process) ? process->tgid : process->pid;
+   this->grouping = MEMORYMAPS_BY_FILE;
+   this->sortKey = MEMORYMAPS_RSS;
+   FunctionBar* fuBar = FunctionBar_new(MemoryMapsScreenFunctions, MemoryMapsScreenKeys, MemoryMapsScreenEvents);
+   return (MemoryMapsScreen*) InfoScreen_init(&this->super, process, fuBar, LINES - 2, "       RSS        PSS       SWAP  ANON_HUGE PRIV_DIRTY   MAPS  NAME");
+}
+
+static void MemoryMapsScreen_clear(MemoryMapsScreen* this) {
+   this->nameBlock = 0;
+   this->nameUsed = 0;
+   this->lastName = NULL;
+   this->mapCount = 0;
+}
+
+void MemoryMapsScreen_delete(Object* cast) {
+   MemoryMapsScreen* this = (MemoryMapsScreen*) cast;
+   for (size_t i = 0; i < this->nameBlockCount; i++)
+      free(this->nameBlocks[i]);
+   free(this->nameBlocks);
+   free(this->maps);
+   free(InfoScreen_done(&this->super));
+}
+
+static void MemoryMapsScreen_draw(InfoScreen* super) {
+   const MemoryMapsScreen* this = (const MemoryMapsScreen*) super;
+   InfoScreen_drawTitled(super, "Memory maps of process %d by %s, sorted by %s (kB) - %s",
+      this->pid, MemoryMaps_groupings[this->grouping], MemoryMaps_columns[this->sortKey].title,
+      Process_getCommand(super->process));
+}
+
+static const char* MemoryMapsScreen_internName(MemoryMapsScreen* this, const char* name) {
+   if (this->lastName && String_eq(this->lastName, name))
+      return this->lastName;
+
+   size_t len = strlen(name) + 1;
+   if (this->nameBlock < this->nameBlockCount && this->nameUsed + len > MEMORYMAPS_BUFFER_SIZE) {
+      this->nameBlock++;
+      this->nameUsed = 0;
+   }
+   if (this->nameBlock == this->nameBlockCount) {
+      this->nameBlocks = xReallocArray(this->nameBlocks, this->nameBlockCount + 1, sizeof(char*));
+      this->nameBlocks[this->nameBlockCount++] = xMalloc(MEMORYMAPS_BUFFER_SIZE);
+   }
+
+   char* copy = this->nameBlocks[this->nameBlock] + this->nameUsed;
+   memcpy(copy, name, len);
+   this->nameUsed += len;
+   this->lastName = copy;
+   return copy;
+}
+
+/* A line starting a mapping, "start-end perms offset dev inode name" */
+static void MemoryMapsScreen_parseMapping(MemoryMapsScreen* this, const char* line) {
+   unsigned long start, end;
+   char perms[5];
+   int nameOffset = 0;
+   if (sscanf(line, "%lx-%lx %4s %*s %*s %*s %n", &start, &end, perms, &nameOffset) < 3 || nameOffset == 0)
+      return;
+
+   const char* name = MemoryMapsScreen_internName(this, line + nameOffset);
+
+   if (this->mapCount == this->mapCapacity) {
+      this->mapCapacity = MAXIMUM(2 * this->mapCapacity, 64);
+      this->maps = xReallocArray(this->maps, this->mapCapacity, sizeof(MemoryMaps_Entry));
+   }
+   MemoryMaps_Entry* map = &this->maps[this->mapCount++];
+   *map = (MemoryMaps_Entry) { .start = start, .end = end, .name = name, .mappings = 1 };
+   memcpy(map->perms, perms, sizeof(map->perms));
+}
+
+static void MemoryMapsScreen_parseLine(MemoryMapsScreen* this, const char* line) {
+   /* only the lines starting a mapping have a dash in their first word */
+   size_t wordLen = strcspn(line, " ");
+   if (memchr(line, '-', wordLen)) {
+      MemoryMapsScreen_parseMapping(this, line);
+      return;
+   }
+   if (this->mapCount == 0)
+      return;
+
+   for (size_t i = 0; i < MEMORYMAPS_COLUMNS; i++) {
+      if (wordLen == MemoryMaps_columns[i].len && strncmp(line, MemoryMaps_columns[i].field, wordLen) == 0) {
+         this->maps[this->mapCount - 1].kb[i] = strtoull(line + wordLen, NULL, 10);
+         return;
+      }
+   }
+}
+
+/*
+ * Reads smaps in chunks into a buffer of its own, parsing the lines in place;
+ * large processes have tens of thousands of lines, of which only the names
+ * are copied. Once the blocks for them exist, a refresh allocates nothing.
+ */
+static bool MemoryMapsScreen_read(MemoryMapsScreen* this) {
+   MemoryMapsScreen_clear(this);
+
+   char path[4096];
+   xSnprintf(path, sizeof(path), "%s/%d/smaps", LinuxProcessList_procDir, this->pid);
+   int fd = open(path, O_RDONLY);
+   if (fd < 0)
+      return false;
+
+   char buffer[MEMORYMAPS_BUFFER_SIZE];
+   size_t used = 0;
+   bool skipping = false;
+   for (;;) {
+      ssize_t res = read(fd, buffer + used, sizeof(buffer) - 1 - used);
+      if (res < 0) {
+         if (errno == EINTR)
+            continue;
+         break;
+      }
+      if (res == 0) {
+         if (used > 0) {
+            buffer[used] = '\0';
+            MemoryMapsScreen_parseLine(this, buffer);
+         }
+         break;
+      }
+      used += (size_t)res;
+
+      char* line = buffer;
+      char* newline;
+      if (skipping) {
+         newline = memchr(buffer, '\n', used);
+         if (!newline) {
+            used = 0;
+            continue;
+         }
+         line = newline + 1;
+         skipping = false;
+      }
+
+      while ((newline = memchr(line, '\n', (size_t)(buffer + used - line)))) {
+         *newline = '\0';
+         MemoryMapsScreen_parseLine(this, line);
+         line = newline + 1;
+      }
+
+      used -= (size_t)(line - buffer);
+      if (used == sizeof(buffer) - 1) {
+         /*
+          * no line is that long but for paths of absurd length; take what
+          * fits, so the fields after it are not added to the mapping before,
+          * and skip the rest of it
+          */
+         buffer[used] = '\0';
+         MemoryMapsScreen_parseLine(this, buffer);
+         used = 0;
+         skipping = true;
+      } else if (used > 0) {
+         memmove(buffer, line, used);
+      }
+   }
+
+   close(fd);
+   return this->mapCount > 0;
+}
+
+static const char* MemoryMaps_Entry_category(const MemoryMaps_Entry* map) {
+   const char* name = map->name;
+   if (!name[0])
+      return "[anonymous]";
+   if (String_eq(name, "[heap]"))
+      return "[heap]";
+   if (String_startsWith(name, "[stack"))
+      return "[stack]";
+   if (String_startsWith(name, "/dev/shm/") || String_startsWith(name, "/memfd:") || String_startsWith(name, "/SYSV"))
+      return "[shared memory]";
+   if (name[0] == '[')
+      return "[kernel]";
+   return map->perms[2] == 'x' ? "[file code]" : "[file data]";
+}
+
+static const char* MemoryMapsScreen_groupName(const MemoryMapsScreen* this, const MemoryMaps_Entry* map) {
+   switch (this->grouping) {
+      case MEMORYMAPS_BY_CATEGORY:
+         return MemoryMaps_Entry_category(map);
+      case MEMORYMAPS_BY_FILE:
+         return map->name[0] ? map->name : "[anonymous]";
+      default:
+         return map->name;
+   }
+}
+
+static int MemoryMaps_Entry_compareByName(const void* v1, const void* v2) {
+   const MemoryMaps_Entry* e1 = v1;
+   const MemoryMaps_Entry* e2 = v2;
+   return strcmp(e1->name, e2->name);
+}
+
+/* qsort has no argument to pass the key in */
+static MemoryMaps_Column MemoryMaps_sortKey;
+static bool MemoryMaps_ascending;
+
+static int MemoryMaps_Entry_compareByKey(const void* v1, const void* v2) {
+   const MemoryMaps_Entry* e1 = v1;
+   const MemoryMaps_Entry* e2 = v2;
+   unsigned long long k1 = e1->kb[MemoryMaps_sortKey];
+   unsigned long long k2 = e2->kb[MemoryMaps_sortKey];
+   int result = (k1 > k2) - (k1 < k2);
+   if (!MemoryMaps_ascending)
+      result = -result;
+   if (result == 0)
+      result = (e1->start > e2->start) - (e1->start < e2->start);
+   return result;
+}
+
+static void MemoryMapsScreen_addEntry(InfoScreen* super, const MemoryMaps_Entry* entry, const char* name) {
+   char line[4200];
+   xSnprintf(line, sizeof(line), "%10llu %10llu %10llu %10llu %10llu %6u  %s",
+      entry->kb[MEMORYMAPS_RSS], entry->kb[MEMORYMAPS_PSS], entry->kb[MEMORYMAPS_SWAP],
+      entry->kb[MEMORYMAPS_ANONHUGE], entry->kb[MEMORYMAPS_PRIVATE_DIRTY],
+      entry->mappings, name);
+   InfoScreen_addLine(super, line);
+}
+
+/* Lines from the mappings read last, in the grouping and order chosen */
+static void MemoryMapsScreen_build(MemoryMapsScreen* this) {
+   InfoScreen* super = &this->super;
+   Panel* panel = super->display;
+   int idx = Panel_getSelectedIndex(panel);
+   Panel_prune(panel);
+   Vector_prune(super->lines);
+
+   if (this->mapCount == 0) {
+      InfoScreen_addLine(super, "Could not read the memory maps of the process.");
+      return;
+   }
+
+   MemoryMaps_Entry* entries = xMallocArray(this->mapCount, sizeof(MemoryMaps_Entry));
+   MemoryMaps_Entry total = { .name = "total" };
+   for (size_t i = 0; i < this->mapCount; i++) {
+      entries[i] = this->maps[i];
+      entries[i].name = MemoryMapsScreen_groupName(this, &this->maps[i]);
+      for (size_t c = 0; c < MEMORYMAPS_COLUMNS; c++)
+         total.kb[c] += entries[i].kb[c];
+      total.mappings++;
+   }
+
+   size_t count = this->mapCount;
+   if (this->grouping != MEMORYMAPS_BY_MAPPING) {
+      qsort(entries, count, sizeof(MemoryMaps_Entry), MemoryMaps_Entry_compareByName);
+      size_t groups = 0;
+      for (size_t i = 0; i < count; i++) {
+         MemoryMaps_Entry* group = groups > 0 ? &entries[groups - 1] : NULL;
+         if (group && String_eq(group->name, entries[i].name)) {
+            for (size_t c = 0; c < MEMORYMAPS_COLUMNS; c++)
+               group->kb[c] += entries[i].kb[c];
+            group->mappings++;
+            group->start = MINIMUM(group->start, entries[i].start);
+         } else {
+            entries[groups++] = entries[i];
+         }
+      }
+      count = groups;
+   }
+
+   MemoryMaps_sortKey = this->sortKey;
+   MemoryMaps_ascending = this->ascending;
+   qsort(entries, count, sizeof(MemoryMaps_Entry), MemoryMaps_Entry_compareByKey);
+
+   MemoryMapsScreen_addEntry(super, &total, "total");
+   for (size_t i = 0; i < count; i++) {
+      const MemoryMaps_Entry* entry = &entries[i];
+      if (this->grouping == MEMORYMAPS_BY_MAPPING) {
+         char name[4200];
+         xSnprintf(name, sizeof(name), "%012lx-%012lx %s  %s", entry->start, entry->end, entry->perms, entry->name);
+         MemoryMapsScreen_addEntry(super, entry, name);
+      } else {
+         MemoryMapsScreen_addEntry(super, entry, entry->name);
+      }
+   }
+   free(entries);
+
+   Panel_setSelected(panel, idx);
+}
+
+static void MemoryMapsScreen_scan(InfoScreen* super) {
+   MemoryMapsScreen* this = (MemoryMapsScreen*) super;
+   MemoryMapsScreen_read(this);
+   MemoryMapsScreen_build(this);
+}
+
+static bool MemoryMapsScreen_onKey(InfoScreen* super, int ch) {
+   MemoryMapsScreen* this = (MemoryMapsScreen*) super;
+   switch (ch) {
+      case '<':
+      case '>':
+      case KEY_F(6):
+         this->sortKey = (this->sortKey + (ch == '<' ? MEMORYMAPS_COLUMNS - 1 : 1)) % MEMORYMAPS_COLUMNS;
+         break;
+      case 'I':
+         this->ascending = !this->ascending;
+         break;
+      case 'g':
+      case KEY_F(7):
+         this->grouping = (this->grouping + 1) % MEMORYMAPS_GROUPINGS;
+         Panel_setSelected(super->display, 0);
+         break;
+      default:
+         return false;
+   }
+   MemoryMapsScreen_build(this);
+   InfoScreen_draw(this);
+   return true;
+}
+
+const InfoScreenClass MemoryMapsScreen_class = {
+   .super = {
+      .extends = Class(Object),
+      .delete = MemoryMapsScreen_delete
+   },
+   .scan = MemoryMapsScreen_scan,
+   .draw = MemoryMapsScreen_draw,
+   .onKey = MemoryMapsScreen_onKey
+};
@@ -0,0 +1,72 @@
+#ifndef HEADER_MemoryMapsScreen
+#define HEADER_MemoryMapsScreen
+/*
+htop - linux/MemoryMapsScreen.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "InfoScreen.h"
+#include "Object.h"
+#include "Process.h"
+
+
+typedef enum MemoryMaps_Column_ {
+   MEMORYMAPS_RSS,
+   MEMORYMAPS_PSS,
+   MEMORYMAPS_SWAP,
+   MEMORYMAPS_ANONHUGE,
+   MEMORYMAPS_PRIVATE_DIRTY,
+   MEMORYMAPS_COLUMNS
+} MemoryMaps_Column;
+
+typedef enum MemoryMaps_Grouping_ {
+   MEMORYMAPS_BY_MAPPING,
+   MEMORYMAPS_BY_FILE,
+   MEMORYMAPS_BY_CATEGORY,
+   MEMORYMAPS_GROUPINGS
+} MemoryMaps_Grouping;
+
+typedef struct MemoryMaps_Entry_ {
+   unsigned long start;
+   unsigned long end;
+   char perms[5];
+   const char* name;          /* backing file or kind of mapping, empty for anonymous memory */
+   unsigned long long kb[MEMORYMAPS_COLUMNS];
+   unsigned int mappings;
+} MemoryMaps_Entry;
+
+typedef struct MemoryMapsScreen_ {
+   InfoScreen super;
+   pid_t pid;
+   MemoryMaps_Grouping grouping;
+   MemoryMaps_Column sortKey;
+   bool ascending;
+
+   MemoryMaps_Entry* maps;
+   size_t mapCount;
+   size_t mapCapacity;
+
+   /*
+    * names are copied once for the mappings following each other with the
+    * same name, into blocks which are kept for the next refresh
+    */
+   char** nameBlocks;
+   size_t nameBlockCount;
+   size_t nameBlock;          /* the block being filled */
+   size_t nameUsed;           /* bytes used in it */
+   const char* lastName;
+} MemoryMapsScreen;
+
+extern const InfoScreenClass MemoryMapsScreen_class;
+
+MemoryMapsScreen* MemoryMapsScreen_new(const Process* process);
+
+void MemoryMapsScreen_delete(Object* cast);
+
+#endif
@@ -12,8 +12,10 @@ in the source distribution for its full text.
 #include <assert.h>
 #include <ctype.h>
 #include <dirent.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <math.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -21,16 +23,21 @@ in the source distribution for its full text.
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/sysmacros.h>
 
 #include "BatteryMeter.h"
 #include "ClockMeter.h"
 #include "Compat.h"
 #include "CPUMeter.h"
+#include "CRT.h"
 #include "DateMeter.h"
 #include "DateTimeMeter.h"
 #include "DiskIOMeter.h"
 #include "HostnameMeter.h"
 #include "HugePageMeter.h"
+#include "InfoScreen.h"
 #include "LoadAverageMeter.h"
 #include "Macros.h"
 #include "MainPanel.h"
@@ -48,12 +55,17 @@ in the source distribution for its full text.
 #include "SwapMeter.h"
 #include "SysArchMeter.h"
 #include "TasksMeter.h"
+#include "UpdateIntervalMeter.h"
 #include "UptimeMeter.h"
 #include "XUtils.h"
+#include "linux/CGroupScreen.h"
 #include "linux/IOPriority.h"
 #include "linux/IOPriorityPanel.h"
 #include "linux/LinuxProcess.h"
 #include "linux/LinuxProcessList.h"
+#include "linux/MemoryMapsScreen.h"
+#include "linux/PressureStall.h"
+#include "linux/SyscallNames.h"
 #include "linux/SystemdMeter.h"
 #include "linux/ZramMeter.h"
 #include "linux/ZramStats.h"
@@ -62,7 +74,6 @@ in the source distribution for its full text.
 #include "zfs/ZfsCompressedArcMeter.h"
 
 #ifdef HAVE_LIBCAP
-#include <errno.h>
 #include <sys/capability.h>
 #endif
 
@@ -151,6 +162,34 @@ static Htop_Reaction Platform_actionSetIOPriority(State* st) {
    return HTOP_REFRESH | HTOP_REDRAW_BAR | HTOP_UPDATE_PANELHDR;
 }
 
+static Htop_Reaction Platform_actionShowMemoryMaps(State* st) {
+   const Process* p = (const Process*) Panel_getSelected((Panel*)st->mainPanel);
+   if (!p)
+      return HTOP_OK;
+
+   MemoryMapsScreen* mms = MemoryMapsScreen_new(p);
+   InfoScreen_setState((InfoScreen*)mms, st);
+   InfoScreen_run((InfoScreen*)mms);
+   MemoryMapsScreen_delete((Object*)mms);
+   clear();
+   CRT_enableDelay();
+   return HTOP_REFRESH | HTOP_REDRAW_BAR;
+}
+
+static Htop_Reaction Platform_actionShowCGroups(State* st) {
+   const Process* p = (const Process*) Panel_getSelected((Panel*)st->mainPanel);
+   if (!p)
+      return HTOP_OK;
+
+   CGroupScreen* cgs = CGroupScreen_new(p);
+   InfoScreen_setState((InfoScreen*)cgs, st);
+   InfoScreen_run((InfoScreen*)cgs);
+   CGroupScreen_delete((Object*)cgs);
+   clear();
+   CRT_enableDelay();
+   return HTOP_REFRESH | HTOP_REDRAW_BAR;
+}
+
 static bool Platform_changeAutogroupPriority(MainPanel* panel, int delta) {
    if (LinuxProcess_isAutogroupEnabled() == false) {
       beep();
@@ -181,12 +220,18 @@ static Htop_Reaction Platform_actionLowerAutogroupPriority(State* st) {
 
 void Platform_setBindings(Htop_Action* keys) {
    keys['i'] = Platform_actionSetIOPriority;
+   keys['V'] = Platform_actionShowMemoryMaps;
+   keys['G'] = Platform_actionShowCGroups;
    keys['{'] = Platform_actionLowerAutogroupPriority;
    keys['}'] = Platform_actionHigherAutogroupPriority;
    keys[KEY_F(19)] = Platform_actionLowerAutogroupPriority;  // Shift-F7
    keys[KEY_F(20)] = Platform_actionHigherAutogroupPriority; // Shift-F8
 }
 
+void Platform_addEventSources(State* st) {
+   PressureStall_watchTriggers(st);
+}
+
 const MeterClass* const Platform_meterTypes[] = {
    &CPUMeter_class,
    &ClockMeter_class,
@@ -201,6 +246,7 @@ const MeterClass* const Platform_meterTypes[] = {
    &HugePageMeter_class,
    &TasksMeter_class,
    &UptimeMeter_class,
+   &UpdateIntervalMeter_class,
    &BatteryMeter_class,
    &HostnameMeter_class,
    &AllCPUsMeter_class,
@@ -215,6 +261,9 @@ const MeterClass* const Platform_meterTypes[] = {
    &RightCPUs4Meter_class,
    &LeftCPUs8Meter_class,
    &RightCPUs8Meter_class,
+   &CPUHeatmapMeter_class,
+   &CPUHeatmapNUMAMeter_class,
+   &CPUHeatmapPackageMeter_class,
    &BlankMeter_class,
    &PressureStallCPUSomeMeter_class,
    &PressureStallIOSomeMeter_class,
@@ -232,8 +281,9 @@ const MeterClass* const Platform_meterTypes[] = {
 };
 
 int Platform_getUptime() {
+   char path[4096];
    double uptime = 0;
-   FILE* fd = fopen(PROCDIR "/uptime", "r");
+   FILE* fd = fopen(LinuxProcessList_procPath(path, sizeof(path), "uptime"), "r");
    if (fd) {
       int n = fscanf(fd, "%64lf", &uptime);
       fclose(fd);
@@ -245,7 +295,8 @@ int Platform_getUptime() {
 }
 
 void Platform_getLoadAverage(double* one, double* five, double* fifteen) {
-   FILE* fd = fopen(PROCDIR "/loadavg", "r");
+   char path[4096];
+   FILE* fd = fopen(LinuxProcessList_procPath(path, sizeof(path), "loadavg"), "r");
    if (!fd)
       goto err;
 
@@ -267,7 +318,8 @@ err:
 }
 
 int Platform_getMaxPid() {
-   FILE* file = fopen(PROCDIR "/sys/kernel/pid_max", "r");
+   char path[4096];
+   FILE* file = fopen(LinuxProcessList_procPath(path, sizeof(path), "sys/kernel/pid_max"), "r");
    if (!file)
       return -1;
 
@@ -371,8 +423,8 @@ void Platform_setZfsCompressedArcValues(Meter* this) {
 }
 
 char* Platform_getProcessEnv(pid_t pid) {
-   char procname[128];
-   xSnprintf(procname, sizeof(procname), PROCDIR "/%d/environ", pid);
+   char procname[4096];
+   xSnprintf(procname, sizeof(procname), "%s/%d/environ", LinuxProcessList_procDir, pid);
    FILE* fd = fopen(procname, "r");
    if (!fd)
       return NULL;
@@ -406,124 +458,609 @@ char* Platform_getProcessEnv(pid_t pid) {
    return env;
 }
 
+/* Paths of the files a process has open, sorted by inode */
+typedef struct Platform_InodePath_ {
+   ino_t inode;
+   dev_t device;
+   char* path;
+} Platform_InodePath;
+
+typedef struct Platform_InodeIndex_ {
+   pid_t pid;
+   Platform_InodePath* entries;
+   size_t count;
+} Platform_InodeIndex;
+
+static int Platform_compareInodePaths(const void* v1, const void* v2) {
+   ino_t inode1 = ((const Platform_InodePath*)v1)->inode;
+   ino_t inode2 = ((const Platform_InodePath*)v2)->inode;
+   return (inode1 > inode2) - (inode1 < inode2);
+}
+
 /*
- * Return the absolute path of a file given its pid&inode number
+ * Indexes the files open in the process in one pass over /proc/PID/fd,
+ * instead of one for each inode looked up.
  *
- * Based on implementation of lslocks from util-linux:
+ * Based on the lookup of lslocks from util-linux:
  * https://sources.debian.org/src/util-linux/2.36-3/misc-utils/lslocks.c/#L162
  */
-char* Platform_getInodeFilename(pid_t pid, ino_t inode) {
-   struct stat sb;
-   const struct dirent* de;
-   DIR* dirp;
-   ssize_t len;
-   int fd;
-
-   char path[PATH_MAX];
-   char sym[PATH_MAX];
-   char* ret = NULL;
-
-   memset(path, 0, sizeof(path));
-   memset(sym, 0, sizeof(sym));
-
-   xSnprintf(path, sizeof(path), "%s/%d/fd/", PROCDIR, pid);
-   if (strlen(path) >= (sizeof(path) - 2))
-      return NULL;
-
-   if (!(dirp = opendir(path)))
-      return NULL;
-
-   if ((fd = dirfd(dirp)) < 0 )
-      goto out;
+static void Platform_indexInodes(Platform_InodeIndex* index, pid_t pid) {
+   index->pid = pid;
+   index->entries = NULL;
+   index->count = 0;
+
+   char path[4096];
+   xSnprintf(path, sizeof(path), "%s/%d/fd", LinuxProcessList_procDir, pid);
+   DIR* dirp = opendir(path);
+   if (!dirp)
+      return;
 
+   size_t capacity = 0;
+   const struct dirent* de;
    while ((de = readdir(dirp))) {
-      if (String_eq(de->d_name, ".") || String_eq(de->d_name, ".."))
+      if (!isdigit((unsigned char)de->d_name[0]))
          continue;
 
-      /* care only for numerical descriptors */
-      if (!strtoull(de->d_name, (char **) NULL, 10))
+      /* only files have a path, sockets and pipes are left out before stat'ing them */
+      char sym[PATH_MAX];
+      ssize_t len = Compat_readlinkat(dirfd(dirp), path, de->d_name, sym, sizeof(sym) - 1);
+      if (len < 1 || sym[0] != '/')
          continue;
+      sym[len] = '\0';
 
-      if (!Compat_fstatat(fd, path, de->d_name, &sb, 0) && inode != sb.st_ino)
+      struct stat sb;
+      if (Compat_fstatat(dirfd(dirp), path, de->d_name, &sb, 0) != 0)
          continue;
 
-      if ((len = Compat_readlinkat(fd, path, de->d_name, sym, sizeof(sym) - 1)) < 1)
-         goto out;
+      if (index->count == capacity) {
+         capacity = MAXIMUM(2 * capacity, 16);
+         index->entries = xReallocArray(index->entries, capacity, sizeof(Platform_InodePath));
+      }
+      index->entries[index->count++] = (Platform_InodePath) { .inode = sb.st_ino, .device = sb.st_dev, .path = xStrdup(sym) };
+   }
+   closedir(dirp);
 
-      sym[len] = '\0';
+   if (index->count > 1)
+      qsort(index->entries, index->count, sizeof(Platform_InodePath), Platform_compareInodePaths);
+}
 
-      ret = xStrdup(sym);
-      break;
+static void Platform_freeInodeIndex(Platform_InodeIndex* index) {
+   for (size_t i = 0; i < index->count; i++)
+      free(index->entries[i].path);
+   free(index->entries);
+}
+
+/*
+ * The path of the inode, preferring one on the given device (major and minor,
+ * or NULL for any); file systems like btrfs report devices in stat which
+ * differ from the ones in /proc/locks.
+ */
+static const char* Platform_lookupInode(const Platform_InodeIndex* index, ino_t inode, const unsigned int* device) {
+   const Platform_InodePath key = { .inode = inode };
+   const Platform_InodePath* found = bsearch(&key, index->entries, index->count, sizeof(Platform_InodePath), Platform_compareInodePaths);
+   if (!found)
+      return NULL;
+
+   while (found > index->entries && found[-1].inode == inode)
+      found--;
+   if (device) {
+      for (const Platform_InodePath* entry = found; entry < index->entries + index->count && entry->inode == inode; entry++) {
+         if (major(entry->device) == device[0] && minor(entry->device) == device[1])
+            return entry->path;
+      }
    }
+   return found->path;
+}
 
-out:
-   closedir(dirp);
+char* Platform_getInodeFilename(pid_t pid, ino_t inode) {
+   Platform_InodeIndex index;
+   Platform_indexInodes(&index, pid);
+   const char* path = Platform_lookupInode(&index, inode, NULL);
+   char* ret = path ? xStrdup(path) : NULL;
+   Platform_freeInodeIndex(&index);
    return ret;
 }
 
-FileLocks_ProcessData* Platform_getProcessLocks(pid_t pid) {
+/* Parses a line of /proc/locks, where locks waiting for another one are marked with "->" */
+static bool Platform_parseLock(const char* line, FileLocks_Data* data) {
+   int id;
+   int offset = 0;
+   if (sscanf(line, "%d: %n", &id, &offset) != 1 || offset == 0)
+      return false;
+
+   const char* rest = line + offset;
+   bool blocked = String_startsWith(rest, "->");
+   if (blocked)
+      rest += 2;
+
+   char lockType[16];
+   char lockExcl[16];
+   char lockRw[16];
+   pid_t lockPid;
+   unsigned int lockDev[2];
+   uint64_t lockInode;
+   char lockStart[25];
+   char lockEnd[25];
+   if (sscanf(rest, " %15s %15s %15s %d %x:%x:%"SCNu64" %24s %24s",
+              lockType, lockExcl, lockRw, &lockPid,
+              &lockDev[0], &lockDev[1], &lockInode,
+              lockStart, lockEnd) != 9)
+      return false;
+
+   data->id = id;
+   data->pid = lockPid;
+   data->blocked = blocked;
+   data->locktype = xStrdup(lockType);
+   data->exclusive = xStrdup(lockExcl);
+   data->readwrite = xStrdup(lockRw);
+   data->filename = NULL;
+   data->dev[0] = lockDev[0];
+   data->dev[1] = lockDev[1];
+   data->inode = lockInode;
+   data->start = strtoull(lockStart, NULL, 10);
+   data->end = String_eq(lockEnd, "EOF") ? ULLONG_MAX : strtoull(lockEnd, NULL, 10);
+   return true;
+}
+
+/* Reads the locks of one process, or of all with pid 0, in one pass over /proc/locks */
+static FileLocks_ProcessData* Platform_readLocks(pid_t pid) {
    FileLocks_ProcessData* pdata = xCalloc(1, sizeof(FileLocks_ProcessData));
 
-   FILE* f = fopen(PROCDIR "/locks", "r");
+   char path[4096];
+   FILE* f = fopen(LinuxProcessList_procPath(path, sizeof(path), "locks"), "r");
    if (!f) {
       pdata->error = true;
       return pdata;
    }
 
+   /* indexed once per process, when it is first seen holding or waiting for a lock */
+   Platform_InodeIndex* indexes = NULL;
+   size_t indexCount = 0;
+
    char buffer[1024];
    FileLocks_LockData** data_ref = &pdata->locks;
-   while(fgets(buffer, sizeof(buffer), f)) {
+   while (fgets(buffer, sizeof(buffer), f)) {
       if (!strchr(buffer, '\n'))
          continue;
 
-      int lock_id;
-      char lock_type[16];
-      char lock_excl[16];
-      char lock_rw[16];
-      pid_t lock_pid;
-      unsigned int lock_dev[2];
-      uint64_t lock_inode;
-      char lock_start[25];
-      char lock_end[25];
-
-      if (10 != sscanf(buffer, "%d:  %15s  %15s %15s %d %x:%x:%"PRIu64" %24s %24s",
-         &lock_id, lock_type, lock_excl, lock_rw, &lock_pid,
-         &lock_dev[0], &lock_dev[1], &lock_inode,
-         lock_start, lock_end))
+      FileLocks_Data data;
+      if (!Platform_parseLock(buffer, &data))
          continue;
 
-      if (pid != lock_pid)
+      if (pid != 0 && pid != data.pid) {
+         FileLocks_Data_clear(&data);
          continue;
+      }
 
-      FileLocks_LockData* ldata = xCalloc(1, sizeof(FileLocks_LockData));
-      FileLocks_Data* data = &ldata->data;
-      data->id = lock_id;
-      data->locktype = xStrdup(lock_type);
-      data->exclusive = xStrdup(lock_excl);
-      data->readwrite = xStrdup(lock_rw);
-      data->filename = Platform_getInodeFilename(lock_pid, lock_inode);
-      data->dev[0] = lock_dev[0];
-      data->dev[1] = lock_dev[1];
-      data->inode = lock_inode;
-      data->start = strtoull(lock_start, NULL, 10);
-      if (!String_eq(lock_end, "EOF")) {
-         data->end = strtoull(lock_end, NULL, 10);
-      } else {
-         data->end = ULLONG_MAX;
+      /* open file description locks are not owned by a process */
+      if (data.pid > 0) {
+         const Platform_InodeIndex* index = NULL;
+         for (size_t i = 0; i < indexCount && !index; i++) {
+            if (indexes[i].pid == data.pid)
+               index = &indexes[i];
+         }
+         if (!index) {
+            indexes = xReallocArray(indexes, indexCount + 1, sizeof(Platform_InodeIndex));
+            Platform_indexInodes(&indexes[indexCount], data.pid);
+            index = &indexes[indexCount++];
+         }
+
+         const char* filename = Platform_lookupInode(index, data.inode, data.dev);
+         data.filename = filename ? xStrdup(filename) : NULL;
       }
 
+      FileLocks_LockData* ldata = xMalloc(sizeof(FileLocks_LockData));
+      ldata->data = data;
+      ldata->next = NULL;
       *data_ref = ldata;
       data_ref = &ldata->next;
    }
+   fclose(f);
+
+   for (size_t i = 0; i < indexCount; i++)
+      Platform_freeInodeIndex(&indexes[i]);
+   free(indexes);
+
+   return pdata;
+}
+
+FileLocks_ProcessData* Platform_getProcessLocks(pid_t pid) {
+   return Platform_readLocks(pid);
+}
+
+FileLocks_ProcessData* Platform_getSystemLocks(void) {
+   return Platform_readLocks(0);
+}
+
+typedef struct OpenFiles_Socket_ {
+   unsigned long inode;
+   OpenFiles_FileData* file;
+} OpenFiles_Socket;
+
+static int Platform_compareSockets(const void* v1, const void* v2) {
+   unsigned long inode1 = ((const OpenFiles_Socket*)v1)->inode;
+   unsigned long inode2 = ((const OpenFiles_Socket*)v2)->inode;
+   return (inode1 > inode2) - (inode1 < inode2);
+}
+
+/* Names all open sockets with the given inode, sockets being sorted by inode */
+static void Platform_nameSocket(OpenFiles_Socket* sockets, size_t count, unsigned long inode, const char* type, const char* name) {
+   const OpenFiles_Socket key = { .inode = inode };
+   const OpenFiles_Socket* found = bsearch(&key, sockets, count, sizeof(OpenFiles_Socket), Platform_compareSockets);
+   if (!found)
+      return;
+
+   while (found > sockets && found[-1].inode == inode)
+      found--;
+   for (; found < sockets + count && found->inode == inode; found++) {
+      free_and_xStrdup(&found->file->data.data[OPENFILES_TYPE], type);
+      free_and_xStrdup(&found->file->data.data[OPENFILES_NAME], name);
+   }
+}
+
+/* Formats an address of /proc/net/{tcp,udp}[6], given as 32 bit words in host byte order */
+static void Platform_formatSocketAddress(char* buffer, size_t size, const char* hex, unsigned int port) {
+   unsigned char address[16] = { 0 };
+   size_t words = MINIMUM(strlen(hex) / 8, 4);
+   bool any = true;
+   for (size_t i = 0; i < words; i++) {
+      char word[9];
+      memcpy(word, hex + 8 * i, 8);
+      word[8] = '\0';
+      uint32_t value = (uint32_t) strtoul(word, NULL, 16);
+      memcpy(address + 4 * i, &value, sizeof(value));
+      any = any && value == 0;
+   }
+
+   char text[INET6_ADDRSTRLEN] = "*";
+   if (!any && !inet_ntop(words == 4 ? AF_INET6 : AF_INET, address, text, sizeof(text)))
+      String_safeStrncpy(text, "?", sizeof(text));
+
+   if (words == 4 && !any)
+      xSnprintf(buffer, size, "[%s]:%u", text, port);
+   else
+      xSnprintf(buffer, size, "%s:%u", text, port);
+}
+
+static void Platform_nameInetSockets(pid_t pid, const char* table, const char* type, OpenFiles_Socket* sockets, size_t count) {
+   static const char* const tcpStates[] = { "", "ESTABLISHED", "SYN_SENT", "SYN_RECV", "FIN_WAIT1", "FIN_WAIT2", "TIME_WAIT", "CLOSE", "CLOSE_WAIT", "LAST_ACK", "LISTEN", "CLOSING" };
+   bool tcp = String_startsWith(table, "tcp");
+
+   char path[4096];
+   xSnprintf(path, sizeof(path), "%s/%d/net/%s", LinuxProcessList_procDir, pid, table);
+   FILE* f = fopen(path, "r");
+   if (!f)
+      return;
+
+   char line[PROC_LINE_LENGTH + 1];
+   while (fgets(line, sizeof(line), f)) {
+      char localHex[33];
+      char remoteHex[33];
+      unsigned int localPort;
+      unsigned int remotePort;
+      unsigned int state;
+      unsigned long inode;
+      if (sscanf(line, " %*u: %32[0-9A-Fa-f]:%x %32[0-9A-Fa-f]:%x %x %*x:%*x %*x:%*x %*x %*u %*u %lu",
+                 localHex, &localPort, remoteHex, &remotePort, &state, &inode) != 6)
+         continue;
+
+      char local[INET6_ADDRSTRLEN + 16];
+      char remote[INET6_ADDRSTRLEN + 16];
+      Platform_formatSocketAddress(local, sizeof(local), localHex, localPort);
+      Platform_formatSocketAddress(remote, sizeof(remote), remoteHex, remotePort);
+
+      char name[2 * sizeof(local) + 32];
+      if (!tcp) {
+         if (remotePort)
+            xSnprintf(name, sizeof(name), "UDP %s->%s", local, remote);
+         else
+            xSnprintf(name, sizeof(name), "UDP %s", local);
+      } else if (state >= ARRAYSIZE(tcpStates)) {
+         xSnprintf(name, sizeof(name), "TCP %s->%s", local, remote);
+      } else if (String_eq(tcpStates[state], "LISTEN")) {
+         xSnprintf(name, sizeof(name), "TCP %s (LISTEN)", local);
+      } else {
+         xSnprintf(name, sizeof(name), "TCP %s->%s (%s)", local, remote, tcpStates[state]);
+      }
+      Platform_nameSocket(sockets, count, inode, type, name);
+   }
+   fclose(f);
+}
+
+static void Platform_nameUnixSockets(pid_t pid, OpenFiles_Socket* sockets, size_t count) {
+   char path[4096];
+   xSnprintf(path, sizeof(path), "%s/%d/net/unix", LinuxProcessList_procDir, pid);
+   FILE* f = fopen(path, "r");
+   if (!f)
+      return;
+
+   char line[PROC_LINE_LENGTH + 1];
+   while (fgets(line, sizeof(line), f)) {
+      unsigned int socketType;
+      unsigned long inode;
+      int pathStart = 0;
+      if (sscanf(line, "%*x: %*x %*x %*x %x %*x %lu%n", &socketType, &inode, &pathStart) != 2)
+         continue;
+
+      char* socketPath = String_trim(line + pathStart);
+      const char* typeName = socketType == 1 ? "STREAM" : socketType == 2 ? "DGRAM" : socketType == 5 ? "SEQPACKET" : "?";
+      char name[PROC_LINE_LENGTH + 32];
+      if (socketPath[0])
+         xSnprintf(name, sizeof(name), "%s type=%s", socketPath, typeName);
+      else
+         xSnprintf(name, sizeof(name), "type=%s", typeName);
+      free(socketPath);
 
+      Platform_nameSocket(sockets, count, inode, "unix", name);
+   }
    fclose(f);
+}
+
+static OpenFiles_FileData* Platform_newOpenFile(const char* fd, const char* link, const struct stat* sb) {
+   OpenFiles_FileData* fdata = xCalloc(1, sizeof(OpenFiles_FileData));
+   char** data = fdata->data.data;
+   data[OPENFILES_FD] = xStrdup(fd);
+   data[OPENFILES_NAME] = xStrdup(link);
+   if (!sb)
+      return fdata;
+
+   const char* type;
+   switch (sb->st_mode & S_IFMT) {
+   case S_IFREG:  type = "REG";  break;
+   case S_IFDIR:  type = "DIR";  break;
+   case S_IFCHR:  type = "CHR";  break;
+   case S_IFBLK:  type = "BLK";  break;
+   case S_IFIFO:  type = "FIFO"; break;
+   case S_IFSOCK: type = "sock"; break;
+   case S_IFLNK:  type = "LINK"; break;
+   default:       type = String_startsWith(link, "anon_inode:") ? "a_inode" : "unknown"; break;
+   }
+   data[OPENFILES_TYPE] = xStrdup(type);
+
+   dev_t device = S_ISCHR(sb->st_mode) || S_ISBLK(sb->st_mode) ? sb->st_rdev : sb->st_dev;
+   xAsprintf(&data[OPENFILES_DEVICE], "%u,%u", major(device), minor(device));
+   xAsprintf(&data[OPENFILES_INODE], "%llu", (unsigned long long) sb->st_ino);
+   if (S_ISREG(sb->st_mode))
+      xAsprintf(&data[OPENFILES_SIZE], "%lld", (long long) sb->st_size);
+
+   return fdata;
+}
+
+static int Platform_openFileNumber(const OpenFiles_FileData* fdata) {
+   const char* fd = fdata->data.data[OPENFILES_FD];
+   return isdigit((unsigned char)fd[0]) ? atoi(fd) : -1;
+}
+
+/*
+ * Lists the files open in the process from /proc/PID/fd and fdinfo, naming
+ * sockets after one pass over the process' /proc/PID/net tables. Entries of
+ * the previous listing whose link names the same socket, pipe or anonymous
+ * inode are taken out of it and reused as they are, so refreshing costs one
+ * readlink for each of them; the caller frees what is left of previous.
+ */
+OpenFiles_ProcessData* Platform_getProcessOpenFiles(pid_t pid, OpenFiles_ProcessData* previous) {
+   OpenFiles_ProcessData* pdata = xCalloc(1, sizeof(OpenFiles_ProcessData));
+   OpenFiles_FileData** tail = &pdata->files;
+
+   char fdPath[4096];
+   xSnprintf(fdPath, sizeof(fdPath), "%s/%d/fd", LinuxProcessList_procDir, pid);
+   DIR* dirp = opendir(fdPath);
+   if (!dirp) {
+      pdata->error = 1;
+      return pdata;
+   }
+
+   char link[PATH_MAX];
+   struct stat sb;
+
+   /* as listed by lsof */
+   static const char* const specialFiles[][2] = { { "cwd", "cwd" }, { "rtd", "root" }, { "txt", "exe" } };
+   for (size_t i = 0; i < ARRAYSIZE(specialFiles); i++) {
+      char path[4096];
+      xSnprintf(path, sizeof(path), "%s/%d/%s", LinuxProcessList_procDir, pid, specialFiles[i][1]);
+      ssize_t len = readlink(path, link, sizeof(link) - 1);
+      if (len < 0)
+         continue;
+
+      link[len] = '\0';
+      *tail = Platform_newOpenFile(specialFiles[i][0], link, stat(path, &sb) == 0 ? &sb : NULL);
+      tail = &(*tail)->next;
+   }
+
+   char fdinfoPath[4096];
+   xSnprintf(fdinfoPath, sizeof(fdinfoPath), "%s/%d/fdinfo", LinuxProcessList_procDir, pid);
+#ifdef HAVE_OPENAT
+   openat_arg_t fdinfoDir = open(fdinfoPath, O_RDONLY | O_DIRECTORY);
+#else
+   openat_arg_t fdinfoDir = fdinfoPath;
+#endif
+
+   OpenFiles_FileData* none = NULL;
+   OpenFiles_FileData** reusable = previous ? &previous->files : &none;
+   OpenFiles_Socket* sockets = NULL;
+   size_t socketCount = 0;
+   size_t socketCapacity = 0;
+
+   const struct dirent* entry;
+   while ((entry = readdir(dirp))) {
+      if (!isdigit((unsigned char)entry->d_name[0]))
+         continue;
+
+      ssize_t len = Compat_readlinkat(dirfd(dirp), fdPath, entry->d_name, link, sizeof(link) - 1);
+      if (len < 0)
+         continue;
+      link[len] = '\0';
+
+      /* both listings come in the order of the descriptors */
+      int fd = atoi(entry->d_name);
+      while (*reusable && Platform_openFileNumber(*reusable) < fd)
+         reusable = &(*reusable)->next;
+
+      OpenFiles_FileData* fdata = *reusable;
+      if (fdata && Platform_openFileNumber(fdata) == fd && link[0] != '/' && fdata->link && String_eq(fdata->link, link)) {
+         *reusable = fdata->next;
+         fdata->next = NULL;
+         *tail = fdata;
+         tail = &fdata->next;
+         continue;
+      }
+
+      bool found = Compat_fstatat(dirfd(dirp), fdPath, entry->d_name, &sb, 0) == 0;
+      fdata = Platform_newOpenFile(entry->d_name, link, found ? &sb : NULL);
+      fdata->link = xStrdup(link);
+      *tail = fdata;
+      tail = &fdata->next;
+
+      unsigned long inode;
+      if (sscanf(link, "socket:[%lu]", &inode) == 1) {
+         free_and_xStrdup(&fdata->data.data[OPENFILES_ACCESS], "u");
+         if (socketCount == socketCapacity) {
+            socketCapacity = MAXIMUM(2 * socketCapacity, 16);
+            sockets = xReallocArray(sockets, socketCapacity, sizeof(OpenFiles_Socket));
+         }
+         sockets[socketCount++] = (OpenFiles_Socket) { .inode = inode, .file = fdata };
+         continue;
+      }
+
+      char fdinfo[128];
+      unsigned long long position;
+      unsigned int flags;
+      if (xReadfileat(fdinfoDir, entry->d_name, fdinfo, sizeof(fdinfo)) > 0 &&
+          sscanf(fdinfo, "pos: %llu flags: %o", &position, &flags) == 2) {
+         int mode = flags & O_ACCMODE;
+         fdata->data.data[OPENFILES_ACCESS] = xStrdup(mode == O_RDONLY ? "r" : mode == O_WRONLY ? "w" : "u");
+         xAsprintf(&fdata->data.data[OPENFILES_OFFSET], "%llu", position);
+      }
+   }
+
+#ifdef HAVE_OPENAT
+   if (fdinfoDir >= 0)
+      Compat_openatArgClose(fdinfoDir);
+#endif
+   closedir(dirp);
+
+   if (socketCount > 0) {
+      qsort(sockets, socketCount, sizeof(OpenFiles_Socket), Platform_compareSockets);
+      Platform_nameInetSockets(pid, "tcp", "IPv4", sockets, socketCount);
+      Platform_nameInetSockets(pid, "tcp6", "IPv6", sockets, socketCount);
+      Platform_nameInetSockets(pid, "udp", "IPv4", sockets, socketCount);
+      Platform_nameInetSockets(pid, "udp6", "IPv6", sockets, socketCount);
+      Platform_nameUnixSockets(pid, sockets, socketCount);
+   }
+   free(sockets);
+
    return pdata;
 }
 
+/* The functions of a kernel stack as in /proc/PID/stack, "[<0>] name+0x1c/0x90" per frame, innermost first */
+static void Platform_readKernelStack(openat_arg_t taskDir, const char* tid, char* stack, size_t size) {
+   stack[0] = '\0';
+
+   char path[64];
+   char buffer[4096];
+   xSnprintf(path, sizeof(path), "%s/stack", tid);
+   if (xReadfileat(taskDir, path, buffer, sizeof(buffer)) <= 0)
+      return;
+
+   size_t len = 0;
+   char* frame = buffer;
+   while (frame && *frame) {
+      char* next = strchr(frame, '\n');
+      if (next)
+         *next++ = '\0';
+
+      const char* name = strstr(frame, "] ");
+      if (name) {
+         name += 2;
+         size_t nameLen = strcspn(name, "+");
+         int written = snprintf(stack + len, size - len, "%s%.*s", len ? " < " : "", (int)nameLen, name);
+         if (written < 0 || (size_t)written >= size - len)
+            break;
+         len += (size_t)written;
+      }
+      frame = next;
+   }
+}
+
+/* Cheap enough to be called many times a second: a few reads of /proc per thread and no ptrace */
+bool Platform_sampleThreads(pid_t pid, bool stacks, ThreadSample** samples, size_t* count, size_t* capacity) {
+   char taskPath[4096];
+   xSnprintf(taskPath, sizeof(taskPath), "%s/%d/task", LinuxProcessList_procDir, pid);
+   DIR* dirp = opendir(taskPath);
+   if (!dirp)
+      return false;
+
+#ifdef HAVE_OPENAT
+   openat_arg_t taskDir = dirfd(dirp);
+#else
+   openat_arg_t taskDir = taskPath;
+#endif
+
+   *count = 0;
+   const struct dirent* entry;
+   while ((entry = readdir(dirp))) {
+      if (!isdigit((unsigned char)entry->d_name[0]))
+         continue;
+
+      char path[64];
+      char buffer[256];
+      xSnprintf(path, sizeof(path), "%s/stat", entry->d_name);
+      if (xReadfileat(taskDir, path, buffer, sizeof(buffer)) <= 0)
+         continue;
+
+      /* the name may contain anything, including parentheses */
+      const char* open = strchr(buffer, '(');
+      const char* close = strrchr(buffer, ')');
+      if (!open || !close || close < open || close[1] != ' ' || !close[2])
+         continue;
+
+      if (*count == *capacity) {
+         *capacity = MAXIMUM(2 * *capacity, 16);
+         *samples = xReallocArray(*samples, *capacity, sizeof(ThreadSample));
+      }
+      ThreadSample* sample = &(*samples)[*count];
+      sample->tid = atoi(entry->d_name);
+      sample->state = close[2];
+      String_safeStrncpy(sample->name, open + 1, MINIMUM(sizeof(sample->name), (size_t)(close - open)));
+      sample->syscall[0] = '\0';
+      sample->wchan[0] = '\0';
+      sample->stack[0] = '\0';
+
+      /* "running", or the number and arguments of the call the thread is in, -1 if none */
+      xSnprintf(path, sizeof(path), "%s/syscall", entry->d_name);
+      long number;
+      if (xReadfileat(taskDir, path, buffer, sizeof(buffer)) <= 0) {
+         String_safeStrncpy(sample->syscall, "?", sizeof(sample->syscall));
+      } else if (sscanf(buffer, "%ld", &number) == 1 && number >= 0) {
+         const char* name = SyscallNames_get(number);
+         if (name)
+            String_safeStrncpy(sample->syscall, name, sizeof(sample->syscall));
+         else
+            xSnprintf(sample->syscall, sizeof(sample->syscall), "syscall %ld", number);
+      }
+
+      if (sample->state != 'R') {
+         xSnprintf(path, sizeof(path), "%s/wchan", entry->d_name);
+         ssize_t len = xReadfileat(taskDir, path, sample->wchan, sizeof(sample->wchan));
+         if (len <= 0 || String_eq(sample->wchan, "0"))
+            sample->wchan[0] = '\0';
+
+         /* only readable with CAP_SYS_ADMIN */
+         if (stacks)
+            Platform_readKernelStack(taskDir, entry->d_name, sample->stack, sizeof(sample->stack));
+      }
+
+      (*count)++;
+   }
+
+   closedir(dirp);
+   return true;
+}
+
 void Platform_getPressureStall(const char* file, bool some, double* ten, double* sixty, double* threehundred) {
    *ten = *sixty = *threehundred = 0;
-   char procname[128];
-   xSnprintf(procname, sizeof(procname), PROCDIR "/pressure/%s", file);
+   char procname[4096];
+   xSnprintf(procname, sizeof(procname), "%s/pressure/%s", LinuxProcessList_procDir, file);
    FILE* fd = fopen(procname, "r");
    if (!fd) {
       *ten = *sixty = *threehundred = NAN;
@@ -539,7 +1076,8 @@ void Platform_getPressureStall(const char* file, bool some, double* ten, double*
 }
 
 bool Platform_getDiskIO(DiskIOData* data) {
-   FILE* fd = fopen(PROCDIR "/diskstats", "r");
+   char path[4096];
+   FILE* fd = fopen(LinuxProcessList_procPath(path, sizeof(path), "diskstats"), "r");
    if (!fd)
       return false;
 
@@ -578,7 +1116,8 @@ bool Platform_getDiskIO(DiskIOData* data) {
 }
 
 bool Platform_getNetworkIO(NetworkIOData* data) {
-   FILE* fd = fopen(PROCDIR "/net/dev", "r");
+   char path[4096];
+   FILE* fd = fopen(LinuxProcessList_procPath(path, sizeof(path), "net/dev"), "r");
    if (!fd)
       return false;
 
@@ -611,9 +1150,8 @@ bool Platform_getNetworkIO(NetworkIOData* data) {
 
 // Linux battery reading by Ian P. Hands (iphands@gmail.com, ihands@redhat.com).
 
-#define PROC_BATTERY_DIR PROCDIR "/acpi/battery"
-#define PROC_POWERSUPPLY_DIR PROCDIR "/acpi/ac_adapter"
-#define PROC_POWERSUPPLY_ACSTATE_FILE PROC_POWERSUPPLY_DIR "/AC/state"
+#define PROC_BATTERY_DIR "acpi/battery"
+#define PROC_POWERSUPPLY_ACSTATE_FILE "acpi/ac_adapter/AC/state"
 #define SYS_POWERSUPPLY_DIR "/sys/class/power_supply"
 
 // ----------------------------------------
@@ -621,7 +1159,8 @@ bool Platform_getNetworkIO(NetworkIOData* data) {
 // ----------------------------------------
 
 static double Platform_Battery_getProcBatInfo(void) {
-   DIR* batteryDir = opendir(PROC_BATTERY_DIR);
+   char batteryPath[4096];
+   DIR* batteryDir = opendir(LinuxProcessList_procPath(batteryPath, sizeof(batteryPath), PROC_BATTERY_DIR));
    if (!batteryDir)
       return NAN;
 
@@ -634,15 +1173,15 @@ static double Platform_Battery_getProcBatInfo(void) {
       if (!String_startsWith(entryName, "BAT"))
          continue;
 
-      char filePath[256];
+      char filePath[4352];
       char bufInfo[1024] = {0};
-      xSnprintf(filePath, sizeof(filePath), "%s/%s/info", PROC_BATTERY_DIR, entryName);
+      xSnprintf(filePath, sizeof(filePath), "%s/%s/info", batteryPath, entryName);
       ssize_t r = xReadfile(filePath, bufInfo, sizeof(bufInfo));
       if (r < 0)
          continue;
 
       char bufState[1024] = {0};
-      xSnprintf(filePath, sizeof(filePath), "%s/%s/state", PROC_BATTERY_DIR, entryName);
+      xSnprintf(filePath, sizeof(filePath), "%s/%s/state", batteryPath, entryName);
       r = xReadfile(filePath, bufState, sizeof(bufState));
       if (r < 0)
          continue;
@@ -684,8 +1223,9 @@ static double Platform_Battery_getProcBatInfo(void) {
 }
 
 static ACPresence procAcpiCheck(void) {
+   char path[4096];
    char buffer[1024] = {0};
-   ssize_t r = xReadfile(PROC_POWERSUPPLY_ACSTATE_FILE, buffer, sizeof(buffer));
+   ssize_t r = xReadfile(LinuxProcessList_procPath(path, sizeof(path), PROC_POWERSUPPLY_ACSTATE_FILE), buffer, sizeof(buffer));
    if (r < 1)
       return AC_ERROR;
 
@@ -718,7 +1258,7 @@ static void Platform_Battery_getSysData(double* percent, ACPresence* isOnAC) {
 
       if (String_startsWith(entryName, "BAT")) {
          char buffer[1024] = {0};
-         char filePath[256];
+         char filePath[4352];
          xSnprintf(filePath, sizeof filePath, SYS_POWERSUPPLY_DIR "/%s/uevent", entryName);
 
          ssize_t r = xReadfile(filePath, buffer, sizeof(buffer));
@@ -770,7 +1310,7 @@ static void Platform_Battery_getSysData(double* percent, ACPresence* isOnAC) {
          if (*isOnAC != AC_ERROR)
             continue;
 
-         char filePath[256];
+         char filePath[4352];
          xSnprintf(filePath, sizeof(filePath), SYS_POWERSUPPLY_DIR "/%s/online", entryName);
 
          ssize_t r = xReadfile(filePath, buffer, sizeof(buffer));
@@ -833,6 +1373,11 @@ void Platform_longOptionsUsage(const char* name)
 #else
    (void) name;
 #endif
+   printf(
+"   --procfs=DIR                 Read system and process data from DIR instead of " PROCDIR "\n"
+"   --pressure-trigger=RESOURCE:some|full:STALL_MS[:WINDOW_MS[:CGROUP]]\n"
+"                                Refresh as soon as cpu, io or memory stalled for STALL_MS within\n"
+"                                WINDOW_MS (default: 1000), for the whole system or a cgroup\n");
 }
 
 CommandLineStatus Platform_getLongOption(int opt, int argc, char** argv) {
@@ -864,6 +1409,23 @@ CommandLineStatus Platform_getLongOption(int opt, int argc, char** argv) {
       }
 #endif
 
+      case 161: {
+         static char procDir[PATH_MAX];
+         if (!realpath(optarg, procDir)) {
+            fprintf(stderr, "Error: invalid procfs directory \"%s\": %s\n", optarg, strerror(errno));
+            return STATUS_ERROR_EXIT;
+         }
+         LinuxProcessList_procDir = procDir;
+         return STATUS_OK;
+      }
+
+      case 162:
+         if (!PressureStall_addTrigger(optarg)) {
+            fprintf(stderr, "Error: invalid pressure stall trigger \"%s\".\n", optarg);
+            return STATUS_ERROR_EXIT;
+         }
+         return STATUS_OK;
+
       default:
          break;
    }
@@ -957,13 +1519,15 @@ static int dropCapabilities(enum CapMode mode) {
 #endif
 
 bool Platform_init(void) {
+   PressureStall_openTriggers();
+
 #ifdef HAVE_LIBCAP
    if (dropCapabilities(Platform_capabilitiesMode) < 0)
       return false;
 #endif
 
-   if (access(PROCDIR, R_OK) != 0) {
-      fprintf(stderr, "Error: could not read procfs (compiled to look in %s).\n", PROCDIR);
+   if (access(LinuxProcessList_procDir, R_OK) != 0) {
+      fprintf(stderr, "Error: could not read procfs (looking in %s).\n", LinuxProcessList_procDir);
       return false;
    }
 
@@ -978,4 +1542,6 @@ void Platform_done(void) {
 #ifdef HAVE_SENSORS_SENSORS_H
    LibSensors_cleanup();
 #endif
+
+   PressureStall_closeTriggers();
 }
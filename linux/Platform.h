@@ -23,9 +23,11 @@ in the source distribution for its full text.
 #include "Macros.h"
 #include "Meter.h"
 #include "NetworkIOMeter.h"
+#include "OpenFilesScreen.h"
 #include "Process.h"
 #include "ProcessLocksScreen.h"
 #include "RichString.h"
+#include "SamplingScreen.h"
 #include "SignalsPanel.h"
 #include "CommandLine.h"
 #include "generic/gettime.h"
@@ -51,6 +53,8 @@ void Platform_done(void);
 
 void Platform_setBindings(Htop_Action* keys);
 
+void Platform_addEventSources(State* st);
+
 int Platform_getUptime(void);
 
 void Platform_getLoadAverage(double* one, double* five, double* fifteen);
@@ -75,6 +79,12 @@ char* Platform_getInodeFilename(pid_t pid, ino_t inode);
 
 FileLocks_ProcessData* Platform_getProcessLocks(pid_t pid);
 
+FileLocks_ProcessData* Platform_getSystemLocks(void);
+
+OpenFiles_ProcessData* Platform_getProcessOpenFiles(pid_t pid, OpenFiles_ProcessData* previous);
+
+bool Platform_sampleThreads(pid_t pid, bool stacks, ThreadSample** samples, size_t* count, size_t* capacity);
+
 void Platform_getPressureStall(const char* file, bool some, double* ten, double* sixty, double* threehundred);
 
 bool Platform_getDiskIO(DiskIOData* data);
@@ -93,9 +103,13 @@ static inline void Platform_getRelease(char** string) {
 
 #ifdef HAVE_LIBCAP
    #define PLATFORM_LONG_OPTIONS \
-      {"drop-capabilities", optional_argument, 0, 160},
+      {"drop-capabilities", optional_argument, 0, 160}, \
+      {"procfs", required_argument, 0, 161}, \
+      {"pressure-trigger", required_argument, 0, 162},
 #else
-   #define PLATFORM_LONG_OPTIONS
+   #define PLATFORM_LONG_OPTIONS \
+      {"procfs", required_argument, 0, 161}, \
+      {"pressure-trigger", required_argument, 0, 162},
 #endif
 
 void Platform_longOptionsUsage(const char* name);
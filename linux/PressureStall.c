@@ -0,0 +1,197 @@
+/*
+htop - linux/PressureStall.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "linux/PressureStall.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "EventLoop.h"
+#include "FlightRecorder.h"
+#include "Macros.h"
+#include "Platform.h"
+#include "ProcessList.h"
+#include "Sampler.h"
+#include "XUtils.h"
+#include "linux/LinuxProcessList.h"
+
+
+#define PRESSURE_STALL_CGROUP_DIR "/sys/fs/cgroup"
+
+/* A lasting stall fires once per window, the flight recorder writes a recording at most this often */
+#define PRESSURE_STALL_DUMP_INTERVAL_MS 60000
+
+static PressureStallTrigger* PressureStall_triggers;
+static size_t PressureStall_triggerCount;
+
+/* protects the state of the triggers, read by the meters on the sampler thread */
+static pthread_mutex_t PressureStall_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static State* PressureStall_state;
+static uint64_t PressureStall_lastDumpMs;
+
+bool PressureStall_addTrigger(const char* spec) {
+   PressureStallTrigger trigger = { .fd = -1, .windowMs = 1000 };
+
+   size_t n;
+   char** parts = String_split(spec, ':', &n);
+
+   bool ok = n >= 3;
+   if (ok) {
+      ok = String_eq(parts[0], "cpu") || String_eq(parts[0], "io") || String_eq(parts[0], "memory");
+      String_safeStrncpy(trigger.resource, parts[0], sizeof(trigger.resource));
+   }
+   if (ok) {
+      ok = String_eq(parts[1], "some") || String_eq(parts[1], "full");
+      trigger.some = String_eq(parts[1], "some");
+   }
+   if (ok)
+      ok = sscanf(parts[2], "%10u", &trigger.stallMs) == 1;
+   if (ok && n >= 4)
+      ok = sscanf(parts[3], "%10u", &trigger.windowMs) == 1;
+
+   /* the limits of the kernel */
+   ok = ok && trigger.stallMs > 0 && trigger.stallMs <= trigger.windowMs &&
+        trigger.windowMs >= 500 && trigger.windowMs <= 10000;
+
+   /* the cgroup is the rest, it may contain colons itself */
+   if (ok && n >= 5) {
+      const char* cgroup = spec;
+      for (int i = 0; i < 4; i++)
+         cgroup = strchr(cgroup, ':') + 1;
+      while (*cgroup == '/')
+         cgroup++;
+      ok = *cgroup != '\0';
+      trigger.cgroup = xStrdup(cgroup);
+   }
+   String_freeArray(parts);
+
+   if (!ok) {
+      free(trigger.cgroup);
+      return false;
+   }
+
+   PressureStall_triggers = xReallocArray(PressureStall_triggers, PressureStall_triggerCount + 1, sizeof(PressureStallTrigger));
+   PressureStall_triggers[PressureStall_triggerCount++] = trigger;
+   return true;
+}
+
+static int PressureStall_open(const PressureStallTrigger* trigger) {
+   char path[4096];
+   if (trigger->cgroup) {
+      xSnprintf(path, sizeof(path), "%s/%s/%s.pressure", PRESSURE_STALL_CGROUP_DIR, trigger->cgroup, trigger->resource);
+   } else {
+      char name[32];
+      xSnprintf(name, sizeof(name), "pressure/%s", trigger->resource);
+      LinuxProcessList_procPath(path, sizeof(path), name);
+   }
+
+   int fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+   if (fd < 0)
+      return -1;
+
+   /* in microseconds, the terminating null byte included */
+   char spec[64];
+   int len = xSnprintf(spec, sizeof(spec), "%s %u %u", trigger->some ? "some" : "full",
+      trigger->stallMs * 1000, trigger->windowMs * 1000);
+   if (write(fd, spec, (size_t)len + 1) < 0) {
+      close(fd);
+      return -1;
+   }
+   return fd;
+}
+
+void PressureStall_openTriggers(void) {
+   for (size_t i = 0; i < PressureStall_triggerCount; i++)
+      PressureStall_triggers[i].fd = PressureStall_open(&PressureStall_triggers[i]);
+}
+
+void PressureStall_closeTriggers(void) {
+   for (size_t i = 0; i < PressureStall_triggerCount; i++) {
+      if (PressureStall_triggers[i].fd >= 0)
+         close(PressureStall_triggers[i].fd);
+      free(PressureStall_triggers[i].cgroup);
+   }
+   free(PressureStall_triggers);
+   PressureStall_triggers = NULL;
+   PressureStall_triggerCount = 0;
+   PressureStall_state = NULL;
+}
+
+/* Runs on the UI thread while it waits for input */
+static void PressureStall_fired(void* data) {
+   PressureStallTrigger* trigger = data;
+   State* st = PressureStall_state;
+
+   uint64_t now;
+   Platform_gettime_monotonic(&now);
+
+   /* a trigger on a cgroup which was removed reports an error from then on */
+   struct pollfd pfd = { .fd = trigger->fd, .events = POLLPRI };
+   bool gone = poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLERR | POLLNVAL));
+
+   pthread_mutex_lock(&PressureStall_lock);
+   if (gone) {
+      EventLoop_removeSource(st->events, trigger->fd);
+      close(trigger->fd);
+      trigger->fd = -1;
+   } else {
+      trigger->events++;
+      trigger->lastEventMs = now;
+   }
+   pthread_mutex_unlock(&PressureStall_lock);
+
+   if (gone)
+      return;
+
+   /* the next scan shows the stall in the meters and who was running during it */
+   Sampler_requestScan(st->sampler);
+
+   if (st->pl->flightRecorder && (PressureStall_lastDumpMs == 0 || now - PressureStall_lastDumpMs >= PRESSURE_STALL_DUMP_INTERVAL_MS)) {
+      FlightRecorder_requestDump();
+      PressureStall_lastDumpMs = now;
+   }
+}
+
+void PressureStall_watchTriggers(State* st) {
+   if (!st->events || !st->sampler)
+      return;
+
+   PressureStall_state = st;
+   for (size_t i = 0; i < PressureStall_triggerCount; i++) {
+      if (PressureStall_triggers[i].fd >= 0)
+         EventLoop_addSource(st->events, PressureStall_triggers[i].fd, true, PressureStall_fired, &PressureStall_triggers[i]);
+   }
+}
+
+void PressureStall_getEvents(const char* resource, bool some, PressureStallEvents* events) {
+   *events = (PressureStallEvents) { 0 };
+
+   pthread_mutex_lock(&PressureStall_lock);
+   for (size_t i = 0; i < PressureStall_triggerCount; i++) {
+      const PressureStallTrigger* trigger = &PressureStall_triggers[i];
+      if (trigger->some != some || !String_eq(trigger->resource, resource))
+         continue;
+
+      if (trigger->fd < 0 && trigger->events == 0) {
+         events->failed++;
+         continue;
+      }
+
+      events->triggers++;
+      events->events += trigger->events;
+      events->lastEventMs = MAXIMUM(events->lastEventMs, trigger->lastEventMs);
+   }
+   pthread_mutex_unlock(&PressureStall_lock);
+}
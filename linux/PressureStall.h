@@ -0,0 +1,54 @@
+#ifndef HEADER_PressureStall
+#define HEADER_PressureStall
+/*
+htop - linux/PressureStall.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Action.h"
+
+
+/*
+ * A PSI trigger, the kernel wakes htop up as soon as the resource stalled
+ * for longer than the threshold within the window, instead of the stall
+ * being averaged away until the next refresh.
+ */
+typedef struct PressureStallTrigger_ {
+   char resource[8];          /* "cpu", "io" or "memory" */
+   bool some;
+   unsigned int stallMs;
+   unsigned int windowMs;
+   char* cgroup;              /* relative to the cgroup2 mount, NULL for the whole system */
+   int fd;                    /* -1 if it could not be set */
+   unsigned int events;
+   uint64_t lastEventMs;      /* monotonic */
+} PressureStallTrigger;
+
+/* The triggers on one resource together */
+typedef struct PressureStallEvents_ {
+   unsigned int triggers;     /* set successfully */
+   unsigned int failed;
+   unsigned int events;
+   uint64_t lastEventMs;
+} PressureStallEvents;
+
+/* Adds a trigger of the form RESOURCE:some|full:STALL_MS[:WINDOW_MS[:CGROUP]] */
+bool PressureStall_addTrigger(const char* spec);
+
+/* Sets the triggers up, before privileges are dropped as that needs CAP_SYS_RESOURCE on older kernels */
+void PressureStall_openTriggers(void);
+
+void PressureStall_closeTriggers(void);
+
+/* Wakes the interactive UI up for a refresh when a trigger fires */
+void PressureStall_watchTriggers(State* st);
+
+/* May be called from any thread */
+void PressureStall_getEvents(const char* resource, bool some, PressureStallEvents* events);
+
+#endif
@@ -9,6 +9,8 @@ in the source distribution for its full text.
 #include "linux/PressureStallMeter.h"
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "CRT.h"
@@ -18,6 +20,10 @@ in the source distribution for its full text.
 #include "RichString.h"
 #include "XUtils.h"
 
+#ifdef HTOP_LINUX
+#include "linux/PressureStall.h"
+#endif
+
 
 static const int PressureStallMeter_attributes[] = {
    PRESSURE_STALL_TEN,
@@ -25,29 +31,42 @@ static const int PressureStallMeter_attributes[] = {
    PRESSURE_STALL_THREEHUNDRED
 };
 
-static void PressureStallMeter_updateValues(Meter* this) {
-   const char* file;
+/* A stall caught by a trigger is highlighted for this long */
+#define PRESSURE_STALL_RECENT_MS 10000
+
+static const char* PressureStallMeter_file(const Meter* this, bool* some) {
+   *some = strstr(Meter_name(this), "Some") != NULL;
+
    if (strstr(Meter_name(this), "CPU")) {
-      file = "cpu";
+      return "cpu";
    } else if (strstr(Meter_name(this), "IO")) {
-      file = "io";
+      return "io";
    } else {
-      file = "memory";
+      return "memory";
    }
+}
 
+static void PressureStallMeter_updateValues(Meter* this) {
    bool some;
-   if (strstr(Meter_name(this), "Some")) {
-      some = true;
-   } else {
-      some = false;
-   }
+   const char* file = PressureStallMeter_file(this, &some);
 
    Platform_getPressureStall(file, some, &this->values[0], &this->values[1], &this->values[2]);
 
    /* only print bar for ten (not sixty and threehundred), cause the sum is meaningless */
    this->curItems = 1;
 
-   xSnprintf(this->txtBuffer, sizeof(this->txtBuffer), "%s %s %5.2lf%% %5.2lf%% %5.2lf%%", some ? "some" : "full", file, this->values[0], this->values[1], this->values[2]);
+   int len = xSnprintf(this->txtBuffer, sizeof(this->txtBuffer), "%s %s %5.2lf%% %5.2lf%% %5.2lf%%", some ? "some" : "full", file, this->values[0], this->values[1], this->values[2]);
+
+#ifdef HTOP_LINUX
+   PressureStallEvents events;
+   PressureStall_getEvents(file, some, &events);
+   if (events.triggers)
+      snprintf(this->txtBuffer + len, sizeof(this->txtBuffer) - (size_t)len, " %u stalls", events.events);
+   else if (events.failed)
+      snprintf(this->txtBuffer + len, sizeof(this->txtBuffer) - (size_t)len, " (no trigger)");
+#else
+   (void) len;
+#endif
 }
 
 static void PressureStallMeter_display(const Object* cast, RichString* out) {
@@ -61,6 +80,23 @@ static void PressureStallMeter_display(const Object* cast, RichString* out) {
    RichString_appendnAscii(out, CRT_colors[PRESSURE_STALL_SIXTY], buffer, len);
    len = xSnprintf(buffer, sizeof(buffer), "%5.2lf%% ", this->values[2]);
    RichString_appendnAscii(out, CRT_colors[PRESSURE_STALL_THREEHUNDRED], buffer, len);
+
+#ifdef HTOP_LINUX
+   bool some;
+   const char* file = PressureStallMeter_file(this, &some);
+   PressureStallEvents events;
+   PressureStall_getEvents(file, some, &events);
+
+   if (events.triggers) {
+      uint64_t now;
+      Platform_gettime_monotonic(&now);
+      bool recent = events.events && now - events.lastEventMs < PRESSURE_STALL_RECENT_MS;
+      len = xSnprintf(buffer, sizeof(buffer), "%u stalls", events.events);
+      RichString_appendnAscii(out, CRT_colors[recent ? METER_VALUE_ERROR : PRESSURE_STALL_THREEHUNDRED], buffer, len);
+   } else if (events.failed) {
+      RichString_appendAscii(out, CRT_colors[PRESSURE_STALL_THREEHUNDRED], "(no trigger)");
+   }
+#endif
 }
 
 const MeterClass PressureStallCPUSomeMeter_class = {
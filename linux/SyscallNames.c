@@ -0,0 +1,399 @@
+/*
+htop - linux/SyscallNames.c
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+#include "config.h" // IWYU pragma: keep
+
+#include "linux/SyscallNames.h"
+
+#include <stddef.h>
+#include <sys/syscall.h>
+
+#include "Macros.h"
+
+
+#define SYSCALL_NAME(name_) { SYS_##name_, #name_ }
+
+/* The calls threads are usually found blocked in, as far as the architecture has them */
+static const struct {
+   long number;
+   const char* name;
+} SyscallNames_table[] = {
+#ifdef SYS_accept
+   SYSCALL_NAME(accept),
+#endif
+#ifdef SYS_accept4
+   SYSCALL_NAME(accept4),
+#endif
+#ifdef SYS_bind
+   SYSCALL_NAME(bind),
+#endif
+#ifdef SYS_brk
+   SYSCALL_NAME(brk),
+#endif
+#ifdef SYS_chdir
+   SYSCALL_NAME(chdir),
+#endif
+#ifdef SYS_clock_nanosleep
+   SYSCALL_NAME(clock_nanosleep),
+#endif
+#ifdef SYS_clone
+   SYSCALL_NAME(clone),
+#endif
+#ifdef SYS_clone3
+   SYSCALL_NAME(clone3),
+#endif
+#ifdef SYS_close
+   SYSCALL_NAME(close),
+#endif
+#ifdef SYS_close_range
+   SYSCALL_NAME(close_range),
+#endif
+#ifdef SYS_connect
+   SYSCALL_NAME(connect),
+#endif
+#ifdef SYS_copy_file_range
+   SYSCALL_NAME(copy_file_range),
+#endif
+#ifdef SYS_dup
+   SYSCALL_NAME(dup),
+#endif
+#ifdef SYS_dup2
+   SYSCALL_NAME(dup2),
+#endif
+#ifdef SYS_dup3
+   SYSCALL_NAME(dup3),
+#endif
+#ifdef SYS_epoll_ctl
+   SYSCALL_NAME(epoll_ctl),
+#endif
+#ifdef SYS_epoll_pwait
+   SYSCALL_NAME(epoll_pwait),
+#endif
+#ifdef SYS_epoll_pwait2
+   SYSCALL_NAME(epoll_pwait2),
+#endif
+#ifdef SYS_epoll_wait
+   SYSCALL_NAME(epoll_wait),
+#endif
+#ifdef SYS_eventfd2
+   SYSCALL_NAME(eventfd2),
+#endif
+#ifdef SYS_execve
+   SYSCALL_NAME(execve),
+#endif
+#ifdef SYS_execveat
+   SYSCALL_NAME(execveat),
+#endif
+#ifdef SYS_exit
+   SYSCALL_NAME(exit),
+#endif
+#ifdef SYS_exit_group
+   SYSCALL_NAME(exit_group),
+#endif
+#ifdef SYS_faccessat
+   SYSCALL_NAME(faccessat),
+#endif
+#ifdef SYS_fadvise64
+   SYSCALL_NAME(fadvise64),
+#endif
+#ifdef SYS_fallocate
+   SYSCALL_NAME(fallocate),
+#endif
+#ifdef SYS_fchmod
+   SYSCALL_NAME(fchmod),
+#endif
+#ifdef SYS_fchown
+   SYSCALL_NAME(fchown),
+#endif
+#ifdef SYS_fcntl
+   SYSCALL_NAME(fcntl),
+#endif
+#ifdef SYS_fdatasync
+   SYSCALL_NAME(fdatasync),
+#endif
+#ifdef SYS_flock
+   SYSCALL_NAME(flock),
+#endif
+#ifdef SYS_fork
+   SYSCALL_NAME(fork),
+#endif
+#ifdef SYS_fstat
+   SYSCALL_NAME(fstat),
+#endif
+#ifdef SYS_fstatfs
+   SYSCALL_NAME(fstatfs),
+#endif
+#ifdef SYS_fsync
+   SYSCALL_NAME(fsync),
+#endif
+#ifdef SYS_ftruncate
+   SYSCALL_NAME(ftruncate),
+#endif
+#ifdef SYS_futex
+   SYSCALL_NAME(futex),
+#endif
+#ifdef SYS_futex_waitv
+   SYSCALL_NAME(futex_waitv),
+#endif
+#ifdef SYS_getdents
+   SYSCALL_NAME(getdents),
+#endif
+#ifdef SYS_getdents64
+   SYSCALL_NAME(getdents64),
+#endif
+#ifdef SYS_getpid
+   SYSCALL_NAME(getpid),
+#endif
+#ifdef SYS_getrandom
+   SYSCALL_NAME(getrandom),
+#endif
+#ifdef SYS_getsockopt
+   SYSCALL_NAME(getsockopt),
+#endif
+#ifdef SYS_gettid
+   SYSCALL_NAME(gettid),
+#endif
+#ifdef SYS_io_getevents
+   SYSCALL_NAME(io_getevents),
+#endif
+#ifdef SYS_io_pgetevents
+   SYSCALL_NAME(io_pgetevents),
+#endif
+#ifdef SYS_io_submit
+   SYSCALL_NAME(io_submit),
+#endif
+#ifdef SYS_io_uring_enter
+   SYSCALL_NAME(io_uring_enter),
+#endif
+#ifdef SYS_ioctl
+   SYSCALL_NAME(ioctl),
+#endif
+#ifdef SYS_kill
+   SYSCALL_NAME(kill),
+#endif
+#ifdef SYS_lseek
+   SYSCALL_NAME(lseek),
+#endif
+#ifdef SYS_lstat
+   SYSCALL_NAME(lstat),
+#endif
+#ifdef SYS_madvise
+   SYSCALL_NAME(madvise),
+#endif
+#ifdef SYS_membarrier
+   SYSCALL_NAME(membarrier),
+#endif
+#ifdef SYS_mkdir
+   SYSCALL_NAME(mkdir),
+#endif
+#ifdef SYS_mkdirat
+   SYSCALL_NAME(mkdirat),
+#endif
+#ifdef SYS_mmap
+   SYSCALL_NAME(mmap),
+#endif
+#ifdef SYS_mprotect
+   SYSCALL_NAME(mprotect),
+#endif
+#ifdef SYS_mremap
+   SYSCALL_NAME(mremap),
+#endif
+#ifdef SYS_msgrcv
+   SYSCALL_NAME(msgrcv),
+#endif
+#ifdef SYS_msgsnd
+   SYSCALL_NAME(msgsnd),
+#endif
+#ifdef SYS_msync
+   SYSCALL_NAME(msync),
+#endif
+#ifdef SYS_munmap
+   SYSCALL_NAME(munmap),
+#endif
+#ifdef SYS_nanosleep
+   SYSCALL_NAME(nanosleep),
+#endif
+#ifdef SYS_newfstatat
+   SYSCALL_NAME(newfstatat),
+#endif
+#ifdef SYS_open
+   SYSCALL_NAME(open),
+#endif
+#ifdef SYS_openat
+   SYSCALL_NAME(openat),
+#endif
+#ifdef SYS_openat2
+   SYSCALL_NAME(openat2),
+#endif
+#ifdef SYS_pause
+   SYSCALL_NAME(pause),
+#endif
+#ifdef SYS_pipe
+   SYSCALL_NAME(pipe),
+#endif
+#ifdef SYS_pipe2
+   SYSCALL_NAME(pipe2),
+#endif
+#ifdef SYS_poll
+   SYSCALL_NAME(poll),
+#endif
+#ifdef SYS_ppoll
+   SYSCALL_NAME(ppoll),
+#endif
+#ifdef SYS_pread64
+   SYSCALL_NAME(pread64),
+#endif
+#ifdef SYS_preadv
+   SYSCALL_NAME(preadv),
+#endif
+#ifdef SYS_preadv2
+   SYSCALL_NAME(preadv2),
+#endif
+#ifdef SYS_pselect6
+   SYSCALL_NAME(pselect6),
+#endif
+#ifdef SYS_ptrace
+   SYSCALL_NAME(ptrace),
+#endif
+#ifdef SYS_pwrite64
+   SYSCALL_NAME(pwrite64),
+#endif
+#ifdef SYS_pwritev
+   SYSCALL_NAME(pwritev),
+#endif
+#ifdef SYS_pwritev2
+   SYSCALL_NAME(pwritev2),
+#endif
+#ifdef SYS_read
+   SYSCALL_NAME(read),
+#endif
+#ifdef SYS_readlink
+   SYSCALL_NAME(readlink),
+#endif
+#ifdef SYS_readlinkat
+   SYSCALL_NAME(readlinkat),
+#endif
+#ifdef SYS_readv
+   SYSCALL_NAME(readv),
+#endif
+#ifdef SYS_recvfrom
+   SYSCALL_NAME(recvfrom),
+#endif
+#ifdef SYS_recvmmsg
+   SYSCALL_NAME(recvmmsg),
+#endif
+#ifdef SYS_recvmsg
+   SYSCALL_NAME(recvmsg),
+#endif
+#ifdef SYS_rename
+   SYSCALL_NAME(rename),
+#endif
+#ifdef SYS_renameat
+   SYSCALL_NAME(renameat),
+#endif
+#ifdef SYS_renameat2
+   SYSCALL_NAME(renameat2),
+#endif
+#ifdef SYS_rt_sigreturn
+   SYSCALL_NAME(rt_sigreturn),
+#endif
+#ifdef SYS_rt_sigsuspend
+   SYSCALL_NAME(rt_sigsuspend),
+#endif
+#ifdef SYS_rt_sigtimedwait
+   SYSCALL_NAME(rt_sigtimedwait),
+#endif
+#ifdef SYS_sched_yield
+   SYSCALL_NAME(sched_yield),
+#endif
+#ifdef SYS_select
+   SYSCALL_NAME(select),
+#endif
+#ifdef SYS_semop
+   SYSCALL_NAME(semop),
+#endif
+#ifdef SYS_semtimedop
+   SYSCALL_NAME(semtimedop),
+#endif
+#ifdef SYS_sendfile
+   SYSCALL_NAME(sendfile),
+#endif
+#ifdef SYS_sendmmsg
+   SYSCALL_NAME(sendmmsg),
+#endif
+#ifdef SYS_sendmsg
+   SYSCALL_NAME(sendmsg),
+#endif
+#ifdef SYS_sendto
+   SYSCALL_NAME(sendto),
+#endif
+#ifdef SYS_setsockopt
+   SYSCALL_NAME(setsockopt),
+#endif
+#ifdef SYS_shutdown
+   SYSCALL_NAME(shutdown),
+#endif
+#ifdef SYS_socket
+   SYSCALL_NAME(socket),
+#endif
+#ifdef SYS_splice
+   SYSCALL_NAME(splice),
+#endif
+#ifdef SYS_stat
+   SYSCALL_NAME(stat),
+#endif
+#ifdef SYS_statx
+   SYSCALL_NAME(statx),
+#endif
+#ifdef SYS_sync
+   SYSCALL_NAME(sync),
+#endif
+#ifdef SYS_sync_file_range
+   SYSCALL_NAME(sync_file_range),
+#endif
+#ifdef SYS_syncfs
+   SYSCALL_NAME(syncfs),
+#endif
+#ifdef SYS_tgkill
+   SYSCALL_NAME(tgkill),
+#endif
+#ifdef SYS_truncate
+   SYSCALL_NAME(truncate),
+#endif
+#ifdef SYS_umount2
+   SYSCALL_NAME(umount2),
+#endif
+#ifdef SYS_unlink
+   SYSCALL_NAME(unlink),
+#endif
+#ifdef SYS_unlinkat
+   SYSCALL_NAME(unlinkat),
+#endif
+#ifdef SYS_vfork
+   SYSCALL_NAME(vfork),
+#endif
+#ifdef SYS_wait4
+   SYSCALL_NAME(wait4),
+#endif
+#ifdef SYS_waitid
+   SYSCALL_NAME(waitid),
+#endif
+#ifdef SYS_write
+   SYSCALL_NAME(write),
+#endif
+#ifdef SYS_writev
+   SYSCALL_NAME(writev),
+#endif
+};
+
+const char* SyscallNames_get(long number) {
+   for (size_t i = 0; i < ARRAYSIZE(SyscallNames_table); i++) {
+      if (SyscallNames_table[i].number == number)
+         return SyscallNames_table[i].name;
+   }
+   return NULL;
+}
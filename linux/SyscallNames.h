@@ -0,0 +1,14 @@
+#ifndef HEADER_SyscallNames
+#define HEADER_SyscallNames
+/*
+htop - linux/SyscallNames.h
+(C) 2022 htop dev team
+Released under the GNU GPLv2+, see the COPYING file
+in the source distribution for its full text.
+*/
+
+
+/* The name of a system call by its number, NULL if unknown */
+const char* SyscallNames_get(long number);
+
+#endif
@@ -8,7 +8,11 @@ in the source distribution for its full text.
 #include "linux/SystemdMeter.h"
 
 #include <dlfcn.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -18,6 +22,7 @@ in the source distribution for its full text.
 #include "CRT.h"
 #include "Macros.h"
 #include "Object.h"
+#include "ProcessList.h"
 #include "RichString.h"
 #include "Settings.h"
 #include "XUtils.h"
@@ -30,17 +35,32 @@ in the source distribution for its full text.
 #ifdef BUILD_STATIC
 
 #define sym_sd_bus_open_system sd_bus_open_system
-#define sym_sd_bus_get_property_string sd_bus_get_property_string
-#define sym_sd_bus_get_property_trivial sd_bus_get_property_trivial
+#define sym_sd_bus_call_method sd_bus_call_method
+#define sym_sd_bus_add_match sd_bus_add_match
+#define sym_sd_bus_process sd_bus_process
+#define sym_sd_bus_message_enter_container sd_bus_message_enter_container
+#define sym_sd_bus_message_exit_container sd_bus_message_exit_container
+#define sym_sd_bus_message_read sd_bus_message_read
+#define sym_sd_bus_message_skip sd_bus_message_skip
+#define sym_sd_bus_message_unref sd_bus_message_unref
 #define sym_sd_bus_unref sd_bus_unref
 
 #else
 
 typedef void sd_bus;
 typedef void sd_bus_error;
+typedef void sd_bus_message;
+typedef void sd_bus_slot;
+typedef int (*sd_bus_message_handler_t)(sd_bus_message*, void*, sd_bus_error*);
 static int (*sym_sd_bus_open_system)(sd_bus**);
-static int (*sym_sd_bus_get_property_string)(sd_bus*, const char*, const char*, const char*, const char*, sd_bus_error*, char**);
-static int (*sym_sd_bus_get_property_trivial)(sd_bus*, const char*, const char*, const char*, const char*, sd_bus_error*, char, void*);
+static int (*sym_sd_bus_call_method)(sd_bus*, const char*, const char*, const char*, const char*, sd_bus_error*, sd_bus_message**, const char*, ...);
+static int (*sym_sd_bus_add_match)(sd_bus*, sd_bus_slot**, const char*, sd_bus_message_handler_t, void*);
+static int (*sym_sd_bus_process)(sd_bus*, sd_bus_message**);
+static int (*sym_sd_bus_message_enter_container)(sd_bus_message*, char, const char*);
+static int (*sym_sd_bus_message_exit_container)(sd_bus_message*);
+static int (*sym_sd_bus_message_read)(sd_bus_message*, const char*, ...);
+static int (*sym_sd_bus_message_skip)(sd_bus_message*, const char*);
+static sd_bus_message* (*sym_sd_bus_message_unref)(sd_bus_message*);
 static sd_bus* (*sym_sd_bus_unref)(sd_bus*);
 static void* dlopenHandle = NULL;
 
@@ -48,21 +68,55 @@ static void* dlopenHandle = NULL;
 
 #if !defined(BUILD_STATIC) || defined(HAVE_LIBSYSTEMD)
 static sd_bus* bus = NULL;
+
+/* set by signals of systemd, so the properties are only fetched again once something changed */
+static bool busChanged = true;
+
+/* without the signals, they are fetched at each update */
+static bool busPolling = false;
 #endif /* !BUILD_STATIC || HAVE_LIBSYSTEMD */
 
 
 #define INVALID_VALUE ((unsigned int)-1)
 
+/* how often to connect to the bus again, or to run systemctl, when there is no connection */
+#define SYSTEMD_RETRY_MS 10000
+
 static char* systemState = NULL;
 static unsigned int nFailedUnits = INVALID_VALUE;
 static unsigned int nInstalledJobs = INVALID_VALUE;
 static unsigned int nNames = INVALID_VALUE;
 static unsigned int nJobs = INVALID_VALUE;
 
+static uint64_t nextRetry = 0;
+
+/* systemctl run in the background, its output collected over several updates */
+static pid_t execChild = 0;
+static int execFd = -1;
+static char execOutput[512];
+static size_t execOutputLen = 0;
+
+static void SystemdMeter_invalidate(void) {
+   free(systemState);
+   systemState = NULL;
+   nFailedUnits = nInstalledJobs = nNames = nJobs = INVALID_VALUE;
+}
+
 static void SystemdMeter_done(ATTR_UNUSED Meter* this) {
    free(systemState);
    systemState = NULL;
 
+   if (execFd >= 0) {
+      close(execFd);
+      execFd = -1;
+   }
+   if (execChild > 0) {
+      kill(execChild, SIGTERM);
+      waitpid(execChild, NULL, 0);
+      execChild = 0;
+   }
+   nextRetry = 0;
+
 #ifdef BUILD_STATIC
 # ifdef HAVE_LIBSYSTEMD
    if (bus) {
@@ -84,6 +138,89 @@ static void SystemdMeter_done(ATTR_UNUSED Meter* this) {
 }
 
 #if !defined(BUILD_STATIC) || defined(HAVE_LIBSYSTEMD)
+
+static const char* const busServiceName = "org.freedesktop.systemd1";
+static const char* const busObjectPath = "/org/freedesktop/systemd1";
+static const char* const busInterfaceName = "org.freedesktop.systemd1.Manager";
+
+static int SystemdMeter_onSignal(ATTR_UNUSED sd_bus_message* message, ATTR_UNUSED void* userdata, ATTR_UNUSED sd_bus_error* error) {
+   busChanged = true;
+   return 0;
+}
+
+static int connectBus(void) {
+   int r = sym_sd_bus_open_system(&bus);
+   if (r < 0)
+      return r;
+
+   /*
+    * Any unit or job coming, going or changing its state may change the
+    * counts; the manager only sends the signals of units and jobs to
+    * subscribers. The bus is never waited on, the signals are just
+    * drained at each update.
+    */
+   r = sym_sd_bus_add_match(bus, NULL,
+                            "type='signal',sender='org.freedesktop.systemd1'",
+                            SystemdMeter_onSignal, NULL);
+   if (r < 0)
+      return r;
+
+   r = sym_sd_bus_call_method(bus, busServiceName, busObjectPath, busInterfaceName, "Subscribe", NULL, NULL, NULL);
+   busPolling = r < 0;
+   busChanged = true;
+   return 0;
+}
+
+/* All properties of the manager in a single call, "a{sv}" */
+static int readProperties(void) {
+   sd_bus_message* reply = NULL;
+   int r = sym_sd_bus_call_method(bus, busServiceName, busObjectPath, "org.freedesktop.DBus.Properties", "GetAll", NULL, &reply, "s", busInterfaceName);
+   if (r < 0)
+      return r;
+
+   static const struct {
+      const char* name;
+      unsigned int* value;
+   } counts[] = {
+      { "NFailedUnits",   &nFailedUnits },
+      { "NInstalledJobs", &nInstalledJobs },
+      { "NNames",         &nNames },
+      { "NJobs",          &nJobs },
+   };
+
+   r = sym_sd_bus_message_enter_container(reply, 'a', "{sv}");
+   while (r >= 0 && (r = sym_sd_bus_message_enter_container(reply, 'e', "sv")) > 0) {
+      const char* name;
+      r = sym_sd_bus_message_read(reply, "s", &name);
+      if (r < 0)
+         break;
+
+      bool known = false;
+      if (String_eq(name, "SystemState")) {
+         const char* state;
+         r = sym_sd_bus_message_read(reply, "v", "s", &state);
+         if (r >= 0)
+            free_and_xStrdup(&systemState, state);
+         known = true;
+      }
+      for (size_t i = 0; !known && i < ARRAYSIZE(counts); i++) {
+         if (String_eq(name, counts[i].name)) {
+            r = sym_sd_bus_message_read(reply, "v", "u", counts[i].value);
+            known = true;
+         }
+      }
+      if (!known)
+         r = sym_sd_bus_message_skip(reply, "v");
+      if (r >= 0)
+         r = sym_sd_bus_message_exit_container(reply);
+   }
+   if (r >= 0)
+      r = sym_sd_bus_message_exit_container(reply);
+
+   sym_sd_bus_message_unref(reply);
+   return r;
+}
+
 static int updateViaLib(void) {
 #ifndef BUILD_STATIC
    if (!dlopenHandle) {
@@ -101,8 +238,14 @@ static int updateViaLib(void) {
       } while(0)
 
       resolve(sd_bus_open_system);
-      resolve(sd_bus_get_property_string);
-      resolve(sd_bus_get_property_trivial);
+      resolve(sd_bus_call_method);
+      resolve(sd_bus_add_match);
+      resolve(sd_bus_process);
+      resolve(sd_bus_message_enter_container);
+      resolve(sd_bus_message_exit_container);
+      resolve(sd_bus_message_read);
+      resolve(sd_bus_message_skip);
+      resolve(sd_bus_message_unref);
       resolve(sd_bus_unref);
 
       #undef resolve
@@ -111,77 +254,34 @@ static int updateViaLib(void) {
 
    int r;
 
-   /* Connect to the system bus */
+   /* Connect to the system bus once, and keep the connection */
    if (!bus) {
-      r = sym_sd_bus_open_system(&bus);
+      r = connectBus();
       if (r < 0)
          goto busfailure;
    }
 
-   static const char* const busServiceName = "org.freedesktop.systemd1";
-   static const char* const busObjectPath = "/org/freedesktop/systemd1";
-   static const char* const busInterfaceName = "org.freedesktop.systemd1.Manager";
-
-   r = sym_sd_bus_get_property_string(bus,
-                                      busServiceName,        /* service to contact */
-                                      busObjectPath,         /* object path */
-                                      busInterfaceName,      /* interface name */
-                                      "SystemState",         /* property name */
-                                      NULL,                  /* object to return error in */
-                                      &systemState);
-   if (r < 0)
-      goto busfailure;
-
-   r = sym_sd_bus_get_property_trivial(bus,
-                                       busServiceName,       /* service to contact */
-                                       busObjectPath,        /* object path */
-                                       busInterfaceName,     /* interface name */
-                                       "NFailedUnits",       /* property name */
-                                       NULL,                 /* object to return error in */
-                                       'u',                  /* property type */
-                                       &nFailedUnits);
-   if (r < 0)
-      goto busfailure;
-
-   r = sym_sd_bus_get_property_trivial(bus,
-                                       busServiceName,       /* service to contact */
-                                       busObjectPath,        /* object path */
-                                       busInterfaceName,     /* interface name */
-                                       "NInstalledJobs",     /* property name */
-                                       NULL,                 /* object to return error in */
-                                       'u',                  /* property type */
-                                       &nInstalledJobs);
+   /* Handle the signals having arrived meanwhile, without waiting for any */
+   while ((r = sym_sd_bus_process(bus, NULL)) > 0)
+      ;
    if (r < 0)
       goto busfailure;
 
-   r = sym_sd_bus_get_property_trivial(bus,
-                                       busServiceName,       /* service to contact */
-                                       busObjectPath,        /* object path */
-                                       busInterfaceName,     /* interface name */
-                                       "NNames",             /* property name */
-                                       NULL,                 /* object to return error in */
-                                       'u',                  /* property type */
-                                       &nNames);
-   if (r < 0)
-      goto busfailure;
+   if (!busChanged)
+      return 0;
 
-   r = sym_sd_bus_get_property_trivial(bus,
-                                       busServiceName,       /* service to contact */
-                                       busObjectPath,        /* object path */
-                                       busInterfaceName,     /* interface name */
-                                       "NJobs",              /* property name */
-                                       NULL,                 /* object to return error in */
-                                       'u',                  /* property type */
-                                       &nJobs);
+   r = readProperties();
    if (r < 0)
       goto busfailure;
 
-   /* success */
+   busChanged = busPolling;
    return 0;
 
 busfailure:
-   sym_sd_bus_unref(bus);
+   if (bus)
+      sym_sd_bus_unref(bus);
    bus = NULL;
+   SystemdMeter_invalidate();
    return -2;
 
 #ifndef BUILD_STATIC
@@ -195,6 +295,60 @@ dlfailure:
 }
 #endif /* !BUILD_STATIC || HAVE_LIBSYSTEMD */
 
+static void parseExecOutput(void) {
+   execOutput[execOutputLen] = '\0';
+
+   char* line = execOutput;
+   while (line && *line) {
+      char* newline = strchr(line, '\n');
+      if (newline)
+         *newline++ = '\0';
+
+      if (String_startsWith(line, "SystemState=")) {
+         free_and_xStrdup(&systemState, line + strlen("SystemState="));
+      } else if (String_startsWith(line, "NFailedUnits=")) {
+         nFailedUnits = strtoul(line + strlen("NFailedUnits="), NULL, 10);
+      } else if (String_startsWith(line, "NNames=")) {
+         nNames = strtoul(line + strlen("NNames="), NULL, 10);
+      } else if (String_startsWith(line, "NJobs=")) {
+         nJobs = strtoul(line + strlen("NJobs="), NULL, 10);
+      } else if (String_startsWith(line, "NInstalledJobs=")) {
+         nInstalledJobs = strtoul(line + strlen("NInstalledJobs="), NULL, 10);
+      }
+      line = newline;
+   }
+}
+
+/* Collects what systemctl has written so far, and its values once it is done */
+static void collectExec(void) {
+   while (execFd >= 0) {
+      ssize_t r = read(execFd, execOutput + execOutputLen, sizeof(execOutput) - 1 - execOutputLen);
+      if (r > 0) {
+         execOutputLen += (size_t)r;
+         if (execOutputLen < sizeof(execOutput) - 1)
+            continue;
+      } else if (r < 0 && errno == EINTR) {
+         continue;
+      } else if (r < 0 && errno == EAGAIN) {
+         return;
+      }
+
+      close(execFd);
+      execFd = -1;
+   }
+
+   int wstatus;
+   pid_t r = waitpid(execChild, &wstatus, WNOHANG);
+   if (r == 0)
+      return;
+
+   execChild = 0;
+   SystemdMeter_invalidate();
+   if (r > 0 && WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 0)
+      parseExecOutput();
+}
+
+/* Runs systemctl without waiting for it; the values of the previous run are shown meanwhile */
 static void updateViaExec(void) {
    if (Settings_isReadonly())
       return;
@@ -203,6 +357,12 @@ static void updateViaExec(void) {
    if (pipe(fdpair) < 0)
       return;
 
+   if (fcntl(fdpair[0], F_SETFL, O_NONBLOCK) < 0 || fcntl(fdpair[0], F_SETFD, FD_CLOEXEC) < 0) {
+      close(fdpair[1]);
+      close(fdpair[0]);
+      return;
+   }
+
    pid_t child = fork();
    if (child < 0) {
       close(fdpair[1]);
@@ -232,51 +392,34 @@ static void updateViaExec(void) {
    }
    close(fdpair[1]);
 
-   int wstatus;
-   if (waitpid(child, &wstatus, 0) < 0 || !WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0) {
-      close(fdpair[0]);
-      return;
-   }
-
-   FILE* commandOutput = fdopen(fdpair[0], "r");
-   if (!commandOutput) {
-      close(fdpair[0]);
-      return;
-   }
-
-   char lineBuffer[128];
-   while (fgets(lineBuffer, sizeof(lineBuffer), commandOutput)) {
-      if (String_startsWith(lineBuffer, "SystemState=")) {
-         char* newline = strchr(lineBuffer + strlen("SystemState="), '\n');
-         if (newline) {
-            *newline = '\0';
-         }
-         free_and_xStrdup(&systemState, lineBuffer + strlen("SystemState="));
-      } else if (String_startsWith(lineBuffer, "NFailedUnits=")) {
-         nFailedUnits = strtoul(lineBuffer + strlen("NFailedUnits="), NULL, 10);
-      } else if (String_startsWith(lineBuffer, "NNames=")) {
-         nNames = strtoul(lineBuffer + strlen("NNames="), NULL, 10);
-      } else if (String_startsWith(lineBuffer, "NJobs=")) {
-         nJobs = strtoul(lineBuffer + strlen("NJobs="), NULL, 10);
-      } else if (String_startsWith(lineBuffer, "NInstalledJobs=")) {
-         nInstalledJobs = strtoul(lineBuffer + strlen("NInstalledJobs="), NULL, 10);
-      }
-   }
-
-   fclose(commandOutput);
+   execChild = child;
+   execFd = fdpair[0];
+   execOutputLen = 0;
 }
 
 static void SystemdMeter_updateValues(Meter* this) {
-   free(systemState);
-   systemState = NULL;
-   nFailedUnits = nInstalledJobs = nNames = nJobs = INVALID_VALUE;
+   uint64_t now = this->pl->monotonicMs;
 
+   if (execChild > 0) {
+      collectExec();
+   }
 #if !defined(BUILD_STATIC) || defined(HAVE_LIBSYSTEMD)
-   if (updateViaLib() < 0)
-      updateViaExec();
+   else if (bus && updateViaLib() == 0) {
+      /* still connected, and up to date */
+   }
+#endif /* !BUILD_STATIC || HAVE_LIBSYSTEMD */
+   else if (now >= nextRetry) {
+      /* connecting again, or running systemctl instead, only every so often */
+      nextRetry = now + SYSTEMD_RETRY_MS;
+#if !defined(BUILD_STATIC) || defined(HAVE_LIBSYSTEMD)
+      if (updateViaLib() == 0)
+         nextRetry = 0;  /* should the connection break, try again at once */
+      else
+         updateViaExec();
 #else
-   updateViaExec();
+      updateViaExec();
 #endif /* !BUILD_STATIC || HAVE_LIBSYSTEMD */
+   }
 
    xSnprintf(this->txtBuffer, sizeof(this->txtBuffer), "%s", systemState ? systemState : "???");
 }
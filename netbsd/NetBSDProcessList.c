@@ -113,7 +113,7 @@ ProcessList* ProcessList_new(UsersTable* usersTable, Hashtable* dynamicMeters, H
 
    NetBSDProcessList* npl = xCalloc(1, sizeof(NetBSDProcessList));
    ProcessList* pl = (ProcessList*) npl;
-   ProcessList_init(pl, Class(NetBSDProcess), usersTable, dynamicMeters, dynamicColumns, pidMatchList, userId);
+   ProcessList_init(pl, Class(NetBSDProcess), NetBSDProcess_new, usersTable, dynamicMeters, dynamicColumns, pidMatchList, userId);
 
    NetBSDProcessList_updateCPUcount(pl);
 
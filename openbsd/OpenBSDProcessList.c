@@ -101,7 +101,7 @@ ProcessList* ProcessList_new(UsersTable* usersTable, Hashtable* dynamicMeters, H
 
    OpenBSDProcessList* opl = xCalloc(1, sizeof(OpenBSDProcessList));
    ProcessList* pl = (ProcessList*) opl;
-   ProcessList_init(pl, Class(OpenBSDProcess), usersTable, dynamicMeters, dynamicColumns, pidMatchList, userId);
+   ProcessList_init(pl, Class(OpenBSDProcess), OpenBSDProcess_new, usersTable, dynamicMeters, dynamicColumns, pidMatchList, userId);
 
    OpenBSDProcessList_updateCPUcount(pl);
 
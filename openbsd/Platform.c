@@ -40,6 +40,7 @@ in the source distribution for its full text.
 #include "SwapMeter.h"
 #include "SysArchMeter.h"
 #include "TasksMeter.h"
+#include "UpdateIntervalMeter.h"
 #include "UptimeMeter.h"
 #include "XUtils.h"
 #include "openbsd/OpenBSDProcess.h"
@@ -102,6 +103,7 @@ const MeterClass* const Platform_meterTypes[] = {
    &MemorySwapMeter_class,
    &TasksMeter_class,
    &UptimeMeter_class,
+   &UpdateIntervalMeter_class,
    &BatteryMeter_class,
    &HostnameMeter_class,
    &SysArchMeter_class,
@@ -117,6 +119,9 @@ const MeterClass* const Platform_meterTypes[] = {
    &RightCPUs4Meter_class,
    &LeftCPUs8Meter_class,
    &RightCPUs8Meter_class,
+   &CPUHeatmapMeter_class,
+   &CPUHeatmapNUMAMeter_class,
+   &CPUHeatmapPackageMeter_class,
    &BlankMeter_class,
    NULL
 };
@@ -135,6 +140,11 @@ void Platform_setBindings(Htop_Action* keys) {
    (void) keys;
 }
 
+void Platform_addEventSources(State* st) {
+   /* no platform-specific event sources */
+   (void) st;
+}
+
 int Platform_getUptime() {
    struct timeval bootTime, currTime;
    const int mib[2] = { CTL_KERN, KERN_BOOTTIME };
@@ -292,6 +302,25 @@ FileLocks_ProcessData* Platform_getProcessLocks(pid_t pid) {
    return NULL;
 }
 
+FileLocks_ProcessData* Platform_getSystemLocks(void) {
+   return NULL;
+}
+
+OpenFiles_ProcessData* Platform_getProcessOpenFiles(pid_t pid, OpenFiles_ProcessData* previous) {
+   (void)pid;
+   (void)previous;
+   return NULL;
+}
+
+bool Platform_sampleThreads(pid_t pid, bool stacks, ThreadSample** samples, size_t* count, size_t* capacity) {
+   (void)pid;
+   (void)stacks;
+   (void)samples;
+   (void)count;
+   (void)capacity;
+   return false;
+}
+
 bool Platform_getDiskIO(DiskIOData* data) {
    // TODO
    (void)data;
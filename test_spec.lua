@@ -214,6 +214,15 @@ describe("htop test suite", function()
       assert.equal(check(initpid))
    end)
 
+   running_it("rejects too deeply nested filter expressions", function()
+      for _, nesting in ipairs({ string.rep("(", 50000), string.rep("!", 50000) }) do
+         local fd = io.popen("HTOPRC=./test.htoprc ./htop --batch=silent -n 1 -F '=" .. nesting .. "pid > 0' 2>&1", "r")
+         local out = fd:read("*a")
+         fd:close()
+         assert.truthy(out:find("expression too deeply nested", 1, true))
+      end
+   end)
+
    running_it("performs incremental search", function()
       send(curses.KEY_HOME)
       send("/")
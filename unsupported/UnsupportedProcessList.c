@@ -16,7 +16,7 @@ in the source distribution for its full text.
 
 ProcessList* ProcessList_new(UsersTable* usersTable, Hashtable* dynamicMeters, Hashtable* dynamicColumns, Hashtable* pidMatchList, uid_t userId) {
    ProcessList* this = xCalloc(1, sizeof(ProcessList));
-   ProcessList_init(this, Class(Process), usersTable, dynamicMeters, dynamicColumns, pidMatchList, userId);
+   ProcessList_init(this, Class(Process), UnsupportedProcess_new, usersTable, dynamicMeters, dynamicColumns, pidMatchList, userId);
 
    this->existingCPUs = 1;
    this->activeCPUs = 1;